@@ -0,0 +1,306 @@
+/**
+* @File: DeadlineScheduler.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the DeadlineScheduler class, a fixed size table of periodic tasks run from
+ * loop(). It replaces the heap allocated AsyncTimeScheduler objects and their std::function tasks:
+ * - the table is sized at compile time and tasks are plain function pointers or callables held by reference, so
+ *   nothing touches the heap and dispatch is a direct call,
+ * - every task has an absolute deadline that advances by exactly one period, so periods do not drift by the runtime
+ *   of the task; deadlines missed while loop() was blocked are skipped rather than run in a burst,
+ * - when several tasks are due, the one with the highest priority runs first, then the one that is most overdue,
+ * - millisUntilNextDeadline() tells loop() how long it may sleep before the next task is due,
+ * - observeRuns() times every run of a task with a clock of the caller, e.g. for a profiler.
+*/
+
+#ifndef AERORADAREMBEDDED_DEADLINESCHEDULER_H
+#define AERORADAREMBEDDED_DEADLINESCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Runs periodic tasks at absolute deadlines.
+ * @tparam Capacity - the most tasks the table holds.
+ */
+template<uint8_t Capacity>
+class DeadlineScheduler {
+
+public:
+    /**
+     * How urgent a task is when several are due at once.
+     */
+    enum Priority : uint8_t {
+        PRIORITY_LOW = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_HIGH
+    };
+
+    //A task without state.
+    typedef void (*Task)();
+
+    //A clock the runtime of a task is measured with, e.g. micros().
+    typedef unsigned long (*Clock)();
+
+    //Called after every run of a task with its id and its runtime in ticks of the clock.
+    typedef void (*RunObserver)(uint8_t id, unsigned long elapsed);
+
+    //The value of millisUntilNextDeadline() when no task is enabled.
+    static const unsigned long noDeadline = 0xFFFFFFFFul;
+
+    /**
+     * Add a task. Its first deadline is one period from now.
+     * @param task - the function to run.
+     * @param periodMillis - the time between two runs.
+     * @param priority - the priority of the task.
+     * @param now - the current value of millis().
+     * @return int - the id of the task, -1 if the table is full.
+     */
+    int add(Task task, unsigned long periodMillis, Priority priority, unsigned long now) {
+        int id = add(periodMillis, priority, now);
+        if (id >= 0) {
+            tasks[id].function = task;
+        }
+        return id;
+    }
+
+    /**
+     * Add a callable object as a task. The object is held by reference and must outlive the scheduler.
+     * @tparam Callable - a type with void operator()().
+     * @param callable - the object to call.
+     * @param periodMillis - the time between two runs.
+     * @param priority - the priority of the task.
+     * @param now - the current value of millis().
+     * @return int - the id of the task, -1 if the table is full.
+     */
+    template<typename Callable>
+    int add(Callable &callable, unsigned long periodMillis, Priority priority, unsigned long now) {
+        int id = add(periodMillis, priority, now);
+        if (id >= 0) {
+            tasks[id].method = &invoke<Callable>;
+            tasks[id].object = &callable;
+        }
+        return id;
+    }
+
+    /**
+     * Run the due tasks, highest priority first. A task runs at most once per call.
+     * @param now - the current value of millis().
+     * @return uint8_t - the number of tasks run.
+     */
+    uint8_t runDue(unsigned long now) {
+        bool ran[Capacity] = {};
+        uint8_t runCount = 0;
+        while (true) {
+            int next = -1;
+            for (uint8_t i = 0; i < count; i++) {
+                if (ran[i] || !isDue(i, now)) {
+                    continue;
+                }
+                if (next < 0 || tasks[i].priority > tasks[next].priority
+                    || (tasks[i].priority == tasks[next].priority
+                        && (long) (tasks[i].deadline - tasks[next].deadline) < 0)) {
+                    next = i;
+                }
+            }
+            if (next < 0) {
+                return runCount;
+            }
+            ran[next] = true;
+            dispatch((uint8_t) next, now);
+            runCount++;
+        }
+    }
+
+    /**
+     * Run a single task if it is due, e.g. from a callback that must not run the other tasks.
+     * @param id - the id of the task.
+     * @param now - the current value of millis().
+     * @return bool - true if the task ran.
+     */
+    bool runIfDue(int id, unsigned long now) {
+        if (!isValid(id) || !isDue((uint8_t) id, now)) {
+            return false;
+        }
+        dispatch((uint8_t) id, now);
+        return true;
+    }
+
+    /**
+     * How long until the next task is due.
+     * @param now - the current value of millis().
+     * @return unsigned long - the milliseconds until the earliest deadline, 0 if a task is due, noDeadline if no
+     * task is enabled.
+     */
+    unsigned long millisUntilNextDeadline(unsigned long now) const {
+        unsigned long earliest = noDeadline;
+        for (uint8_t i = 0; i < count; i++) {
+            if (!tasks[i].enabled) {
+                continue;
+            }
+            long remaining = (long) (tasks[i].deadline - now);
+            unsigned long wait = remaining > 0 ? (unsigned long) remaining : 0;
+            if (wait < earliest) {
+                earliest = wait;
+            }
+        }
+        return earliest;
+    }
+
+    /**
+     * Change the period of a task. The next deadline becomes one new period after the last run.
+     * @param id - the id of the task.
+     * @param periodMillis - the new time between two runs.
+     */
+    void setPeriod(int id, unsigned long periodMillis) {
+        if (isValid(id) && periodMillis > 0) {
+            Entry &task = tasks[id];
+            task.deadline = task.deadline - task.period + periodMillis;
+            task.period = periodMillis;
+        }
+    }
+
+    /**
+     * Start the period of a task over, its next deadline becomes one period from now.
+     * @param id - the id of the task.
+     * @param now - the current value of millis().
+     */
+    void restart(int id, unsigned long now) {
+        if (isValid(id)) {
+            tasks[id].deadline = now + tasks[id].period;
+        }
+    }
+
+    /**
+     * Make a task due now, e.g. because an interrupt needs it handled before its next deadline.
+     * @param id - the id of the task.
+     * @param now - the current value of millis().
+     */
+    void runSoon(int id, unsigned long now) {
+        if (isValid(id)) {
+            tasks[id].deadline = now;
+        }
+    }
+
+    /**
+     * Enable or disable a task. A re-enabled task is due one period from now.
+     * @param id - the id of the task.
+     * @param enabled - whether the task runs.
+     * @param now - the current value of millis().
+     */
+    void setEnabled(int id, bool enabled, unsigned long now) {
+        if (isValid(id) && tasks[id].enabled != enabled) {
+            tasks[id].enabled = enabled;
+            tasks[id].deadline = now + tasks[id].period;
+        }
+    }
+
+    /**
+     * The number of deadlines a task has missed because loop() was blocked for more than a period.
+     * @param id - the id of the task.
+     * @return uint32_t - the number of skipped runs.
+     */
+    uint32_t skippedCount(int id) const {
+        return isValid(id) ? tasks[id].skipped : 0;
+    }
+
+    /**
+     * Time every run of a task and pass its runtime to an observer.
+     * @param timer - the clock the runtime is measured with.
+     * @param runObserver - called after every run, nullptr to stop timing.
+     */
+    void observeRuns(Clock timer, RunObserver runObserver) {
+        clock = timer;
+        observer = timer != nullptr ? runObserver : nullptr;
+    }
+
+private:
+    /**
+     * A row of the task table.
+     */
+    struct Entry {
+        //a plain function, or else method called with object
+        Task function;
+        void (*method)(void *object);
+        void *object;
+        unsigned long period;
+        unsigned long deadline;
+        uint32_t skipped;
+        Priority priority;
+        bool enabled;
+    };
+
+    Entry tasks[Capacity]{};
+    uint8_t count = 0;
+
+    //The clock and observer of observeRuns(), no run is timed without an observer.
+    Clock clock = nullptr;
+    RunObserver observer = nullptr;
+
+    /**
+     * Call a callable through a plain function pointer.
+     * @tparam Callable - the type of the object.
+     * @param object - the object.
+     */
+    template<typename Callable>
+    static void invoke(void *object) {
+        (*static_cast<Callable *>(object))();
+    }
+
+    /**
+     * Add a row to the table.
+     * @param periodMillis - the time between two runs.
+     * @param priority - the priority of the task.
+     * @param now - the current value of millis().
+     * @return int - the id of the row, -1 if the table is full or the period is 0.
+     */
+    int add(unsigned long periodMillis, Priority priority, unsigned long now) {
+        if (count == Capacity || periodMillis == 0) {
+            return -1;
+        }
+        tasks[count] = {nullptr, nullptr, nullptr, periodMillis, now + periodMillis, 0, priority, true};
+        return count++;
+    }
+
+    /**
+     * Whether an id refers to a row of the table.
+     * @param id - the id.
+     * @return bool - true if the id is valid.
+     */
+    bool isValid(int id) const {
+        return id >= 0 && id < count;
+    }
+
+    /**
+     * Whether a task is enabled and its deadline has passed.
+     * @param id - the id of the task.
+     * @param now - the current value of millis().
+     * @return bool - true if the task should run.
+     */
+    bool isDue(uint8_t id, unsigned long now) const {
+        return tasks[id].enabled && (long) (now - tasks[id].deadline) >= 0;
+    }
+
+    /**
+     * Advance the deadline of a task by whole periods past now, then run it.
+     * @param id - the id of the task.
+     * @param now - the current value of millis().
+     */
+    void dispatch(uint8_t id, unsigned long now) {
+        Entry &task = tasks[id];
+        unsigned long missed = (now - task.deadline) / task.period;
+        task.skipped += missed;
+        task.deadline += (missed + 1) * task.period;
+        unsigned long start = observer != nullptr ? clock() : 0;
+        if (task.function != nullptr) {
+            task.function();
+        } else {
+            task.method(task.object);
+        }
+        if (observer != nullptr) {
+            observer(id, clock() - start);
+        }
+    }
+};
+
+#endif //AERORADAREMBEDDED_DEADLINESCHEDULER_H
@@ -0,0 +1,113 @@
+/**
+* @File: BootSequence.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the BootSequence class.
+*/
+
+#include "BootSequence.h"
+#include <Arduino.h>
+#include "Log/Log.h"
+
+void BootSequence::begin(unsigned long now) {
+    bootMillis = now;
+    for (PhaseRecord &phase: phases) {
+        phase = {PENDING, 0, 0};
+    }
+}
+
+void BootSequence::start(Phase phase, unsigned long now) {
+    if (phase < PHASE_COUNT && phases[phase].status == PENDING) {
+        phases[phase].status = RUNNING;
+        phases[phase].startedMillis = now;
+    }
+}
+
+void BootSequence::finish(Phase phase, bool ready, unsigned long now) {
+    if (phase >= PHASE_COUNT || isDone(phase)) {
+        return;
+    }
+    //a phase that ends without having been started took no time of its own
+    if (phases[phase].status == PENDING) {
+        phases[phase].startedMillis = now;
+    }
+    phases[phase].status = ready ? READY : TIMED_OUT;
+    phases[phase].doneMillis = now;
+
+    LOG_INFO(LOG_BOOT, "Boot: %s %s %.1f s", name(phase), ready ? "ready after" : "timed out after",
+             (now - bootMillis) / 1000.0);
+}
+
+void BootSequence::skip(Phase phase, unsigned long now) {
+    if (phase < PHASE_COUNT && !isDone(phase)) {
+        phases[phase] = {SKIPPED, now, now};
+        LOG_INFO(LOG_BOOT, "Boot: %s skipped", name(phase));
+    }
+}
+
+bool BootSequence::hasTimedOut(Phase phase, unsigned long timeoutMillis, unsigned long now) const {
+    return isRunning(phase) && now - phases[phase].startedMillis >= timeoutMillis;
+}
+
+BootSequence::Status BootSequence::status(Phase phase) const {
+    return phase < PHASE_COUNT ? phases[phase].status : PENDING;
+}
+
+bool BootSequence::isRunning(Phase phase) const {
+    return status(phase) == RUNNING;
+}
+
+bool BootSequence::isDone(Phase phase) const {
+    return status(phase) == READY || status(phase) == TIMED_OUT || status(phase) == SKIPPED;
+}
+
+bool BootSequence::isComplete() const {
+    for (uint8_t i = 0; i < PHASE_COUNT; i++) {
+        if (!isDone((Phase) i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned long BootSequence::millisToDone(Phase phase) const {
+    return isDone(phase) ? phases[phase].doneMillis - bootMillis : 0;
+}
+
+unsigned long BootSequence::millisSinceDone(Phase phase, unsigned long now) const {
+    return isDone(phase) ? now - phases[phase].doneMillis : 0;
+}
+
+const char *BootSequence::name(Phase phase) {
+    switch (phase) {
+        case START_DELAY:
+            return "start delay";
+        case MAVLINK_LINK:
+            return "MAVLink link";
+        case GPS_FIX:
+            return "GPS fix";
+        case MODEM:
+            return "modem";
+        case BOOTUP_MESSAGE:
+            return "bootup message";
+        case CONFIGURATION:
+            return "configuration";
+        default:
+            return "unknown";
+    }
+}
+
+void BootSequence::report() const {
+    LOG_INFO(LOG_BOOT, "Boot phases (started / done, seconds since boot):");
+    for (uint8_t i = 0; i < PHASE_COUNT; i++) {
+        const PhaseRecord &phase = phases[i];
+        if (phase.status == PENDING || phase.status == SKIPPED) {
+            LOG_INFO(LOG_BOOT, "  %s: %s", name((Phase) i), phase.status == PENDING ? "pending" : "skipped");
+        } else if (phase.status == RUNNING) {
+            LOG_INFO(LOG_BOOT, "  %s: %.1f / running", name((Phase) i), (phase.startedMillis - bootMillis) / 1000.0);
+        } else {
+            LOG_INFO(LOG_BOOT, "  %s: %.1f / %.1f %s", name((Phase) i), (phase.startedMillis - bootMillis) / 1000.0,
+                     (phase.doneMillis - bootMillis) / 1000.0, phase.status == READY ? "ready" : "timed out");
+        }
+    }
+}
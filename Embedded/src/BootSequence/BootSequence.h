@@ -0,0 +1,164 @@
+/**
+* @File: BootSequence.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the BootSequence class, which tracks the phases of the boot of the Blackbox.
+ * setup() used to run the phases strictly one after the other and block in each of them, so the GPS wait, the bootup
+ * message and the configuration wait added up to several minutes before the first telemetry upload. The phases are
+ * now advanced by a scheduler task from loop() and run concurrently where they do not depend on each other:
+ * - MAVLink ingestion runs from the first loop(), the MAVLink and GPS phases only wait for their first message,
+ * - the modem is started while the GPS phase is still waiting for a fix, uploads start as soon as it is set up,
+ * - the bootup message is the bootup notice carried by the first uploads, the configuration phase waits for the
+ *   answer to it while uploads run with the configuration in effect.
+ * Every phase records when it started and when it became ready or timed out, so the time to ready can be reported.
+*/
+
+#ifndef AERORADAREMBEDDED_BOOTSEQUENCE_H
+#define AERORADAREMBEDDED_BOOTSEQUENCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Records the start, the end and the outcome of every boot phase.
+ */
+class BootSequence {
+
+public:
+    /**
+     * The phases of the boot.
+     */
+    enum Phase : uint8_t {
+        //the power up delay before the modem is started
+        START_DELAY = 0,
+        //the first requested message from the Pixhawk
+        MAVLINK_LINK,
+        //the first position from the Pixhawk, which needs a GPS fix
+        GPS_FIX,
+        //the IridiumSBD modem setup
+        MODEM,
+        //the bootup message to the server
+        BOOTUP_MESSAGE,
+        //the configuration from the server
+        CONFIGURATION,
+        PHASE_COUNT
+    };
+
+    /**
+     * The progress of a phase.
+     */
+    enum Status : uint8_t {
+        PENDING = 0,
+        RUNNING,
+        READY,
+        TIMED_OUT,
+        //not needed on this boot, e.g. after a warm start
+        SKIPPED
+    };
+
+    /**
+     * Set the time every phase is measured from. Call once at the start of setup().
+     * @param now - the current value of millis().
+     */
+    void begin(unsigned long now);
+
+    /**
+     * Start a pending phase.
+     * @param phase - the phase.
+     * @param now - the current value of millis().
+     */
+    void start(Phase phase, unsigned long now);
+
+    /**
+     * End a phase that has not ended yet.
+     * @param phase - the phase.
+     * @param ready - true if the phase succeeded, false if it timed out.
+     * @param now - the current value of millis().
+     */
+    void finish(Phase phase, bool ready, unsigned long now);
+
+    /**
+     * End a phase that is not needed on this boot.
+     * @param phase - the phase.
+     * @param now - the current value of millis().
+     */
+    void skip(Phase phase, unsigned long now);
+
+    /**
+     * Whether a running phase has been running for at least a timeout.
+     * @param phase - the phase.
+     * @param timeoutMillis - the timeout.
+     * @param now - the current value of millis().
+     * @return bool - true if the phase is running and its time is up.
+     */
+    bool hasTimedOut(Phase phase, unsigned long timeoutMillis, unsigned long now) const;
+
+    /**
+     * The progress of a phase.
+     * @param phase - the phase.
+     * @return Status - the status.
+     */
+    Status status(Phase phase) const;
+
+    /**
+     * Whether a phase is running.
+     * @param phase - the phase.
+     * @return bool - true if the phase has started but not ended.
+     */
+    bool isRunning(Phase phase) const;
+
+    /**
+     * Whether a phase has ended, ready, timed out or skipped.
+     * @param phase - the phase.
+     * @return bool - true if the phase has ended.
+     */
+    bool isDone(Phase phase) const;
+
+    /**
+     * Whether every phase has ended.
+     * @return bool - true once the boot is over.
+     */
+    bool isComplete() const;
+
+    /**
+     * The time from the start of the boot until a phase ended.
+     * @param phase - the phase.
+     * @return unsigned long - the milliseconds, 0 if the phase has not ended.
+     */
+    unsigned long millisToDone(Phase phase) const;
+
+    /**
+     * The time since a phase ended.
+     * @param phase - the phase.
+     * @param now - the current value of millis().
+     * @return unsigned long - the milliseconds, 0 if the phase has not ended.
+     */
+    unsigned long millisSinceDone(Phase phase, unsigned long now) const;
+
+    /**
+     * The name of a phase, for reports.
+     * @param phase - the phase.
+     * @return const char* - the name.
+     */
+    static const char *name(Phase phase);
+
+    /**
+     * Print the status and the timing of every phase to the USB serial port.
+     */
+    void report() const;
+
+private:
+    /**
+     * The timing of a phase, in values of millis().
+     */
+    struct PhaseRecord {
+        Status status;
+        unsigned long startedMillis;
+        unsigned long doneMillis;
+    };
+
+    PhaseRecord phases[PHASE_COUNT]{};
+    unsigned long bootMillis = 0;
+};
+
+#endif //AERORADAREMBEDDED_BOOTSEQUENCE_H
@@ -0,0 +1,298 @@
+/**
+* @File: ConfigProtocol.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the binary configuration commands the server sends to the Blackbox as mobile
+ * terminated SBD messages, and their parser. The commands used to be comma separated text that only knew the upload
+ * flag and the upload interval. A command is now a format version byte and a sequence number chosen by the server,
+ * followed by typed, length-prefixed entries in the style of the sectioned telemetry format:
+ *
+ *     version | varint sequence | (type | varint length | payload)*
+ *
+ * Values are varints, so a typical command (upload every 60 s, three message rates and a codec) takes ~25 bytes and
+ * fits into a single credit. A command can also select a built-in telemetry schema and add, requantize or remove
+ * single fields of it, which changes what is sampled and which messages are requested from the Pixhawk. Unknown entry
+ * types are skipped by their length, so an older firmware accepts commands from a newer server. The parser works in
+ * place on the received buffer and allocates nothing. Every command is answered with an ACK_COMMAND acknowledgement
+ * carrying its sequence number and the Result.
+ *
+ * The header only depends on the C++ standard library and the telemetry codec, so that it can be shared with host
+ * tools. The website encoder (Website/src/helpers/ConfigCommandHelper.ts) mirrors this format and must be updated
+ * together with it; ConfigProtocolTest parses a command it encoded.
+*/
+
+#ifndef AERORADAREMBEDDED_CONFIGPROTOCOL_H
+#define AERORADAREMBEDDED_CONFIGPROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "TelemetryCodec/TelemetryCodec.h"
+
+namespace ConfigProtocol {
+
+    //The version of the command format, the first byte of every command. It can never collide with the legacy text
+    // configuration, which starts with '0' or '1'.
+    static const uint8_t formatVersion = 1;
+
+    //The largest sequence number, so that it fits into an acknowledgement together with the result.
+    static const uint32_t maxSequence = 0xFFFFFF;
+
+    //The most message rates and field quantizations a single command can carry.
+    static const uint8_t maxMessageRates = 8;
+    static const uint8_t maxQuantizations = TelemetryCodec::FIELD_COUNT;
+
+    //The upload interval used when a command asks for 15 seconds or less, as the text configuration did.
+    static const uint32_t minUploadIntervalSeconds = 15;
+    static const uint32_t defaultUploadIntervalSeconds = 60;
+
+    /**
+     * The types of entry in a command. Each entry is written as its type byte, its length as a varint and its
+     * payload.
+     */
+    enum EntryType : uint8_t {
+        ENTRY_UPLOAD = 1,           //varint: upload interval in seconds << 1 | upload enabled
+        ENTRY_MESSAGE_RATE = 2,     //varint MAVLink message ID, varint interval in milliseconds (0 stops it)
+        ENTRY_CODEC = 3,            //one byte: Codec
+        ENTRY_QUANTIZATION = 4,     //field ID byte, bits byte (0x80 if signed, 0 removes the field), varint step,
+                                    // zigzag varint offset
+        ENTRY_SCHEMA = 5            //one byte: TelemetryCodec::SchemaId, applied before the quantization entries
+    };
+
+    /**
+     * How the samples of an upload are encoded.
+     */
+    enum Codec : uint8_t {
+        //a delta encoded batch of the queued history and the backlog
+        CODEC_BATCH = 0,
+        //only the most important queued sample, the cheapest upload when only the latest position matters
+        CODEC_LATEST = 1,
+        CODEC_COUNT
+    };
+
+    /**
+     * The outcome of a command, sent back in its acknowledgement.
+     */
+    enum Result : uint8_t {
+        //the command was applied
+        RESULT_OK = 0,
+        //the format version is not known, e.g. a legacy text configuration
+        RESULT_UNKNOWN_VERSION,
+        //the command is truncated or an entry overruns it
+        RESULT_MALFORMED,
+        //a value is out of range or there are too many entries of a type
+        RESULT_INVALID_VALUE,
+        //the command is valid, but this device cannot apply all of it, so none of it was applied
+        RESULT_UNSUPPORTED
+    };
+
+    /**
+     * The interval at which a MAVLink message is requested from the Pixhawk.
+     */
+    struct MessageRate {
+        uint32_t messageId;
+        //the interval in milliseconds, 0 to stop the message
+        uint32_t intervalMillis;
+    };
+
+    /**
+     * A parsed command. Only the parts that were present in the command are set.
+     */
+    struct Command {
+        //the sequence number chosen by the server, echoed in the acknowledgement
+        uint32_t sequence = 0;
+
+        //the upload flag and interval, if hasUpload
+        bool hasUpload = false;
+        bool uploadData = false;
+        uint32_t uploadIntervalMillis = 0;
+
+        //the intervals to request MAVLink messages of the telemetry schema at
+        uint8_t messageRateCount = 0;
+        MessageRate messageRates[maxMessageRates]{};
+
+        //the sample codec, if hasCodec
+        bool hasCodec = false;
+        Codec codec = CODEC_BATCH;
+
+        //the built-in telemetry schema, if hasSchema
+        bool hasSchema = false;
+        uint8_t schema = TelemetryCodec::SCHEMA_STANDARD;
+
+        //the fields to add to, requantize in or remove from the telemetry schema
+        uint8_t quantizationCount = 0;
+        TelemetryCodec::FieldSpec quantizations[maxQuantizations]{};
+    };
+
+    /**
+     * The value of the acknowledgement of a command.
+     * @param sequence - the sequence number of the command.
+     * @param result - the outcome of the command.
+     * @return uint32_t - the sequence number shifted left by 3, ORed with the result.
+     */
+    inline uint32_t acknowledgementValue(uint32_t sequence, Result result) {
+        return (sequence & maxSequence) << 3 | result;
+    }
+
+    /**
+     * Parse the payload of an entry into the command.
+     * @param type - the type of the entry.
+     * @param payload - the payload.
+     * @param length - the length of the payload.
+     * @param command - the command to fill in.
+     * @return Result - RESULT_OK if the entry was parsed or skipped, the reason otherwise.
+     */
+    inline Result parseEntry(uint8_t type, const uint8_t *payload, size_t length, Command &command) {
+        uint64_t value;
+        size_t offset = 0;
+        size_t used;
+
+        switch (type) {
+            case ENTRY_UPLOAD: {
+                used = TelemetryCodec::readVarint(payload, length, value);
+                if (used == 0) {
+                    return RESULT_MALFORMED;
+                }
+                uint64_t seconds = value >> 1;
+                if (seconds > 0xFFFFFFFFull / 1000) {
+                    return RESULT_INVALID_VALUE;
+                }
+                if (seconds <= minUploadIntervalSeconds) {
+                    seconds = defaultUploadIntervalSeconds;
+                }
+                command.hasUpload = true;
+                command.uploadData = (value & 1) != 0;
+                command.uploadIntervalMillis = (uint32_t) seconds * 1000;
+                return RESULT_OK;
+            }
+            case ENTRY_MESSAGE_RATE: {
+                if (command.messageRateCount >= maxMessageRates) {
+                    return RESULT_INVALID_VALUE;
+                }
+                uint64_t messageId;
+                used = TelemetryCodec::readVarint(payload, length, messageId);
+                if (used == 0) {
+                    return RESULT_MALFORMED;
+                }
+                offset += used;
+                used = TelemetryCodec::readVarint(payload + offset, length - offset, value);
+                if (used == 0) {
+                    return RESULT_MALFORMED;
+                }
+                //MAVLink 2 message IDs have 24 bits
+                if (messageId > 0xFFFFFF || value > 0xFFFFFFFFull) {
+                    return RESULT_INVALID_VALUE;
+                }
+                command.messageRates[command.messageRateCount++] = {(uint32_t) messageId, (uint32_t) value};
+                return RESULT_OK;
+            }
+            case ENTRY_CODEC: {
+                if (length < 1) {
+                    return RESULT_MALFORMED;
+                }
+                if (payload[0] >= CODEC_COUNT) {
+                    return RESULT_INVALID_VALUE;
+                }
+                command.hasCodec = true;
+                command.codec = (Codec) payload[0];
+                return RESULT_OK;
+            }
+            case ENTRY_SCHEMA: {
+                if (length < 1) {
+                    return RESULT_MALFORMED;
+                }
+                if (payload[0] >= TelemetryCodec::SCHEMA_COUNT) {
+                    return RESULT_INVALID_VALUE;
+                }
+                command.hasSchema = true;
+                command.schema = payload[0];
+                return RESULT_OK;
+            }
+            case ENTRY_QUANTIZATION: {
+                if (command.quantizationCount >= maxQuantizations) {
+                    return RESULT_INVALID_VALUE;
+                }
+                if (length < 2) {
+                    return RESULT_MALFORMED;
+                }
+                uint8_t field = payload[0];
+                uint8_t bits = payload[1] & 0x7F;
+                bool isSigned = (payload[1] & 0x80) != 0;
+                if (field >= TelemetryCodec::FIELD_COUNT) {
+                    return RESULT_INVALID_VALUE;
+                }
+                //a removed field has no step and offset
+                if (bits == 0) {
+                    command.quantizations[command.quantizationCount++] = {(TelemetryCodec::FieldId) field, 0, false,
+                                                                          0, 0};
+                    return RESULT_OK;
+                }
+                offset = 2;
+                uint64_t step;
+                used = TelemetryCodec::readVarint(payload + offset, length - offset, step);
+                if (used == 0) {
+                    return RESULT_MALFORMED;
+                }
+                offset += used;
+                used = TelemetryCodec::readVarint(payload + offset, length - offset, value);
+                if (used == 0) {
+                    return RESULT_MALFORMED;
+                }
+                int64_t fieldOffset = TelemetryCodec::zigzagDecode(value);
+                if (bits > 63 || step < 1 || step > INT32_MAX || fieldOffset < INT32_MIN || fieldOffset > INT32_MAX) {
+                    return RESULT_INVALID_VALUE;
+                }
+                command.quantizations[command.quantizationCount++] = {(TelemetryCodec::FieldId) field, bits,
+                                                                      isSigned, (int32_t) step,
+                                                                      (int32_t) fieldOffset};
+                return RESULT_OK;
+            }
+            default:
+                //an entry of a newer server, skipped
+                return RESULT_OK;
+        }
+    }
+
+    /**
+     * Parse a command.
+     * @param buffer - the received message.
+     * @param length - the length of the message.
+     * @param command - set to the command. The sequence number is set as soon as it has been read, so that even a
+     * rejected command can be acknowledged.
+     * @return Result - RESULT_OK if the whole command was parsed, the reason otherwise.
+     */
+    inline Result parse(const uint8_t *buffer, size_t length, Command &command) {
+        command = Command();
+        if (length < 1 || buffer[0] != formatVersion) {
+            return RESULT_UNKNOWN_VERSION;
+        }
+
+        uint64_t value;
+        size_t used = TelemetryCodec::readVarint(buffer + 1, length - 1, value);
+        if (used == 0) {
+            return RESULT_MALFORMED;
+        }
+        if (value > maxSequence) {
+            return RESULT_INVALID_VALUE;
+        }
+        command.sequence = (uint32_t) value;
+
+        size_t offset = 1 + used;
+        while (offset < length) {
+            uint8_t type = buffer[offset++];
+            used = TelemetryCodec::readVarint(buffer + offset, length - offset, value);
+            if (used == 0 || value > length - offset - used) {
+                return RESULT_MALFORMED;
+            }
+            offset += used;
+
+            Result result = parseEntry(type, buffer + offset, (size_t) value, command);
+            if (result != RESULT_OK) {
+                return result;
+            }
+            offset += (size_t) value;
+        }
+        return RESULT_OK;
+    }
+}
+
+#endif //AERORADAREMBEDDED_CONFIGPROTOCOL_H
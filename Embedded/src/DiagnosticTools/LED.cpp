@@ -2,54 +2,43 @@
 * @File: LED.cpp
 * @Author: Yarema Dzulynsky
 * @Date: 2023-04-23
-* @Description: This code defines the LED class, which is responsible for controlling a single LED with customizable
- * color values. The class provides methods for turning the LED on and off, as well as toggling its state. When the LED
- * is turned on, it is set to the color values provided during its instantiation, and when turned off, the color values
- * are set to zero. The class uses the Arduino's analogWrite function to set the appropriate color values for the LED's
- * red, green, and blue pins.
+* @Description: This code defines the LED class, which is responsible for driving the RGB LED. Every color is written
+ * with the Arduino's analogWrite function to the LED's red, green, and blue pins, but only to the pins whose value
+ * differs from the one already written.
 */
 
 #include "LED.h"
 
 
-LED::LED(int redPin, int greenPin, int bluePin, int redValue, int greenValue, int blueValue): redValue(redValue), greenValue(greenValue), blueValue(blueValue) {
-    this->redPin = redPin;
-    this->greenPin = greenPin;
-    this->bluePin = bluePin;
-    currentRedValue = 0;
-    currentGreenValue = 0;
-    currentBlueValue = 0;
-
+LED::LED(int redPin, int greenPin, int bluePin) : redPin(redPin), greenPin(greenPin), bluePin(bluePin) {
 }
 
-void LED::toggle() {
-    if (currentRedValue == 0 && currentGreenValue == 0 && currentBlueValue == 0) {
-        on();
-    } else {
-        off();
+void LED::show(const Color &color) {
+
+    //the pins are in an unknown state until they are first written
+    if (!written) {
+        current = {(uint8_t) ~color.red, (uint8_t) ~color.green, (uint8_t) ~color.blue};
+        written = true;
     }
+
+    writeChannel(redPin, current.red, color.red);
+    writeChannel(greenPin, current.green, color.green);
+    writeChannel(bluePin, current.blue, color.blue);
 }
 
 void LED::off() {
-
-    currentRedValue = 0;
-    currentGreenValue = 0;
-    currentBlueValue = 0;
-
-
-
-    analogWrite(redPin, currentRedValue);
-    analogWrite(greenPin, currentGreenValue);
-    analogWrite(bluePin, currentBlueValue);
+    show({0, 0, 0});
 }
 
-void LED::on() {
-
-    currentRedValue = redValue;
-    currentGreenValue = greenValue;
-    currentBlueValue = blueValue;
+uint32_t LED::writeCount() const {
+    return writes;
+}
 
-    analogWrite(redPin, currentRedValue);
-    analogWrite(greenPin, currentGreenValue);
-    analogWrite(bluePin, currentBlueValue);
+void LED::writeChannel(int pin, uint8_t &current, uint8_t value) {
+    if (current == value) {
+        return;
+    }
+    current = value;
+    analogWrite(pin, value);
+    writes++;
 }
@@ -2,10 +2,10 @@
 * @File: LED.h
 * @Author: Yarema Dzulynsky
 * @Date: 2023-04-23
-* @Description: This library provides an LED class for controlling an RGB LED status light with Arduino. The LED class
- * allows users to create an RGB LED object with specified pin assignments and RGB values. It offers methods to turn
- * the LED on, off, or toggle its state. The class also stores the current state of the LED and its desired RGB values
- * to achieve the correct color.
+* @Description: This library provides an LED class for driving an RGB LED status light with Arduino. The LED class
+ * owns the three PWM pins of the LED and shows one color at a time. It remembers the value last written to every
+ * pin, so that showing the color that is already lit, which is what a blinking pattern does most of the time, costs
+ * no analogWrite at all, and a color change only writes the channels that differ.
 */
 
 #ifndef RGBLEDSTATUSLIGHT_LED_H
@@ -14,41 +14,62 @@
 #include "Arduino.h"
 
 /**
- * A class that represents an LED.
+ * A color of the RGB LED, one PWM value (0 - 255) per channel.
+ */
+struct Color {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+};
+
+/**
+ * A class that represents the RGB LED.
  */
 class LED {
 
 public:
     /**
-     * Construct an LED with the given pins and values.
+     * Construct an LED with the given pins. Nothing is written until the first color is shown.
      * @param redPin - the pin that the red LED is connected to.
      * @param greenPin - the pin that the green LED is connected to.
      * @param bluePin - the pin that the blue LED is connected to.
-     * @param redValue - the RGB value (0 - 255) that the red LED should be set to.
-     * @param greenValue - the RGB value (0 - 255) that the green LED should be set to.
-     * @param blueValue - the RGB value (0 - 255) that the blue LED should be set to.
      */
-    LED(int redPin, int greenPin, int bluePin, int redValue, int greenValue, int blueValue);
+    LED(int redPin, int greenPin, int bluePin);
+
+    /**
+     * Show a color, writing only the channels whose value changes.
+     * @param color - the color to show.
+     */
+    void show(const Color &color);
 
-    //toggle the LED.
-    void toggle();
+    //turn the LED off.
     void off();
-    void on();
+
+    /**
+     * The number of analogWrite calls made since boot.
+     * @return uint32_t - the write counter.
+     */
+    uint32_t writeCount() const;
+
+private:
+    /**
+     * Write a channel if its value changes.
+     * @param pin - the pin of the channel.
+     * @param current - the value last written to the pin.
+     * @param value - the new value.
+     */
+    void writeChannel(int pin, uint8_t &current, uint8_t value);
 
     //pin assignments
     int redPin;
     int greenPin;
     int bluePin;
 
-    //The current RGB values of the LED
-    int currentRedValue;
-    int currentGreenValue;
-    int currentBlueValue;
+    //The color last written to the pins, valid once written is set
+    Color current{};
+    bool written = false;
 
-    //RGB values to get the correct color
-    const int redValue;
-    const int blueValue;
-    const int greenValue;
+    uint32_t writes = 0;
 };
 
 
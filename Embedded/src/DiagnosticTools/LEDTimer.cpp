@@ -0,0 +1,116 @@
+/**
+* @File: LEDTimer.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This code sets up TC3 as a 16 bit counter in match frequency mode, clocked by GCLK0 (48 MHz) divided
+ * by 1024, and defines TC3_Handler(), which steps the LED patterns. TC3 shares its clock with TCC2, which analogWrite()
+ * already runs from GCLK0, so the PWM of the RGB channels is not affected. The interrupt has the lowest priority, so
+ * the UART receive interrupts always preempt it.
+*/
+
+#include "LEDTimer.h"
+#include <Arduino.h>
+
+//The timer that drives rgbLED and the onboard LED.
+LEDTimer ledTimer;
+
+//The rate of the TC3 counter, GCLK0 divided by the prescaler.
+static const unsigned long timerHz = 48000000ul / 1024;
+
+//The NVIC priority of the TC3 interrupt, the lowest of the SAMD21.
+static const uint32_t timerPriority = 3;
+
+/**
+ * Wait for a write to the TC3 registers to reach the counter clock domain.
+ */
+static inline void syncTimer() {
+    while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+}
+
+void TC3_Handler() {
+    //clear the compare match before the next one can be missed
+    TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+    ledTimer.tick();
+}
+
+void LEDTimer::begin(RGBLED &rgbLED, int heartbeatPin, unsigned long heartbeatMillis) {
+    this->heartbeatPin = heartbeatPin;
+    this->heartbeatMillis = heartbeatMillis;
+    heartbeatToggledMillis = millis();
+
+    //the first step sets up the PWM outputs, which is kept out of the interrupt
+    rgbLED.asyncRun();
+
+    //clock TC3 from GCLK0 and reset it
+    PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+    GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TCC2_TC3);
+    while (GCLK->STATUS.bit.SYNCBUSY);
+    TC3->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+    while (TC3->COUNT16.CTRLA.bit.SWRST);
+
+    //count up to CC0, then start over and raise the compare interrupt
+    TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV1024;
+    syncTimer();
+    TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+    NVIC_SetPriority(TC3_IRQn, timerPriority);
+
+    //only hand the LED to the interrupt once it is set up
+    this->rgbLED = &rgbLED;
+    TC3->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+    syncTimer();
+    NVIC_EnableIRQ(TC3_IRQn);
+    wake();
+}
+
+void LEDTimer::tick() {
+    if (rgbLED == nullptr) {
+        return;
+    }
+    ticks++;
+    unsigned long now = millis();
+    unsigned long next = rgbLED->asyncRun();
+
+    //toggle the onboard LED once its period is over
+    if (heartbeatPin >= 0) {
+        if (now - heartbeatToggledMillis >= heartbeatMillis) {
+            heartbeatToggledMillis += heartbeatMillis;
+            //after a long gap, carry on from now
+            if (now - heartbeatToggledMillis >= heartbeatMillis) {
+                heartbeatToggledMillis = now;
+            }
+            heartbeatOn = !heartbeatOn;
+            digitalWrite(heartbeatPin, heartbeatOn);
+        }
+        unsigned long untilHeartbeat = heartbeatMillis - (now - heartbeatToggledMillis);
+        if (untilHeartbeat < next) {
+            next = untilHeartbeat;
+        }
+    }
+
+    arm(next);
+}
+
+void LEDTimer::wake() {
+    if (rgbLED != nullptr) {
+        NVIC_SetPendingIRQ(TC3_IRQn);
+    }
+}
+
+uint32_t LEDTimer::tickCount() const {
+    return ticks;
+}
+
+void LEDTimer::arm(unsigned long millis) {
+    //a step that ends within the current millisecond is picked up by the next interrupt
+    if (millis < 1) {
+        millis = 1;
+    } else if (millis > maxFrameMillis) {
+        millis = maxFrameMillis;
+    }
+
+    //the counter starts over, so the next interrupt is a whole interval from now
+    TC3->COUNT16.CC[0].reg = (uint16_t) (millis * timerHz / 1000 - 1);
+    syncTimer();
+    TC3->COUNT16.COUNT.reg = 0;
+    syncTimer();
+}
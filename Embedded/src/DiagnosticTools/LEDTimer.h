@@ -0,0 +1,77 @@
+/**
+* @File: LEDTimer.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the LEDTimer class, which drives the RGB status LED and the onboard heartbeat
+ * LED from the TC3 compare interrupt, so that no task, wait loop or ISBD callback has to keep calling
+ * RGBLED::asyncRun() for the patterns to be on time. The RGB channels are held by the TCC PWM outputs set up by
+ * analogWrite(); the interrupt only runs when a pattern step or the heartbeat is due, and then re-arms the timer for
+ * the next one. A change of state fires the interrupt straight away, so the new pattern starts without delay.
+*/
+
+#ifndef AERORADAREMBEDDED_LEDTIMER_H
+#define AERORADAREMBEDDED_LEDTIMER_H
+
+#include "RGBLED.h"
+
+/**
+ * Runs the LED patterns from a timer interrupt. tick() may only be called from the TC3 interrupt once begin() has run.
+ */
+class LEDTimer {
+
+public:
+    //The longest time in milliseconds between two interrupts, it must fit the 16 bit counter at 46875 Hz (1398 ms).
+    static const unsigned long maxFrameMillis = 1000;
+
+    /**
+     * Default constructor.
+     */
+    LEDTimer() = default;
+
+    /**
+     * Show the first step of the current pattern and start the timer. Must be called after the LED pins are set up.
+     * @param rgbLED - the status LED whose patterns are run.
+     * @param heartbeatPin - the pin of the onboard LED, toggled at a fixed period.
+     * @param heartbeatMillis - the time in milliseconds between two toggles of the onboard LED.
+     */
+    void begin(RGBLED &rgbLED, int heartbeatPin, unsigned long heartbeatMillis);
+
+    /**
+     * Step the patterns and re-arm the timer for the next step. Interrupt side only.
+     */
+    void tick();
+
+    /**
+     * Fire the interrupt now instead of at the next step, e.g. after a change of state. Safe to call anywhere.
+     */
+    void wake();
+
+    /**
+     * The number of interrupts that ran since boot.
+     * @return uint32_t - the interrupt counter.
+     */
+    uint32_t tickCount() const;
+
+private:
+    /**
+     * Restart the timer to fire after a number of milliseconds.
+     * @param millis - the time until the next interrupt, 1 to maxFrameMillis.
+     */
+    void arm(unsigned long millis);
+
+    //The status LED, nullptr until begin().
+    RGBLED *rgbLED = nullptr;
+
+    //The onboard LED, its period, its state and the value of millis() when it was last toggled.
+    int heartbeatPin = -1;
+    unsigned long heartbeatMillis = 0;
+    bool heartbeatOn = false;
+    unsigned long heartbeatToggledMillis = 0;
+
+    volatile uint32_t ticks = 0;
+};
+
+//The timer that drives rgbLED and the onboard LED.
+extern LEDTimer ledTimer;
+
+#endif //AERORADAREMBEDDED_LEDTIMER_H
@@ -3,190 +3,199 @@
 * @Author: Yarema Dzulynsky
 * @Date: 2023-04-23
 * @Description: This code defines the RGBLED class, which is responsible for controlling an RGB LED with multiple
- * colors and states. The class provides methods for turning individual colors on or off, toggling colors, and setting
- * the LED state. The LED can be in one of several states, each associated with a specific blinking pattern. The
- * asyncRun() method is responsible for executing the blinking pattern based on the current state. Additionally, the
- * class provides an asynchronous delay method to run the LED pattern for a specified duration.
+ * colors and states. The LED can be in one of several states, each associated with a specific blinking pattern, which
+ * is defined below as a constant table of colors and durations. The asyncRun() method is responsible for stepping
+ * through the pattern of the current state, or of a state shown for a while by showFor(), and is run by the LEDTimer
+ * interrupt. Additionally, the class provides a delay method that sleeps while the LED pattern keeps running.
  */
 
 #include "RGBLED.h"
+#include <limits.h>
+#include "LEDTimer.h"
+#include "PowerIdle/GlobalPowerIdle.h"
 
-RGBLED::RGBLED(int redPin, int greenPin, int bluePin, RGBLED::States startingState) :
+//The colors of the patterns.
+static constexpr Color COLOR_RED = {255, 0, 0};
+static constexpr Color COLOR_GREEN = {0, 255, 0};
+static constexpr Color COLOR_BLUE = {0, 0, 255};
+static constexpr Color COLOR_ORANGE = {255, 165, 0};
+static constexpr Color COLOR_PURPLE = {128, 0, 128};
+static constexpr Color COLOR_YELLOW = {255, 255, 0};
+static constexpr Color COLOR_WHITE = {255, 255, 255};
+static constexpr Color COLOR_OFF = {0, 0, 0};
 
-        red(redPin, greenPin, bluePin, colorMap[RED][0], colorMap[RED][1], colorMap[RED][2]),
-        green(redPin, greenPin, bluePin, colorMap[GREEN][0], colorMap[GREEN][1], colorMap[GREEN][2]),
-        blue(redPin, greenPin, bluePin, colorMap[BLUE][0], colorMap[BLUE][1], colorMap[BLUE][2]),
-        orange(redPin, greenPin, bluePin, colorMap[ORANGE][0], colorMap[ORANGE][1], colorMap[ORANGE][2]),
-        purple(redPin, greenPin, bluePin, colorMap[PURPLE][0], colorMap[PURPLE][1], colorMap[PURPLE][2]),
-        yellow(redPin, greenPin, bluePin, colorMap[YELLOW][0], colorMap[YELLOW][1], colorMap[YELLOW][2]),
-        white(redPin, greenPin, bluePin, colorMap[WHITE][0], colorMap[WHITE][1], colorMap[WHITE][2]) {
-        state = startingState;
-}
+//Startup: the LED runs through all colors at 4hz.
+static constexpr RGBLED::PatternStep startDelaySteps[] = {
+        {COLOR_RED,    250},
+        {COLOR_GREEN,  250},
+        {COLOR_BLUE,   250},
+        {COLOR_ORANGE, 250},
+        {COLOR_PURPLE, 250},
+        {COLOR_YELLOW, 250}
+};
 
-void RGBLED::setState(States state) {
-    this->state = state;
-}
+//Operational in flight: the LED is blue for 850ms then white for 150ms.
+static constexpr RGBLED::PatternStep inFlightSteps[] = {{COLOR_BLUE, 850}, {COLOR_WHITE, 150}};
 
-RGBLED::States RGBLED::getState() {
-    return state;
-}
+//Trying to acquire a GPS lock: the LED blinks blue at 1Hz.
+static constexpr RGBLED::PatternStep waitingForGPSLockSteps[] = {{COLOR_BLUE, 500}, {COLOR_OFF, 500}};
 
+//Sending the bootup message: the LED blinks red at 1Hz.
+static constexpr RGBLED::PatternStep sendingBootupMessageSteps[] = {{COLOR_RED, 500}, {COLOR_OFF, 500}};
 
-void RGBLED::asyncLEDDelay(long timeMillis) {
-    long startTime = millis();
-    while (millis() - startTime < timeMillis) {
-        this->asyncRun();
-        delay(50);
-    }
+//Receiving the configuration: the LED blinks yellow at 1Hz.
+static constexpr RGBLED::PatternStep sendReceiveConfigSteps[] = {{COLOR_YELLOW, 500}, {COLOR_OFF, 500}};
 
-}
+//Ready for takeoff: the LED blinks green at 1Hz.
+static constexpr RGBLED::PatternStep readyForTakeoffSteps[] = {{COLOR_GREEN, 500}, {COLOR_OFF, 500}};
 
-void RGBLED::allOff() {
-    red.off();
-    green.off();
-    blue.off();
-    orange.off();
-    purple.off();
-    yellow.off();
-    white.off();
-}
+//Sending a telemetry transmission: the LED blinks purple at 1Hz.
+static constexpr RGBLED::PatternStep sendingTelemetrySteps[] = {{COLOR_PURPLE, 500}, {COLOR_OFF, 500}};
 
-void RGBLED::redOn() {
-    allOff();
-    red.on();
-}
+//No configuration within the timeout, or a failed satellite transmission: the LED blinks red at 10Hz.
+static constexpr RGBLED::PatternStep fastRedSteps[] = {{COLOR_RED, 50}, {COLOR_OFF, 50}};
 
-void RGBLED::greenOn() {
-    allOff();
-    green.on();
-}
+//In flight without a configuration: the LED is blue for 850ms then purple for 150ms.
+static constexpr RGBLED::PatternStep inFlightDefaultSteps[] = {{COLOR_BLUE, 850}, {COLOR_PURPLE, 150}};
 
-void RGBLED::blueOn() {
-    allOff();
-    blue.on();
-}
+//In flight but configured not to upload: the LED is blue for 850ms then red for 150ms.
+static constexpr RGBLED::PatternStep inFlightNoUploadSteps[] = {{COLOR_BLUE, 850}, {COLOR_RED, 150}};
 
-void RGBLED::orangeOn() {
-    allOff();
-    orange.on();
-}
+//A successful satellite transmission: the LED blinks green at 10Hz.
+static constexpr RGBLED::PatternStep inFlightSBDSuccessSteps[] = {{COLOR_GREEN, 50}, {COLOR_OFF, 50}};
 
-void RGBLED::purpleOn() {
-    allOff();
-    purple.on();
-}
+//A telemetry transmission failed for lack of a GPS fix: the LED blinks yellow at 10Hz.
+static constexpr RGBLED::PatternStep noGPSFixSteps[] = {{COLOR_YELLOW, 50}, {COLOR_OFF, 50}};
 
-void RGBLED::yellowOn() {
-    allOff();
-    yellow.on();
-}
+//Any other state: the LED is off.
+static constexpr RGBLED::PatternStep offSteps[] = {{COLOR_OFF, 0}};
 
-void RGBLED::whiteOn() {
-    allOff();
-    white.on();
-}
+/**
+ * The number of steps of a pattern table.
+ * @param steps - the table.
+ * @return uint8_t - the number of steps.
+ */
+template<size_t count>
+static constexpr uint8_t stepsIn(const RGBLED::PatternStep (&steps)[count]) {
+    return (uint8_t) count;
+}
+
+//The pattern of every state, indexed by RGBLED::States.
+static constexpr RGBLED::Pattern patterns[RGBLED::STATE_COUNT] = {
+        {startDelaySteps,           stepsIn(startDelaySteps)},
+        {inFlightSteps,             stepsIn(inFlightSteps)},
+        {waitingForGPSLockSteps,    stepsIn(waitingForGPSLockSteps)},
+        {sendingBootupMessageSteps, stepsIn(sendingBootupMessageSteps)},
+        {sendReceiveConfigSteps,    stepsIn(sendReceiveConfigSteps)},
+        {readyForTakeoffSteps,      stepsIn(readyForTakeoffSteps)},
+        {sendingTelemetrySteps,     stepsIn(sendingTelemetrySteps)},
+        {fastRedSteps,              stepsIn(fastRedSteps)},
+        {inFlightDefaultSteps,      stepsIn(inFlightDefaultSteps)},
+        {inFlightNoUploadSteps,     stepsIn(inFlightNoUploadSteps)},
+        {fastRedSteps,              stepsIn(fastRedSteps)},
+        {inFlightSBDSuccessSteps,   stepsIn(inFlightSBDSuccessSteps)},
+        {noGPSFixSteps,             stepsIn(noGPSFixSteps)}
+};
+
+static constexpr RGBLED::Pattern offPattern = {offSteps, stepsIn(offSteps)};
+
+//The longest a pattern catches up on missed steps in milliseconds, after a longer gap it carries on from now.
+static const unsigned long maxCatchUpMillis = 10000;
 
-void RGBLED::redOff() {
-    red.off();
+RGBLED::RGBLED(int redPin, int greenPin, int bluePin, RGBLED::States startingState) :
+        output(redPin, greenPin, bluePin), state(startingState) {
 }
 
-void RGBLED::greenOff() {
-    green.off();
-}
+void RGBLED::setState(States state) {
+    if (this->state == state) {
+        return;
+    }
 
-void RGBLED::blueOff() {
-    blue.off();
-}
+    //the interrupt must never see the new state with a step of the old pattern, a state shown by showFor() goes on
+    // and its end starts the pattern of the new state
+    noInterrupts();
+    this->state = state;
+    if (!showing) {
+        restart = true;
+    }
+    interrupts();
 
-void RGBLED::orangeOff() {
-    orange.off();
+    //show the first step now rather than when the old step would have ended
+    ledTimer.wake();
 }
 
-void RGBLED::purpleOff() {
-    purple.off();
-}
+void RGBLED::showFor(States state, unsigned long durationMillis) {
+    noInterrupts();
+    shownState = state;
+    shownUntilMillis = millis() + durationMillis;
+    showing = true;
+    restart = true;
+    interrupts();
 
-void RGBLED::yellowOff() {
-    yellow.off();
+    ledTimer.wake();
 }
 
-void RGBLED::whiteOff() {
-    white.off();
+RGBLED::States RGBLED::getState() {
+    return state;
 }
 
-void RGBLED::toggleRed() {
-    red.toggle();
-}
 
-void RGBLED::toggleGreen() {
-    green.toggle();
+void RGBLED::asyncLEDDelay(long timeMillis) {
+    unsigned long startTime = millis();
+    unsigned long elapsed;
+    //the pattern runs from the timer interrupt, so this only has to sleep
+    while ((elapsed = millis() - startTime) < (unsigned long) timeMillis) {
+        powerIdle.idle(timeMillis - elapsed);
+    }
 }
 
-void RGBLED::toggleBlue() {
-    blue.toggle();
+void RGBLED::allOff() {
+    output.off();
 }
 
-void RGBLED::toggleOrange() {
-    orange.toggle();
+const RGBLED::Pattern &RGBLED::patternOf(States state) {
+    return (unsigned) state < STATE_COUNT ? patterns[state] : offPattern;
 }
 
-void RGBLED::togglePurple() {
-    purple.toggle();
-}
+unsigned long RGBLED::asyncRun() {
+    unsigned long now = millis();
 
-void RGBLED::toggleYellow() {
-    yellow.toggle();
-}
+    //a state shown by showFor() takes the place of the current state until its time is over
+    if (showing && (long) (now - shownUntilMillis) >= 0) {
+        showing = false;
+        restart = true;
+    }
+    const Pattern &pattern = patternOf(showing ? shownState : state);
 
-void RGBLED::toggleWhite() {
-    white.toggle();
-}
+    //a new state starts its pattern from the first step
+    if (restart) {
+        step = 0;
+        stepStartMillis = now;
+        restart = false;
+    }
+
+    //move on by as many steps as are over, a single step pattern is shown for as long as its state lasts
+    while (pattern.stepCount > 1 && now - stepStartMillis >= pattern.steps[step].durationMillis) {
+        stepStartMillis += pattern.steps[step].durationMillis;
+        step = (uint8_t) ((step + 1) % pattern.stepCount);
 
-void RGBLED::asyncRun() {
-    //switch case to determine the state and execute the correct blinking pattern.
-    switch (state) {
-        case 0:
-            startDelay.run(*this);
-            break;
-        case 1:
-            inFlight.run(*this);
-            break;
-        case 2:
-            waitingForGPSLock.run(*this);
-            break;
-        case 3:
-            sendingBootupMessage.run(*this);
-            break;
-        case 4:
-            sendReceiveConfig.run(*this);
-            break;
-        case 5:
-            readyForTakeoff.run(*this);
-            break;
-        case 6:
-            sendingTelemetry.run(*this);
-            break;
-        case 7:
-            configTimout.run(*this);
-            break;
-        case 8:
-            inFlightDefault.run(*this);
-            break;
-        case 9:
-            inFlightNoUpload.run(*this);
-            break;
-        case 10:
-            inFlightSBDFailed.run(*this);
-            break;
-        case 11:
-            inFlightSBDSuccess.run(*this);
-            break;
-        case 12:
-            noGPSFix.run(*this);
-            break;
-
-        default:
-            allOff();
-            break;
+        //after a long gap between runs, pick up from now instead of replaying every missed step
+        if (now - stepStartMillis > maxCatchUpMillis) {
+            stepStartMillis = now;
+        }
     }
-}
\ No newline at end of file
+
+    //only a change of color reaches the pins
+    output.show(pattern.steps[step].color);
+
+    unsigned long next = ULONG_MAX;
+    if (pattern.stepCount > 1) {
+        next = pattern.steps[step].durationMillis - (now - stepStartMillis);
+    }
+
+    //run again when the shown state ends, if that is before the next step
+    if (showing && shownUntilMillis - now < next) {
+        next = shownUntilMillis - now;
+    }
+    return next;
+}
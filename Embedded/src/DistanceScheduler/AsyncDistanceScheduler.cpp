@@ -3,6 +3,7 @@
 //
 
 #include "AsyncDistanceScheduler.h"
+#include "Log/Log.h"
 
 AsyncDistanceScheduler::AsyncDistanceScheduler(float kmPerTrigger, std::function<void()> func) {
     this->kmPerTrigger = kmPerTrigger;
@@ -20,8 +21,7 @@ void AsyncDistanceScheduler::run(float groundSpeed) {
     long averageSpeed = (prevSpeed + groundSpeed) / 2;
     distanceTraveled += averageSpeed * timeInHours;
 
-    Serial.print("Distance traveled: ");
-    Serial.println(distanceTraveled);
+    LOG_DEBUG(LOG_SYSTEM, "Distance traveled: %.2f", distanceTraveled);
 
     if (distanceTraveled >= kmPerTrigger) {
         func();
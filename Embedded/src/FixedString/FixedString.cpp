@@ -0,0 +1,131 @@
+/**
+* @File: FixedString.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the TextBuffer class.
+*/
+
+#include "FixedString.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+//The largest whole part appendFloat() writes, the same limit as Arduino's Print::printFloat().
+static const double maxWholePart = 4294967040.0;
+
+TextBuffer::TextBuffer(char *buffer, size_t capacity) : buffer(buffer), size(capacity) {
+    buffer[0] = '\0';
+}
+
+void TextBuffer::clear() {
+    used = 0;
+    cut = false;
+    buffer[0] = '\0';
+}
+
+bool TextBuffer::append(char c) {
+    if (used + 1 >= size) {
+        cut = true;
+        return false;
+    }
+    buffer[used++] = c;
+    buffer[used] = '\0';
+    return true;
+}
+
+bool TextBuffer::append(const char *text) {
+    size_t length = strlen(text);
+    size_t room = size - 1 - used;
+    if (length > room) {
+        length = room;
+        cut = true;
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+    buffer[used] = '\0';
+    return !cut;
+}
+
+bool TextBuffer::appendf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool fits = vappendf(format, args);
+    va_end(args);
+    return fits;
+}
+
+bool TextBuffer::vappendf(const char *format, va_list args) {
+    size_t room = size - used;
+    int written = vsnprintf(buffer + used, room, format, args);
+
+    //an encoding error leaves the string as it was
+    if (written < 0) {
+        buffer[used] = '\0';
+        cut = true;
+        return false;
+    }
+
+    //vsnprintf already cut the text off at the end of the buffer
+    if ((size_t) written >= room) {
+        used = size - 1;
+        cut = true;
+        return false;
+    }
+    used += (size_t) written;
+    return true;
+}
+
+bool TextBuffer::appendFloat(double value, uint8_t decimals) {
+    if (isnan(value)) {
+        return append("nan");
+    }
+    if (isinf(value)) {
+        return append(value < 0 ? "-inf" : "inf");
+    }
+    if (decimals > 9) {
+        decimals = 9;
+    }
+
+    bool negative = value < 0;
+    if (negative) {
+        value = -value;
+    }
+
+    if (value > maxWholePart) {
+        return append("ovf");
+    }
+
+    //round the number scaled to its last decimal, then split it into the whole part and the decimals
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    uint64_t scaled = (uint64_t) (value * scale + 0.5);
+    uint32_t whole = (uint32_t) (scaled / scale);
+    uint32_t fraction = (uint32_t) (scaled % scale);
+
+    if (decimals == 0) {
+        return appendf("%s%lu", negative ? "-" : "", (unsigned long) whole);
+    }
+    return appendf("%s%lu.%0*lu", negative ? "-" : "", (unsigned long) whole, (int) decimals, (unsigned long) fraction);
+}
+
+bool TextBuffer::startsWith(const char *prefix) const {
+    return strncmp(buffer, prefix, strlen(prefix)) == 0;
+}
+
+const char *TextBuffer::c_str() const {
+    return buffer;
+}
+
+size_t TextBuffer::length() const {
+    return used;
+}
+
+size_t TextBuffer::capacity() const {
+    return size - 1;
+}
+
+bool TextBuffer::truncated() const {
+    return cut;
+}
@@ -0,0 +1,150 @@
+/**
+* @File: FixedString.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines TextBuffer and FixedString, the replacement for Arduino String on every path
+ * that runs during a flight. Arduino String grows on the heap with every +=, which over a long flight fragments the
+ * 32 KB of RAM until an allocation fails. A FixedString keeps its characters in a buffer of a fixed capacity, inline in
+ * its owner or in static storage, and never allocates. Text that does not fit is cut off and the string remembers that
+ * it was truncated, so a long log line is shortened rather than crashing the device.
+ *
+ * Formatting follows snprintf. The newlib-nano printf of the SAMD toolchain has no floating point support unless it
+ * is linked in explicitly, so floats are written with appendFloat() instead of %f.
+*/
+
+#ifndef AERORADAREMBEDDED_FIXEDSTRING_H
+#define AERORADAREMBEDDED_FIXEDSTRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/**
+ * A null-terminated string in a buffer it does not own. Functions take a TextBuffer &, so that they accept a
+ * FixedString of any capacity.
+ */
+class TextBuffer {
+
+public:
+    /**
+     * Constructor
+     * @param buffer - the storage of the string, at least one byte.
+     * @param capacity - the size of the storage in bytes, including the terminating null.
+     */
+    TextBuffer(char *buffer, size_t capacity);
+
+    //the storage is not owned, so a copy would write into the original
+    TextBuffer(const TextBuffer &) = delete;
+    TextBuffer &operator=(const TextBuffer &) = delete;
+
+    /**
+     * Empty the string.
+     */
+    void clear();
+
+    /**
+     * Append a character.
+     * @param c - the character.
+     * @return bool - false if it did not fit.
+     */
+    bool append(char c);
+
+    /**
+     * Append a null-terminated string, as much of it as fits.
+     * @param text - the string.
+     * @return bool - false if it did not fit entirely.
+     */
+    bool append(const char *text);
+
+    /**
+     * Append formatted text, as much of it as fits. The format follows snprintf, without floating point.
+     * @param format - the format string.
+     * @return bool - false if it did not fit entirely.
+     */
+    bool appendf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * Append formatted text from an argument list, see appendf().
+     * @param format - the format string.
+     * @param args - the arguments.
+     * @return bool - false if it did not fit entirely.
+     */
+    bool vappendf(const char *format, va_list args);
+
+    /**
+     * Append a number with a fixed number of decimals, rounded half away from zero.
+     * @param value - the number.
+     * @param decimals - the number of decimals, at most 9.
+     * @return bool - false if it did not fit entirely.
+     */
+    bool appendFloat(double value, uint8_t decimals);
+
+    /**
+     * Whether the string starts with a prefix.
+     * @param prefix - the prefix.
+     * @return bool - true if it does.
+     */
+    bool startsWith(const char *prefix) const;
+
+    /**
+     * The string.
+     * @return const char* - the null-terminated characters, valid until the string changes.
+     */
+    const char *c_str() const;
+
+    /**
+     * The length of the string.
+     * @return size_t - the number of characters, without the terminating null.
+     */
+    size_t length() const;
+
+    /**
+     * The longest string that fits.
+     * @return size_t - the number of characters, without the terminating null.
+     */
+    size_t capacity() const;
+
+    /**
+     * Whether text was cut off since the last clear().
+     * @return bool - true if something did not fit.
+     */
+    bool truncated() const;
+
+private:
+    char *buffer;
+    size_t size;
+    size_t used = 0;
+    bool cut = false;
+};
+
+/**
+ * A TextBuffer with its own storage of a fixed capacity.
+ * @tparam maxLength - the longest string that fits, without the terminating null.
+ */
+template<size_t maxLength>
+class FixedString : public TextBuffer {
+
+public:
+    /**
+     * Construct an empty string.
+     */
+    FixedString() : TextBuffer(storage, maxLength + 1) {
+    }
+
+    /**
+     * Construct a string from formatted text, see TextBuffer::appendf().
+     * @param format - the format string.
+     */
+    explicit FixedString(const char *format, ...) __attribute__((format(printf, 2, 3))) :
+            TextBuffer(storage, maxLength + 1) {
+        va_list args;
+        va_start(args, format);
+        vappendf(format, args);
+        va_end(args);
+    }
+
+private:
+    char storage[maxLength + 1];
+};
+
+#endif //AERORADAREMBEDDED_FIXEDSTRING_H
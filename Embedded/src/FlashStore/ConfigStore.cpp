@@ -0,0 +1,148 @@
+/**
+* @File: ConfigStore.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the ConfigStore class.
+*/
+
+#include "ConfigStore.h"
+#include <string.h>
+
+ConfigStore::ConfigStore(FlashDevice &flash)
+        : journal(flash, FlashBacklog::NEWEST_FIRST, FlashBacklog::OVERWRITE_OLDEST) {
+}
+
+bool ConfigStore::begin() {
+
+    journal.begin();
+
+    //the newest intact record wins, older ones were left by a reset between an append and its markSent
+    FlashBacklog::RecordRef refs[maxRecoveredRecords];
+    size_t count = journal.select(refs, maxRecoveredRecords);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t record[FlashBacklog::maxRecordSize];
+        uint8_t tag = 0;
+        size_t length = journal.read(refs[i], record, sizeof(record), tag);
+
+        StoredConfig config = stored;
+        if (!found && length > 0 && decode(record, length, config)) {
+            stored = config;
+            storedRef = refs[i];
+            found = true;
+        } else {
+            journal.markSent(refs[i]);
+        }
+    }
+    return found;
+}
+
+bool ConfigStore::hasConfig() const {
+    return found;
+}
+
+const ConfigStore::StoredConfig &ConfigStore::config() const {
+    return stored;
+}
+
+bool ConfigStore::save(const StoredConfig &config) {
+
+    uint8_t record[recordSize];
+    size_t length = encode(config, record);
+    if (!journal.append(record, length, formatVersion)) {
+        return false;
+    }
+
+    //only the new record stays pending
+    if (found) {
+        journal.markSent(storedRef);
+    }
+    journal.select(&storedRef, 1);
+    stored = config;
+    found = true;
+    return true;
+}
+
+size_t ConfigStore::encode(const StoredConfig &config, uint8_t *buffer) {
+
+    size_t length = 0;
+    buffer[length++] = formatVersion;
+    buffer[length++] = config.uploadData ? 1 : 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[length++] = (uint8_t) (config.uploadIntervalMillis >> (8 * i));
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[length++] = (uint8_t) (config.configSequence >> (8 * i));
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        buffer[length++] = (uint8_t) (config.unixMillis >> (8 * i));
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[length++] = (uint8_t) ((uint32_t) config.driftPpb >> (8 * i));
+    }
+    buffer[length++] = config.codec;
+    uint8_t rateCount = config.messageRateCount < maxStoredMessageRates ? config.messageRateCount
+                                                                        : maxStoredMessageRates;
+    buffer[length++] = rateCount;
+    for (uint8_t r = 0; r < maxStoredMessageRates; r++) {
+        const ConfigProtocol::MessageRate &rate = config.messageRates[r];
+        buffer[length++] = r < rateCount ? (uint8_t) rate.messageId : 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            buffer[length++] = r < rateCount ? (uint8_t) (rate.intervalMillis >> (8 * i)) : 0;
+        }
+    }
+    uint8_t schemaSize = config.schemaSize < maxStoredSchemaSize ? config.schemaSize : maxStoredSchemaSize;
+    buffer[length++] = schemaSize;
+    for (uint8_t i = 0; i < maxStoredSchemaSize; i++) {
+        buffer[length++] = i < schemaSize ? config.schema[i] : 0;
+    }
+    return length;
+}
+
+bool ConfigStore::decode(const uint8_t *buffer, size_t length, StoredConfig &config) {
+
+    if (length < minRecordSize || buffer[0] != formatVersion) {
+        return false;
+    }
+
+    config.uploadData = (buffer[1] & 1) != 0;
+    config.uploadIntervalMillis = 0;
+    config.configSequence = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        config.uploadIntervalMillis |= (uint32_t) buffer[2 + i] << (8 * i);
+        config.configSequence |= (uint32_t) buffer[6 + i] << (8 * i);
+    }
+
+    //the fields appended since format version 1
+    if (length >= 18) {
+        config.unixMillis = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            config.unixMillis |= (uint64_t) buffer[10 + i] << (8 * i);
+        }
+    }
+    if (length >= 22) {
+        uint32_t drift = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            drift |= (uint32_t) buffer[18 + i] << (8 * i);
+        }
+        config.driftPpb = (int32_t) drift;
+    }
+    if (length >= 24 + 5 * maxStoredMessageRates) {
+        config.codec = buffer[22] < ConfigProtocol::CODEC_COUNT ? (ConfigProtocol::Codec) buffer[22]
+                                                                : ConfigProtocol::CODEC_BATCH;
+        config.messageRateCount = buffer[23] < maxStoredMessageRates ? buffer[23] : maxStoredMessageRates;
+        for (uint8_t r = 0; r < maxStoredMessageRates; r++) {
+            const uint8_t *entry = buffer + 24 + 5 * r;
+            config.messageRates[r].messageId = entry[0];
+            config.messageRates[r].intervalMillis = 0;
+            for (uint8_t i = 0; i < 4; i++) {
+                config.messageRates[r].intervalMillis |= (uint32_t) entry[1 + i] << (8 * i);
+            }
+        }
+    }
+    if (length >= recordSize) {
+        const uint8_t *schema = buffer + 24 + 5 * maxStoredMessageRates;
+        config.schemaSize = schema[0] < maxStoredSchemaSize ? schema[0] : maxStoredSchemaSize;
+        memcpy(config.schema, schema + 1, maxStoredSchemaSize);
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+/**
+* @File: ConfigStore.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the ConfigStore class, which keeps the last accepted configuration and the
+ * last known time in flash, so that a device reset mid-flight by a brownout or the watchdog can resume uploading
+ * within seconds instead of sending another bootup message and waiting for the configuration again. The store is a
+ * FlashBacklog used as a journal: every save appends a record and marks the previous one as sent, so the newest
+ * pending record is the stored configuration and the writes are spread over the whole region.
+ *
+ * A record is a format version byte followed by the fields, little-endian. Fields are only ever appended, so a record
+ * written by an older firmware simply lacks the trailing fields, which keep their defaults.
+*/
+
+#ifndef AERORADAREMBEDDED_CONFIGSTORE_H
+#define AERORADAREMBEDDED_CONFIGSTORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlashBacklog.h"
+#include "ConfigProtocol/ConfigProtocol.h"
+
+/**
+ * The last accepted configuration and the last known time, kept in flash across resets.
+ */
+class ConfigStore {
+
+public:
+    //The most MAVLink message rates kept, one per message the telemetry schema can sample.
+    static const uint8_t maxStoredMessageRates = 4;
+
+    //The longest telemetry schema descriptor kept, the rest of a 52 byte backlog record. Room for a built-in schema
+    // and one or two changed fields.
+    static const uint8_t maxStoredSchemaSize = 7;
+
+    /**
+     * Everything that is restored after a reset.
+     */
+    struct StoredConfig {
+        //whether telemetry is uploaded
+        bool uploadData;
+        //the time between two telemetry uploads
+        uint32_t uploadIntervalMillis;
+        //the number of configurations accepted from the server, across resets
+        uint32_t configSequence;
+        //the time when the record was saved, in unix milliseconds, 0 if the clock was not synchronised
+        uint64_t unixMillis;
+        //the drift estimate of the time base, in parts per billion
+        int32_t driftPpb;
+        //the sample codec
+        ConfigProtocol::Codec codec;
+        //the intervals of the MAVLink messages of the telemetry schema, none to keep the defaults
+        uint8_t messageRateCount;
+        ConfigProtocol::MessageRate messageRates[maxStoredMessageRates];
+        //the descriptor of the telemetry schema, empty to keep the standard schema
+        uint8_t schemaSize;
+        uint8_t schema[maxStoredSchemaSize];
+    };
+
+    //The version of the record format. Appending a field does not change it.
+    static const uint8_t formatVersion = 1;
+
+    //The length of a record with every field of this firmware: the message rates take a one byte ID and a four byte
+    // interval each, the schema descriptor a length byte and its bytes.
+    static const size_t recordSize = 24 + 5 * maxStoredMessageRates + 1 + maxStoredSchemaSize;
+
+    //The length of the shortest record that is accepted, the fields of format version 1 up to the sequence number.
+    static const size_t minRecordSize = 10;
+
+    /**
+     * Constructor
+     * @param flash - the flash region that holds the store.
+     */
+    explicit ConfigStore(FlashDevice &flash);
+
+    /**
+     * Recover the stored configuration from flash. Call once at startup.
+     * @return bool - true if a configuration was found.
+     */
+    bool begin();
+
+    /**
+     * Whether a configuration was found by begin() or saved since.
+     * @return bool - true if config() holds a stored configuration.
+     */
+    bool hasConfig() const;
+
+    /**
+     * The stored configuration.
+     * @return const StoredConfig& - the configuration, the defaults if hasConfig() is false.
+     */
+    const StoredConfig &config() const;
+
+    /**
+     * Save a configuration, replacing the stored one.
+     * @param config - the configuration.
+     * @return bool - true if the configuration was written to flash.
+     */
+    bool save(const StoredConfig &config);
+
+    /**
+     * Encode a configuration into a record.
+     * @param config - the configuration.
+     * @param buffer - filled with the record, at least recordSize bytes.
+     * @return size_t - the length of the record.
+     */
+    static size_t encode(const StoredConfig &config, uint8_t *buffer);
+
+    /**
+     * Decode a record. Fields missing from a shorter record keep the value they have in config.
+     * @param buffer - the record.
+     * @param length - the length of the record.
+     * @param config - set to the configuration.
+     * @return bool - true if the record has the current format version and all mandatory fields.
+     */
+    static bool decode(const uint8_t *buffer, size_t length, StoredConfig &config);
+
+private:
+    //The most pending records looked at by begin(). More than one is only left by a reset in the middle of save().
+    static const uint8_t maxRecoveredRecords = 4;
+
+    FlashBacklog journal;
+
+    StoredConfig stored{true, 0, 0, 0, 0, ConfigProtocol::CODEC_BATCH, 0, {}, 0, {}};
+    bool found = false;
+
+    //the record that holds the stored configuration
+    FlashBacklog::RecordRef storedRef{};
+};
+
+#endif //AERORADAREMBEDDED_CONFIGSTORE_H
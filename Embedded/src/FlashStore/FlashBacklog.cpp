@@ -0,0 +1,284 @@
+/**
+* @File: FlashBacklog.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the FlashBacklog class.
+*/
+
+#include "FlashBacklog.h"
+#include <string.h>
+
+/*
+ * Record layout within a page, little endian:
+ * 0-3   sequence number, never 0 or 0xFFFFFFFF
+ * 4     payload length
+ * 5     tag
+ * 6-7   CRC-16 of bytes 0-5 and the payload
+ * 8-11  state word, 0xFFFFFFFF while pending, programmed to 0 once sent
+ * 12-   payload
+ */
+static const size_t stateOffset = 8;
+
+FlashBacklog::FlashBacklog(FlashDevice &flash, DrainOrder order, OverflowPolicy overflow)
+        : flash(flash), order(order), overflow(overflow) {
+}
+
+size_t FlashBacklog::begin() {
+
+    size_t pageCount = flash.size() / flash.pageSize();
+    pages = (uint16_t) (pageCount < maxPages ? pageCount : maxPages);
+    pagesPerRow = (uint16_t) (flash.rowSize() / flash.pageSize());
+    //only use whole rows
+    pages -= pagesPerRow > 0 ? pages % pagesPerRow : pages;
+    if (pages == 0) {
+        return 0;
+    }
+
+    memset(pendingBits, 0, sizeof(pendingBits));
+    pending = 0;
+    head = 0;
+    nextSequence = 1;
+
+    //the newest intact record tells where the head is
+    uint32_t newest = 0;
+    uint8_t payload[maxRecordSize];
+    for (uint16_t page = 0; page < pages; page++) {
+        Header header;
+        if (!readRecord(page, header, payload)) {
+            continue;
+        }
+        if (header.pending) {
+            setPending(page, true);
+        }
+        if (header.sequence > newest) {
+            newest = header.sequence;
+            head = (uint16_t) ((page + 1) % pages);
+        }
+    }
+    if (newest > 0) {
+        nextSequence = newest + 1;
+    }
+
+    //a torn write may have left the rest of the head row unusable, continue in the next row instead
+    if (head % pagesPerRow != 0) {
+        for (uint16_t page = head; page % pagesPerRow != 0; page++) {
+            if (!isBlank(page)) {
+                head = (uint16_t) ((head / pagesPerRow + 1) * pagesPerRow % pages);
+                break;
+            }
+        }
+    }
+
+    return pending;
+}
+
+bool FlashBacklog::append(const uint8_t *payload, size_t length, uint8_t tag) {
+
+    if (pages == 0 || length > maxPayloadSize()) {
+        return false;
+    }
+
+    //entering a row means erasing it, along with any records still pending in it
+    if (head % pagesPerRow == 0) {
+        uint16_t lost = 0;
+        for (uint16_t page = head; page < head + pagesPerRow; page++) {
+            if (isPending(page)) {
+                lost++;
+            }
+        }
+        if (lost > 0 && overflow == REJECT_NEWEST) {
+            rejected++;
+            return false;
+        }
+        if (!flash.eraseRow((size_t) head * flash.pageSize())) {
+            return false;
+        }
+        for (uint16_t page = head; page < head + pagesPerRow; page++) {
+            setPending(page, false);
+        }
+        overwritten += lost;
+    }
+
+    uint8_t image[maxRecordSize];
+    memset(image, 0xFF, sizeof(image));
+    image[0] = (uint8_t) nextSequence;
+    image[1] = (uint8_t) (nextSequence >> 8);
+    image[2] = (uint8_t) (nextSequence >> 16);
+    image[3] = (uint8_t) (nextSequence >> 24);
+    image[4] = (uint8_t) length;
+    image[5] = tag;
+    memcpy(image + headerSize, payload, length);
+    uint16_t crc = crc16(image + headerSize, length, crc16(image, 6, 0xFFFF));
+    image[6] = (uint8_t) crc;
+    image[7] = (uint8_t) (crc >> 8);
+
+    //the page was erased with its row, so one program writes the whole record
+    if (!flash.program((size_t) head * flash.pageSize(), image, headerSize + length)) {
+        return false;
+    }
+
+    setPending(head, true);
+    head = (uint16_t) ((head + 1) % pages);
+    nextSequence++;
+    return true;
+}
+
+size_t FlashBacklog::select(RecordRef *refs, size_t maxCount) {
+
+    size_t selected = 0;
+    uint8_t payload[maxRecordSize];
+    for (uint16_t i = 0; i < pages && selected < maxCount && selected < pending; i++) {
+        //the oldest record is at the head, the newest just before it
+        uint16_t page = order == OLDEST_FIRST ? (uint16_t) ((head + i) % pages)
+                                              : (uint16_t) ((head + pages - 1 - i) % pages);
+        if (!isPending(page)) {
+            continue;
+        }
+        Header header;
+        if (!readRecord(page, header, payload)) {
+            //the record went bad in flash, it can never be sent
+            setPending(page, false);
+            continue;
+        }
+        refs[selected++] = {page, header.sequence};
+    }
+    return selected;
+}
+
+size_t FlashBacklog::read(const RecordRef &ref, uint8_t *payload, size_t capacity, uint8_t &tag) {
+
+    if (ref.page >= pages || !isPending(ref.page)) {
+        return 0;
+    }
+    Header header;
+    uint8_t record[maxRecordSize];
+    if (!readRecord(ref.page, header, record) || header.sequence != ref.sequence || header.length > capacity) {
+        return 0;
+    }
+    memcpy(payload, record, header.length);
+    tag = header.tag;
+    return header.length;
+}
+
+bool FlashBacklog::markSent(const RecordRef &ref) {
+
+    if (ref.page >= pages || !isPending(ref.page)) {
+        return false;
+    }
+    Header header;
+    uint8_t record[maxRecordSize];
+    if (!readRecord(ref.page, header, record) || header.sequence != ref.sequence) {
+        return false;
+    }
+
+    //the second and last program of the page since its row was erased
+    static const uint8_t sent[4] = {0, 0, 0, 0};
+    setPending(ref.page, false);
+    return flash.program((size_t) ref.page * flash.pageSize() + stateOffset, sent, sizeof(sent));
+}
+
+size_t FlashBacklog::pendingCount() const {
+    return pending;
+}
+
+size_t FlashBacklog::capacity() const {
+    return pages;
+}
+
+uint8_t FlashBacklog::fillPercent() const {
+    return pages == 0 ? 0 : (uint8_t) ((uint32_t) pending * 100 / pages);
+}
+
+bool FlashBacklog::isFull() const {
+    if (pages == 0) {
+        return true;
+    }
+    if (head % pagesPerRow != 0) {
+        return false;
+    }
+    for (uint16_t page = head; page < head + pagesPerRow; page++) {
+        if (isPending(page)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t FlashBacklog::maxPayloadSize() const {
+    size_t recordSize = flash.pageSize() < maxRecordSize ? flash.pageSize() : maxRecordSize;
+    return recordSize > headerSize ? recordSize - headerSize : 0;
+}
+
+void FlashBacklog::setDrainOrder(DrainOrder newOrder) {
+    order = newOrder;
+}
+
+void FlashBacklog::setOverflowPolicy(OverflowPolicy newOverflow) {
+    overflow = newOverflow;
+}
+
+uint32_t FlashBacklog::overwrittenCount() const {
+    return overwritten;
+}
+
+uint32_t FlashBacklog::rejectedCount() const {
+    return rejected;
+}
+
+bool FlashBacklog::readRecord(uint16_t page, Header &header, uint8_t *payload) {
+
+    uint8_t raw[headerSize];
+    size_t address = (size_t) page * flash.pageSize();
+    flash.read(address, raw, headerSize);
+
+    header.sequence = (uint32_t) raw[0] | (uint32_t) raw[1] << 8 | (uint32_t) raw[2] << 16 | (uint32_t) raw[3] << 24;
+    header.length = raw[4];
+    header.tag = raw[5];
+    header.pending = raw[8] == 0xFF && raw[9] == 0xFF && raw[10] == 0xFF && raw[11] == 0xFF;
+    if (header.sequence == 0 || header.sequence == 0xFFFFFFFF || header.length > maxPayloadSize()) {
+        return false;
+    }
+
+    flash.read(address + headerSize, payload, header.length);
+    uint16_t crc = crc16(payload, header.length, crc16(raw, 6, 0xFFFF));
+    return crc == (uint16_t) (raw[6] | raw[7] << 8);
+}
+
+bool FlashBacklog::isBlank(uint16_t page) {
+    uint8_t raw[maxRecordSize];
+    size_t length = flash.pageSize() < maxRecordSize ? flash.pageSize() : maxRecordSize;
+    flash.read((size_t) page * flash.pageSize(), raw, length);
+    for (size_t i = 0; i < length; i++) {
+        if (raw[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FlashBacklog::isPending(uint16_t page) const {
+    return (pendingBits[page / 32] >> (page % 32)) & 1u;
+}
+
+void FlashBacklog::setPending(uint16_t page, bool value) {
+    if (isPending(page) == value) {
+        return;
+    }
+    if (value) {
+        pendingBits[page / 32] |= 1u << (page % 32);
+        pending++;
+    } else {
+        pendingBits[page / 32] &= ~(1u << (page % 32));
+        pending--;
+    }
+}
+
+uint16_t FlashBacklog::crc16(const uint8_t *data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (uint16_t) (crc << 1 ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,242 @@
+/**
+* @File: FlashBacklog.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the FlashBacklog class, a persistent store-and-forward log of encoded
+ * telemetry records in NOR flash. The RAM send queue only holds the last couple of minutes; records it has to give up
+ * while the link is down are appended here instead of being lost, and drained once uploads succeed again, even after
+ * a reboot.
+ *
+ * The log is a ring of one record per flash page, written strictly in order:
+ * - every page holds a header (sequence number, length, tag, CRC, state word) followed by the payload,
+ * - a row is erased just before the head enters it, so every row is erased once per trip around the ring, which
+ *   levels the wear across the whole region,
+ * - a record is marked as sent by programming its state word to 0 rather than by erasing it, so a delivered record
+ *   costs no erase at all,
+ * - after a reboot, begin() rebuilds the head and the pending records from the sequence numbers and state words; a
+ *   record torn by a power loss fails its CRC and is skipped.
+*/
+
+#ifndef AERORADAREMBEDDED_FLASHBACKLOG_H
+#define AERORADAREMBEDDED_FLASHBACKLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlashDevice.h"
+
+/**
+ * A wear levelled ring of records in flash that survives reboots.
+ */
+class FlashBacklog {
+
+public:
+    /**
+     * The order pending records are handed out for sending.
+     */
+    enum DrainOrder : uint8_t {
+        //fill the gap from its start, the server sees the flight in order
+        OLDEST_FIRST = 0,
+        //fill the gap from its end, the most recent history reaches the operator first
+        NEWEST_FIRST
+    };
+
+    /**
+     * What happens when the head reaches a row that still holds pending records.
+     */
+    enum OverflowPolicy : uint8_t {
+        //erase the row, losing its oldest pending records
+        OVERWRITE_OLDEST = 0,
+        //refuse the new record until pending records have been sent
+        REJECT_NEWEST
+    };
+
+    /**
+     * A pending record. The sequence number guards against the page having been reused since it was selected.
+     */
+    struct RecordRef {
+        uint16_t page;
+        uint32_t sequence;
+    };
+
+    //The most pages the backlog manages, e.g. 32 KB of 64 byte pages. Larger regions are only used up to this.
+    static const size_t maxPages = 512;
+
+    //The bytes of every page taken by the record header.
+    static const size_t headerSize = 12;
+
+    //The most bytes of a page used by a record, header included.
+    static const size_t maxRecordSize = 64;
+
+    /**
+     * Constructor
+     * @param flash - the flash region that holds the log.
+     * @param order - the order pending records are drained in.
+     * @param overflow - what happens when the log is full of pending records.
+     */
+    FlashBacklog(FlashDevice &flash, DrainOrder order, OverflowPolicy overflow);
+
+    /**
+     * Recover the log from flash. Call once at startup, before any other method.
+     * @return size_t - the number of pending records found.
+     */
+    size_t begin();
+
+    /**
+     * Append a record at the head of the log.
+     * @param payload - the record.
+     * @param length - the length of the record, at most maxPayloadSize().
+     * @param tag - a byte stored with the record, e.g. its priority.
+     * @return bool - true if the record was stored, false if it is too long, the flash failed or the log is full and
+     * the overflow policy is REJECT_NEWEST.
+     */
+    bool append(const uint8_t *payload, size_t length, uint8_t tag);
+
+    /**
+     * Select pending records in drain order.
+     * @param refs - filled with the selected records.
+     * @param maxCount - the size of refs.
+     * @return size_t - the number of records selected.
+     */
+    size_t select(RecordRef *refs, size_t maxCount);
+
+    /**
+     * Read a pending record.
+     * @param ref - the record, from select().
+     * @param payload - filled with the record.
+     * @param capacity - the size of payload.
+     * @param tag - set to the tag stored with the record.
+     * @return size_t - the length of the record, 0 if it is no longer pending or does not fit.
+     */
+    size_t read(const RecordRef &ref, uint8_t *payload, size_t capacity, uint8_t &tag);
+
+    /**
+     * Mark a record as sent, so it is never drained again.
+     * @param ref - the record, from select().
+     * @return bool - true if the record was marked, false if it was no longer pending.
+     */
+    bool markSent(const RecordRef &ref);
+
+    /**
+     * The number of records waiting to be sent.
+     * @return size_t - the number of records.
+     */
+    size_t pendingCount() const;
+
+    /**
+     * The number of records the log holds.
+     * @return size_t - the number of pages in use.
+     */
+    size_t capacity() const;
+
+    /**
+     * How full the log is.
+     * @return uint8_t - the pending records as a percentage of capacity().
+     */
+    uint8_t fillPercent() const;
+
+    /**
+     * Whether the next append has to overwrite or reject pending records. Producers can use it as backpressure.
+     * @return bool - true if the row at the head still holds pending records.
+     */
+    bool isFull() const;
+
+    /**
+     * The largest record that fits in a page.
+     * @return size_t - the number of bytes.
+     */
+    size_t maxPayloadSize() const;
+
+    /**
+     * Change the order pending records are drained in.
+     * @param order - the new order.
+     */
+    void setDrainOrder(DrainOrder order);
+
+    /**
+     * Change what happens when the log is full of pending records.
+     * @param overflow - the new policy.
+     */
+    void setOverflowPolicy(OverflowPolicy overflow);
+
+    /**
+     * The number of pending records lost to OVERWRITE_OLDEST since boot.
+     * @return uint32_t - the number of records.
+     */
+    uint32_t overwrittenCount() const;
+
+    /**
+     * The number of records refused by REJECT_NEWEST since boot.
+     * @return uint32_t - the number of records.
+     */
+    uint32_t rejectedCount() const;
+
+private:
+    /**
+     * A decoded record header.
+     */
+    struct Header {
+        uint32_t sequence;
+        uint8_t length;
+        uint8_t tag;
+        bool pending;
+    };
+
+    FlashDevice &flash;
+    DrainOrder order;
+    OverflowPolicy overflow;
+
+    uint16_t pages = 0;
+    uint16_t pagesPerRow = 1;
+
+    //the page the next record is written to
+    uint16_t head = 0;
+    uint32_t nextSequence = 1;
+
+    //one bit per page that holds a pending record
+    uint32_t pendingBits[maxPages / 32]{};
+    uint16_t pending = 0;
+
+    uint32_t overwritten = 0;
+    uint32_t rejected = 0;
+
+    /**
+     * Read and check the record in a page.
+     * @param page - the page.
+     * @param header - set to the record header.
+     * @param payload - filled with the record, at least maxPayloadSize() bytes.
+     * @return bool - true if the page holds an intact record.
+     */
+    bool readRecord(uint16_t page, Header &header, uint8_t *payload);
+
+    /**
+     * Whether every byte of a page is erased.
+     * @param page - the page.
+     * @return bool - true if the page can be programmed.
+     */
+    bool isBlank(uint16_t page);
+
+    /**
+     * Whether a page holds a pending record.
+     * @param page - the page.
+     * @return bool - true if the record is waiting to be sent.
+     */
+    bool isPending(uint16_t page) const;
+
+    /**
+     * Set or clear the pending bit of a page, keeping the pending count in step.
+     * @param page - the page.
+     * @param value - whether the page holds a pending record.
+     */
+    void setPending(uint16_t page, bool value);
+
+    /**
+     * The CRC-16/CCITT of a record.
+     * @param data - the bytes.
+     * @param length - the number of bytes.
+     * @param crc - the CRC so far.
+     * @return uint16_t - the updated CRC.
+     */
+    static uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc);
+};
+
+#endif //AERORADAREMBEDDED_FLASHBACKLOG_H
@@ -0,0 +1,69 @@
+/**
+* @File: FlashDevice.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the FlashDevice interface, the NOR flash that persistent stores such as the
+ * telemetry backlog are written to. It mirrors how the SAMD21 NVM behaves: programming can only clear bits, and only an
+ * erase of a whole row sets them back to 1. On the device it is implemented by SamdFlash on top of a region of spare
+ * on-chip flash; on a host build it is implemented by RamFlash, which emulates the same rules in RAM.
+*/
+
+#ifndef AERORADAREMBEDDED_FLASHDEVICE_H
+#define AERORADAREMBEDDED_FLASHDEVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * A region of NOR flash, addressed from 0.
+ */
+class FlashDevice {
+
+public:
+    virtual ~FlashDevice() = default;
+
+    /**
+     * The size of the region.
+     * @return size_t - the number of bytes, a multiple of rowSize().
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * The size of a page, the largest unit written by a single program().
+     * @return size_t - the number of bytes.
+     */
+    virtual size_t pageSize() const = 0;
+
+    /**
+     * The size of a row, the unit erased by eraseRow().
+     * @return size_t - the number of bytes, a multiple of pageSize().
+     */
+    virtual size_t rowSize() const = 0;
+
+    /**
+     * Read bytes from the region.
+     * @param address - the address of the first byte.
+     * @param data - filled with the bytes read.
+     * @param length - the number of bytes to read.
+     */
+    virtual void read(size_t address, uint8_t *data, size_t length) = 0;
+
+    /**
+     * Program bytes within a single page. Bits can only be cleared, so the stored value becomes the AND of the old
+     * and the new value.
+     * @param address - the address of the first byte, must be a multiple of 4.
+     * @param data - the bytes to program.
+     * @param length - the number of bytes, must not cross a page boundary.
+     * @return bool - true if the bytes were programmed, false if the arguments are out of range.
+     */
+    virtual bool program(size_t address, const uint8_t *data, size_t length) = 0;
+
+    /**
+     * Erase a row, setting all of its bytes to 0xFF.
+     * @param address - the address of the first byte of the row.
+     * @return bool - true if the row was erased, false if the address is out of range.
+     */
+    virtual bool eraseRow(size_t address) = 0;
+};
+
+#endif //AERORADAREMBEDDED_FLASHDEVICE_H
@@ -0,0 +1,92 @@
+/**
+* @File: RamFlash.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the RamFlash class.
+*/
+
+#include "RamFlash.h"
+#include <string.h>
+
+RamFlash::RamFlash(uint8_t *memory, size_t size, size_t pageSize, size_t pagesPerRow)
+        : memory(memory), memorySize(size), page(pageSize), row(pageSize * pagesPerRow) {
+}
+
+size_t RamFlash::size() const {
+    return memorySize;
+}
+
+size_t RamFlash::pageSize() const {
+    return page;
+}
+
+size_t RamFlash::rowSize() const {
+    return row;
+}
+
+void RamFlash::read(size_t address, uint8_t *data, size_t length) {
+    if (address > memorySize || length > memorySize - address) {
+        memset(data, 0xFF, length);
+        return;
+    }
+    memcpy(data, memory + address, length);
+}
+
+bool RamFlash::program(size_t address, const uint8_t *data, size_t length) {
+
+    //the NVM is written in whole 32 bit words within a single page
+    if (address % 4 != 0 || address > memorySize || length > memorySize - address
+        || length == 0 || address / page != (address + length - 1) / page) {
+        return false;
+    }
+
+    size_t pageIndex = address / page;
+    if (pageIndex < maxPages && ++programs[pageIndex] > maxProgramsPerPage) {
+        violationCount++;
+    }
+
+    bool setsBits = false;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t old = memory[address + i];
+        if ((uint8_t) (data[i] & ~old) != 0) {
+            setsBits = true;
+        }
+        memory[address + i] = old & data[i];
+    }
+    if (setsBits) {
+        violationCount++;
+    }
+    return true;
+}
+
+bool RamFlash::eraseRow(size_t address) {
+
+    if (address % row != 0 || address >= memorySize) {
+        return false;
+    }
+
+    memset(memory + address, 0xFF, row);
+
+    size_t rowIndex = address / row;
+    if (rowIndex < maxRows) {
+        erases[rowIndex]++;
+    }
+    for (size_t p = address / page; p < (address + row) / page && p < maxPages; p++) {
+        programs[p] = 0;
+    }
+    return true;
+}
+
+void RamFlash::eraseAll() {
+    for (size_t address = 0; address < memorySize; address += row) {
+        eraseRow(address);
+    }
+}
+
+uint32_t RamFlash::eraseCount(size_t rowIndex) const {
+    return rowIndex < maxRows ? erases[rowIndex] : 0;
+}
+
+uint32_t RamFlash::violations() const {
+    return violationCount;
+}
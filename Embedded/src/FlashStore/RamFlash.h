@@ -0,0 +1,85 @@
+/**
+* @File: RamFlash.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines RamFlash, a FlashDevice emulated in a caller supplied RAM buffer. It enforces
+ * the rules of the real NOR flash (programming only clears bits, pages are programmed at most twice between erases,
+ * writes stay within a page) and counts erases per row, so the stores built on FlashDevice, and their wear levelling,
+ * can be exercised without the hardware. It has no Arduino dependencies so it can be used in a host build as well as
+ * on the device.
+*/
+
+#ifndef AERORADAREMBEDDED_RAMFLASH_H
+#define AERORADAREMBEDDED_RAMFLASH_H
+
+#include "FlashDevice.h"
+
+/**
+ * A FlashDevice in RAM.
+ */
+class RamFlash : public FlashDevice {
+
+public:
+    //The most rows whose erases are counted.
+    static const size_t maxRows = 256;
+
+    //The most pages whose programs are counted.
+    static const size_t maxPages = 1024;
+
+    //How often a page may be programmed between two erases of its row, as on the SAMD21.
+    static const uint8_t maxProgramsPerPage = 2;
+
+    /**
+     * Constructor. The contents of the buffer are kept, so a second RamFlash over the same buffer sees what the first
+     * one wrote, like the device after a reboot.
+     * @param memory - the buffer that holds the emulated flash.
+     * @param size - the size of the buffer, a multiple of pageSize * pagesPerRow.
+     * @param pageSize - the size of a page.
+     * @param pagesPerRow - the number of pages erased together.
+     */
+    RamFlash(uint8_t *memory, size_t size, size_t pageSize = 64, size_t pagesPerRow = 4);
+
+    size_t size() const override;
+
+    size_t pageSize() const override;
+
+    size_t rowSize() const override;
+
+    void read(size_t address, uint8_t *data, size_t length) override;
+
+    bool program(size_t address, const uint8_t *data, size_t length) override;
+
+    bool eraseRow(size_t address) override;
+
+    /**
+     * Erase every row, like a chip that was just flashed.
+     */
+    void eraseAll();
+
+    /**
+     * The number of times a row was erased.
+     * @param rowIndex - the index of the row.
+     * @return uint32_t - the number of erases.
+     */
+    uint32_t eraseCount(size_t rowIndex) const;
+
+    /**
+     * The number of program() calls that broke the rules of the flash, such as setting a bit that was cleared or
+     * programming a page too often. Such calls still store the AND of the old and new value, like the real flash.
+     * @return uint32_t - the number of violations.
+     */
+    uint32_t violations() const;
+
+private:
+    uint8_t *memory;
+    size_t memorySize;
+    size_t page;
+    size_t row;
+
+    uint32_t erases[maxRows]{};
+    //the number of programs of each page since its row was erased, for the first maxPages pages
+    uint8_t programs[maxPages]{};
+    uint32_t violationCount = 0;
+};
+
+#endif //AERORADAREMBEDDED_RAMFLASH_H
@@ -0,0 +1,78 @@
+/**
+* @File: SamdFlash.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the SamdFlash class.
+*/
+
+#include "SamdFlash.h"
+#include <Arduino.h>
+
+SamdFlash::SamdFlash(const volatile uint8_t *region, size_t size) : region(region), regionSize(size) {
+}
+
+size_t SamdFlash::size() const {
+    return regionSize;
+}
+
+size_t SamdFlash::pageSize() const {
+    return samdPageSize;
+}
+
+size_t SamdFlash::rowSize() const {
+    return samdRowSize;
+}
+
+void SamdFlash::read(size_t address, uint8_t *data, size_t length) {
+    //the flash is memory mapped
+    for (size_t i = 0; i < length; i++) {
+        data[i] = address + i < regionSize ? region[address + i] : 0xFF;
+    }
+}
+
+bool SamdFlash::program(size_t address, const uint8_t *data, size_t length) {
+
+    if (address % 4 != 0 || address > regionSize || length > regionSize - address
+        || length == 0 || address / samdPageSize != (address + length - 1) / samdPageSize) {
+        return false;
+    }
+
+    //write the page buffer by hand, words that are left at 0xFFFFFFFF do not change the flash
+    NVMCTRL->CTRLB.bit.MANW = 1;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+    waitReady();
+
+    //the page buffer only takes 16 or 32 bit writes
+    volatile uint32_t *destination = (volatile uint32_t *) (region + address);
+    for (size_t i = 0; i < length; i += 4) {
+        uint32_t word = 0;
+        for (size_t j = 0; j < 4; j++) {
+            uint8_t byte = i + j < length ? data[i + j] : 0xFF;
+            word |= (uint32_t) byte << (8 * j);
+        }
+        *destination++ = word;
+    }
+
+    //the write page command takes its address from the last page buffer write
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+    waitReady();
+    return true;
+}
+
+bool SamdFlash::eraseRow(size_t address) {
+
+    if (address % samdRowSize != 0 || address >= regionSize) {
+        return false;
+    }
+
+    //the address register takes the address in 16 bit words
+    NVMCTRL->ADDR.reg = (uint32_t) ((uintptr_t) (region + address) / 2);
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+    waitReady();
+    return true;
+}
+
+void SamdFlash::waitReady() {
+    while (NVMCTRL->INTFLAG.bit.READY == 0) {
+    }
+}
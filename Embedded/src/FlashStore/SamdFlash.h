@@ -0,0 +1,65 @@
+/**
+* @File: SamdFlash.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines SamdFlash, the FlashDevice on top of a region of the SAMD21's on-chip flash.
+ * The region is an ordinary array in the firmware image, aligned to a row and declared with SAMD_FLASH_REGION, so the
+ * linker keeps code and constants out of it. It is erased and programmed through the NVM controller, which stalls the
+ * CPU for a few milliseconds per row erase and a few microseconds per page write.
+*/
+
+#ifndef AERORADAREMBEDDED_SAMDFLASH_H
+#define AERORADAREMBEDDED_SAMDFLASH_H
+
+#include "FlashDevice.h"
+
+/**
+ * Declare a region of spare on-chip flash for a SamdFlash.
+ * @param name - the name of the region.
+ * @param bytes - the size of the region, a multiple of SamdFlash::samdRowSize.
+ */
+#define SAMD_FLASH_REGION(name, bytes) \
+    __attribute__((aligned(256))) const volatile uint8_t name[bytes] = {}
+
+/**
+ * A FlashDevice in the SAMD21's on-chip flash.
+ */
+class SamdFlash : public FlashDevice {
+
+public:
+    //The page size of the SAMD21 NVM.
+    static const size_t samdPageSize = 64;
+
+    //The row size of the SAMD21 NVM, 4 pages.
+    static const size_t samdRowSize = 256;
+
+    /**
+     * Constructor
+     * @param region - the first byte of a region declared with SAMD_FLASH_REGION.
+     * @param size - the size of the region.
+     */
+    SamdFlash(const volatile uint8_t *region, size_t size);
+
+    size_t size() const override;
+
+    size_t pageSize() const override;
+
+    size_t rowSize() const override;
+
+    void read(size_t address, uint8_t *data, size_t length) override;
+
+    bool program(size_t address, const uint8_t *data, size_t length) override;
+
+    bool eraseRow(size_t address) override;
+
+private:
+    const volatile uint8_t *region;
+    size_t regionSize;
+
+    /**
+     * Wait until the NVM controller is ready for the next command.
+     */
+    static void waitReady();
+};
+
+#endif //AERORADAREMBEDDED_SAMDFLASH_H
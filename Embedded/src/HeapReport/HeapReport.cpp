@@ -0,0 +1,88 @@
+/**
+* @File: HeapReport.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the HeapReport class and the allocation counters behind it.
+ * The linker sends every call to malloc, calloc, realloc and free to the __wrap_ functions below, which count the call
+ * and hand it on to the C library through __real_.
+*/
+
+#include "HeapReport.h"
+#include <Arduino.h>
+#include <malloc.h>
+#include "Log/Log.h"
+
+extern "C" {
+
+//The end of the heap, moved up by the C library as the heap grows.
+char *sbrk(int increment);
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+
+//The allocation counters, an allocation may happen in an interrupt.
+static volatile uint32_t allocationCount = 0;
+static volatile uint32_t freeCount = 0;
+
+void *__wrap_malloc(size_t size) {
+    allocationCount++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocationCount++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    allocationCount++;
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void *pointer) {
+    //free(nullptr) does nothing, so it does not count
+    if (pointer != nullptr) {
+        freeCount++;
+    }
+    __real_free(pointer);
+}
+
+}
+
+HeapReport::Snapshot HeapReport::snapshot() {
+    struct mallinfo info = mallinfo();
+
+    //the stack grows down towards the end of the heap
+    char stackTop;
+    char *heapEnd = sbrk(0);
+
+    Snapshot snapshot;
+    snapshot.allocations = allocationCount;
+    snapshot.frees = freeCount;
+    snapshot.heapBytes = (uint32_t) info.arena;
+    snapshot.usedBytes = (uint32_t) info.uordblks;
+    snapshot.freeBytes = (uint32_t) info.fordblks;
+    snapshot.freeChunks = (uint32_t) info.ordblks;
+    snapshot.stackGapBytes = &stackTop > heapEnd ? (uint32_t) (&stackTop - heapEnd) : 0;
+    return snapshot;
+}
+
+HeapReport::Snapshot HeapReport::report() {
+    Snapshot now = snapshot();
+    lastPeriodAllocations = now.allocations - last.allocations;
+
+    LOG_INFO(LOG_SYSTEM, "Heap: %lu B in use, %lu B free in %lu chunks, %lu B claimed, %lu B to the stack, "
+                         "%lu allocations and %lu frees since the last report",
+             (unsigned long) now.usedBytes, (unsigned long) now.freeBytes, (unsigned long) now.freeChunks,
+             (unsigned long) now.heapBytes, (unsigned long) now.stackGapBytes,
+             (unsigned long) lastPeriodAllocations, (unsigned long) (now.frees - last.frees));
+
+    last = now;
+    return now;
+}
+
+uint32_t HeapReport::allocationsInLastPeriod() const {
+    return lastPeriodAllocations;
+}
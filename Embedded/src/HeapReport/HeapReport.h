@@ -0,0 +1,73 @@
+/**
+* @File: HeapReport.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the HeapReport class, which shows whether the firmware still uses the heap
+ * once it runs, and how fragmented the heap has become. The build wraps malloc, calloc, realloc and free
+ * (-Wl,--wrap in platformio.ini), so every allocation is counted, including those made by new and by Arduino String.
+ * The state of the heap itself comes from newlib's mallinfo(): the bytes in use, the free bytes left inside the heap
+ * and the number of free chunks they are split into. A steady state shows no new allocations between two reports and
+ * the same heap from one report to the next.
+*/
+
+#ifndef AERORADAREMBEDDED_HEAPREPORT_H
+#define AERORADAREMBEDDED_HEAPREPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Measures the use of the heap and reports it, together with the change since the last report.
+ */
+class HeapReport {
+
+public:
+    /**
+     * The state of the heap at one point in time.
+     */
+    struct Snapshot {
+        //calls to malloc, calloc and realloc since boot
+        uint32_t allocations;
+        //calls to free since boot
+        uint32_t frees;
+        //the bytes claimed from the system for the heap, they are never given back
+        uint32_t heapBytes;
+        //the bytes of the heap in use
+        uint32_t usedBytes;
+        //the bytes of the heap that are free, and the number of chunks they are split into
+        uint32_t freeBytes;
+        uint32_t freeChunks;
+        //the bytes between the end of the heap and the stack
+        uint32_t stackGapBytes;
+    };
+
+    /**
+     * Default constructor.
+     */
+    HeapReport() = default;
+
+    /**
+     * Measure the heap now.
+     * @return Snapshot - the state of the heap.
+     */
+    static Snapshot snapshot();
+
+    /**
+     * Log the state of the heap and the allocations since the last report, then start a new period. Nothing in here
+     * allocates.
+     * @return Snapshot - the state of the heap that was logged.
+     */
+    Snapshot report();
+
+    /**
+     * The number of allocations between the last two reports.
+     * @return uint32_t - the allocations, 0 in a steady state.
+     */
+    uint32_t allocationsInLastPeriod() const;
+
+private:
+    Snapshot last{};
+    uint32_t lastPeriodAllocations = 0;
+};
+
+#endif //AERORADAREMBEDDED_HEAPREPORT_H
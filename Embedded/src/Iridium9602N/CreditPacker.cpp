@@ -0,0 +1,128 @@
+/**
+* @File: CreditPacker.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This code implements the CreditPacker class. The packer measures the full pending content, picks a
+ * credit budget, pulls the budget back by one credit if only a few optional bytes would spill into it, and then fills
+ * the budget in order of value.
+*/
+
+#include "CreditPacker.h"
+#include <string.h>
+
+using namespace TelemetryCodec;
+
+uint16_t CreditPacker::creditsFor(size_t bytes) {
+    return bytes == 0 ? 1 : (uint16_t) ((bytes + creditSize - 1) / creditSize);
+}
+
+size_t CreditPacker::roundUpToCredit(size_t bytes) {
+    return (size_t) creditsFor(bytes) * creditSize;
+}
+
+size_t CreditPacker::writeSamplesSection(const Schema &schema, const TelemetrySample *samples, size_t sampleCount,
+                                         uint8_t *buffer, size_t capacity, size_t &encodedCount) {
+    encodedCount = 0;
+
+    //leave room for the section header, whose varint length grows to 2 bytes once the body reaches 128 bytes
+    if (sampleCount == 0 || capacity <= 3) {
+        return 0;
+    }
+    size_t reservedHeader = capacity - 2 < 128 ? 2 : 3;
+
+    size_t bodyLength = encodeBatchBody(schema, samples, sampleCount, buffer + reservedHeader,
+                                        capacity - reservedHeader, encodedCount);
+    if (bodyLength == 0) {
+        return 0;
+    }
+
+    //write the real header and slide the body up against it
+    size_t headerLength = writeSectionHeader(SECTION_SAMPLES, bodyLength, buffer);
+    memmove(buffer + headerLength, buffer + reservedHeader, bodyLength);
+    return headerLength + bodyLength;
+}
+
+size_t CreditPacker::pack(const TelemetrySample *samples, size_t sampleCount, const Schema &schema,
+                          const Acknowledgement *acks, size_t ackCount, const DeviceStatus *status,
+                          const HealthCounters *health, uint8_t *buffer, size_t capacity, Result &result) {
+    result = Result();
+
+    //measure the mandatory content: the version byte, every acknowledgement, the status and the newest sample with
+    // the schema it is encoded with
+    size_t ackPayload = acknowledgementPayloadSize(acks, ackCount);
+    size_t ackSection = ackCount > 0 ? sectionHeaderSize(ackPayload) + ackPayload : 0;
+    size_t statusPayload = status != nullptr ? statusPayloadSize(*status) : 0;
+    size_t statusSection = status != nullptr ? sectionHeaderSize(statusPayload) + statusPayload : 0;
+    size_t schemaPayload = sampleCount > 0 && !isStandardSchema(schema) ? schemaDescriptorSize(schema) : 0;
+    size_t schemaSection = schemaPayload > 0 ? sectionHeaderSize(schemaPayload) + schemaPayload : 0;
+    size_t newestBody = 1 + keyframeSize(schema);
+    size_t newestSample = sampleCount > 0 ? schemaSection + sectionHeaderSize(newestBody) + newestBody : 0;
+    size_t mandatory = 1 + ackSection + statusSection + newestSample;
+    if (mandatory > capacity || (ackCount == 0 && status == nullptr && sampleCount == 0)) {
+        return 0;
+    }
+
+    //measure everything that is pending by encoding the samples into the buffer as a scratch area
+    size_t fullSamples = 0;
+    if (sampleCount > 0) {
+        size_t ignored;
+        fullSamples = schemaSection + writeSamplesSection(schema, samples, sampleCount, buffer,
+                                                          capacity - 1 - ackSection - statusSection - schemaSection,
+                                                          ignored);
+    }
+    size_t healthPayload = health != nullptr ? healthPayloadSize(*health) : 0;
+    size_t healthSection = health != nullptr ? sectionHeaderSize(healthPayload) + healthPayload : 0;
+    size_t full = 1 + ackSection + statusSection + fullSamples + healthSection;
+
+    //pay for the credits the full content needs, unless only a few optional bytes spill into the last one
+    size_t budget = roundUpToCredit(full);
+    if (budget > creditSize && full - (budget - creditSize) < minSpillBytes && budget - creditSize >= mandatory) {
+        budget -= creditSize;
+    }
+    if (budget > capacity) {
+        budget = capacity;
+    }
+
+    //version byte
+    size_t offset = 0;
+    buffer[offset++] = sectionedFormatVersion;
+
+    //acknowledgements are always sent
+    if (ackCount > 0) {
+        offset += writeSectionHeader(SECTION_ACKNOWLEDGEMENTS, ackPayload, buffer + offset);
+        offset += writeAcknowledgementPayload(acks, ackCount, buffer + offset);
+        result.acknowledgements = ackCount;
+    }
+
+    //so is the status, whenever it has changed
+    if (status != nullptr) {
+        offset += writeSectionHeader(SECTION_STATUS, statusPayload, buffer + offset);
+        offset += writeStatusPayload(*status, buffer + offset);
+        result.status = true;
+    }
+
+    //as many of the newest samples as fit, leaving room for the health counters only if everything else fits
+    if (sampleCount > 0) {
+        size_t sampleBudget = budget - offset;
+        if (health != nullptr && fullSamples + healthSection <= sampleBudget) {
+            sampleBudget = fullSamples;
+        }
+        if (schemaSection > 0) {
+            offset += writeSectionHeader(SECTION_SCHEMA, schemaPayload, buffer + offset);
+            offset += writeSchemaDescriptor(schema, buffer + offset);
+            sampleBudget -= schemaSection;
+        }
+        offset += writeSamplesSection(schema, samples, sampleCount, buffer + offset, sampleBudget, result.samples);
+    }
+
+    //the health counters fill whatever room is left in the budget
+    if (health != nullptr && offset + healthSection <= budget) {
+        offset += writeSectionHeader(SECTION_HEALTH, healthPayload, buffer + offset);
+        offset += writeHealthPayload(*health, buffer + offset);
+        result.health = true;
+    }
+
+    result.bytes = offset;
+    result.credits = creditsFor(offset);
+    return offset;
+}
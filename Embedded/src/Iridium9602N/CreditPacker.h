@@ -0,0 +1,131 @@
+/**
+* @File: CreditPacker.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the CreditPacker class, which builds sectioned telemetry packets that make
+ * the most of every 50 byte Iridium credit. Mobile originated messages are billed per started credit, so the packer
+ * first decides how many credits the pending content deserves and then fills them in order of value:
+ * acknowledgements and the device status, the newest sample, older samples (newest first) and finally the device
+ * health counters. Optional content is never allowed to open a new credit for just a few bytes; it is dropped instead.
+*/
+
+#ifndef AERORADAREMBEDDED_CREDITPACKER_H
+#define AERORADAREMBEDDED_CREDITPACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "TelemetryCodec/TelemetryCodec.h"
+
+/**
+ * Packs samples, acknowledgements and health counters into a sectioned packet aligned to Iridium credit boundaries.
+ */
+class CreditPacker {
+
+public:
+    //The number of bytes in one Iridium mobile originated credit.
+    static const uint16_t creditSize = 50;
+
+    //The minimum number of bytes of optional content that justify paying for another credit.
+    static const uint16_t minSpillBytes = 12;
+
+    /**
+     * The outcome of packing a message.
+     */
+    struct Result {
+        //The number of bytes in the packet.
+        size_t bytes = 0;
+        //The number of credits the packet will be billed.
+        uint16_t credits = 0;
+        //The number of samples in the packet. These are always the newest ones.
+        size_t samples = 0;
+        //The number of acknowledgements in the packet.
+        size_t acknowledgements = 0;
+        //A boolean to indicate if the device status is in the packet.
+        bool status = false;
+        //A boolean to indicate if the health counters are in the packet.
+        bool health = false;
+    };
+
+    /**
+     * The number of credits a message of the given length is billed.
+     * @param bytes - the length of the message.
+     * @return uint16_t - the number of credits, at least 1.
+     */
+    static uint16_t creditsFor(size_t bytes);
+
+    /**
+     * Pack pending content into a sectioned packet. A packet without samples is allowed if it carries
+     * acknowledgements or the device status.
+     * @param samples - the pending samples, oldest first. The newest sample is always packed.
+     * @param sampleCount - the number of pending samples.
+     * @param schema - the schema to encode the samples with. A schema section is packed ahead of the samples
+     * unless it is the standard schema.
+     * @param acks - the pending acknowledgements, which are always packed.
+     * @param ackCount - the number of pending acknowledgements.
+     * @param status - the device status, which is always packed, nullptr to leave it out.
+     * @param health - the health counters to pack if there is room, nullptr to leave them out.
+     * @param buffer - the buffer to pack into.
+     * @param capacity - the size of the buffer, usually the 340 byte mobile originated limit.
+     * @param result - set to what was packed.
+     * @return size_t - the number of bytes in the packet, 0 if the mandatory content does not fit.
+     */
+    static size_t pack(const TelemetryCodec::TelemetrySample *samples, size_t sampleCount,
+                       const TelemetryCodec::Schema &schema,
+                       const TelemetryCodec::Acknowledgement *acks, size_t ackCount,
+                       const TelemetryCodec::DeviceStatus *status,
+                       const TelemetryCodec::HealthCounters *health,
+                       uint8_t *buffer, size_t capacity, Result &result);
+
+    /**
+     * Pack a ranked selection of samples. pack() leaves out the oldest samples that do not fit, which may be highly
+     * ranked ones, so the selection is shrunk to the number that fit and packed again until every selected sample is
+     * in the packet.
+     * @tparam SelectSamples - a callable size_t(size_t selected, TelemetrySample *samples) that writes the top
+     * selected samples by rank, oldest first, and returns their number.
+     * @param selected - the number of samples to select, set to the number that were packed.
+     * @param selectSamples - writes the samples of a selection.
+     * @param samples - the room for the samples of a selection.
+     * The other parameters and the return value are those of pack().
+     */
+    template<typename SelectSamples>
+    static size_t packSelection(size_t &selected, SelectSamples selectSamples, TelemetryCodec::TelemetrySample *samples,
+                                const TelemetryCodec::Schema &schema,
+                                const TelemetryCodec::Acknowledgement *acks, size_t ackCount,
+                                const TelemetryCodec::DeviceStatus *status,
+                                const TelemetryCodec::HealthCounters *health,
+                                uint8_t *buffer, size_t capacity, Result &result) {
+        while (true) {
+            size_t sampleCount = selectSamples(selected, samples);
+            size_t length = pack(samples, sampleCount, schema, acks, ackCount, status, health, buffer, capacity,
+                                 result);
+            if (length == 0 || result.samples >= selected) {
+                return length;
+            }
+            selected = result.samples;
+        }
+    }
+
+private:
+    /**
+     * Round a length up to the next credit boundary.
+     * @param bytes - the length.
+     * @return size_t - the length rounded up to a multiple of creditSize.
+     */
+    static size_t roundUpToCredit(size_t bytes);
+
+    /**
+     * Write the samples section into the buffer, fitting as many of the newest samples as possible.
+     * @param schema - the schema to encode the samples with.
+     * @param samples - the samples, oldest first.
+     * @param sampleCount - the number of samples.
+     * @param buffer - the buffer to write to.
+     * @param capacity - the number of bytes available for the whole section.
+     * @param encodedCount - set to the number of samples written.
+     * @return size_t - the number of bytes written, 0 if not even one sample fits.
+     */
+    static size_t writeSamplesSection(const TelemetryCodec::Schema &schema,
+                                      const TelemetryCodec::TelemetrySample *samples, size_t sampleCount,
+                                      uint8_t *buffer, size_t capacity, size_t &encodedCount);
+};
+
+#endif //AERORADAREMBEDDED_CREDITPACKER_H
@@ -4,278 +4,440 @@
 * @Date: 2023-04-23
 * @Description: This code is for the Iridium9602N class which is responsible for handling communication with the
  * Iridium satellite modem. The class allows you to insert MAVLink messages into a satellite queue, verify and push
- * the messages out of the queue to the satellite, and receive and parse configuration messages from the server. It
- * also provides functionality for sending a bootup message to the server, setting up the modem, and checking the
- * signal quality of the modem.
+ * the messages out of the queue to the satellite together with the device status and acknowledgements, and parse the
+ * configuration messages the server sends back in the same sessions. It also provides functionality for setting up
+ * the modem and checking the signal quality of the modem.
 */
 
 #include "Iridium9602N.h"
 #include "DiagnosticTools/GlobalDiagnosticLED.h"
+#include "LatencyProfiler/LatencyProfiler.h"
+#include "CreditPacker.h"
+#include "TimeBase/GlobalTimeBase.h"
+#include "Log/Log.h"
+
+bool Iridium9602N::insertIntoSatQueue(const TelemetryStore &store) {
+
+    //keep the fields of every message that arrived since the last call, they are sent along with the next trigger
+    bool triggered = false;
+    for (uint8_t i = 0; i < telemetrySchema.messageCount(); i++) {
+        uint32_t messageId = telemetrySchema.message(i).messageId;
+        uint32_t sequence = store.sequence(messageId);
+        if (sequence == 0 || sequence == seenSequences[i]) {
+            continue;
+        }
+        seenSequences[i] = sequence;
+        TelemetrySchema::copyFields(store, messageId, latestFields);
+        arrivedMessages |= (uint8_t) (1 << i);
+        triggered |= messageId == telemetrySchema.triggerMessage();
+    }
+
+    //queue the new sample, with the latest fields of every other message
+    return triggered && queueTelemetry(SendQueue::ROUTINE);
+}
+
+bool Iridium9602N::queueTelemetry(SendQueue::Priority priority) {
+
+    //a record needs every message of the schema
+    uint8_t allMessages = (uint8_t) ((1 << telemetrySchema.messageCount()) - 1);
+    if (arrivedMessages != allMessages) {
+        return false;
+    }
 
-void Iridium9602N::insertIntoSatQueue(mavlink_message_t msg) {
+    unsigned long lifetime = priority == SendQueue::CRITICAL ? criticalLifetimeMillis : routineLifetimeMillis;
+    return sendQueue.push(buildTelemetrySample(), priority, millis(), lifetime);
+}
 
-    //check if the message has a valid length
-    if (msg.len > 0) {
-        //check if the message is MAVLINK_MSG_ID_GLOBAL_POSITION_INT
-        if (msg.msgid == MAVLINK_MSG_ID_GLOBAL_POSITION_INT) {
-            //save the message and flag it as in queue
-            globalPositionIntMsg = msg;
-            globalPositionIntInQueue = true;
+void Iridium9602N::setSchema(const TelemetrySchema &schema) {
 
+    //a message keeps counting as arrived if the old schema sampled it too
+    uint8_t arrived = 0;
+    uint32_t seen[TelemetrySchema::maxMessages]{};
+    for (uint8_t i = 0; i < schema.messageCount(); i++) {
+        int previous = telemetrySchema.indexOf(schema.message(i).messageId);
+        if (previous >= 0 && (arrivedMessages >> previous) & 1) {
+            arrived |= (uint8_t) (1 << i);
         }
-            // check if the message is MAVLINK_MSG_ID_ATTITUDE
-        else if (msg.msgid == MAVLINK_MSG_ID_ATTITUDE) {
-            //save the message and flag it as in queue
-            attitudeMsg = msg;
-            attitudeInQueue = true;
+        if (previous >= 0) {
+            seen[i] = seenSequences[previous];
         }
     }
-
+    telemetrySchema = schema;
+    arrivedMessages = arrived;
+    memcpy(seenSequences, seen, sizeof(seenSequences));
 }
 
-bool Iridium9602N::verifyAndPushOutSatQueue() {
+bool Iridium9602N::hasPartialSample() {
+    return arrivedMessages != 0 && arrivedMessages != (uint8_t) ((1 << telemetrySchema.messageCount()) - 1);
+}
 
-    //check if both messages are in queue
-    if (globalPositionIntInQueue && attitudeInQueue) {
+bool Iridium9602N::verifyAndPushOutSatQueue(bool includeSamples) {
 
-        rgbLED.setState(RGBLED::SENDING_TELEMETRY);
-        // Get the length of each message and create a buffer for each
-        uint16_t attitudeLen = mavlink_msg_get_send_buffer_length(&attitudeMsg);
-        uint16_t globalPositionIntLen = mavlink_msg_get_send_buffer_length(&globalPositionIntMsg);
-        uint8_t attitudeBuffer[attitudeLen];
-        uint8_t globalPositionIntBuffer[globalPositionIntLen];
+    //the previous upload is still in progress, its records stay queued
+    if (session.isBusy()) {
+        return true;
+    }
+    retryPending = false;
+
+    //never spend a session on data that is too old to matter, it goes to the backlog instead
+    sendQueue.dropExpired(millis());
+
+    // Rank what is left, most important first. While the backlog is draining, only the newest routine records are
+    // taken from the send queue, so that most of the message carries the backlog. The latest codec only sends the
+    // top ranked record.
+    size_t maxSamples = codec == ConfigProtocol::CODEC_LATEST ? 1 : maxSamplesPerMessage;
+    uint8_t order[SendQueue::capacity];
+    size_t ranked = includeSamples ? sendQueue.rank(order, SendQueue::capacity) : 0;
+    bool draining = backlog.pendingCount() > 0;
+    size_t queued = 0;
+    size_t routine = 0;
+    for (size_t j = 0; j < ranked && queued < maxSamples; j++) {
+        if (sendQueue.at(order[j]).priority == SendQueue::ROUTINE) {
+            if (draining && routine == liveRecordsWhileDraining) {
+                continue;
+            }
+            routine++;
+        }
+        order[queued++] = order[j];
+    }
 
+    //then the backlog in its drain order, ranked below everything in the send queue
+    FlashBacklog::RecordRef backlogRefs[maxSamplesPerMessage];
+    size_t backlogCount = 0;
+    size_t candidates = includeSamples ? backlog.select(backlogRefs, maxSamples - queued) : 0;
+    for (size_t j = 0; j < candidates; j++) {
+        //a record this firmware cannot decode would never leave the backlog, so it is discarded
+        TelemetryCodec::TelemetrySample sample;
+        if (readBacklogSample(backlogRefs[j], sample)) {
+            backlogRefs[backlogCount++] = backlogRefs[j];
+        } else {
+            backlog.markSent(backlogRefs[j]);
+        }
+    }
 
-        // Insert each message into the buffer created above
-        mavlink_msg_to_send_buffer(attitudeBuffer, &attitudeMsg);
-        mavlink_msg_to_send_buffer(globalPositionIntBuffer, &globalPositionIntMsg);
+    //the status goes along whenever it has changed, and is what a session that only picks up a message carries
+    bool statusChanged = refreshStatus();
+    bool sendStatus = statusChanged || ringInterrupt || mtWaiting;
 
-        // Calculate the total length and create a combined buffer
-        uint16_t combinedLen = attitudeLen + globalPositionIntLen;
-        uint8_t combinedBuffer[combinedLen];
+    size_t selected = queued + backlogCount;
+    if (selected == 0 && pendingAckCount == 0 && !sendStatus) {
+        return false;
+    }
 
-        // Copy the contents of both buffers into the combined buffer
-        memcpy(combinedBuffer, attitudeBuffer, attitudeLen);
-        memcpy(combinedBuffer + attitudeLen, globalPositionIntBuffer, globalPositionIntLen);
+    rgbLED.setState(RGBLED::SENDING_TELEMETRY);
 
-        //put unix time into a buffer and add it to the combined buffer
-        uint8_t unixTimeBuffer[4];
-        memcpy(unixTimeBuffer, &currentMeasurementUnixTime, 4);
-        memcpy(combinedBuffer + combinedLen, unixTimeBuffer, 4);
-        combinedLen += 4;
+    // Pack the top ranked records, any queued acknowledgements, the status and the health counters into as few
+    // credits as possible. The packer leaves out the oldest samples that do not fit, which may be critical ones, so
+    // packSelection() shrinks the selection to what fits until every selected record is in the packet.
+    health.counters[TelemetryCodec::UPTIME_SECONDS] = millis() / 1000;
+    auto selectSamples = [&](size_t selection, TelemetryCodec::TelemetrySample *out) {
+        size_t sampleCount = 0;
 
-        // Reset the flags
-        attitudeInQueue = false;
-        globalPositionIntInQueue = false;
+        //the backlog records are older than anything in the send queue, put them first in the order they were written
+        size_t fromBacklog = selection > queued ? selection - queued : 0;
+        bool newestFirst = fromBacklog > 1 && backlogRefs[0].sequence > backlogRefs[1].sequence;
+        for (size_t j = 0; j < fromBacklog; j++) {
+            readBacklogSample(backlogRefs[newestFirst ? fromBacklog - 1 - j : j], out[sampleCount++]);
+        }
+        //the batch codec wants the samples oldest first, which is the order of the queue
+        size_t fromQueue = selection < queued ? selection : queued;
+        for (size_t i = 0; i < sendQueue.size(); i++) {
+            for (size_t j = 0; j < fromQueue; j++) {
+                if (order[j] == i) {
+                    out[sampleCount++] = sendQueue.at(i).sample;
+                }
+            }
+        }
+        return sampleCount;
+    };
+    uint8_t packet[maxMessageSize];
+    TelemetryCodec::TelemetrySample samples[maxSamplesPerMessage];
+    CreditPacker::Result packed;
+    size_t packetLen = CreditPacker::packSelection(selected, selectSamples, samples, telemetrySchema.schema(),
+                                                   pendingAcks, pendingAckCount, sendStatus ? &status : nullptr,
+                                                   &health, packet, sizeof(packet), packed);
+    if (packetLen == 0) {
+        return false;
+    }
 
-        // Push the combined buffer to the satellite
-        pushViaSatellite(combinedBuffer, combinedLen);
-        return true;
+    // Remember which records and acknowledgements are in flight. They are only dropped once they have been
+    // delivered.
+    for (size_t j = 0; j < selected && j < queued; j++) {
+        sendQueue.markInFlight(order[j]);
     }
-    return false;
+    sessionBacklogCount = 0;
+    for (size_t j = queued; j < selected; j++) {
+        sessionBacklog[sessionBacklogCount++] = backlogRefs[j - queued];
+    }
+    memcpy(sessionAcks, pendingAcks, sizeof(pendingAcks));
+    sessionAckCount = packed.acknowledgements;
+    sessionStatus = status;
+    sessionCarriesStatus = packed.status;
+
+    // Start pushing the packet to the satellite with a single attempt, poll() takes it from here. A failed attempt
+    // is retried with a freshly packed message.
+    if (pushViaSatellite(packet, packetLen) != 0) {
+        sendQueue.completeInFlight(false);
+        sessionBacklogCount = 0;
+    }
+    return true;
+}
 
+bool Iridium9602N::retryDue() {
+    return retryPending && (long) (millis() - retryAtMillis) >= 0;
 }
 
-int Iridium9602N::pushViaSatellite(uint8_t *buffer, uint16_t bufferLength) {
+bool Iridium9602N::backlogDrainDue() {
+    //only drain while uploads are getting through, a failed session is retried by retryDue() instead
+    return !retryPending && lastDeliveredMillis != 0 && backlog.pendingCount() > 0
+           && millis() - lastDeliveredMillis >= backlogDrainIntervalMillis;
+}
 
-//    rgbLED.setState(RGBLED::SENDING_TELEMETRY);
+bool Iridium9602N::exchangeDue(bool uploadsEnabled) {
 
-    // Check if the message is too long
-    if (bufferLength > maxMessageSize) {
-        Serial.println("Message too long!");
-        delay(100);
-        return -1;
+    //a failed session waits for its retry
+    if (!modemReady || session.isBusy() || (retryPending && !retryDue())) {
+        return false;
     }
+    if (ringInterrupt || mtWaiting || bootUpPending) {
+        return true;
+    }
+    return !uploadsEnabled && (pendingAckCount > 0 || refreshStatus());
+}
 
-    //Send the buffer. The sendSBDBinary will try to send the message ~10 times before giving up.
-    int err = modem.sendReceiveSBDBinary(buffer, bufferLength, bufferIn, bufferInSize);
+bool Iridium9602N::refreshStatus() {
+    status.fields[TelemetryCodec::STATUS_GPS_FIX] = gpsFix ? 1 : 0;
+    status.fields[TelemetryCodec::STATUS_BOOTUP] = bootUpPending ? 1 : 0;
+    return memcmp(&status, &deliveredStatus, sizeof(status)) != 0;
+}
 
+bool Iridium9602N::readBacklogSample(const FlashBacklog::RecordRef &ref, TelemetryCodec::TelemetrySample &sample) {
+    uint8_t encoded[FlashBacklog::maxRecordSize];
+    uint8_t tag;
+    size_t length = backlog.read(ref, encoded, sizeof(encoded), tag);
+    return length > 0 && TelemetryCodec::decodeRecord(encoded, length, sample);
+}
 
+void Iridium9602N::spoolToBacklog(const SendQueue::Record &record, void *context) {
 
+    Iridium9602N *iridium = (Iridium9602N *) context;
 
-    if (err != ISBD_SUCCESS) {
-        Serial.print("Send failed: error ");
-        Serial.println(err);
-        bufferInSize = 200;
-        return err;
+    //store the record with every field, whatever schema it is sent with, tagged with its priority
+    uint8_t encoded[FlashBacklog::maxRecordSize];
+    size_t length = TelemetryCodec::encodeRecord(record.sample, encoded, sizeof(encoded));
+    if (length == 0 || !iridium->backlog.append(encoded, length, record.priority)) {
+        LOG_WARN(LOG_SATELLITE, "Backlog full, record dropped.");
     }
+}
 
+void Iridium9602N::queueAcknowledgement(TelemetryCodec::AcknowledgementKind kind, uint32_t value) {
 
-    //print the rx message
-    Serial.print("RX: ");
-    String message = String((char *) bufferIn);
-    Serial.println(message);
-    Serial.println("RX size: " + String(bufferInSize));
+    //replace an older acknowledgement of the same kind, the server only needs the latest one
+    for (uint8_t i = 0; i < pendingAckCount; i++) {
+        if (pendingAcks[i].kind == kind) {
+            pendingAcks[i].value = value;
+            return;
+        }
+    }
 
-    if(bufferInSize != 0 && bufferInSize != 200)    {
-        inBufferFilled = true;
+    //otherwise append it if there is room
+    if (pendingAckCount < maxPendingAcks) {
+        pendingAcks[pendingAckCount++] = {kind, value};
     }
-    bufferInSize = 200;
-    return 0;
 }
 
-void Iridium9602N::setup() {
-
+void Iridium9602N::recordSession(bool delivered, size_t bytes) {
 
-    Serial.println("Starting modem...");
-    int err = modem.begin();
-    if (err != ISBD_SUCCESS) {
-        Serial.print("Begin failed: error ");
-        Serial.println(err);
-        if (err == ISBD_NO_MODEM_DETECTED)
-            Serial.println("No modem detected: check wiring.");
+    //count the session and, if it was delivered, what it cost
+    health.counters[TelemetryCodec::SBD_SESSIONS]++;
+    if (!delivered) {
+        health.counters[TelemetryCodec::SBD_FAILED_SESSIONS]++;
         return;
-
     }
+    lastSessionBytes = bytes;
+    lastSessionCredits = CreditPacker::creditsFor(bytes);
+    health.counters[TelemetryCodec::SBD_BYTES_SENT] += bytes;
+    health.counters[TelemetryCodec::SBD_CREDITS_USED] += lastSessionCredits;
 
-    int signalQuality = -1;
-    err = modem.getSignalQuality(signalQuality);
-    if (err != ISBD_SUCCESS) {
-        Serial.print("SignalQuality failed: error ");
-        Serial.println(err);
-        return;
-    }
-
-
+    LOG_INFO(LOG_SATELLITE, "Session used %lu bytes, %u credits", (unsigned long) lastSessionBytes,
+             (unsigned) lastSessionCredits);
 }
 
+TelemetryCodec::TelemetrySample Iridium9602N::buildTelemetrySample() {
 
-bool
-Iridium9602N::receiveConfigurationMode(ConfigResponsePacket &response, bool &uploadData, long &uploadIntervalMillis) {
+    //the latest fields of every message, timestamped now
+    TelemetryCodec::TelemetrySample sample = latestFields;
+    sample.fields[TelemetryCodec::UNIX_TIME_MILLIS] = (int64_t) timeBase.unixMillis(millis());
+    return sample;
+}
 
-    int err;
+int Iridium9602N::pushViaSatellite(uint8_t *buffer, uint16_t bufferLength) {
 
-    //check if the modem has a message waiting
-    bool ring = modem.hasRingAsserted();
+    // Check if the message is too long
+    if (bufferLength > maxMessageSize) {
+        LOG_ERROR(LOG_SATELLITE, "Message too long!");
+        return -1;
+    }
 
+    // Only one session can use the modem at a time
+    if (!session.begin(IridiumSession::SEND_RECEIVE, buffer, bufferLength, 1)) {
+        LOG_WARN(LOG_SATELLITE, "Modem busy, not sending.");
+        return ISBD_REENTRANT;
+    }
 
-    //if there is a message waiting, read it
-    if (ring || modem.getWaitingMessageCount() > 0 || err != ISBD_SUCCESS || inBufferFilled || ringInterrupt) {
+    sessionBytes = bufferLength;
+    sessionPending = true;
+    return 0;
+}
 
-        Serial.println("inBufferFilled" + String(inBufferFilled));
-        Serial.println("ringInterrupt" + String(ringInterrupt));
-        Serial.println("ring" + String(ring));
-        Serial.println("modem.getWaitingMessageCount()" + String(modem.getWaitingMessageCount()));
+bool Iridium9602N::requestSystemTime() {
 
+    // Only one session can use the modem at a time
+    if (!session.begin(IridiumSession::SYSTEM_TIME)) {
+        return false;
+    }
+    sessionPending = true;
+    return true;
+}
 
-        rgbLED.setState(RGBLED::SEND_RECEIVE_CONFIG);
+void Iridium9602N::poll() {
 
-        //create a buffer to store the incoming message.
-        uint8_t buffer[200];
-        size_t bufferSize = 200;
+    //advance the session by one step
+    session.poll();
 
-        //read the message into the buffer and send a response.
-        err = modem.sendReceiveSBDText(response.createResponse(gpsFix).c_str(), buffer, bufferSize);
+    //handle the result once, when the session completes
+    if (sessionPending && !session.isBusy()) {
+        sessionPending = false;
+        const IridiumSession::Result &result = session.result();
 
-        if (err != ISBD_SUCCESS) {
-            Serial.print("sendReceiveSBDBinary failed: error ");
-            Serial.println(err);
-            return false;
+        if (result.operation == IridiumSession::SYSTEM_TIME) {
+            //the modem answers without network service until it has seen a satellite, just try again later
+            if (result.error == IridiumSession::SESSION_OK) {
+                timeBase.syncFromIridium(result.systemTime, millis());
+            }
+        } else {
+            handleSessionResult(result);
         }
+    }
+}
 
-        if(inBufferFilled)    {
-            //cast the buffer to a string
-            String message = String((char *) bufferIn);
-            Serial.println(message);
+void Iridium9602N::handleSessionResult(const IridiumSession::Result &result) {
 
+    //the records went out once the gateway accepted them, even if the message from the server could not be read
+    bool delivered = result.moDelivered;
+    recordSession(delivered, sessionBytes);
+    sendQueue.completeInFlight(delivered);
 
-            if (message.startsWith("1") || message.startsWith("0")) {
-                //parse the message
-                if (message.startsWith("1")) {
-                    uploadData = true;
-                } else if (message.startsWith("0")) {
-                    uploadData = false;
-                }
-                int indexOfUploadInterval = message.indexOf(",");
-                message = message.substring(indexOfUploadInterval + 1);
-                //set the upload interval using the received message data
-                unsigned long intervalPreCheck = message.substring(0, message.indexOf(",")).toInt() * 1000ul;
-
-                //make sure the requested interval is more than 15 seconds
-                if(intervalPreCheck > 15000)    {
-                    uploadIntervalMillis = intervalPreCheck;
-                }
-                else {
-                    uploadIntervalMillis = 60000;
-                }
-                Serial.println("Upload data: " + String(uploadData));
-                Serial.println("Upload interval: " + String(uploadIntervalMillis));
-            } else{
+    //delivered backlog records are never drained again, those of a failed session stay pending
+    for (uint8_t i = 0; delivered && i < sessionBacklogCount; i++) {
+        backlog.markSent(sessionBacklog[i]);
+    }
+    sessionBacklogCount = 0;
 
-                Serial.println("Invalid message received");
-            }
+    if (!delivered) {
+        LOG_WARN(LOG_SATELLITE, "Send failed: error %d", (int) result.error);
+        rgbLED.showFor(RGBLED::IN_FLIGHT_SBD_FAILED, sessionOutcomeMillis);
 
-            //reset buffers and flags
-            bufferInSize = 200;
-            inBufferFilled = false;
+        //retry soon, packed again from the send queue so that newer data supersedes the failed snapshot
+        retryPending = true;
+        retryAtMillis = millis() + sendRetryMillis;
+        return;
+    }
+    rgbLED.showFor(RGBLED::IN_FLIGHT_SBD_SUCCESS, sessionOutcomeMillis);
+    lastDeliveredMillis = millis();
+
+    //the session picked up any message the server had waiting, the gateway tells if there are more
+    ringInterrupt = false;
+    mtWaiting = result.mtQueued > 0;
+
+    //the delivered status only goes again once it changes, the bootup notice never
+    if (sessionCarriesStatus) {
+        deliveredStatus = sessionStatus;
+        if (sessionStatus.fields[TelemetryCodec::STATUS_BOOTUP] != 0) {
+            bootUpPending = false;
+            LOG_INFO(LOG_SATELLITE, "Bootup notice delivered");
         }
-        else {
-            //cast the buffer to a string
-            String message = String((char *) buffer);
-            Serial.println(message);
-
-
-            if (message.startsWith("1") || message.startsWith("0")) {
-                //parse the message
-                if (message.startsWith("1")) {
-                    uploadData = true;
-                } else if (message.startsWith("0")) {
-                    uploadData = false;
-                }
-                int indexOfUploadInterval = message.indexOf(",");
-                message = message.substring(indexOfUploadInterval + 1);
-                //set the upload interval using the received message data
-                uploadIntervalMillis = message.substring(0, message.indexOf(",")).toInt() * 1000ul;
-                Serial.println("Upload data: " + String(uploadData));
-                Serial.println("Upload interval: " + String(uploadIntervalMillis));
-            } else{
-                Serial.println("Invalid message received");
+    }
+    sessionCarriesStatus = false;
+
+    //drop the delivered acknowledgements, unless they were replaced by a newer value while the session ran
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < pendingAckCount; i++) {
+        bool sent = false;
+        for (uint8_t j = 0; j < sessionAckCount; j++) {
+            if (pendingAcks[i].kind == sessionAcks[j].kind && pendingAcks[i].value == sessionAcks[j].value) {
+                sent = true;
             }
         }
+        if (!sent) {
+            pendingAcks[kept++] = pendingAcks[i];
+        }
+    }
+    pendingAckCount = kept;
+    sessionAckCount = 0;
+
+    //a message received during the session is left in bufferIn for takeReceivedCommand, only if it was read whole
+    if (result.error != IridiumSession::SESSION_OK) {
+        LOG_WARN(LOG_SATELLITE, "Message from the server lost: error %d", (int) result.error);
+    } else if (result.receivedLength > 0) {
+        bufferInSize = result.receivedLength;
+        inBufferFilled = true;
 
-        /*
-         * DO NOT REMOVE
-         * IF YOU DON'T RUN modem.hasRingAsserted()
-         * AFTER DOWNLOADING THE MESSAGE,
-         * THE RING PIN WILL REMAIN LOW (ACTIVE)
-         * AND READ IN AN EMPTY MESSAGE BOTH COSTING
-         * MONEY AND BREAKING THE CODE WHEN PARSED.
-         *
-         */
-        modem.hasRingAsserted();
-
-
-        //reset buffers and flags
-        ringInterrupt = false;
-        configReceived = true;
-        return true;
+        LOG_DEBUG(LOG_SATELLITE, "RX size: %lu", (unsigned long) bufferInSize);
     }
+}
+
+void Iridium9602N::setup() {
 
-    //if there is no message waiting, return false
-    return false;
+    //recover the records that were not delivered before the last reboot
+    size_t recovered = backlog.begin();
+    LOG_INFO(LOG_SATELLITE, "Backlog: %lu records pending", (unsigned long) recovered);
 }
 
-bool Iridium9602N::sendBootUpMessage() {
-    rgbLED.setState(RGBLED::SENDING_BOOTUP_MESSAGE);
+bool Iridium9602N::beginModem() {
 
+    LOG_INFO(LOG_SATELLITE, "Starting modem...");
     int err;
-    //send a bootup message to the server
-    err = modem.sendReceiveSBDText("bootup,", bufferIn, bufferInSize);
-
+    {
+        LatencyProfiler::Scope timed(latencyProfiler, LatencyProfiler::MODEM_BEGIN);
+        err = modem.begin();
+    }
     if (err != ISBD_SUCCESS) {
-        Serial.print("Send failed: error ");
-        Serial.println(err);
-        bufferInSize = 200;
+        LOG_ERROR(LOG_SATELLITE, "Begin failed: error %d", err);
+        if (err == ISBD_NO_MODEM_DETECTED)
+            LOG_ERROR(LOG_SATELLITE, "No modem detected: check wiring.");
         return false;
+
     }
 
-    if(bufferInSize != 0)    {
-        inBufferFilled = true;
+    int signalQuality = -1;
+    {
+        LatencyProfiler::Scope timed(latencyProfiler, LatencyProfiler::SIGNAL_QUALITY);
+        err = modem.getSignalQuality(signalQuality);
+    }
+    if (err != ISBD_SUCCESS) {
+        LOG_WARN(LOG_SATELLITE, "SignalQuality failed: error %d", err);
+        return false;
     }
 
-    Serial.print("Sent bootup message");
+    modemReady = true;
     return true;
 }
 
 
+bool Iridium9602N::takeReceivedCommand(ConfigProtocol::Command &command, ConfigProtocol::Result &result) {
 
+    //only a session fills bufferIn, and only while no session is running is it safe to read
+    if (!inBufferFilled || session.isBusy()) {
+        return false;
+    }
+    inBufferFilled = false;
+
+    //parse the command in place
+    result = ConfigProtocol::parse(bufferIn, bufferInSize, command);
+    bufferInSize = sizeof(bufferIn);
+    if (result != ConfigProtocol::RESULT_OK) {
+        LOG_WARN(LOG_CONFIG, "Invalid command received: result %d", (int) result);
+    }
+    return true;
+}
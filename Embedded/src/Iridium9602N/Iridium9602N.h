@@ -4,8 +4,9 @@
 * @Date: 2023-04-23
 * @Description: This file provides the Iridium9602N class for handling communication with the Iridium 9602N satellite
  * module. The class is responsible for sending and receiving satellite messages to and from the module, setting up the
- * module, managing a queue for Mavlink messages, and handling configuration settings received from the server. It
- * also includes methods to send boot-up messages, push data via satellite, and manage telemetry uploads. The class
+ * module, managing a queue for Mavlink messages, and handling configuration settings received from the server. The
+ * bootup notice, the device status and configuration acknowledgements ride along with telemetry uploads, and a
+ * configuration sent by the server is read from the same session, so every exchange costs a single session. The class
  * maintains the current state of the queue and other communication flags for efficient handling of messages.
 */
 
@@ -16,7 +17,13 @@
 #include <Uart.h>
 #include "MavlinkInterpreter/MavlinkInterpreter.h"
 #include "IridiumSBD.h"
-#include "ConfigResponsePacket/ConfigResponsePacket.h"
+#include "TelemetryCodec/TelemetryCodec.h"
+#include "ConfigProtocol/ConfigProtocol.h"
+#include "IridiumSession.h"
+#include "UartModemPort.h"
+#include "SendQueue.h"
+#include "FlashStore/FlashBacklog.h"
+#include "TelemetrySchema/TelemetrySchema.h"
 
 
 
@@ -32,83 +39,276 @@ public:
      * @param uart The UART object to be used for the Iridium9602N module.
      * @param sleepPin The pin to be used for the sleep mode.
      * @param ringPin The pin to be used for the ring indicator.
+     * @param backlogFlash The flash region that holds the telemetry backlog across reboots.
      */
-    Iridium9602N(Uart &uart, int sleepPin, int ringPin) : modem(uart, sleepPin, ringPin) {}
+    Iridium9602N(Uart &uart, int sleepPin, int ringPin, FlashDevice &backlogFlash)
+            : modem(uart, sleepPin, ringPin), modemPort(uart), session(modemPort, bufferIn, sizeof(bufferIn)),
+              sendQueue(historySpacingMillis), backlog(backlogFlash, backlogDrainOrder, backlogOverflowPolicy) {
+        sendQueue.setEvictionHandler(&Iridium9602N::spoolToBacklog, this);
+    }
 
 public:
 
     /**
-     * Sets up the Iridium9602N module.
+     * Recovers the telemetry backlog from flash. Does not talk to the modem, see beginModem().
      */
     void setup();
 
     /**
-     * Inserts a mavlink message (Position or Attitude) into the satellite queue.
-     * @param msg The mavlink message to be inserted into the satellite queue.
+     * Sets up the Iridium 9602N modem. This blocks while the modem starts up, with the ISBD callbacks running.
+     * @return true if the modem answered and is ready for sessions, false if it should be tried again later.
      */
-    void insertIntoSatQueue(mavlink_message_t msg);
+    bool beginModem();
 
     /**
-     * Verifies if there are both attitude and position messages in the satellite queue and if so,
-     * pushes them out to the server.
-     * @return true if the messages were sent, false otherwise.
+     * Inserts the new messages of the telemetry store into the satellite queue. The fields the telemetry schema samples
+     * from every message that arrived since the last call are kept, and a new copy of the schema's trigger message
+     * (usually the position) then turns the latest fields into a routine record of the send queue. Messages the schema
+     * does not sample are ignored.
+     * @param store The latest decoded MAVLink messages, read in place.
+     * @return true if a record was queued.
      */
-    bool verifyAndPushOutSatQueue();
+    bool insertIntoSatQueue(const TelemetryStore &store);
 
     /**
-     * Pushes a buffer of data to the server via satellite and is sent as a binary packet.
+     * Turns the latest fields into a record of the send queue.
+     * @param priority The priority of the record. Critical records outrank routine ones and live longer.
+     * @return true if the record was queued, false if not every message of the schema has arrived yet or the queue is
+     * full.
+     */
+    bool queueTelemetry(SendQueue::Priority priority);
+
+    /**
+     * Replaces the telemetry schema. Records already queued are sent with the new schema, and a message the new schema
+     * samples has to arrive before the next record is queued unless the old schema sampled it too.
+     * @param schema The new telemetry schema.
+     */
+    void setSchema(const TelemetrySchema &schema);
+
+    /**
+     * Whether some, but not all, messages of the telemetry schema have arrived, e.g. the attitude without a position
+     * while the Pixhawk has no GPS fix.
+     * @return true if a sample is incomplete.
+     */
+    bool hasPartialSample();
+
+    /**
+     * Drops expired records and starts pushing the most important remaining records out to the server as one
+     * compact, delta encoded message: critical records first, then the newest routine records, as many as the
+     * message holds. While the flash backlog has pending records, only the newest few routine records are sent and
+     * the rest of the message is filled from the backlog. Queued acknowledgements go with every message, and so does
+     * the device status whenever it has changed or a message from the server is waiting to be picked up.
+     * @param includeSamples Whether to send telemetry, false to only exchange acknowledgements, the status and
+     * messages from the server.
+     * @return true if a message is being sent, false if there was nothing to send.
+     */
+    bool verifyAndPushOutSatQueue(bool includeSamples = true);
+
+    /**
+     * Whether the records of a failed session should be retried now rather than at the next upload interval.
+     * @return true if a retry is due.
+     */
+    bool retryDue();
+
+    /**
+     * Whether the link is up and the flash backlog should be drained by an extra upload now rather than at the next
+     * upload interval.
+     * @return true if a drain upload is due.
+     */
+    bool backlogDrainDue();
+
+    /**
+     * Whether a session should be started now, ahead of the next upload interval, to pick up a message from the
+     * server, deliver the bootup notice or, while telemetry uploads are disabled, deliver acknowledgements and
+     * status changes.
+     * @param uploadsEnabled Whether telemetry uploads are enabled, so that they carry acknowledgements and status
+     * changes anyway.
+     * @return true if an exchange is due.
+     */
+    bool exchangeDue(bool uploadsEnabled);
+
+    /**
+     * Queues an acknowledgement that is carried to the server by the next telemetry upload. An older queued
+     * acknowledgement of the same kind is replaced.
+     * @param kind The kind of acknowledgement.
+     * @param value The value being acknowledged.
+     */
+    void queueAcknowledgement(TelemetryCodec::AcknowledgementKind kind, uint32_t value);
+
+    /**
+     * Takes the latest fields of the messages of the telemetry schema as a telemetry sample for the compact codec.
+     * @return The telemetry sample, timestamped with the current time of the global time base.
+     */
+    TelemetryCodec::TelemetrySample buildTelemetrySample();
+
+    /**
+     * Starts pushing a buffer of data to the server via satellite as a binary packet. The buffer is copied, and the
+     * SBD session then runs in the background while poll() is called from loop().
      * @param buffer The buffer to be sent.
      * @param bufferLength The length of the buffer.
-     * @return The number of bytes sent, -1 if the message is too long.
+     * @return 0 if the session was started, -1 if the message is too long, ISBD_REENTRANT if a session is already
+     * running.
      */
     int pushViaSatellite(uint8_t *buffer, uint16_t bufferLength);
 
     /**
-     * Receives a settings configuration mode packet from the server. This packet is then parsed and the response is
-     * sent back to the server.
-     * @param response The response packet to be sent back to the server. This can contain any data that may be
-     * needed before flight.
-     * @param uploadData  A flag to indicate if the device should telemetry upload data or not.
-     * @param uploadIntervalMillis  The interval in milliseconds between telemetry uploads.
-     * @return true if the packet was received/sent successfully, false otherwise.
+     * Starts reading the Iridium system time (AT-MSSTM) in the background. Once it completes, poll() uses it to
+     * synchronise the global time base.
+     * @return true if the request was started, false if the modem is busy.
+     */
+    bool requestSystemTime();
+
+    /**
+     * Advances the background SBD session by one step and handles its result once it completes. Call once per
+     * loop().
      */
-    bool receiveConfigurationMode(ConfigResponsePacket &response, bool &uploadData, long &uploadIntervalMillis);
+    void poll();
 
     /**
-     * Sends a boot up message to the server to indicate that the device has started.
-     * @return true if the message was sent successfully, false otherwise.
+     * Takes the configuration command that the server sent with the last session, if any. The command is parsed in
+     * place from bufferIn and no session is started. Applying it and acknowledging it is up to the caller.
+     * @param command Set to the parsed command.
+     * @param result Set to the outcome of parsing, RESULT_OK if the command can be applied.
+     * @return true if a message was waiting, false otherwise.
      */
-    bool sendBootUpMessage();
+    bool takeReceivedCommand(ConfigProtocol::Command &command, ConfigProtocol::Result &result);
 
 
 public:
-    //IridiumSBD modem Object
+    //IridiumSBD modem Object, only used to set the modem up
     IridiumSBD modem;
 
-    //Mavlink messages to be sent via satellite
-    mavlink_message_t globalPositionIntMsg{};
-    mavlink_message_t attitudeMsg{};
+    //The non-blocking driver used for telemetry uploads. While it is busy it owns the modem UART, so the blocking
+    //IridiumSBD calls must not be made.
+    UartModemPort modemPort;
+    IridiumSession session;
+
+    //Which fields are sampled and sent, and the MAVLink messages they come from, set by a configuration command.
+    TelemetrySchema telemetrySchema;
+
+    //The latest fields of the messages of the telemetry schema.
+    TelemetryCodec::TelemetrySample latestFields{};
+
+    //A bit per message of the telemetry schema, set once the message has arrived.
+    uint8_t arrivedMessages = 0;
+
+    //The telemetry store sequence number of the latest copy taken of each message of the telemetry schema.
+    uint32_t seenSequences[TelemetrySchema::maxMessages]{};
+
+    //The largest mobile terminated SBD message the gateway delivers.
+    static const size_t maxMtMessageSize = 270;
 
     /**
-     * A buffer to store Mavlink messages which are received while
-     * the modem is attempting to send a telemetry update to the server.
+     * A buffer to store the message from the server which is received while the modem is sending a telemetry update.
+     * AT+SBDRB frames it with 2 length and 2 checksum bytes, which the session checks and does not store.
      */
-    uint8_t bufferIn[200]{};
-    size_t bufferInSize = 200;
+    uint8_t bufferIn[maxMtMessageSize]{};
+    size_t bufferInSize = maxMtMessageSize;
 
     //A boolean to indicate if the buffer was filled during the last outgoing telemetry transmission.
     bool inBufferFilled = false;
 
-    //Flags to indicate if a message is in the queue
-    bool globalPositionIntInQueue = false;
-    bool attitudeInQueue = false;
+    //A boolean to indicate if the gateway reported more messages from the server waiting after the last session.
+    bool mtWaiting = false;
 
     /**
-     * maximum buffer size for outgoing messages. This is essentially a safety check to ensure that
-     * the message is not too large/too expensive. The absolute maximum size is 340 bytes, but this
-     * variable is set to 100 bytes to just be enough to send the 80 byte telemetry update.
+     * maximum buffer size for outgoing messages. This is the absolute maximum size of a mobile originated SBD
+     * message, which is needed to carry a full batch of delta encoded samples.
      */
-    const int maxMessageSize = 100;
+    static const int maxMessageSize = 340;
+
+    //The spacing of the routine position history held in the send queue, e.g. 2 minutes of 10 second samples.
+    static const unsigned long historySpacingMillis = 10 * 1000ul;
+
+    //How long a routine position is worth sending.
+    static const unsigned long routineLifetimeMillis = 10 * 60 * 1000ul;
+
+    //How long a critical record is worth sending.
+    static const unsigned long criticalLifetimeMillis = 60 * 60 * 1000ul;
+
+    //How long to wait before retrying the records of a failed session. Each retry is packed again from the send
+    // queue, so it carries the freshest data rather than the snapshot of the failed attempt.
+    static const unsigned long sendRetryMillis = 20 * 1000ul;
+
+    //How long the LED shows whether a session delivered its message, before it goes back to the operational state.
+    static const unsigned long sessionOutcomeMillis = 5 * 1000ul;
+
+    //The telemetry records waiting to be sent.
+    SendQueue sendQueue;
+
+    //The order the flash backlog is drained in. Newest first fills the most recent part of a gap first.
+    static const FlashBacklog::DrainOrder backlogDrainOrder = FlashBacklog::NEWEST_FIRST;
+
+    //What happens when the flash backlog is full. Overwriting keeps the most recent history of a long outage.
+    static const FlashBacklog::OverflowPolicy backlogOverflowPolicy = FlashBacklog::OVERWRITE_OLDEST;
+
+    //The records the send queue had to give up before they were delivered, kept in flash across reboots.
+    FlashBacklog backlog;
+
+    //The most samples in one message. Bounds the stack used to pack a message.
+    static const uint8_t maxSamplesPerMessage = 16;
+
+    //The number of routine records from the send queue in a message while the backlog is draining, so most of the
+    // message is left for the backlog. Older routine records are evicted into the backlog in turn.
+    static const uint8_t liveRecordsWhileDraining = 2;
+
+    //The time between two uploads while the backlog is draining and the link is up.
+    static const unsigned long backlogDrainIntervalMillis = 30 * 1000ul;
+
+    //The backlog records carried by the session in progress, marked as sent once it is delivered.
+    FlashBacklog::RecordRef sessionBacklog[maxSamplesPerMessage]{};
+    uint8_t sessionBacklogCount = 0;
+
+    //The value of millis() when the last telemetry session was delivered, 0 if none has been.
+    unsigned long lastDeliveredMillis = 0;
+
+    //A boolean to indicate if the last session failed and its records should be retried at retryAtMillis.
+    bool retryPending = false;
+    unsigned long retryAtMillis = 0;
+
+    //The maximum number of acknowledgements waiting for the next upload.
+    static const uint8_t maxPendingAcks = 4;
+
+    //The acknowledgements waiting for the next upload.
+    TelemetryCodec::Acknowledgement pendingAcks[maxPendingAcks]{};
+
+    //The number of acknowledgements in pendingAcks.
+    uint8_t pendingAckCount = 0;
+
+    //The acknowledgements carried by the session in progress, dropped from pendingAcks once it is delivered.
+    TelemetryCodec::Acknowledgement sessionAcks[maxPendingAcks]{};
+    uint8_t sessionAckCount = 0;
+
+    //A boolean to indicate if a session was started and its result has not been handled yet.
+    bool sessionPending = false;
+
+    //The number of mobile originated bytes in the session in progress.
+    size_t sessionBytes = 0;
+
+    //Device health counters, carried in the spare room of telemetry uploads.
+    TelemetryCodec::HealthCounters health{};
+
+    //The number of bytes and credits used by the last delivered SBD session.
+    size_t lastSessionBytes = 0;
+    uint16_t lastSessionCredits = 0;
+
+    //A boolean to indicate if the modem has been set up by beginModem().
+    bool modemReady = false;
+
+    //A boolean to indicate if the bootup notice of a cold boot has yet to be delivered in the device status.
+    bool bootUpPending = false;
+
+    //The device status, sent whenever it differs from the last delivered one. The bootup and GPS fix fields are kept
+    // up to date from bootUpPending and gpsFix.
+    TelemetryCodec::DeviceStatus status{};
+    TelemetryCodec::DeviceStatus deliveredStatus{};
+
+    //The status carried by the session in progress, and whether it carries one at all.
+    TelemetryCodec::DeviceStatus sessionStatus{};
+    bool sessionCarriesStatus = false;
+
+    //How the samples of an upload are encoded, set by a configuration command.
+    ConfigProtocol::Codec codec = ConfigProtocol::CODEC_BATCH;
 
     //A boolean to indicate if the configuration mode packet has been received.
     bool configReceived = false;
@@ -116,12 +316,45 @@ public:
     //A boolean which indicates whether a ring interrupt has occurred.
     volatile bool ringInterrupt = false;
 
-    //A time_t variable to store the time of the last telemetry measurement.
-    time_t currentMeasurementUnixTime = 0;
-
     //A boolean to indicate if the device has a GPS fix.
     bool gpsFix = false;
 
+private:
+    /**
+     * Records the outcome of an SBD session in the health counters and reports the bytes and credits it used.
+     * @param delivered Whether the session succeeded.
+     * @param bytes The number of mobile originated bytes in the session.
+     */
+    void recordSession(bool delivered, size_t bytes);
+
+    /**
+     * Handles the result of a completed telemetry session: records it, drops the delivered acknowledgements and
+     * status and leaves any received message in bufferIn for applyReceivedConfiguration.
+     * @param result The result of the session.
+     */
+    void handleSessionResult(const IridiumSession::Result &result);
+
+    /**
+     * Brings the bootup and GPS fix fields of the status up to date.
+     * @return true if the status differs from the last delivered one.
+     */
+    bool refreshStatus();
+
+    /**
+     * Reads and decodes a record of the flash backlog.
+     * @param ref The record.
+     * @param sample Set to the decoded sample.
+     * @return true if the record is still pending and could be decoded.
+     */
+    bool readBacklogSample(const FlashBacklog::RecordRef &ref, TelemetryCodec::TelemetrySample &sample);
+
+    /**
+     * The eviction handler of the send queue: appends the encoded record to the flash backlog.
+     * @param record The record given up by the send queue.
+     * @param context The Iridium9602N object.
+     */
+    static void spoolToBacklog(const SendQueue::Record &record, void *context);
+
 };
 
 #endif //AERORADAREMBEDDED_IRIDIUM9602N_H
@@ -5,17 +5,32 @@
 #include "Iridium9602NMock.h"
 #include "DiagnosticTools/GlobalDiagnosticLED.h"
 
-void Iridium9602NMock::insertIntoSatQueue(mavlink_message_t msg) {
+bool Iridium9602NMock::insertIntoSatQueue(const TelemetryStore &store) {
 
+    return false;
+}
+
+bool Iridium9602NMock::queueTelemetry(SendQueue::Priority priority) {
+
+    return false;
+}
+
+void Iridium9602NMock::setSchema(const TelemetrySchema &schema) {
 
+    telemetrySchema = schema;
+}
+
+bool Iridium9602NMock::hasPartialSample() {
 
+    return false;
 }
 
-bool Iridium9602NMock::verifyAndPushOutSatQueue() {
+bool Iridium9602NMock::verifyAndPushOutSatQueue(bool includeSamples) {
 
     rgbLED.setState(RGBLED::SENDING_TELEMETRY);
 
     rgbLED.asyncLEDDelay(1*5*1000);
+    bootUpPending = false;
     return true;
 }
 
@@ -25,18 +40,38 @@ int Iridium9602NMock::pushViaSatellite(uint8_t *buffer, uint16_t bufferLength) {
     return 0;
 }
 
+void Iridium9602NMock::poll() {
+
+}
+
+bool Iridium9602NMock::retryDue() {
+
+    return false;
+}
+
+bool Iridium9602NMock::backlogDrainDue() {
+
+    return false;
+}
+
 void Iridium9602NMock::setup() {
 
 
 
 
 
+}
+
+bool Iridium9602NMock::beginModem() {
+
+    modemReady = true;
+    return true;
 }
 
 
 
 bool firstConfigCall = true;
-bool Iridium9602NMock::receiveConfigurationMode(ConfigResponsePacket &response, bool &uploadData, long &uploadIntervalMillis) {
+bool Iridium9602NMock::takeReceivedCommand(ConfigProtocol::Command &command, ConfigProtocol::Result &result) {
 
 
     //get a random number form 1 to 10
@@ -48,6 +83,11 @@ bool Iridium9602NMock::receiveConfigurationMode(ConfigResponsePacket &response,
         rgbLED.asyncLEDDelay(5*1*1000);
 
         firstConfigCall = false;
+        command = ConfigProtocol::Command();
+        command.hasUpload = true;
+        command.uploadData = true;
+        command.uploadIntervalMillis = 60 * 1000ul;
+        result = ConfigProtocol::RESULT_OK;
         return true;
     }
     //if there is no message waiting, return false
@@ -55,11 +95,9 @@ bool Iridium9602NMock::receiveConfigurationMode(ConfigResponsePacket &response,
 
 }
 
-bool Iridium9602NMock::sendBootUpMessage() {
+bool Iridium9602NMock::exchangeDue(bool uploadsEnabled) {
 
-    rgbLED.setState(RGBLED::SENDING_BOOTUP_MESSAGE);
-    rgbLED.asyncLEDDelay(1*5*1000);
-    return true;
+    return false;
 }
 
 
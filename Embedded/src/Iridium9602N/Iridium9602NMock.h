@@ -7,7 +7,10 @@
 #include <Uart.h>
 #include "MavlinkInterpreter/MavlinkInterpreter.h"
 #include "IridiumSBD.h"
-#include "ConfigResponsePacket/ConfigResponsePacket.h"
+#include "SendQueue.h"
+#include "FlashStore/FlashDevice.h"
+#include "ConfigProtocol/ConfigProtocol.h"
+#include "TelemetrySchema/TelemetrySchema.h"
 
 
 
@@ -19,8 +22,9 @@ public:
      * @param uart The UART object to be used for the Iridium9602N module.
      * @param sleepPin The pin to be used for the sleep mode.
      * @param ringPin The pin to be used for the ring indicator.
+     * @param backlogFlash The flash region that holds the telemetry backlog.
      */
-    Iridium9602NMock(Uart &uart, int sleepPin, int ringPin){
+    Iridium9602NMock(Uart &uart, int sleepPin, int ringPin, FlashDevice &backlogFlash){
 
     };
 
@@ -32,17 +36,44 @@ public:
     void setup();
 
     /**
-     * Inserts a mavlink message (Position or Attitude) into the satellite queue.
-     * @param msg The mavlink message to be inserted into the satellite queue.
+     * Sets up the Iridium 9602N modem.
+     * @return true if the modem is ready for sessions.
      */
-    void insertIntoSatQueue(mavlink_message_t msg);
+    bool beginModem();
+
+    /**
+     * Inserts the new messages of the telemetry store into the satellite queue.
+     * @param store The latest decoded MAVLink messages.
+     * @return true if a record was queued.
+     */
+    bool insertIntoSatQueue(const TelemetryStore &store);
+
+    /**
+     * Turns the latest fields into a record of the send queue.
+     * @param priority The priority of the record.
+     * @return true if the record was queued, false otherwise.
+     */
+    bool queueTelemetry(SendQueue::Priority priority);
+
+    /**
+     * Replaces the telemetry schema.
+     * @param schema The new telemetry schema.
+     */
+    void setSchema(const TelemetrySchema &schema);
+
+    /**
+     * Whether some, but not all, messages of the telemetry schema have arrived.
+     * @return true if a sample is incomplete.
+     */
+    bool hasPartialSample();
 
     /**
      * Verifies if there are both attitude and position messages in the satellite queue and if so,
      * pushes them out to the server.
+     * @param includeSamples Whether to send telemetry, false to only exchange the status and acknowledgements.
      * @return true if the messages were sent, false otherwise.
      */
-    bool verifyAndPushOutSatQueue();
+    bool verifyAndPushOutSatQueue(bool includeSamples = true);
 
     /**
      * Pushes a buffer of data to the server via satellite and is sent as a binary packet.
@@ -53,41 +84,58 @@ public:
     int pushViaSatellite(uint8_t *buffer, uint16_t bufferLength);
 
     /**
-     * Receives a settings configuration mode packet from the server. This packet is then parsed and the response is
-     * sent back to the server.
-     * @param response The response packet to be sent back to the server. This can contain any data that may be
-     * needed before flight.
-     * @param uploadData  A flag to indicate if the device should telemetry upload data or not.
-     * @param uploadIntervalMillis  The interval in milliseconds between telemetry uploads.
-     * @return true if the packet was received/sent successfully, false otherwise.
+     * Advances the background SBD session by one step.
      */
-    bool receiveConfigurationMode(ConfigResponsePacket &response, bool &uploadData, long &uploadIntervalMillis);
+    void poll();
 
     /**
-     * Sends a boot up message to the server to indicate that the device has started.
-     * @return true if the message was sent successfully, false otherwise.
+     * Whether the records of a failed session should be retried now.
+     * @return true if a retry is due.
      */
-    bool sendBootUpMessage();
+    bool retryDue();
+
+    /**
+     * Whether the flash backlog should be drained now.
+     * @return true if a drain upload is due.
+     */
+    bool backlogDrainDue();
+
+    /**
+     * Whether a session should be started now, ahead of the next upload interval.
+     * @param uploadsEnabled Whether telemetry uploads are enabled.
+     * @return true if an exchange is due.
+     */
+    bool exchangeDue(bool uploadsEnabled);
+
+    /**
+     * Takes the configuration command that the server sent with the last session, if any.
+     * @param command Set to the command.
+     * @param result Set to the outcome of parsing.
+     * @return true if a message was waiting, false otherwise.
+     */
+    bool takeReceivedCommand(ConfigProtocol::Command &command, ConfigProtocol::Result &result);
 
 
 public:
     //IridiumSBD modem Object
 //    IridiumSBD modem;
 
-    //Mavlink messages to be sent via satellite
-    mavlink_message_t globalPositionIntMsg;
-    mavlink_message_t attitudeMsg;
+    //Which fields are sampled and sent
+    TelemetrySchema telemetrySchema;
 
 
-    //Flags to indicate if a message is in the queue
-    bool globalPositionIntInQueue = false;
-    bool attitudeInQueue = false;
 
     //Maximum message size
     const int maxMessageSize = 100;
 
+    ConfigProtocol::Codec codec = ConfigProtocol::CODEC_BATCH;
+
     bool configReceived = false;
 
+    bool modemReady = false;
+
+    bool bootUpPending = false;
+
 };
 
 #endif //AERORADAREMBEDDED_IRIDIUM9602NMOCK_H
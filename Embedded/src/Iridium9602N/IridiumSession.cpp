@@ -0,0 +1,374 @@
+/**
+* @File: IridiumSession.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the IridiumSession class.
+*/
+
+#include "IridiumSession.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+IridiumSession::IridiumSession(ModemPort &port, uint8_t *mtBuffer, size_t mtCapacity)
+        : port(port), mtBuffer(mtBuffer), mtCapacity(mtCapacity), state(IDLE), step(STEP_CSQ), sessionResult(),
+          moBuffer(), moLength(0), moWritten(0), maxSendAttempts(0), lineBuffer(), lineLength(0), lineOverflow(false),
+          responseSeen(false), writeStatus(-1), echoMatched(0), payloadRead(0), payloadLength(0), payloadChecksum(0),
+          sessionStart(0), stepStart(0), stepTimeout(0), retryAt(0) {
+}
+
+bool IridiumSession::begin(Operation operation, const uint8_t *data, size_t length, uint8_t maxAttempts) {
+
+    if (isBusy()) {
+        return false;
+    }
+
+    sessionResult = Result();
+    sessionResult.operation = operation;
+    sessionResult.signalQuality = -1;
+    sessionResult.moStatus = -1;
+    sessionResult.mtStatus = -1;
+
+    switch (operation) {
+        case SIGNAL_QUALITY:
+            step = STEP_CSQ;
+            break;
+        case SYSTEM_TIME:
+            step = STEP_MSSTM;
+            break;
+        case SEND_RECEIVE: {
+            if (length > maxMessageSize) {
+                sessionResult.error = SESSION_MESSAGE_TOO_LONG;
+                return false;
+            }
+            //the modem expects the payload followed by the low 16 bits of its byte sum, most significant byte first
+            uint16_t checksum = 0;
+            for (size_t i = 0; i < length; i++) {
+                moBuffer[i] = data[i];
+                checksum += data[i];
+            }
+            moBuffer[length] = (uint8_t) (checksum >> 8);
+            moBuffer[length + 1] = (uint8_t) (checksum & 0xFF);
+            moLength = length;
+            moWritten = 0;
+            maxSendAttempts = maxAttempts;
+            step = STEP_SBDWB;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    sessionStart = port.millis();
+    nextStep(step);
+    return true;
+}
+
+void IridiumSession::poll() {
+
+    if (state == IDLE) {
+        return;
+    }
+
+    unsigned long now = port.millis();
+
+    switch (state) {
+        case SEND_COMMAND:
+            sendCommand();
+            stepStart = now;
+            return;
+
+        case RETRY_WAIT:
+            if ((long) (now - retryAt) >= 0) {
+                nextStep(STEP_SBDIX);
+            }
+            return;
+
+        case WRITE_PAYLOAD: {
+            //only write what fits in the transmit buffer so the UART never blocks us
+            size_t remaining = moLength + 2 - moWritten;
+            size_t space = port.availableForWrite();
+            size_t chunk = remaining < space ? remaining : space;
+            if (chunk > 0) {
+                moWritten += port.write(moBuffer + moWritten, chunk);
+            }
+            if (moWritten >= moLength + 2) {
+                step = STEP_SBDWB_STATUS;
+                state = AWAIT_RESPONSE;
+                stepStart = now;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    for (uint8_t i = 0; i < maxBytesPerPoll && isReceiving() && port.available() > 0; i++) {
+        int c = port.read();
+        if (c < 0) {
+            break;
+        }
+        if (state == READ_PAYLOAD) {
+            receivePayload((uint8_t) c);
+        } else if (state == AWAIT_ECHO) {
+            //the binary response to AT+SBDRB starts straight after the command echo, with no line break
+            static const char echo[] = "AT+SBDRB\r";
+            if ((char) c == echo[echoMatched]) {
+                echoMatched++;
+            } else {
+                echoMatched = (char) c == echo[0] ? 1 : 0;
+            }
+            if (echo[echoMatched] == '\0') {
+                payloadRead = 0;
+                payloadLength = 0;
+                payloadChecksum = 0;
+                state = READ_PAYLOAD;
+            }
+        } else {
+            receiveText((uint8_t) c);
+        }
+    }
+
+    if (state != IDLE && state != RETRY_WAIT && state != SEND_COMMAND && now - stepStart > stepTimeout) {
+        finish(SESSION_TIMEOUT);
+    }
+}
+
+bool IridiumSession::isReceiving() const {
+    return state == AWAIT_RESPONSE || state == AWAIT_ECHO || state == READ_PAYLOAD;
+}
+
+bool IridiumSession::isBusy() const {
+    return state != IDLE;
+}
+
+const IridiumSession::Result &IridiumSession::result() const {
+    return sessionResult;
+}
+
+void IridiumSession::sendCommand() {
+
+    char command[24];
+    switch (step) {
+        case STEP_CSQ:
+            snprintf(command, sizeof(command), "AT+CSQ\r");
+            break;
+        case STEP_MSSTM:
+            snprintf(command, sizeof(command), "AT-MSSTM\r");
+            break;
+        case STEP_SBDWB:
+            snprintf(command, sizeof(command), "AT+SBDWB=%u\r", (unsigned) moLength);
+            break;
+        case STEP_SBDIX:
+            sessionResult.attempts++;
+            snprintf(command, sizeof(command), "AT+SBDIX\r");
+            break;
+        case STEP_SBDRB:
+            snprintf(command, sizeof(command), "AT+SBDRB\r");
+            break;
+        default:
+            return;
+    }
+
+    port.write((const uint8_t *) command, strlen(command));
+    lineLength = 0;
+    lineOverflow = false;
+    responseSeen = false;
+    echoMatched = 0;
+    stepTimeout = step == STEP_SBDIX ? sbdixTimeoutMillis : commandTimeoutMillis;
+    state = step == STEP_SBDRB ? AWAIT_ECHO : AWAIT_RESPONSE;
+}
+
+void IridiumSession::receiveText(uint8_t c) {
+
+    if (c == '\r') {
+        return;
+    }
+    if (c != '\n') {
+        if (lineLength < lineBufferSize - 1) {
+            lineBuffer[lineLength++] = (char) c;
+        } else {
+            lineOverflow = true;
+        }
+        return;
+    }
+
+    lineBuffer[lineLength] = '\0';
+    bool usable = lineLength > 0 && !lineOverflow;
+    lineLength = 0;
+    lineOverflow = false;
+
+    //skip blank lines and the modem echoing our command back
+    if (usable && strncmp(lineBuffer, "AT", 2) != 0) {
+        handleLine(lineBuffer);
+    }
+}
+
+void IridiumSession::receivePayload(uint8_t c) {
+
+    //2 length bytes, the message, then 2 checksum bytes
+    if (payloadRead < 2) {
+        payloadLength = (uint16_t) ((payloadLength << 8) | c);
+    } else if (payloadRead < 2u + payloadLength) {
+        size_t index = payloadRead - 2;
+        if (index < mtCapacity) {
+            mtBuffer[index] = c;
+        }
+        payloadChecksum += c;
+    } else {
+        size_t checksumIndex = payloadRead - 2 - payloadLength;
+        uint8_t expected = checksumIndex == 0 ? (uint8_t) (payloadChecksum >> 8) : (uint8_t) (payloadChecksum & 0xFF);
+        if (c != expected) {
+            finish(SESSION_CHECKSUM_ERROR);
+            return;
+        }
+    }
+    payloadRead++;
+
+    if (payloadRead == 4u + payloadLength) {
+        if (payloadLength > mtCapacity) {
+            sessionResult.receivedLength = mtCapacity;
+            finish(SESSION_RX_OVERFLOW);
+            return;
+        }
+        sessionResult.receivedLength = payloadLength;
+        //the payload is followed by a final OK
+        responseSeen = true;
+        state = AWAIT_RESPONSE;
+    }
+}
+
+void IridiumSession::handleLine(const char *line) {
+
+    if (strcmp(line, "ERROR") == 0) {
+        finish(SESSION_PROTOCOL_ERROR);
+        return;
+    }
+
+    bool ok = strcmp(line, "OK") == 0;
+
+    switch (step) {
+        case STEP_CSQ:
+            if (strncmp(line, "+CSQ:", 5) == 0) {
+                sessionResult.signalQuality = atoi(line + 5);
+                responseSeen = true;
+            } else if (ok) {
+                finish(responseSeen ? SESSION_OK : SESSION_PROTOCOL_ERROR);
+            }
+            break;
+
+        case STEP_MSSTM:
+            if (strncmp(line, "-MSSTM:", 7) == 0) {
+                const char *value = line + 7;
+                while (*value == ' ') {
+                    value++;
+                }
+                if (strncmp(value, "no network service", 18) == 0) {
+                    finish(SESSION_NO_NETWORK);
+                    return;
+                }
+                sessionResult.systemTime = (uint32_t) strtoul(value, nullptr, 16);
+                responseSeen = true;
+            } else if (ok) {
+                finish(responseSeen ? SESSION_OK : SESSION_PROTOCOL_ERROR);
+            }
+            break;
+
+        case STEP_SBDWB:
+            if (strcmp(line, "READY") == 0) {
+                writeStatus = -1;
+                state = WRITE_PAYLOAD;
+            }
+            break;
+
+        case STEP_SBDWB_STATUS:
+            if (line[0] >= '0' && line[0] <= '3' && line[1] == '\0') {
+                writeStatus = line[0] - '0';
+            } else if (ok) {
+                if (writeStatus == 0) {
+                    nextStep(STEP_SBDIX);
+                } else if (writeStatus == 2) {
+                    finish(SESSION_CHECKSUM_ERROR);
+                } else if (writeStatus == 3) {
+                    finish(SESSION_MESSAGE_TOO_LONG);
+                } else {
+                    finish(SESSION_PROTOCOL_ERROR);
+                }
+            }
+            break;
+
+        case STEP_SBDIX:
+            if (strncmp(line, "+SBDIX:", 7) == 0) {
+                unsigned values[6] = {0};
+                const char *cursor = line + 7;
+                for (uint8_t i = 0; i < 6; i++) {
+                    char *end;
+                    values[i] = (unsigned) strtoul(cursor, &end, 10);
+                    if (end == cursor) {
+                        finish(SESSION_PROTOCOL_ERROR);
+                        return;
+                    }
+                    cursor = *end == ',' ? end + 1 : end;
+                }
+                sessionResult.moStatus = (int) values[0];
+                sessionResult.moMsn = (uint16_t) values[1];
+                sessionResult.mtStatus = (int) values[2];
+                sessionResult.mtMsn = (uint16_t) values[3];
+                sessionResult.mtLength = (uint16_t) values[4];
+                sessionResult.mtQueued = (uint16_t) values[5];
+                //MO status 0 to 4 means the message was transferred, even if the rest of the session fails
+                sessionResult.moDelivered = sessionResult.moStatus <= 4;
+                responseSeen = true;
+            } else if (ok) {
+                if (!responseSeen) {
+                    finish(SESSION_PROTOCOL_ERROR);
+                } else {
+                    handleSessionResult();
+                }
+            }
+            break;
+
+        case STEP_SBDRB:
+            if (ok && responseSeen) {
+                finish(SESSION_OK);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void IridiumSession::handleSessionResult() {
+
+    //anything but a transferred message is a failed attempt
+    if (sessionResult.moDelivered) {
+        if (sessionResult.mtStatus == 1 && sessionResult.mtLength > 0) {
+            nextStep(STEP_SBDRB);
+        } else {
+            finish(SESSION_OK);
+        }
+        return;
+    }
+
+    unsigned long now = port.millis();
+    if ((maxSendAttempts != 0 && sessionResult.attempts >= maxSendAttempts)
+        || now + sbdixRetryDelayMillis - sessionStart >= sendReceiveTimeoutMillis) {
+        finish(SESSION_SEND_FAILED);
+        return;
+    }
+    retryAt = now + sbdixRetryDelayMillis;
+    state = RETRY_WAIT;
+}
+
+void IridiumSession::nextStep(Step next) {
+    step = next;
+    state = SEND_COMMAND;
+}
+
+void IridiumSession::finish(Error error) {
+    sessionResult.error = error;
+    sessionResult.durationMillis = port.millis() - sessionStart;
+    state = IDLE;
+}
@@ -0,0 +1,227 @@
+/**
+* @File: IridiumSession.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the IridiumSession class, a cooperative, step-driven driver for the Iridium
+ * 9602N. Instead of blocking inside the IridiumSBD library for the whole of an SBD session, an operation is started
+ * with begin() and advanced by calling poll() from loop(). Each poll() handles whatever the modem has sent since the
+ * last call and moves the AT command exchange (AT+SBDWB, AT+SBDIX, AT+SBDRB, AT+CSQ, AT-MSSTM) forward by at most one
+ * step, so scheduling, MAVLink ingest and LED updates keep running while a session is in progress.
+*/
+
+#ifndef AERORADAREMBEDDED_IRIDIUMSESSION_H
+#define AERORADAREMBEDDED_IRIDIUMSESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ModemPort.h"
+
+/**
+ * A non-blocking driver for the Iridium 9602N AT command set.
+ */
+class IridiumSession {
+
+public:
+    /**
+     * The operations a session can perform.
+     */
+    enum Operation {
+        NO_OPERATION,
+        //AT+CSQ
+        SIGNAL_QUALITY,
+        //AT-MSSTM
+        SYSTEM_TIME,
+        //AT+SBDWB, then AT+SBDIX until the message is sent, then AT+SBDRB if a message is waiting
+        SEND_RECEIVE
+    };
+
+    /**
+     * The outcome of a session.
+     */
+    enum Error {
+        SESSION_OK = 0,
+        SESSION_TIMEOUT,
+        SESSION_PROTOCOL_ERROR,
+        SESSION_MESSAGE_TOO_LONG,
+        SESSION_CHECKSUM_ERROR,
+        SESSION_SEND_FAILED,
+        SESSION_NO_NETWORK,
+        SESSION_RX_OVERFLOW
+    };
+
+    /**
+     * Everything the modem reported during the last session. Once moDelivered is set, error only tells whether the
+     * MT message was read: the MO message is with the gateway whatever happens to AT+SBDRB.
+     */
+    struct Result {
+        Operation operation;
+        Error error;
+        //AT+SBDIX reported MO status 0 to 4, the gateway accepted the MO message
+        bool moDelivered;
+        //AT+CSQ, 0 to 5
+        int signalQuality;
+        //AT-MSSTM, Iridium system time in 90 ms ticks
+        uint32_t systemTime;
+        //AT+SBDIX
+        int moStatus;
+        uint16_t moMsn;
+        int mtStatus;
+        uint16_t mtMsn;
+        uint16_t mtLength;
+        uint16_t mtQueued;
+        //the number of bytes of the received message copied into the MT buffer
+        size_t receivedLength;
+        //the number of AT+SBDIX attempts made
+        uint8_t attempts;
+        unsigned long durationMillis;
+    };
+
+    static const size_t maxMessageSize = 340;
+    static const uint8_t lineBufferSize = 64;
+    //the most received bytes handled by a single poll()
+    static const uint8_t maxBytesPerPoll = 64;
+    //how long to wait for the modem to answer an ordinary AT command
+    static const unsigned long commandTimeoutMillis = 20 * 1000ul;
+    //how long to wait for the modem to answer AT+SBDIX
+    static const unsigned long sbdixTimeoutMillis = 60 * 1000ul;
+    //how long to wait between failed AT+SBDIX attempts
+    static const unsigned long sbdixRetryDelayMillis = 20 * 1000ul;
+    //how long a SEND_RECEIVE session may keep retrying AT+SBDIX
+    static const unsigned long sendReceiveTimeoutMillis = 300 * 1000ul;
+
+    /**
+     * Constructor
+     * @param port - the modem connection.
+     * @param mtBuffer - where a received (MT) message is copied to.
+     * @param mtCapacity - the size of mtBuffer.
+     */
+    IridiumSession(ModemPort &port, uint8_t *mtBuffer, size_t mtCapacity);
+
+    /**
+     * Start an operation. The MO payload of a SEND_RECEIVE is copied, so data does not have to outlive the call.
+     * @param operation - the operation to perform.
+     * @param data - the MO payload, only used by SEND_RECEIVE.
+     * @param length - the length of the MO payload.
+     * @param maxAttempts - the most AT+SBDIX attempts a SEND_RECEIVE makes, 0 to keep retrying until
+     * sendReceiveTimeoutMillis.
+     * @return bool - true if the operation was started, false if a session is already running or the payload is too
+     * long. The reason is available from result().
+     */
+    bool begin(Operation operation, const uint8_t *data = nullptr, size_t length = 0, uint8_t maxAttempts = 0);
+
+    /**
+     * Advance the running operation by at most one step. Call once per loop().
+     */
+    void poll();
+
+    /**
+     * Whether an operation is running.
+     * @return bool - true until the operation completes or fails.
+     */
+    bool isBusy() const;
+
+    /**
+     * The result of the last completed operation.
+     * @return const Result& - the result, only meaningful while isBusy() is false.
+     */
+    const Result &result() const;
+
+private:
+    enum State {
+        IDLE,
+        SEND_COMMAND,
+        AWAIT_RESPONSE,
+        WRITE_PAYLOAD,
+        AWAIT_ECHO,
+        READ_PAYLOAD,
+        RETRY_WAIT
+    };
+
+    enum Step {
+        STEP_CSQ,
+        STEP_MSSTM,
+        STEP_SBDWB,
+        STEP_SBDWB_STATUS,
+        STEP_SBDIX,
+        STEP_SBDRB
+    };
+
+    ModemPort &port;
+    uint8_t *mtBuffer;
+    size_t mtCapacity;
+
+    State state;
+    Step step;
+    Result sessionResult;
+
+    uint8_t moBuffer[maxMessageSize + 2];
+    size_t moLength;
+    size_t moWritten;
+    uint8_t maxSendAttempts;
+
+    char lineBuffer[lineBufferSize];
+    uint8_t lineLength;
+    bool lineOverflow;
+
+    //set while the expected response line for the current step has been seen, before the final OK
+    bool responseSeen;
+    int writeStatus;
+
+    uint8_t echoMatched;
+    size_t payloadRead;
+    uint16_t payloadLength;
+    uint16_t payloadChecksum;
+
+    unsigned long sessionStart;
+    unsigned long stepStart;
+    unsigned long stepTimeout;
+    unsigned long retryAt;
+
+    /**
+     * Whether the current state consumes bytes from the modem.
+     * @return bool - true while waiting for a response.
+     */
+    bool isReceiving() const;
+
+    /**
+     * Send the AT command for the current step.
+     */
+    void sendCommand();
+
+    /**
+     * Feed one received byte into the line assembler, handling the line once it is complete.
+     * @param c - the received byte.
+     */
+    void receiveText(uint8_t c);
+
+    /**
+     * Feed one received byte of the binary AT+SBDRB response.
+     * @param c - the received byte.
+     */
+    void receivePayload(uint8_t c);
+
+    /**
+     * Act on a complete response line for the current step.
+     * @param line - the line with its line ending removed.
+     */
+    void handleLine(const char *line);
+
+    /**
+     * Act on the result of an AT+SBDIX attempt.
+     */
+    void handleSessionResult();
+
+    /**
+     * Move on to a step and send its command on the next poll().
+     * @param next - the step to move to.
+     */
+    void nextStep(Step next);
+
+    /**
+     * Finish the operation.
+     * @param error - the outcome.
+     */
+    void finish(Error error);
+};
+
+#endif //AERORADAREMBEDDED_IRIDIUMSESSION_H
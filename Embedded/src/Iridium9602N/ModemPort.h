@@ -0,0 +1,57 @@
+/**
+* @File: ModemPort.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the ModemPort interface, the byte stream and clock that the non-blocking
+ * IridiumSession driver talks through. On the device it is implemented by UartModemPort on top of SerialSAT; on a host
+ * build it is implemented by ScriptedModemPort, a fake modem that answers AT commands from a script.
+*/
+
+#ifndef AERORADAREMBEDDED_MODEMPORT_H
+#define AERORADAREMBEDDED_MODEMPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * The byte stream and clock the Iridium modem is reached through.
+ */
+class ModemPort {
+
+public:
+    virtual ~ModemPort() = default;
+
+    /**
+     * The number of bytes received from the modem that are waiting to be read.
+     * @return int - the number of bytes available.
+     */
+    virtual int available() = 0;
+
+    /**
+     * Read the next byte received from the modem.
+     * @return int - the byte, -1 if none is available.
+     */
+    virtual int read() = 0;
+
+    /**
+     * Send bytes to the modem.
+     * @param data - the bytes to send.
+     * @param length - the number of bytes to send.
+     * @return size_t - the number of bytes accepted.
+     */
+    virtual size_t write(const uint8_t *data, size_t length) = 0;
+
+    /**
+     * The number of bytes that can be written without blocking.
+     * @return size_t - the free space in the transmit buffer.
+     */
+    virtual size_t availableForWrite() = 0;
+
+    /**
+     * The current time.
+     * @return unsigned long - milliseconds since an arbitrary point.
+     */
+    virtual unsigned long millis() = 0;
+};
+
+#endif //AERORADAREMBEDDED_MODEMPORT_H
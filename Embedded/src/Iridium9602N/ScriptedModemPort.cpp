@@ -0,0 +1,135 @@
+/**
+* @File: ScriptedModemPort.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the ScriptedModemPort class.
+*/
+
+#include "ScriptedModemPort.h"
+#include <stdlib.h>
+#include <string.h>
+
+ScriptedModemPort::ScriptedModemPort(const Exchange *script, size_t exchangeCount)
+        : script(script), exchangeCount(exchangeCount), nextExchange(0), mismatchCount(0), clock(0), replyAt(0),
+          command(), commandLength(0), payload(), payloadExpected(0), payloadReceived(0),
+          pendingPayloadResponse(nullptr), rxQueue(), rxHead(0), rxTail(0) {
+}
+
+int ScriptedModemPort::available() {
+    //nothing is visible to the driver until the modem has had time to answer
+    if ((long) (clock - replyAt) < 0) {
+        return 0;
+    }
+    return (int) (rxHead - rxTail);
+}
+
+int ScriptedModemPort::read() {
+    if (available() == 0) {
+        return -1;
+    }
+    uint8_t c = rxQueue[rxTail % rxQueueSize];
+    rxTail++;
+    return c;
+}
+
+size_t ScriptedModemPort::write(const uint8_t *data, size_t length) {
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+
+        //binary AT+SBDWB payload
+        if (payloadReceived < payloadExpected) {
+            if (payloadReceived < maxPayloadSize) {
+                payload[payloadReceived] = c;
+            }
+            payloadReceived++;
+            if (payloadReceived == payloadExpected) {
+                size_t messageLength = payloadExpected - 2;
+                uint16_t checksum = 0;
+                for (size_t j = 0; j < messageLength && j < maxPayloadSize; j++) {
+                    checksum += payload[j];
+                }
+                bool valid = messageLength + 2 <= maxPayloadSize
+                             && payload[messageLength] == (uint8_t) (checksum >> 8)
+                             && payload[messageLength + 1] == (uint8_t) (checksum & 0xFF);
+                queueText(valid ? pendingPayloadResponse : "\r\n2\r\n\r\nOK\r\n");
+            }
+            continue;
+        }
+
+        if (c == '\r') {
+            command[commandLength] = '\0';
+            handleCommand();
+            commandLength = 0;
+        } else if (commandLength < sizeof(command) - 1) {
+            command[commandLength++] = (char) c;
+        }
+    }
+    return length;
+}
+
+size_t ScriptedModemPort::availableForWrite() {
+    return txBufferSize;
+}
+
+unsigned long ScriptedModemPort::millis() {
+    return clock;
+}
+
+void ScriptedModemPort::advance(unsigned long millis) {
+    clock += millis;
+}
+
+bool ScriptedModemPort::finished() const {
+    return nextExchange == exchangeCount && rxHead == rxTail && payloadReceived == payloadExpected;
+}
+
+size_t ScriptedModemPort::mismatches() const {
+    return mismatchCount;
+}
+
+const uint8_t *ScriptedModemPort::lastPayload(size_t &length) const {
+    length = payloadExpected >= 2 ? payloadExpected - 2 : 0;
+    return payload;
+}
+
+void ScriptedModemPort::queue(const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length && rxHead - rxTail < rxQueueSize; i++) {
+        rxQueue[rxHead % rxQueueSize] = data[i];
+        rxHead++;
+    }
+}
+
+void ScriptedModemPort::queueText(const char *text) {
+    if (text != nullptr) {
+        queue((const uint8_t *) text, strlen(text));
+    }
+}
+
+void ScriptedModemPort::handleCommand() {
+
+    //the modem echoes every command back
+    queue((const uint8_t *) command, commandLength);
+    queueText("\r");
+
+    if (nextExchange >= exchangeCount
+        || strncmp(command, script[nextExchange].command, strlen(script[nextExchange].command)) != 0) {
+        mismatchCount++;
+        queueText("\r\nERROR\r\n");
+        return;
+    }
+
+    const Exchange &exchange = script[nextExchange++];
+    replyAt = clock + exchange.delayMillis;
+
+    if (exchange.binary != nullptr) {
+        queue(exchange.binary, exchange.binaryLength);
+    }
+    queueText(exchange.response);
+
+    if (strncmp(command, "AT+SBDWB=", 9) == 0) {
+        payloadExpected = (size_t) atoi(command + 9) + 2;
+        payloadReceived = 0;
+        pendingPayloadResponse = exchange.payloadResponse;
+    }
+}
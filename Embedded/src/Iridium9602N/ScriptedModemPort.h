@@ -0,0 +1,125 @@
+/**
+* @File: ScriptedModemPort.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines ScriptedModemPort, a fake Iridium 9602N for exercising IridiumSession without
+ * the hardware. It plays back a script of AT command exchanges against a simulated clock, echoing each command and
+ * answering with the scripted response once its delay has passed. It has no Arduino dependencies so it can be used in
+ * a host build as well as on the device.
+*/
+
+#ifndef AERORADAREMBEDDED_SCRIPTEDMODEMPORT_H
+#define AERORADAREMBEDDED_SCRIPTEDMODEMPORT_H
+
+#include "ModemPort.h"
+
+/**
+ * A fake modem that answers AT commands from a script.
+ */
+class ScriptedModemPort : public ModemPort {
+
+public:
+    /**
+     * One command and the modem's answer to it.
+     */
+    struct Exchange {
+        //the start of the command line expected from the driver, without the trailing carriage return
+        const char *command;
+        //raw bytes sent straight after the command echo, such as the AT+SBDRB payload, may be null
+        const uint8_t *binary;
+        size_t binaryLength;
+        //text sent after the binary bytes
+        const char *response;
+        //how long the modem takes to answer
+        unsigned long delayMillis;
+        //for AT+SBDWB, the text sent once the payload and its checksum have been received
+        const char *payloadResponse;
+    };
+
+    static const size_t maxPayloadSize = 342;
+    static const size_t txBufferSize = 64;
+    static const size_t rxQueueSize = 512;
+
+    /**
+     * Constructor
+     * @param script - the exchanges, in the order the driver is expected to make them.
+     * @param exchangeCount - the number of exchanges.
+     */
+    ScriptedModemPort(const Exchange *script, size_t exchangeCount);
+
+    int available() override;
+
+    int read() override;
+
+    size_t write(const uint8_t *data, size_t length) override;
+
+    size_t availableForWrite() override;
+
+    unsigned long millis() override;
+
+    /**
+     * Move the simulated clock forward.
+     * @param millis - the number of milliseconds to advance by.
+     */
+    void advance(unsigned long millis);
+
+    /**
+     * Whether every exchange in the script has been played.
+     * @return bool - true once the last exchange has been answered.
+     */
+    bool finished() const;
+
+    /**
+     * The number of commands that did not match the script. A mismatched command is answered with ERROR.
+     * @return size_t - the number of mismatches.
+     */
+    size_t mismatches() const;
+
+    /**
+     * The last payload written with AT+SBDWB, without its checksum.
+     * @param length - set to the payload length.
+     * @return const uint8_t* - the payload.
+     */
+    const uint8_t *lastPayload(size_t &length) const;
+
+private:
+    const Exchange *script;
+    size_t exchangeCount;
+    size_t nextExchange;
+    size_t mismatchCount;
+
+    unsigned long clock;
+    unsigned long replyAt;
+
+    char command[32];
+    size_t commandLength;
+
+    uint8_t payload[maxPayloadSize];
+    size_t payloadExpected;
+    size_t payloadReceived;
+    const char *pendingPayloadResponse;
+
+    uint8_t rxQueue[rxQueueSize];
+    size_t rxHead;
+    size_t rxTail;
+
+    /**
+     * Queue bytes for the driver to read.
+     * @param data - the bytes.
+     * @param length - the number of bytes.
+     */
+    void queue(const uint8_t *data, size_t length);
+
+    /**
+     * Queue a string for the driver to read.
+     * @param text - the string, may be null.
+     */
+    void queueText(const char *text);
+
+    /**
+     * Answer a complete command line.
+     */
+    void handleCommand();
+};
+
+#endif //AERORADAREMBEDDED_SCRIPTEDMODEMPORT_H
@@ -0,0 +1,149 @@
+/**
+* @File: SendQueue.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the SendQueue class.
+*/
+
+#include "SendQueue.h"
+#include <string.h>
+
+SendQueue::SendQueue(unsigned long minSpacingMillis) : minSpacingMillis(minSpacingMillis) {
+}
+
+bool SendQueue::push(const TelemetryCodec::TelemetrySample &sample, Priority priority, unsigned long now,
+                     unsigned long lifetimeMillis) {
+
+    Record record = {sample, priority, now, now + lifetimeMillis, false, 0};
+
+    //a routine fix replaces the newest unsent one if that one was only keeping the head of the history fresh
+    if (priority == ROUTINE) {
+        int last = routineBefore(count);
+        if (last >= 0 && !records[last].inFlight) {
+            int previous = routineBefore((size_t) last);
+            if (previous >= 0 && records[last].queuedMillis - records[previous].queuedMillis < minSpacingMillis) {
+                removeAt((size_t) last);
+                dropped++;
+            }
+        }
+    }
+
+    //make room if needed, first by dropping expired records, then the oldest unsent routine record and, for a
+    // critical record only, the oldest unsent critical record
+    if (count == capacity) {
+        dropExpired(now);
+    }
+    if (count == capacity) {
+        int victim = -1;
+        for (int pass = ROUTINE; pass <= priority && victim < 0; pass++) {
+            for (size_t i = 0; i < count && victim < 0; i++) {
+                if (!records[i].inFlight && records[i].priority == pass) {
+                    victim = (int) i;
+                }
+            }
+        }
+        if (victim < 0) {
+            evict(record);
+            dropped++;
+            return false;
+        }
+        evict(records[victim]);
+        removeAt((size_t) victim);
+        dropped++;
+    }
+
+    records[count++] = record;
+    return true;
+}
+
+void SendQueue::setEvictionHandler(EvictionHandler handler, void *context) {
+    evictionHandler = handler;
+    evictionContext = context;
+}
+
+size_t SendQueue::dropExpired(unsigned long now) {
+
+    size_t removed = 0;
+    for (size_t i = count; i > 0; i--) {
+        const Record &record = records[i - 1];
+        if (!record.inFlight && (long) (now - record.deadlineMillis) > 0) {
+            evict(record);
+            removeAt(i - 1);
+            removed++;
+        }
+    }
+    dropped += removed;
+    return removed;
+}
+
+size_t SendQueue::rank(uint8_t *order, size_t maxCount) const {
+
+    //critical records first, each group newest first
+    size_t written = 0;
+    for (int pass = CRITICAL; pass >= ROUTINE; pass--) {
+        for (size_t i = count; i > 0 && written < maxCount; i--) {
+            const Record &record = records[i - 1];
+            if (!record.inFlight && record.priority == pass) {
+                order[written++] = (uint8_t) (i - 1);
+            }
+        }
+    }
+    return written;
+}
+
+void SendQueue::markInFlight(size_t index) {
+    if (index < count) {
+        records[index].inFlight = true;
+    }
+}
+
+size_t SendQueue::completeInFlight(bool delivered) {
+
+    size_t completed = 0;
+    for (size_t i = count; i > 0; i--) {
+        Record &record = records[i - 1];
+        if (!record.inFlight) {
+            continue;
+        }
+        completed++;
+        if (delivered) {
+            removeAt(i - 1);
+        } else {
+            record.inFlight = false;
+            record.attempts++;
+        }
+    }
+    return completed;
+}
+
+const SendQueue::Record &SendQueue::at(size_t index) const {
+    return records[index];
+}
+
+size_t SendQueue::size() const {
+    return count;
+}
+
+uint32_t SendQueue::droppedCount() const {
+    return dropped;
+}
+
+void SendQueue::evict(const Record &record) {
+    if (evictionHandler != nullptr) {
+        evictionHandler(record, evictionContext);
+    }
+}
+
+void SendQueue::removeAt(size_t index) {
+    memmove(records + index, records + index + 1, (count - index - 1) * sizeof(Record));
+    count--;
+}
+
+int SendQueue::routineBefore(size_t before) const {
+    for (size_t i = before; i > 0; i--) {
+        if (records[i - 1].priority == ROUTINE) {
+            return (int) (i - 1);
+        }
+    }
+    return -1;
+}
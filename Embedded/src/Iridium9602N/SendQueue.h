@@ -0,0 +1,174 @@
+/**
+* @File: SendQueue.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the SendQueue class, the small priority queue of telemetry records waiting to
+ * be sent via satellite. Operators care about how fresh the latest position on the map is, not about completeness, so
+ * the queue is freshest-wins:
+ * - every record has a deadline and expired records are dropped before they can waste a session,
+ * - a new routine position supersedes the newest unsent one if that one was only a freshness update, so the queue
+ *   holds a history spaced minSpacingMillis apart whose newest entry is always the latest position,
+ * - critical records outrank routine ones, then newer records outrank older ones,
+ * - records of a failed session go back into the queue, where newer data can supersede or outrank them,
+ * - records that have to make room or expire are handed to an eviction handler, e.g. to spool them to flash.
+*/
+
+#ifndef AERORADAREMBEDDED_SENDQUEUE_H
+#define AERORADAREMBEDDED_SENDQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "TelemetryCodec/TelemetryCodec.h"
+
+/**
+ * A fixed capacity queue of outbound telemetry records with priorities and deadlines.
+ */
+class SendQueue {
+
+public:
+    /**
+     * How important a record is.
+     */
+    enum Priority : uint8_t {
+        //a regular position fix
+        ROUTINE = 0,
+        //an event the operator must see, never superseded by routine fixes
+        CRITICAL
+    };
+
+    /**
+     * One outbound record.
+     */
+    struct Record {
+        TelemetryCodec::TelemetrySample sample;
+        Priority priority;
+        //the value of millis() when the record was queued
+        unsigned long queuedMillis;
+        //the value of millis() after which the record is no longer worth sending
+        unsigned long deadlineMillis;
+        //A boolean to indicate if the record is part of the session in progress.
+        bool inFlight;
+        //the number of failed sessions that carried the record
+        uint8_t attempts;
+    };
+
+    /**
+     * Called with every record that is dropped to make room or because it expired. Superseded and delivered records
+     * are not passed on.
+     * @param record - the record being dropped.
+     * @param context - the context given to setEvictionHandler.
+     */
+    typedef void (*EvictionHandler)(const Record &record, void *context);
+
+    //The maximum number of records held.
+    static const uint8_t capacity = 12;
+
+    /**
+     * Constructor
+     * @param minSpacingMillis - the spacing of the routine position history.
+     */
+    explicit SendQueue(unsigned long minSpacingMillis);
+
+    /**
+     * Queue a record. A routine record supersedes the newest unsent routine record if that one was queued less than
+     * minSpacingMillis after the routine record before it. If the queue is full, expired records and then the oldest
+     * unsent routine record make room. Only a critical record makes room by evicting the oldest unsent critical record,
+     * once no routine record is left to evict.
+     * @param sample - the telemetry sample.
+     * @param priority - the priority of the record.
+     * @param now - the current value of millis().
+     * @param lifetimeMillis - how long the record is worth sending.
+     * @return bool - true if the record was queued, false if the queue is full of more important records. A record
+     * that is not queued is evicted.
+     */
+    bool push(const TelemetryCodec::TelemetrySample &sample, Priority priority, unsigned long now,
+              unsigned long lifetimeMillis);
+
+    /**
+     * Set the handler that receives evicted records.
+     * @param handler - the handler, nullptr to simply drop them.
+     * @param context - passed to the handler.
+     */
+    void setEvictionHandler(EvictionHandler handler, void *context);
+
+    /**
+     * Drop every record that is not in flight and has passed its deadline.
+     * @param now - the current value of millis().
+     * @return size_t - the number of records dropped.
+     */
+    size_t dropExpired(unsigned long now);
+
+    /**
+     * Rank the records that are not in flight: critical before routine, then newest first.
+     * @param order - filled with record indices, most important first.
+     * @param maxCount - the size of order.
+     * @return size_t - the number of indices written.
+     */
+    size_t rank(uint8_t *order, size_t maxCount) const;
+
+    /**
+     * Mark a record as part of the session in progress.
+     * @param index - the index of the record.
+     */
+    void markInFlight(size_t index);
+
+    /**
+     * Finish the session in progress. Delivered records are removed, the records of a failed session are returned
+     * to the queue.
+     * @param delivered - whether the session succeeded.
+     * @return size_t - the number of records that were in flight.
+     */
+    size_t completeInFlight(bool delivered);
+
+    /**
+     * A record, oldest first.
+     * @param index - the index of the record, less than size().
+     * @return const Record& - the record.
+     */
+    const Record &at(size_t index) const;
+
+    /**
+     * The number of records held.
+     * @return size_t - the number of records.
+     */
+    size_t size() const;
+
+    /**
+     * The number of records that were dropped or superseded without being delivered.
+     * @return uint32_t - the number of records.
+     */
+    uint32_t droppedCount() const;
+
+private:
+    unsigned long minSpacingMillis;
+
+    //the records, oldest first
+    Record records[capacity]{};
+    uint8_t count = 0;
+
+    uint32_t dropped = 0;
+
+    EvictionHandler evictionHandler = nullptr;
+    void *evictionContext = nullptr;
+
+    /**
+     * Hand a record to the eviction handler, if there is one.
+     * @param record - the record being dropped.
+     */
+    void evict(const Record &record);
+
+    /**
+     * Remove a record, keeping the others in order.
+     * @param index - the index of the record.
+     */
+    void removeAt(size_t index);
+
+    /**
+     * Find the newest routine record before an index.
+     * @param before - the index to search before.
+     * @return int - the index, -1 if there is none.
+     */
+    int routineBefore(size_t before) const;
+};
+
+#endif //AERORADAREMBEDDED_SENDQUEUE_H
@@ -0,0 +1,52 @@
+/**
+* @File: UartModemPort.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines UartModemPort, the ModemPort used on the device. It forwards to the UART the
+ * Iridium 9602N is wired to and uses the Arduino millis() clock.
+*/
+
+#ifndef AERORADAREMBEDDED_UARTMODEMPORT_H
+#define AERORADAREMBEDDED_UARTMODEMPORT_H
+
+#include <Arduino.h>
+#include "ModemPort.h"
+
+/**
+ * A ModemPort on top of an Arduino serial stream.
+ */
+class UartModemPort : public ModemPort {
+
+public:
+    /**
+     * Constructor
+     * @param stream - the serial stream connected to the modem.
+     */
+    explicit UartModemPort(Stream &stream) : stream(stream) {}
+
+    int available() override {
+        return stream.available();
+    }
+
+    int read() override {
+        return stream.read();
+    }
+
+    size_t write(const uint8_t *data, size_t length) override {
+        return stream.write(data, length);
+    }
+
+    size_t availableForWrite() override {
+        int space = stream.availableForWrite();
+        return space > 0 ? (size_t) space : 0;
+    }
+
+    unsigned long millis() override {
+        return ::millis();
+    }
+
+private:
+    Stream &stream;
+};
+
+#endif //AERORADAREMBEDDED_UARTMODEMPORT_H
@@ -0,0 +1,183 @@
+/**
+* @File: LatencyProfiler.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the LatencyHistogram and LatencyProfiler classes.
+*/
+
+#include "LatencyProfiler.h"
+#include <Arduino.h>
+#include "Log/Log.h"
+
+//The profiler every probe records into.
+LatencyProfiler latencyProfiler;
+
+//The names of the probes before the scheduler tasks, indexed by LatencyProfiler::Probe.
+static const char *const probeNames[LatencyProfiler::TASK_FIRST] = {
+        "loop", "mavlinkParse", "sessionStep", "modemBegin", "signalQuality"
+};
+
+void LatencyHistogram::record(uint32_t micros) {
+    uint8_t bucket = bucketOf(micros);
+
+    //halve every bucket rather than lose the shape, a bucket that had runs keeps at least one
+    if (buckets[bucket] == 0xFFFF) {
+        for (uint8_t i = 0; i < bucketCount; i++) {
+            buckets[i] = (uint16_t) ((buckets[i] + 1u) / 2);
+        }
+    }
+    buckets[bucket]++;
+
+    runs++;
+    if (micros < shortest) {
+        shortest = micros;
+    }
+    if (micros > longest) {
+        longest = micros;
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (uint8_t i = 0; i < bucketCount; i++) {
+        buckets[i] = 0;
+    }
+    runs = 0;
+    shortest = 0xFFFFFFFFul;
+    longest = 0;
+}
+
+uint32_t LatencyHistogram::count() const {
+    return runs;
+}
+
+uint32_t LatencyHistogram::min() const {
+    return runs > 0 ? shortest : 0;
+}
+
+uint32_t LatencyHistogram::max() const {
+    return longest;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t percent) const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < bucketCount; i++) {
+        total += buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    //the rank of the run the percentile falls on, rounded up
+    uint32_t rank = (uint32_t) (((uint64_t) total * percent + 99) / 100);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    uint8_t bucket = 0;
+    for (; bucket < bucketCount - 1; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+
+    uint32_t limit = bucketLimit(bucket);
+    if (limit < shortest) {
+        return shortest;
+    }
+    return limit > longest ? longest : limit;
+}
+
+uint8_t LatencyHistogram::bucketOf(uint32_t micros) {
+    if (micros < 2) {
+        return (uint8_t) micros;
+    }
+
+    //the power of two below the runtime, and the half of it the runtime falls into
+    uint8_t exponent = (uint8_t) (31 - __builtin_clz(micros));
+    uint8_t bucket = (uint8_t) (2 * exponent + ((micros >> (exponent - 1)) & 1));
+    return bucket < bucketCount ? bucket : (uint8_t) (bucketCount - 1);
+}
+
+uint32_t LatencyHistogram::bucketLimit(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket;
+    }
+    uint8_t exponent = bucket / 2;
+    uint32_t lower = (uint32_t) (2 + (bucket & 1)) << (exponent - 1);
+    return lower + (1ul << (exponent - 1)) - 1;
+}
+
+LatencyProfiler::Scope::Scope(LatencyProfiler &profiler, Probe probe)
+        : profiler(profiler), probe(probe), start(micros()) {}
+
+LatencyProfiler::Scope::~Scope() {
+    profiler.record(probe, micros() - start);
+}
+
+void LatencyProfiler::record(uint8_t probe, uint32_t micros) {
+    if (probe < probeCount) {
+        histograms[probe].record(micros);
+    }
+}
+
+void LatencyProfiler::recordTask(uint8_t task, uint32_t micros) {
+    if (task < maxTasks) {
+        histograms[TASK_FIRST + task].record(micros);
+    }
+}
+
+void LatencyProfiler::nameTask(int task, const char *name) {
+    if (task >= 0 && task < maxTasks) {
+        taskNames[task] = name;
+    }
+}
+
+void LatencyProfiler::report() {
+    lastWorstProbe = LOOP;
+    lastWorstMicros = 0;
+    lastLoopP99Micros = histograms[LOOP].percentile(99);
+
+    for (uint8_t probe = 0; probe < probeCount; probe++) {
+        LatencyHistogram &histogram = histograms[probe];
+        if (histogram.count() == 0) {
+            continue;
+        }
+        LOG_INFO(LOG_SYSTEM, "Latency %s: %lu runs, min %lu p50 %lu p99 %lu max %lu us", name(probe),
+                 (unsigned long) histogram.count(), (unsigned long) histogram.min(),
+                 (unsigned long) histogram.percentile(50), (unsigned long) histogram.percentile(99),
+                 (unsigned long) histogram.max());
+
+        //the loop contains every other probe, so it is left out of the worst
+        if (probe != LOOP && histogram.max() > lastWorstMicros) {
+            lastWorstProbe = probe;
+            lastWorstMicros = histogram.max();
+        }
+        histogram.reset();
+    }
+}
+
+const LatencyHistogram &LatencyProfiler::histogram(uint8_t probe) const {
+    return histograms[probe < probeCount ? probe : (uint8_t) LOOP];
+}
+
+const char *LatencyProfiler::name(uint8_t probe) const {
+    if (probe < TASK_FIRST) {
+        return probeNames[probe];
+    }
+    const char *taskName = probe < probeCount ? taskNames[probe - TASK_FIRST] : nullptr;
+    return taskName != nullptr ? taskName : "task";
+}
+
+uint8_t LatencyProfiler::worstProbe() const {
+    return lastWorstProbe;
+}
+
+uint32_t LatencyProfiler::worstMicros() const {
+    return lastWorstMicros;
+}
+
+uint32_t LatencyProfiler::loopP99Micros() const {
+    return lastLoopP99Micros;
+}
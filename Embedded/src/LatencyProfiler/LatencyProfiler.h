@@ -0,0 +1,221 @@
+/**
+* @File: LatencyProfiler.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the LatencyHistogram and LatencyProfiler classes, which measure how long the
+ * active part of loop(), every scheduler task, the MAVLink parse and the calls to the modem take on the board. Every
+ * run is timed with micros(), which reads SysTick, and counted in a histogram of fixed size: two buckets per power of
+ * two from 1 us to 67 s, so a percentile is known to within a third of its value, however long the device runs. The
+ * profiler logs min, p50, p99 and max of every probe that ran once per report period and keeps the worst of them for
+ * the health counters of the next upload.
+*/
+
+#ifndef AERORADAREMBEDDED_LATENCYPROFILER_H
+#define AERORADAREMBEDDED_LATENCYPROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * The distribution of the runtimes of one probe, in fixed memory.
+ */
+class LatencyHistogram {
+
+public:
+    //The number of buckets: 0 us, 1 us, then two per power of two up to 2^26 us. Longer runs go into the last one.
+    static const uint8_t bucketCount = 52;
+
+    /**
+     * Default constructor.
+     */
+    LatencyHistogram() = default;
+
+    /**
+     * Count a run.
+     * @param micros - the runtime of the run.
+     */
+    void record(uint32_t micros);
+
+    /**
+     * Forget every run, e.g. at the start of a report period.
+     */
+    void reset();
+
+    /**
+     * The number of runs since the last reset.
+     * @return uint32_t - the runs.
+     */
+    uint32_t count() const;
+
+    /**
+     * The shortest run since the last reset.
+     * @return uint32_t - the runtime in us, 0 if nothing ran.
+     */
+    uint32_t min() const;
+
+    /**
+     * The longest run since the last reset.
+     * @return uint32_t - the runtime in us, 0 if nothing ran.
+     */
+    uint32_t max() const;
+
+    /**
+     * The runtime that a share of the runs did not exceed, the upper end of its bucket limited to min() and max().
+     * @param percent - the share of the runs, e.g. 50 or 99.
+     * @return uint32_t - the runtime in us, 0 if nothing ran.
+     */
+    uint32_t percentile(uint8_t percent) const;
+
+private:
+    /**
+     * The bucket a runtime is counted in.
+     * @param micros - the runtime.
+     * @return uint8_t - the index of the bucket.
+     */
+    static uint8_t bucketOf(uint32_t micros);
+
+    /**
+     * The longest runtime a bucket counts.
+     * @param bucket - the index of the bucket.
+     * @return uint32_t - the runtime in us.
+     */
+    static uint32_t bucketLimit(uint8_t bucket);
+
+    //The runs per bucket, halved together when one of them would overflow so that the shape is kept.
+    uint16_t buckets[bucketCount]{};
+
+    uint32_t runs = 0;
+    uint32_t shortest = 0xFFFFFFFFul;
+    uint32_t longest = 0;
+};
+
+/**
+ * The histograms of every probe, filled from the main loop and reported every report period.
+ */
+class LatencyProfiler {
+
+public:
+    /**
+     * What is timed. The scheduler tasks follow TASK_FIRST in the order of their ids.
+     */
+    enum Probe : uint8_t {
+        LOOP = 0,           //loop() without the sleep at its end
+        MAVLINK_PARSE,      //decoding MAVLink from the receive ring
+        SESSION_STEP,       //one AT command step of an SBD session
+        MODEM_BEGIN,        //IridiumSBD::begin()
+        SIGNAL_QUALITY,     //IridiumSBD::getSignalQuality()
+        TASK_FIRST
+    };
+
+    //The most scheduler tasks that are timed.
+    static const uint8_t maxTasks = 16;
+
+    //The number of probes.
+    static const uint8_t probeCount = TASK_FIRST + maxTasks;
+
+    /**
+     * Times a block of code from its construction to the end of its scope.
+     */
+    class Scope {
+    public:
+        /**
+         * Start timing.
+         * @param profiler - the profiler the run is recorded in.
+         * @param probe - the probe of the run.
+         */
+        Scope(LatencyProfiler &profiler, Probe probe);
+
+        /**
+         * Stop timing and record the run.
+         */
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        LatencyProfiler &profiler;
+        Probe probe;
+        uint32_t start;
+    };
+
+    /**
+     * Default constructor.
+     */
+    LatencyProfiler() = default;
+
+    /**
+     * Record a run of a probe.
+     * @param probe - the probe.
+     * @param micros - the runtime of the run.
+     */
+    void record(uint8_t probe, uint32_t micros);
+
+    /**
+     * Record a run of a scheduler task, see DeadlineScheduler::observeRuns().
+     * @param task - the id of the task.
+     * @param micros - the runtime of the run.
+     */
+    void recordTask(uint8_t task, uint32_t micros);
+
+    /**
+     * Name a scheduler task in the report.
+     * @param task - the id of the task, nothing happens for -1.
+     * @param name - the name, a string literal.
+     */
+    void nameTask(int task, const char *name);
+
+    /**
+     * Log min, p50, p99 and max of every probe that ran since the last report, remember the worst of them for
+     * worstProbe(), worstMicros() and loopP99Micros(), then start a new period.
+     */
+    void report();
+
+    /**
+     * The histogram of a probe in the current period.
+     * @param probe - the probe.
+     * @return const LatencyHistogram& - the histogram.
+     */
+    const LatencyHistogram &histogram(uint8_t probe) const;
+
+    /**
+     * The name of a probe.
+     * @param probe - the probe.
+     * @return const char* - the name.
+     */
+    const char *name(uint8_t probe) const;
+
+    /**
+     * The probe with the longest run in the last report period.
+     * @return uint8_t - the probe.
+     */
+    uint8_t worstProbe() const;
+
+    /**
+     * The longest run of any probe in the last report period.
+     * @return uint32_t - the runtime in us.
+     */
+    uint32_t worstMicros() const;
+
+    /**
+     * The 99th percentile of loop() in the last report period.
+     * @return uint32_t - the runtime in us.
+     */
+    uint32_t loopP99Micros() const;
+
+private:
+    LatencyHistogram histograms[probeCount];
+
+    //The names of the scheduler tasks, nullptr if not named.
+    const char *taskNames[maxTasks]{};
+
+    //The worst of the last report period.
+    uint8_t lastWorstProbe = LOOP;
+    uint32_t lastWorstMicros = 0;
+    uint32_t lastLoopP99Micros = 0;
+};
+
+//The profiler every probe records into.
+extern LatencyProfiler latencyProfiler;
+
+#endif //AERORADAREMBEDDED_LATENCYPROFILER_H
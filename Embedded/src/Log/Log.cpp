@@ -0,0 +1,372 @@
+/**
+* @File: Log.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the LogRing class. A record in the ring is its size (2 bytes),
+ * the level, the category, millis() (4 bytes), the address of the format string, the number of arguments and then
+ * every argument as a type byte followed by 4 bytes for an integer, 8 bytes for a float or the characters of a string
+ * with their terminating null. Records are written and dropped whole with interrupts disabled, so an interrupt may log
+ * while the main loop logs or flushes.
+*/
+
+#include "Log.h"
+#include <Arduino.h>
+#include <string.h>
+#include "FixedString/FixedString.h"
+
+//The ring every LOG_ macro writes to.
+LogRing logRing;
+
+void logFormatCheck(const char *format, ...) {
+    //only there for the format attribute, an unoptimized build may still reference it
+}
+
+//The fixed part of a record: size, level, category, time, format and number of arguments.
+static const size_t headerSize = 2 + 1 + 1 + 4 + sizeof(const char *) + 1;
+
+//The largest record, a message with longer strings has them cut off to fit.
+static const size_t maxRecordSize = 320;
+
+//The longest formatted message, longer ones are cut off.
+static const size_t maxLineLength = 320;
+
+/**
+ * Disable interrupts, also when called from an interrupt handler.
+ * @return uint32_t - the interrupt mask to restore.
+ */
+static inline uint32_t lockRing() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+/**
+ * Restore the interrupt mask from before lockRing().
+ * @param primask - the interrupt mask.
+ */
+static inline void unlockRing(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+//The letter of every level in a formatted message, indexed by the level.
+static const char levelLetters[] = {'-', 'E', 'W', 'I', 'D'};
+
+/**
+ * The name of the category of a message.
+ * @param category - the category.
+ * @return const char* - the name.
+ */
+static const char *categoryName(uint8_t category) {
+    switch (category) {
+        case LOG_SYSTEM:
+            return "system";
+        case LOG_BOOT:
+            return "boot";
+        case LOG_MAVLINK:
+            return "mavlink";
+        case LOG_SATELLITE:
+            return "satellite";
+        case LOG_CONFIG:
+            return "config";
+        default:
+            return "log";
+    }
+}
+
+/**
+ * The number of bytes an argument takes in a record.
+ * @param argument - the argument.
+ * @param stringLength - the length a string is cut off at, set for a string argument.
+ * @param room - the bytes left in the record.
+ * @return size_t - the size of the argument including its type byte.
+ */
+static size_t argumentSize(const LogRing::Argument &argument, size_t &stringLength, size_t room) {
+    switch (argument.type) {
+        case LogRing::Argument::FLOAT:
+            return 1 + sizeof(double);
+        case LogRing::Argument::STRING: {
+            size_t length = argument.s == nullptr ? 0 : strlen(argument.s);
+            if (length > LogRing::maxStringLength) {
+                length = LogRing::maxStringLength;
+            }
+            //a string is cut off to fit into the record, the type byte and the null always fit
+            if (1 + length + 1 > room) {
+                length = room >= 2 ? room - 2 : 0;
+            }
+            stringLength = length;
+            return 1 + length + 1;
+        }
+        default:
+            return 1 + 4;
+    }
+}
+
+void LogRing::writeRecord(uint8_t level, uint8_t category, const char *format, const Argument *arguments,
+                          size_t count) {
+
+    //work out the size first, so that the ring is only locked for the copy
+    size_t stringLengths[maxArguments];
+    size_t size = headerSize;
+    for (size_t i = 0; i < count; i++) {
+        //every argument that follows needs at least its type byte and a null
+        size_t reserve = 2 * (count - i - 1);
+        size_t room = maxRecordSize > size + reserve ? maxRecordSize - size - reserve : 0;
+        size += argumentSize(arguments[i], stringLengths[i], room);
+    }
+    uint32_t now = millis();
+    uint8_t argumentCount = (uint8_t) count;
+    uint16_t recordSize = (uint16_t) size;
+
+    uint32_t primask = lockRing();
+
+    //drop the oldest records until the new one fits
+    while ((uint16_t) (capacity - (uint16_t) (head - tail)) < size) {
+        tail = (uint16_t) (tail + this->recordSize(tail));
+        dropped = dropped + 1;
+    }
+
+    uint16_t index = head;
+    copyIn(index, &recordSize, 2);
+    copyIn(index + 2, &level, 1);
+    copyIn(index + 3, &category, 1);
+    copyIn(index + 4, &now, 4);
+    copyIn(index + 8, &format, sizeof(format));
+    copyIn(index + 8 + sizeof(format), &argumentCount, 1);
+    index = (uint16_t) (index + headerSize);
+
+    for (size_t i = 0; i < count; i++) {
+        const Argument &argument = arguments[i];
+        uint8_t type = argument.type;
+        copyIn(index, &type, 1);
+        index++;
+        switch (argument.type) {
+            case Argument::FLOAT:
+                copyIn(index, &argument.f, sizeof(double));
+                index = (uint16_t) (index + sizeof(double));
+                break;
+            case Argument::STRING: {
+                static const char terminator = '\0';
+                if (stringLengths[i] > 0) {
+                    copyIn(index, argument.s, stringLengths[i]);
+                }
+                copyIn((uint16_t) (index + stringLengths[i]), &terminator, 1);
+                index = (uint16_t) (index + stringLengths[i] + 1);
+                break;
+            }
+            default:
+                copyIn(index, &argument.u, 4);
+                index = (uint16_t) (index + 4);
+                break;
+        }
+    }
+    head = index;
+
+    unlockRing(primask);
+}
+
+bool LogRing::peek(TextBuffer &line) {
+    line.clear();
+
+    //copy the oldest record out, the ring may change while it is formatted
+    uint8_t record[maxRecordSize];
+    uint32_t primask = lockRing();
+    if (head == tail) {
+        unlockRing(primask);
+        return false;
+    }
+    uint16_t size = recordSize(tail);
+    copyOut(tail, record, size);
+    peeked = tail;
+    peekPending = true;
+    unlockRing(primask);
+
+    //the header
+    uint8_t level = record[2];
+    uint8_t category = record[3];
+    uint32_t millis;
+    const char *format;
+    memcpy(&millis, record + 4, 4);
+    memcpy(&format, record + 8, sizeof(format));
+    uint8_t count = record[8 + sizeof(format)];
+
+    //the arguments, strings point into the copy of the record
+    Argument arguments[maxArguments];
+    const uint8_t *position = record + headerSize;
+    for (uint8_t i = 0; i < count && i < maxArguments; i++) {
+        Argument::Type type = (Argument::Type) *position++;
+        arguments[i].type = type;
+        switch (type) {
+            case Argument::FLOAT:
+                memcpy(&arguments[i].f, position, sizeof(double));
+                position += sizeof(double);
+                break;
+            case Argument::STRING:
+                arguments[i].s = (const char *) position;
+                position += strlen((const char *) position) + 1;
+                break;
+            default:
+                memcpy(&arguments[i].u, position, 4);
+                position += 4;
+                break;
+        }
+    }
+
+    line.appendf("%lu.%03lu %c %s: ", (unsigned long) (millis / 1000), (unsigned long) (millis % 1000),
+                 level < sizeof(levelLetters) ? levelLetters[level] : '?', categoryName(category));
+
+    //format the message one conversion at a time, every conversion takes its stored argument
+    uint8_t next = 0;
+    const char *p = format;
+    while (*p != '\0') {
+        const char *percent = strchr(p, '%');
+        if (percent == nullptr) {
+            line.append(p);
+            break;
+        }
+        if (percent > p) {
+            line.appendf("%.*s", (int) (percent - p), p);
+        }
+        p = percent + 1;
+        if (*p == '%') {
+            line.append('%');
+            p++;
+            continue;
+        }
+
+        //copy the flags, width and precision, and skip the length modifiers, the arguments have their own size
+        char spec[16] = "%";
+        size_t specLength = 1;
+        int precision = -1;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr) {
+            if (*p == '.') {
+                precision = atoi(p + 1);
+            }
+            if (specLength < sizeof(spec) - 4) {
+                spec[specLength++] = *p;
+            }
+            p++;
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) {
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+
+        if (next >= count) {
+            line.append("?");
+            continue;
+        }
+        const Argument &argument = arguments[next++];
+        int32_t asSigned = argument.type == Argument::FLOAT ? (int32_t) argument.f : argument.i;
+        uint32_t asUnsigned = argument.type == Argument::FLOAT ? (uint32_t) argument.f : argument.u;
+
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                spec[specLength++] = 'l';
+                spec[specLength++] = 'd';
+                spec[specLength] = '\0';
+                line.appendf(spec, (long) (argument.type == Argument::STRING ? 0 : asSigned));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[specLength++] = 'l';
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                line.appendf(spec, (unsigned long) (argument.type == Argument::STRING ? 0 : asUnsigned));
+                break;
+            case 'c':
+                line.append((char) asUnsigned);
+                break;
+            case 's':
+                spec[specLength++] = 's';
+                spec[specLength] = '\0';
+                line.appendf(spec, argument.type == Argument::STRING ? argument.s : "?");
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'g':
+                if (argument.type == Argument::FLOAT) {
+                    line.appendFloat(argument.f, (uint8_t) (precision < 0 ? 6 : precision));
+                } else if (argument.type == Argument::SIGNED) {
+                    line.appendFloat(argument.i, (uint8_t) (precision < 0 ? 6 : precision));
+                } else {
+                    line.appendFloat(argument.u, (uint8_t) (precision < 0 ? 6 : precision));
+                }
+                break;
+            default:
+                line.append("?");
+                break;
+        }
+    }
+    return true;
+}
+
+void LogRing::pop() {
+    uint32_t primask = lockRing();
+    if (peekPending && head != tail && tail == peeked) {
+        tail = (uint16_t) (tail + recordSize(tail));
+    }
+    peekPending = false;
+    unlockRing(primask);
+}
+
+size_t LogRing::flush(Print &out, size_t room) {
+    size_t written = 0;
+    FixedString<maxLineLength> line;
+
+    //messages lost since the last flush are reported first
+    uint32_t drops = dropped;
+    if (drops != reportedDrops) {
+        line.appendf("%lu log messages dropped", (unsigned long) (drops - reportedDrops));
+        out.println(line.c_str());
+        room = room > line.length() + 2 ? room - line.length() - 2 : 0;
+        reportedDrops = drops;
+    }
+
+    /*
+     * Write the messages that fit. A host drains the USB buffer within a frame, so the first message is written even
+     * if it is longer than the room, otherwise a long message would never go.
+     */
+    while (peek(line)) {
+        size_t length = line.length() + 2;
+        if (written > 0 && length > room) {
+            break;
+        }
+        out.println(line.c_str());
+        room = room > length ? room - length : 0;
+        pop();
+        written++;
+    }
+    return written;
+}
+
+uint32_t LogRing::droppedCount() const {
+    return dropped;
+}
+
+void LogRing::copyIn(uint16_t index, const void *data, size_t length) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    for (size_t i = 0; i < length; i++) {
+        buffer[(uint16_t) (index + i) & (capacity - 1)] = bytes[i];
+    }
+}
+
+void LogRing::copyOut(uint16_t index, void *data, size_t length) const {
+    uint8_t *bytes = (uint8_t *) data;
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = buffer[(uint16_t) (index + i) & (capacity - 1)];
+    }
+}
+
+uint16_t LogRing::recordSize(uint16_t index) const {
+    uint16_t size;
+    copyOut(index, &size, 2);
+    return size;
+}
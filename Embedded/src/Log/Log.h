@@ -0,0 +1,242 @@
+/**
+* @File: Log.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the logging of the firmware. A message has a level and a category, and both
+ * are filtered at compile time: LOG_LEVEL and LOG_CATEGORIES default to the values below and can be set from the
+ * build_flags in platformio.ini. A message that is filtered out compiles to nothing, its arguments are not even
+ * evaluated.
+ *
+ * A message that is kept is not formatted where it is logged. The LOG_ macros store the format string, the time and
+ * the raw arguments in logRing, a binary ring buffer, which takes a few microseconds and is safe in an interrupt.
+ * LogRing::flush() formats the messages and writes them to the USB serial port, but only while a host has the port
+ * open and only as much as fits into the USB buffer, so logging never blocks and a device in flight, where no host
+ * is attached, never spends a cycle on formatting. When the ring is full the oldest messages are dropped.
+ *
+ * The format string follows printf and must be a string literal, it is only read when the message is formatted. The
+ * conversions d, i, u, x, X, o, c, s and f are supported; integers are stored with 32 bits, so 64-bit arguments do not
+ * compile, and strings are copied into the ring, cut off after maxStringLength characters. Floats use %f or %.Nf, which
+ * printf on the board does not have.
+*/
+
+#ifndef AERORADAREMBEDDED_LOG_H
+#define AERORADAREMBEDDED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//The levels of a message, a build keeps the messages up to LOG_LEVEL.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+//The categories of a message, a build keeps the messages of the categories in LOG_CATEGORIES.
+#define LOG_SYSTEM 0x01u
+#define LOG_BOOT 0x02u
+#define LOG_MAVLINK 0x04u
+#define LOG_SATELLITE 0x08u
+#define LOG_CONFIG 0x10u
+#define LOG_ALL 0xFFu
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES LOG_ALL
+#endif
+
+//Whether a message of a level and category is kept by this build, a constant expression.
+#define LOG_ENABLED(level, category) ((level) <= LOG_LEVEL && ((category) & LOG_CATEGORIES) != 0)
+
+/**
+ * Never called, it only lets the compiler check the arguments of a LOG_ macro against its format.
+ * @param format - the format string.
+ */
+void logFormatCheck(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+//Log a message: LOG_INFO(LOG_SATELLITE, "Session used %lu bytes", bytes).
+#define LOG_AT(level, category, ...)                                                                                   \
+    do {                                                                                                               \
+        if (LOG_ENABLED(level, category)) {                                                                            \
+            logRing.write(level, category, __VA_ARGS__);                                                               \
+        }                                                                                                              \
+        if (false) {                                                                                                   \
+            logFormatCheck(__VA_ARGS__);                                                                               \
+        }                                                                                                              \
+    } while (false)
+
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+
+class Print;
+class TextBuffer;
+
+/**
+ * A ring buffer of binary log records, written by the LOG_ macros from anywhere, including interrupts, and formatted
+ * by flush() from the main loop.
+ */
+class LogRing {
+
+public:
+    //The number of bytes the ring can hold, about 60 short messages.
+    static const uint16_t capacity = 2048;
+
+    //The longest string argument that is kept, longer ones are cut off.
+    static const uint8_t maxStringLength = 255;
+
+    //The most arguments a message may have.
+    static const uint8_t maxArguments = 12;
+
+    /**
+     * One argument of a message, converted from its C++ type.
+     */
+    struct Argument {
+        enum Type : uint8_t {
+            SIGNED,
+            UNSIGNED,
+            FLOAT,
+            STRING
+        };
+
+        Type type;
+        union {
+            int32_t i;
+            uint32_t u;
+            double f;
+            const char *s;
+        };
+
+        Argument() : type(UNSIGNED), u(0) {}
+        Argument(char value) : type(SIGNED), i(value) {}
+        Argument(signed char value) : type(SIGNED), i(value) {}
+        Argument(short value) : type(SIGNED), i(value) {}
+        Argument(int value) : type(SIGNED), i(value) {}
+        Argument(long value) : type(SIGNED), i((int32_t) value) {}
+        Argument(bool value) : type(UNSIGNED), u(value) {}
+        Argument(unsigned char value) : type(UNSIGNED), u(value) {}
+        Argument(unsigned short value) : type(UNSIGNED), u(value) {}
+        Argument(unsigned int value) : type(UNSIGNED), u(value) {}
+        Argument(unsigned long value) : type(UNSIGNED), u((uint32_t) value) {}
+        //records hold 32-bit integers, so 64-bit values do not compile rather than being cut off silently; cast a value
+        // that fits, or log a larger one in two halves
+        Argument(long long value) = delete;
+        Argument(unsigned long long value) = delete;
+        Argument(float value) : type(FLOAT), f(value) {}
+        Argument(double value) : type(FLOAT), f(value) {}
+        Argument(const char *value) : type(STRING), s(value) {}
+    };
+
+    /**
+     * Default constructor.
+     */
+    LogRing() = default;
+
+    /**
+     * Store a message without arguments. Called by the LOG_ macros.
+     * @param level - the level of the message.
+     * @param category - the category of the message.
+     * @param format - the format string, a string literal.
+     */
+    void write(uint8_t level, uint8_t category, const char *format) {
+        writeRecord(level, category, format, nullptr, 0);
+    }
+
+    /**
+     * Store a message. Called by the LOG_ macros.
+     * @param level - the level of the message.
+     * @param category - the category of the message.
+     * @param format - the format string, a string literal.
+     * @param args - the arguments of the message.
+     */
+    template<typename... Args>
+    void write(uint8_t level, uint8_t category, const char *format, Args... args) {
+        static_assert(sizeof...(Args) <= maxArguments, "too many arguments for a log message");
+        const Argument arguments[] = {Argument(args)...};
+        writeRecord(level, category, format, arguments, sizeof...(Args));
+    }
+
+    /**
+     * Format the stored messages and write them to an output, oldest first, while the output has room for them.
+     * @param out - where the messages are written, e.g. Serial.
+     * @param room - the number of bytes the output takes without blocking.
+     * @return size_t - the number of messages written.
+     */
+    size_t flush(Print &out, size_t room);
+
+    /**
+     * Format the oldest message into a line. The message stays in the ring.
+     * @param line - cleared, then set to the formatted message without a line break.
+     * @return bool - false if the ring is empty.
+     */
+    bool peek(TextBuffer &line);
+
+    /**
+     * Remove the message formatted by the last peek(), unless it was dropped in the meantime.
+     */
+    void pop();
+
+    /**
+     * The number of messages dropped because the ring was full.
+     * @return uint32_t - the drop counter.
+     */
+    uint32_t droppedCount() const;
+
+private:
+    /**
+     * Encode a message into the ring, dropping the oldest messages to make room.
+     * @param level - the level of the message.
+     * @param category - the category of the message.
+     * @param format - the format string.
+     * @param arguments - the arguments.
+     * @param count - the number of arguments.
+     */
+    void writeRecord(uint8_t level, uint8_t category, const char *format, const Argument *arguments, size_t count);
+
+    /**
+     * Copy bytes into the ring at an index, wrapping around its end.
+     * @param index - the free-running index to write at.
+     * @param data - the bytes.
+     * @param length - the number of bytes.
+     */
+    void copyIn(uint16_t index, const void *data, size_t length);
+
+    /**
+     * Copy bytes out of the ring at an index, wrapping around its end.
+     * @param index - the free-running index to read at.
+     * @param data - where the bytes go.
+     * @param length - the number of bytes.
+     */
+    void copyOut(uint16_t index, void *data, size_t length) const;
+
+    /**
+     * The size of the record at an index.
+     * @param index - the free-running index of the record.
+     * @return uint16_t - the number of bytes of the record.
+     */
+    uint16_t recordSize(uint16_t index) const;
+
+    //The records, indexed by the free-running head and tail counters masked to the capacity.
+    uint8_t buffer[capacity]{};
+
+    //The index of the next byte to be written, and of the oldest record.
+    volatile uint16_t head = 0;
+    volatile uint16_t tail = 0;
+
+    //The number of messages dropped to make room, and how many of them flush() has reported.
+    volatile uint32_t dropped = 0;
+    uint32_t reportedDrops = 0;
+
+    //The index of the message formatted by the last peek().
+    uint16_t peeked = 0;
+    bool peekPending = false;
+};
+
+//The ring every LOG_ macro writes to.
+extern LogRing logRing;
+
+#endif //AERORADAREMBEDDED_LOG_H
@@ -0,0 +1,145 @@
+/**
+* @File: MavlinkFramer.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the MavlinkFramer class.
+*/
+
+#include "MavlinkFramer.h"
+
+//The length of a MAVLink v1 header, start marker included.
+static const uint8_t headerLengthV1 = 6;
+
+//The length of a MAVLink v2 header, start marker included.
+static const uint8_t headerLengthV2 = MAVLINK_CORE_HEADER_LEN + 1;
+
+MavlinkFramer::MavlinkFramer(uint8_t channel) : channel(channel) {
+}
+
+bool MavlinkFramer::subscribe(uint32_t messageId) {
+    if (messageId > maxSubscribedId) {
+        return false;
+    }
+    subscriptions[messageId >> 3] |= (uint8_t) (1 << (messageId & 7));
+    return true;
+}
+
+void MavlinkFramer::unsubscribe(uint32_t messageId) {
+    if (messageId <= maxSubscribedId) {
+        subscriptions[messageId >> 3] &= (uint8_t) ~(1 << (messageId & 7));
+    }
+}
+
+bool MavlinkFramer::isSubscribed(uint32_t messageId) const {
+    return messageId <= maxSubscribedId && (subscriptions[messageId >> 3] & (1 << (messageId & 7))) != 0;
+}
+
+MavlinkFramer::Result MavlinkFramer::feed(uint8_t c, mavlink_message_t &msg) {
+    switch (state) {
+        case IDLE:
+            //anything between frames is noise
+            if (c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1) {
+                headerBytes[0] = c;
+                headerLength = 1;
+                headerNeeded = c == MAVLINK_STX ? headerLengthV2 : headerLengthV1;
+                state = HEADER;
+            }
+            return NONE;
+
+        case HEADER: {
+            headerBytes[headerLength++] = c;
+            if (headerLength < headerNeeded) {
+                return NONE;
+            }
+            Result result = onHeader();
+            //a subscribed frame gets its header replayed into the parser, which starts afresh at every frame
+            if (state == PASS) {
+                mavlink_reset_channel_status(channel);
+                for (uint8_t i = 0; i < headerLength; i++) {
+                    mavlink_parse_char(channel, headerBytes[i], &msg, &status);
+                }
+            }
+            return result;
+        }
+
+        case PASS:
+            return pass(c, msg);
+
+        case SKIP:
+            skipped(1);
+            return NONE;
+    }
+    return NONE;
+}
+
+uint16_t MavlinkFramer::pendingSkip() const {
+    return state == SKIP ? remaining : 0;
+}
+
+void MavlinkFramer::skipped(uint16_t count) {
+    if (state != SKIP) {
+        return;
+    }
+    if (count > remaining) {
+        count = remaining;
+    }
+    remaining -= count;
+    bytesSkipped += count;
+    if (remaining == 0) {
+        state = IDLE;
+    }
+}
+
+const MavlinkFramer::Header &MavlinkFramer::header() const {
+    return latest;
+}
+
+uint32_t MavlinkFramer::skippedFrames() const {
+    return framesSkipped;
+}
+
+uint32_t MavlinkFramer::skippedBytes() const {
+    return bytesSkipped;
+}
+
+MavlinkFramer::Result MavlinkFramer::onHeader() {
+
+    //v1: STX, length, sequence, system, component, message ID
+    //v2: STX, length, incompatibility flags, compatibility flags, sequence, system, component, 3 byte message ID
+    bool v2 = headerBytes[0] == MAVLINK_STX;
+    latest.payloadLength = headerBytes[1];
+    if (v2) {
+        latest.systemId = headerBytes[5];
+        latest.componentId = headerBytes[6];
+        latest.messageId = headerBytes[7] | ((uint32_t) headerBytes[8] << 8) | ((uint32_t) headerBytes[9] << 16);
+    } else {
+        latest.systemId = headerBytes[3];
+        latest.componentId = headerBytes[4];
+        latest.messageId = headerBytes[5];
+    }
+
+    //the payload, the CRC and the signature of a signed v2 frame follow the header
+    remaining = latest.payloadLength + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (v2 && (headerBytes[2] & MAVLINK_IFLAG_SIGNED)) {
+        remaining += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+
+    if (isSubscribed(latest.messageId)) {
+        state = PASS;
+        return NONE;
+    }
+    state = SKIP;
+    framesSkipped++;
+    bytesSkipped += headerLength;
+    return SKIPPED;
+}
+
+MavlinkFramer::Result MavlinkFramer::pass(uint8_t c, mavlink_message_t &msg) {
+    remaining--;
+    bool parsed = mavlink_parse_char(channel, c, &msg, &status) != 0;
+    //the frame ends with its last byte whether or not the CRC matched
+    if (remaining == 0) {
+        state = IDLE;
+    }
+    return parsed ? FRAME : NONE;
+}
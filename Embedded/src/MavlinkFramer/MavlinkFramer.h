@@ -0,0 +1,178 @@
+/**
+* @File: MavlinkFramer.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the MavlinkFramer class, a pre-filter in front of mavlink_parse_char. The
+ * Pixhawk streams dozens of message types and only a handful are used, but the MAVLink parser runs its per-byte state
+ * machine and CRC over every frame and copies each one into a 280 byte mavlink_message_t. The framer only reads the
+ * MAVLink v1 or v2 header of a frame and looks its message ID up in a subscription bitmap:
+ * - a subscribed frame is passed byte by byte to mavlink_parse_char, which checks its CRC and decodes it as before,
+ * - any other frame is skipped, the caller can fast-forward the receive ring past its payload in one step, and only
+ *   its header is reported, so that stream rates can still be observed.
+ * A skipped frame's CRC is never checked, so a corrupted length byte can cost the rest of at most one frame before
+ * the framer finds the next start marker again.
+*/
+
+#ifndef AERORADAREMBEDDED_MAVLINKFRAMER_H
+#define AERORADAREMBEDDED_MAVLINKFRAMER_H
+
+#include "Arduino.h"
+
+#undef F
+
+#include "standard/mavlink.h"
+
+#undef F
+
+/**
+ * Splits the byte stream from the Pixhawk into frames and only parses the subscribed ones.
+ */
+class MavlinkFramer {
+
+public:
+    /**
+     * What a byte fed to the framer completed.
+     */
+    enum Result : uint8_t {
+        //nothing yet
+        NONE = 0,
+        //a subscribed frame was parsed and its CRC matched, it is in the message passed to feed()
+        FRAME,
+        //the header of a frame that is not subscribed was read, the rest of the frame is skipped
+        SKIPPED
+    };
+
+    /**
+     * The header of the latest frame.
+     */
+    struct Header {
+        uint32_t messageId;
+        uint8_t systemId;
+        uint8_t componentId;
+        uint8_t payloadLength;
+    };
+
+    //The largest message ID that can be subscribed to. Every message the Blackbox uses has a MAVLink v1 ID.
+    static const uint16_t maxSubscribedId = 255;
+
+    /**
+     * Constructor
+     * @param channel - the MAVLink channel whose parser the subscribed frames are passed to.
+     */
+    explicit MavlinkFramer(uint8_t channel = MAVLINK_COMM_0);
+
+    /**
+     * Have the frames of a message parsed.
+     * @param messageId - the ID of the message.
+     * @return bool - true if the message is subscribed, false if its ID is above maxSubscribedId.
+     */
+    bool subscribe(uint32_t messageId);
+
+    /**
+     * Have the frames of a message skipped.
+     * @param messageId - the ID of the message.
+     */
+    void unsubscribe(uint32_t messageId);
+
+    /**
+     * Whether the frames of a message are parsed.
+     * @param messageId - the ID of the message.
+     * @return bool - true if the message is subscribed, false otherwise.
+     */
+    bool isSubscribed(uint32_t messageId) const;
+
+    /**
+     * Take the next byte of the stream.
+     * @param c - the byte.
+     * @param msg - set to the parsed message when FRAME is returned.
+     * @return Result - what the byte completed.
+     */
+    Result feed(uint8_t c, mavlink_message_t &msg);
+
+    /**
+     * The number of bytes of a skipped frame that are still to come. The caller may throw them away without feeding
+     * them, and report them with skipped().
+     * @return uint16_t - the number of bytes left to skip.
+     */
+    uint16_t pendingSkip() const;
+
+    /**
+     * Report bytes of a skipped frame that were thrown away instead of fed.
+     * @param count - the number of bytes, at most pendingSkip().
+     */
+    void skipped(uint16_t count);
+
+    /**
+     * The header of the latest frame, valid once feed() has returned FRAME or SKIPPED.
+     * @return const Header& - the header.
+     */
+    const Header &header() const;
+
+    /**
+     * The number of frames skipped since boot.
+     * @return uint32_t - the skipped frame counter.
+     */
+    uint32_t skippedFrames() const;
+
+    /**
+     * The number of bytes skipped since boot, headers included.
+     * @return uint32_t - the skipped byte counter.
+     */
+    uint32_t skippedBytes() const;
+
+private:
+
+    /**
+     * Where the framer is within a frame.
+     */
+    enum State : uint8_t {
+        //looking for the start marker of a frame
+        IDLE = 0,
+        //collecting the header
+        HEADER,
+        //passing a subscribed frame to the MAVLink parser
+        PASS,
+        //skipping a frame that is not subscribed
+        SKIP
+    };
+
+    /**
+     * Decide what to do with a frame once its header is complete.
+     * @return Result - SKIPPED if the frame is skipped, NONE if it is passed to the parser.
+     */
+    Result onHeader();
+
+    /**
+     * Pass a byte of a subscribed frame to the MAVLink parser.
+     * @param c - the byte.
+     * @param msg - set to the parsed message.
+     * @return Result - FRAME if the byte completed a frame with a matching CRC, NONE otherwise.
+     */
+    Result pass(uint8_t c, mavlink_message_t &msg);
+
+    //The MAVLink channel of the parser.
+    uint8_t channel;
+
+    //One bit per subscribed message ID.
+    uint8_t subscriptions[(maxSubscribedId + 1) / 8]{};
+
+    State state = IDLE;
+
+    //The header bytes of the current frame, start marker included.
+    uint8_t headerBytes[MAVLINK_CORE_HEADER_LEN + 1]{};
+    uint8_t headerLength = 0;
+    uint8_t headerNeeded = 0;
+
+    //The number of bytes of the current frame after its header still to come.
+    uint16_t remaining = 0;
+
+    //The parser state, passed to mavlink_parse_char.
+    mavlink_status_t status{};
+
+    Header latest{};
+
+    uint32_t framesSkipped = 0;
+    uint32_t bytesSkipped = 0;
+};
+
+#endif //AERORADAREMBEDDED_MAVLINKFRAMER_H
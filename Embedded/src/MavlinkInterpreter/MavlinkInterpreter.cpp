@@ -10,41 +10,44 @@
 */
 
 #include "MavlinkInterpreter.h"
+#include "Log/Log.h"
 
 //create a buffer to hold the mavlink message
 uint8_t defaultBuffer[MAVLINK_MAX_PACKET_LEN];
 
-//create a vector to hold the IDs of requested messages
-std::vector<uint8_t> messageIDVector = {};
-
 
 //define the serial connection between the arduino and Pixhawk
 #define SerialMAV Serial1
 
+/**
+ * Write a command of the stream rate manager to the Pixhawk.
+ * @param msg - the packed command.
+ * @param context - unused.
+ */
+static void writeToPixhawk(const mavlink_message_t &msg, void *context) {
+    uint16_t len = mavlink_msg_to_send_buffer(defaultBuffer, &msg);
+    SerialMAV.write(defaultBuffer, len);
+}
 
-boolean MavlinkInterpreter::messageRequested(int value) {
 
-    //loop through the vector of requested message IDs
-    for (int id: messageIDVector) {
-        //if the ID is found, return true
-        if (id == value) {
-            return true;
-        }
-    }
+boolean MavlinkInterpreter::messageRequested(int value) {
 
-    //if the ID is not found, return false
-    return false;
+    //a requested message is one whose frames the framer parses into the telemetry store
+    return value >= 0 && framer.isSubscribed((uint32_t) value) && TelemetryStore::supports((uint32_t) value);
 }
 
 MavlinkInterpreter::MavlinkInterpreter() {
-    // implementation of default constructor
+    subscribeRateNegotiation();
 }
 
 MavlinkInterpreter::MavlinkInterpreter(long baudRate) {
 
     //initialize the serial connection between the arduino and Pixhawk
     SerialMAV.begin(baudRate);
-    Serial.println("MavlinkInterpreter initialized");
+    subscribeRateNegotiation();
+    //move the UART receive interrupt over to the large receive ring so bytes survive a blocked main loop
+    attachMavlinkRxRing();
+    LOG_INFO(LOG_MAVLINK, "MavlinkInterpreter initialized");
 
 }
 
@@ -59,150 +62,162 @@ void MavlinkInterpreter::requestMavlinkMessages(std::vector<uint8_t> messageIDs)
 
 }
 
-void MavlinkInterpreter::requestMavlinkMessage(uint8_t messageID) {
-
-    //if the message has not previously been requested, add it to the vector of requested messages
-    if (!messageRequested(messageID)) {
-        messageIDVector.push_back(messageID);
-    }
+void MavlinkInterpreter::requestMavlinkMessage(uint8_t messageID, uint32_t intervalMillis) {
 
-    //create a mavlink message and length variable
-    mavlink_message_t msg;
-    uint16_t len;
+    //the frames of the message are parsed from now on, the interval is sent once the autopilot is known, and only if it changed
+    framer.subscribe(messageID);
+    streamRates.request(messageID, intervalMillis);
+}
 
-    //pack the message and send it to the Pixhawk
-    mavlink_msg_request_data_stream_pack(1, 200, &msg, 1, 1, messageID, 1, 1);
-    len = mavlink_msg_to_send_buffer(defaultBuffer, &msg);
-    SerialMAV.write(defaultBuffer, len);
+void MavlinkInterpreter::releaseMavlinkMessage(uint8_t messageID) {
 
+    //ask the Pixhawk to stop sending the message
+    framer.unsubscribe(messageID);
+    streamRates.release(messageID);
 }
 
-String MavlinkInterpreter::toANSI(mavlink_message_t msg) {
+bool MavlinkInterpreter::toANSI(uint32_t messageID, TextBuffer &json) const {
+    json.clear();
 
-    //if the message is empty, return an empty string
-    if (msg.len == 0) {
-        return "Empty Message";
+    //if the message never arrived, return an empty message
+    if (store.sequence(messageID) == 0) {
+        return json.append("Empty Message");
     }
 
-    //create a string to hold the JSON
-    String json = "not implemented";
-
-
     //switch on the message ID
-    switch (msg.msgid) {
-        //if the message ID is 30, decode it as a MAVLINK_MSG_ID_ATTITUDE message
+    switch (messageID) {
+        //if the message ID is 30, read the latest MAVLINK_MSG_ID_ATTITUDE message
         case MAVLINK_MSG_ID_ATTITUDE: {
 
-            //decode the message
-            mavlink_attitude_t attitude;
-            mavlink_msg_attitude_decode(&msg, &attitude);
+            //the message is already decoded
+            const mavlink_attitude_t &attitude = store.attitude().value;
 
             //create the JSON string
-            json = "\"roll\": " + String(attitude.roll, 5) + ", \"pitch\": " + String(attitude.pitch, 5) +
-                   ", \"yaw\": " + String(attitude.yaw, 5) + "";
+            json.append("\"roll\": ");
+            json.appendFloat(attitude.roll, 5);
+            json.append(", \"pitch\": ");
+            json.appendFloat(attitude.pitch, 5);
+            json.append(", \"yaw\": ");
+            json.appendFloat(attitude.yaw, 5);
             break;
         }
-        //if the message ID is 33, decode it as a MAVLINK_MSG_ID_GLOBAL_POSITION_INT message
+        //if the message ID is 33, read the latest MAVLINK_MSG_ID_GLOBAL_POSITION_INT message
         case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
-            //decode the message
-            mavlink_global_position_int_t global_position_int;
-            mavlink_msg_global_position_int_decode(&msg, &global_position_int);
+            //the message is already decoded
+            const mavlink_global_position_int_t &global_position_int = store.globalPosition().value;
 
             //create the JSON string
-            json = "\"heading\":" + String(global_position_int.hdg / 100.0) +
-                   ",\"altitude\":" + String(global_position_int.alt / 1000.0) + ",\"latitude\":" +
-                   String(double(global_position_int.lat)) + ",\"longitude\":" +
-                   String(double(global_position_int.lon)) + ",\"relative_altitude\":" +
-                   String(global_position_int.relative_alt / 1000.0) + ",\"groundSpeed\":" +
-                   String(global_position_int.vx / 100.0) + ",\"vy\":" +
-                   String(global_position_int.vy / 100.0) +
-                   ",\"vz\":" + String(global_position_int.vz / 100.0) + ",\"flightTime\":" +
-                   String(global_position_int.time_boot_ms / 1000.0) + "";
+            json.append("\"heading\":");
+            json.appendFloat(global_position_int.hdg / 100.0, 2);
+            json.append(",\"altitude\":");
+            json.appendFloat(global_position_int.alt / 1000.0, 2);
+            json.appendf(",\"latitude\":%ld,\"longitude\":%ld", (long) global_position_int.lat,
+                         (long) global_position_int.lon);
+            json.append(",\"relative_altitude\":");
+            json.appendFloat(global_position_int.relative_alt / 1000.0, 2);
+            json.append(",\"groundSpeed\":");
+            json.appendFloat(global_position_int.vx / 100.0, 2);
+            json.append(",\"vy\":");
+            json.appendFloat(global_position_int.vy / 100.0, 2);
+            json.append(",\"vz\":");
+            json.appendFloat(global_position_int.vz / 100.0, 2);
+            json.append(",\"flightTime\":");
+            json.appendFloat(global_position_int.time_boot_ms / 1000.0, 2);
             break;
         }
+        default:
+            json.append("not implemented");
+            break;
     }
 
-    //return the JSON string
-    return json;
+    return !json.truncated();
 }
 
-std::vector<mavlink_message_t> MavlinkInterpreter::receiveMavlinkMessages() {
-
-    //create an empty vector to hold the messages
-    std::vector<mavlink_message_t> messages = {};
-
-    //loop through the vector of requested message IDs
-    for (uint8_t messageID: messageIDVector) {
-        //wait for and receive the message. If the message is not received, the function will return an empty message
-        mavlink_message_t msg = receiveMavlinkMessage(messageID);
-        //add the message to the vector
-        messages.push_back(msg);
-    }
+const TelemetryStore &MavlinkInterpreter::telemetryStore() const {
+    return store;
+}
 
-    //return the vector of messages
-    return messages;
+unsigned long MavlinkInterpreter::receivedMillis(uint32_t messageID) {
+    return store.receivedMillis(messageID);
 }
 
-mavlink_message_t MavlinkInterpreter::receiveMavlinkMessage(uint32_t messageID) {
+int MavlinkInterpreter::demultiplexSerialStream() {
 
-    //create a boolean to hold whether a message has been received
-    bool messageReceived = false;
-    //create a constant to hold the maximum number of attempts to receive a message
-    const int maxAttempts = 10;
-    //create an integer to hold the number of attempts to receive a message
-    int attempts = 0;
+    //drain everything that is currently in the receive ring
+    return drainRxRing(SerialRxRing::capacity);
+}
 
+int MavlinkInterpreter::drainRxRing(size_t maxBytes) {
 
-    //loop until a message is received or the maximum number of attempts is reached
-    while (!messageReceived && attempts < maxAttempts) {
+    //the parser state is shared, so never re-enter a drain that is already running
+    if (draining) {
+        return 0;
+    }
+    draining = true;
 
-        //create a mavlink message and status variable
-        mavlink_message_t msg;
-        mavlink_status_t status;
+    //create a mavlink message
+    mavlink_message_t msg;
 
-        // create a long to hold the start time using the arduino millis function.
-        long start = millis();
+    //create an integer to hold the number of requested frames decoded into the telemetry store
+    int routed = 0;
 
-        //loop while the serial connection is open, the pixhawk is streaming, and a message has not been received
-        //THIS MAY BE REDUNDANT AND CAN BE REMOVED ASSUMING TESTING SHOWS IT IS NOT NEEDED
-        while (SerialMAV.available()) {
+    // create a long to hold the start time using the arduino millis function.
+    unsigned long start = millis();
 
+    //loop through the receive ring and parse the bytes into mavlink messages
+    uint8_t c;
+    for (size_t bytesRead = 0; bytesRead < maxBytes && mavlinkRxRing.pop(c); bytesRead++) {
 
-            //loop through the serial connection and parse the bytes into a mavlink message
-            while (SerialMAV.available()) {
+        //frame the byte. The framer keeps its state between calls, so a frame may be split across several drains.
+        MavlinkFramer::Result result = framer.feed(c, msg);
 
-                //read the next byte from the serial connection
-                uint8_t c = SerialMAV.read();
+        //a frame nobody subscribed to is only counted, and the ring is fast-forwarded past the rest of it
+        if (result == MavlinkFramer::SKIPPED) {
+            const MavlinkFramer::Header &header = framer.header();
+            streamRates.observe(header.messageId, header.systemId, header.componentId, millis());
+            size_t skip = framer.pendingSkip();
+            if (skip > maxBytes - bytesRead - 1) {
+                skip = maxBytes - bytesRead - 1;
+            }
+            skip = mavlinkRxRing.skip((uint16_t) skip);
+            framer.skipped((uint16_t) skip);
+            bytesRead += skip;
+        }
 
-                //parse the byte into a mavlink message
-                if (mavlink_parse_char(MAVLINK_COMM_0, c, &msg, &status)) {
+        //a subscribed frame has been parsed and its CRC checked
+        if (result == MavlinkFramer::FRAME) {
 
-                    //if the message is the requested message, return it
-                    if (messageRequested(msg.msgid) && msg.msgid == messageID) {
-                        return msg;
-                    }
-                    /*
-                     * if the message is not the requested message, increment the attempts counter and break out
-                     * of the loop.
-                     */
-                    else {
-                        attempts++;
-                        break;
-                    }
-                }
+            //let the rate manager discover the autopilot, match acknowledgements and observe the rates
+            streamRates.onMessage(msg, millis());
 
-                //if the loop has been running for more than 10 seconds, break out of the loop
-                if (millis() - start > 10000) {
-                    break;
-                }
+            //decode the message once into the telemetry store, over its older copy
+            if (store.write(msg, millis())) {
+                routed++;
             }
-
-
         }
 
-        //return an empty message
-        return mavlink_message_t{};
+        //if the drain has used up its time budget, leave the remaining bytes for the next drain
+        if (millis() - start > demultiplexTimeBudgetMillis) {
+            break;
+        }
     }
+
+    draining = false;
+    return routed;
+}
+
+uint32_t MavlinkInterpreter::rxOverflowCount() {
+    return mavlinkRxRing.overflowCount();
+}
+
+uint16_t MavlinkInterpreter::rxHighWaterMark() {
+    return mavlinkRxRing.highWaterMark();
 }
 
+void MavlinkInterpreter::subscribeRateNegotiation() {
 
+    //the rate manager discovers the autopilot from its HEARTBEAT and needs the answers to its commands
+    streamRates.setSender(writeToPixhawk, nullptr);
+    framer.subscribe(MAVLINK_MSG_ID_HEARTBEAT);
+    framer.subscribe(MAVLINK_MSG_ID_COMMAND_ACK);
+}
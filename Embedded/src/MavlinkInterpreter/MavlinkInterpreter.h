@@ -26,6 +26,11 @@
 #include <sstream>
 #include <iomanip>
 #include "mavlink_types.h"
+#include "SerialRxRing/SerialRxRing.h"
+#include "StreamRateManager/StreamRateManager.h"
+#include "MavlinkFramer/MavlinkFramer.h"
+#include "FixedString/FixedString.h"
+#include "TelemetryStore/TelemetryStore.h"
 
 /**
  * @description The MavlinkInterpreter class is responsible for communicating with the Pixhawk 6C via serial.
@@ -53,19 +58,28 @@ public:
     explicit MavlinkInterpreter(long baudRate);
 
     /**
-     * @description Request a mavlink message from the Pixhawk.
+     * @description Request a mavlink message from the Pixhawk. The interval is negotiated by streamRates once the
+     * autopilot has been heard from, so the request may be made before the Pixhawk is up.
      * @param messageID - the ID of the message to request.
+     * @param intervalMillis - the interval between two messages in milliseconds.
      */
-    void requestMavlinkMessage(uint8_t messageID);
+    void requestMavlinkMessage(uint8_t messageID, uint32_t intervalMillis = 1000);
 
     /**
-     * @description Decode a mavlink message into a json string. It is important to note that this message is only
-     * capable of decoding a subset of mavlink messages. To add more, simply add more cases to the switch statement.
-     * This method is to be used for debugging purposes only.
-     * @param msg - the mavlink message to decode.
-     * @return String - A JSON string representation of the mavlink message.
+     * Ask the Pixhawk to stop sending a message and stop parsing it.
+     * @param messageID - the ID of the message.
      */
-    String toANSI(mavlink_message_t msg);
+    void releaseMavlinkMessage(uint8_t messageID);
+
+    /**
+     * @description Turn the latest copy of a mavlink message in the telemetry store into a json string. It is
+     * important to note that this method is only capable of showing a subset of mavlink messages. To add more, simply
+     * add more cases to the switch statement. This method is to be used for debugging purposes only.
+     * @param messageID - the ID of the message to show.
+     * @param json - cleared, then set to a JSON string representation of the mavlink message.
+     * @return bool - false if the representation did not fit into json.
+     */
+    bool toANSI(uint32_t messageID, TextBuffer &json) const;
 
 
     /**
@@ -76,20 +90,76 @@ public:
 
 
     /**
-     * Wait for the previously requested messages to be received and return them in a vector. if a message is not
-     * received within ~10 attempts, it is assumed that the message will not be received and an empty message is
-     * added to the vector.
-     * @return std::vector<mavlink_message_t> - a vector of mavlink messages.
+     * The latest decoded copy of every requested message. Producers are the drains of the receive ring, consumers
+     * tell new copies by their sequence numbers.
+     * @return const TelemetryStore& - the telemetry store.
      */
-    std::vector<mavlink_message_t> receiveMavlinkMessages();
+    const TelemetryStore &telemetryStore() const;
 
     /**
-     * Wait for a specific message to be received and return it. If the message is not received within ~10 attempts,
-     * an empty message is returned.
-     * @param messageID - the ID of the message to wait for.
-     * @return mavlink_message_t - the mavlink message received.
+     * The time at which the latest copy of a requested message was parsed out of the receive ring.
+     * @param messageID - the ID of the message.
+     * @return unsigned long - the value of millis() when the message was received, 0 if it never was.
      */
-    mavlink_message_t receiveMavlinkMessage(uint32_t messageID);
+    unsigned long receivedMillis(uint32_t messageID);
+
+    /**
+     * Read everything currently buffered in the receive ring in a single pass and decode every completed frame whose
+     * ID has been requested into the telemetry store. Only the frames of requested messages, HEARTBEAT and
+     * COMMAND_ACK are parsed, the others are skipped after their header has been shown to streamRates. The sweep stops
+     * once the ring is empty or the demultiplexer time budget is spent.
+     * @return int - the number of requested frames that were decoded into the telemetry store.
+     */
+    int demultiplexSerialStream();
+
+    /**
+     * Take at most maxBytes bytes out of the receive ring and decode completed, requested frames into the telemetry
+     * store. Skipped bytes count towards maxBytes. Partial frames are carried over to the next call, so the ring can be
+     * drained in small increments from anywhere that must not block for long. If a drain is already in progress
+     * further up the call stack (for example when called from an ISBD callback), the call returns immediately without
+     * touching the parser.
+     * @param maxBytes - the maximum number of bytes to take out of the ring.
+     * @return int - the number of requested frames that were decoded into the telemetry store.
+     */
+    int drainRxRing(size_t maxBytes);
+
+    /**
+     * The number of bytes from the Pixhawk that were lost because the receive ring or the UART was full.
+     * @return uint32_t - the overflow counter.
+     */
+    uint32_t rxOverflowCount();
+
+    /**
+     * The largest number of bytes that have been waiting in the receive ring at any one time.
+     * @return uint16_t - the high-water mark.
+     */
+    uint16_t rxHighWaterMark();
+
+    //The maximum time in milliseconds that a single sweep of the serial stream may take.
+    static const unsigned long demultiplexTimeBudgetMillis = 100;
+
+    //The MAVLink identity of the Blackbox.
+    static const uint8_t systemId = 1;
+    static const uint8_t componentId = 200;
+
+    //The rates of the requested messages as negotiated with the autopilot, polled by the stream rate task.
+    StreamRateManager streamRates{systemId, componentId};
+
+private:
+
+    /**
+     * Have the framer parse the messages the stream rate negotiation needs, and send its commands to the Pixhawk.
+     */
+    void subscribeRateNegotiation();
+
+    //The latest decoded copy of every requested message.
+    TelemetryStore store;
+
+    //Splits the receive ring into frames, and only parses the frames of subscribed messages.
+    MavlinkFramer framer;
+
+    //A boolean to indicate if the receive ring is currently being drained.
+    volatile bool draining = false;
 };
 
 #endif //AERORADARV1_MAVLINKINTERPRETER_H
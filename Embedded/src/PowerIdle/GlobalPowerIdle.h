@@ -0,0 +1,17 @@
+/**
+* @File: GlobalPowerIdle.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file declares the global instance of the PowerIdle class, named powerIdle, which is used to
+ * sleep the CPU whenever the code would otherwise wait.
+*/
+
+#ifndef AERORADAREMBEDDED_GLOBALPOWERIDLE_H
+#define AERORADAREMBEDDED_GLOBALPOWERIDLE_H
+
+#include "PowerIdle.h"
+
+// Global power idle
+extern PowerIdle powerIdle;
+
+#endif //AERORADAREMBEDDED_GLOBALPOWERIDLE_H
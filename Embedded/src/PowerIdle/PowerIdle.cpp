@@ -0,0 +1,71 @@
+/**
+* @File: PowerIdle.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the PowerIdle class.
+*/
+
+#include "PowerIdle.h"
+#include <Arduino.h>
+
+PowerIdle::PowerIdle(unsigned long maxIdleMillis) : maxIdleMillis(maxIdleMillis) {
+}
+
+void PowerIdle::setWakeCondition(WakeCondition condition) {
+    wakeCondition = condition;
+}
+
+unsigned long PowerIdle::idle(unsigned long millisUntilDeadline) {
+
+    unsigned long start = micros();
+    active += start - lastWakeMicros;
+
+    unsigned long sleepMillis = millisUntilDeadline < maxIdleMillis ? millisUntilDeadline : maxIdleMillis;
+    unsigned long startMillis = millis();
+
+    // SysTick interrupts every millisecond, so an interrupt that slips in between the check and the WFI delays the
+    // wake by at most 1 ms.
+    while (millis() - startMillis < sleepMillis && !shouldWake()) {
+        waitForInterrupt();
+    }
+    wakeRequested = false;
+
+    lastWakeMicros = micros();
+    inIdle += lastWakeMicros - start;
+    return millis() - startMillis;
+}
+
+void PowerIdle::requestWake() {
+    wakeRequested = true;
+}
+
+uint16_t PowerIdle::activePermille() const {
+    uint64_t total = active + inIdle;
+    return total == 0 ? 1000 : (uint16_t) (active * 1000 / total);
+}
+
+uint64_t PowerIdle::activeMicros() const {
+    return active;
+}
+
+uint64_t PowerIdle::idleMicros() const {
+    return inIdle;
+}
+
+void PowerIdle::resetDutyCycle() {
+    active = 0;
+    inIdle = 0;
+    lastWakeMicros = micros();
+}
+
+bool PowerIdle::shouldWake() {
+    return wakeRequested || (wakeCondition != nullptr && wakeCondition());
+}
+
+void PowerIdle::waitForInterrupt() {
+    //IDLE sleep mode 0 only stops the CPU clock, everything else keeps running
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    PM->SLEEP.reg = PM_SLEEP_IDLE_CPU;
+    __DSB();
+    __WFI();
+}
@@ -0,0 +1,102 @@
+/**
+* @File: PowerIdle.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the PowerIdle class, which puts the SAMD21 to sleep between scheduler
+ * deadlines instead of letting loop() spin on millis(). The CPU waits for an interrupt (WFI) in the IDLE sleep mode,
+ * which stops the CPU clock but keeps the SERCOM, EIC and SysTick clocks running, so UART bytes keep arriving, the
+ * RING pin still interrupts and millis() stays correct. Any interrupt wakes the CPU; the CPU goes straight back to
+ * sleep unless the deadline has passed, a wake was requested or the wake condition holds. The class also measures the
+ * time spent in idle() versus the rest of loop(), so the savings can be reported. The interrupt handlers that run while
+ * the CPU waits count as time in idle(), so the active share is a lower bound on the CPU load.
+*/
+
+#ifndef AERORADAREMBEDDED_POWERIDLE_H
+#define AERORADAREMBEDDED_POWERIDLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Sleeps the CPU until a deadline or an interrupt that needs attention, and measures the duty cycle.
+ */
+class PowerIdle {
+
+public:
+    /**
+     * Checked after every interrupt while idle.
+     * @return bool - true if loop() has work to do now.
+     */
+    typedef bool (*WakeCondition)();
+
+    /**
+     * Constructor
+     * @param maxIdleMillis - the longest a single idle() may sleep.
+     */
+    explicit PowerIdle(unsigned long maxIdleMillis);
+
+    /**
+     * Set the condition that ends an idle early, e.g. bytes from the modem.
+     * @param condition - the condition, nullptr for none.
+     */
+    void setWakeCondition(WakeCondition condition);
+
+    /**
+     * Sleep until a number of milliseconds have passed, a wake was requested or the wake condition holds.
+     * @param millisUntilDeadline - how long loop() has nothing to do, e.g. from the scheduler.
+     * @return unsigned long - the number of milliseconds slept.
+     */
+    unsigned long idle(unsigned long millisUntilDeadline);
+
+    /**
+     * End the current or next idle() early. Safe to call from an interrupt handler.
+     */
+    void requestWake();
+
+    /**
+     * The share of time spent outside idle() since the last resetDutyCycle().
+     * @return uint16_t - the active time in parts per thousand.
+     */
+    uint16_t activePermille() const;
+
+    /**
+     * The time spent outside idle() since the last resetDutyCycle().
+     * @return uint64_t - the active time in microseconds.
+     */
+    uint64_t activeMicros() const;
+
+    /**
+     * The time spent in idle() since the last resetDutyCycle(). This is the time asleep plus the interrupt handlers
+     * that ran meanwhile, which are not measured apart.
+     * @return uint64_t - the idle time in microseconds.
+     */
+    uint64_t idleMicros() const;
+
+    /**
+     * Start a new duty cycle measurement.
+     */
+    void resetDutyCycle();
+
+private:
+    unsigned long maxIdleMillis;
+    WakeCondition wakeCondition = nullptr;
+    volatile bool wakeRequested = false;
+
+    uint64_t active = 0;
+    uint64_t inIdle = 0;
+    //the value of micros() when the last idle() returned, or the measurement started
+    unsigned long lastWakeMicros = 0;
+
+    /**
+     * Whether the idle should end.
+     * @return bool - true if a wake was requested or the wake condition holds.
+     */
+    bool shouldWake();
+
+    /**
+     * Stop the CPU until the next interrupt.
+     */
+    static void waitForInterrupt();
+};
+
+#endif //AERORADAREMBEDDED_POWERIDLE_H
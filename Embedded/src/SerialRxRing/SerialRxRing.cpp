@@ -0,0 +1,60 @@
+/**
+* @File: SerialRxRing.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This code installs the receive interrupt that feeds mavlinkRxRing. The MKR WiFi 1010 variant already
+ * defines SERCOM5_Handler() for Serial1, so the handler cannot simply be redefined. Instead, the vector table is copied
+ * into RAM once and the SERCOM5 entry is pointed at mavlinkRxIrqHandler(), which empties the UART into the ring and
+ * then hands the interrupt to the core handler for transmit and error processing.
+*/
+
+#include "SerialRxRing.h"
+#include <Arduino.h>
+
+//The ring fed by the Pixhawk UART receive interrupt.
+SerialRxRing mavlinkRxRing;
+
+//A copy of the vector table in RAM. The SAMD21 requires the table to be aligned to the next power of two above its size.
+static DeviceVectors ramVectors __attribute__((aligned(256)));
+
+//A boolean to indicate if the vector table has already been relocated.
+static bool ringAttached = false;
+
+/**
+ * The SERCOM5 interrupt handler that feeds mavlinkRxRing.
+ */
+static void mavlinkRxIrqHandler() {
+    SercomUsart &usart = SERCOM5->USART;
+
+    //if the UART's holding register overran, at least one byte was lost before it could be read
+    if (usart.STATUS.bit.BUFOVF) {
+        mavlinkRxRing.countOverflow(1);
+    }
+
+    //move every received byte into the ring before the core handler sees the interrupt
+    while (usart.INTFLAG.bit.RXC) {
+        mavlinkRxRing.push((uint8_t) usart.DATA.reg);
+    }
+
+    //let the core handler deal with transmit and with clearing the error flags
+    Serial1.IrqHandler();
+}
+
+void attachMavlinkRxRing() {
+
+    //only relocate the vector table once
+    if (ringAttached) {
+        return;
+    }
+
+    //copy the current vector table into RAM and point the SERCOM5 entry at the ring handler
+    noInterrupts();
+    memcpy(&ramVectors, (const void *) (uintptr_t) SCB->VTOR, sizeof(ramVectors));
+    ramVectors.pfnSERCOM5_Handler = (void *) mavlinkRxIrqHandler;
+    __DSB();
+    SCB->VTOR = (uint32_t) (uintptr_t) &ramVectors;
+    __DSB();
+    interrupts();
+
+    ringAttached = true;
+}
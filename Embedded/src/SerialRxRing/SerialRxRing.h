@@ -0,0 +1,146 @@
+/**
+* @File: SerialRxRing.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the SerialRxRing class, a large single-producer/single-consumer byte ring
+ * that sits between the Pixhawk UART (Serial1) and the MAVLink parser. The producer is the SERCOM5 receive interrupt,
+ * which moves every received byte out of the UART before the small default core buffer can overflow. The consumer is
+ * the main loop (or the ISBD callbacks), which drains the ring incrementally. The ring keeps overflow and high-water
+ * counters so that stream corruption during long modem sessions is visible instead of silent.
+*/
+
+#ifndef AERORADAREMBEDDED_SERIALRXRING_H
+#define AERORADAREMBEDDED_SERIALRXRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * A lock-free single-producer/single-consumer byte ring. push() may only be called from the interrupt that produces
+ * the bytes and pop() may only be called from the code that consumes them.
+ */
+class SerialRxRing {
+
+public:
+    //The number of bytes the ring can hold. Must be a power of two. ~0.7 s of a saturated 57600 baud link.
+    static const uint16_t capacity = 4096;
+
+    /**
+     * Default constructor.
+     */
+    SerialRxRing() = default;
+
+    /**
+     * Store a received byte in the ring. If the ring is full the byte is dropped and the overflow counter is
+     * incremented. Producer side only.
+     * @param c - the byte to store.
+     */
+    inline void push(uint8_t c) {
+        uint16_t h = head;
+        uint16_t used = (uint16_t) (h - tail);
+
+        //if the ring is full, drop the byte and count it
+        if (used >= capacity) {
+            overflows++;
+            return;
+        }
+
+        buffer[h & (capacity - 1)] = c;
+        head = (uint16_t) (h + 1);
+
+        //track the deepest the ring has ever been
+        if (used + 1 > highWater) {
+            highWater = used + 1;
+        }
+    }
+
+    /**
+     * Take the oldest byte out of the ring. Consumer side only.
+     * @param c - set to the byte that was taken out of the ring.
+     * @return true if a byte was available, false if the ring is empty.
+     */
+    inline bool pop(uint8_t &c) {
+        uint16_t t = tail;
+        if (t == head) {
+            return false;
+        }
+        c = buffer[t & (capacity - 1)];
+        tail = (uint16_t) (t + 1);
+        return true;
+    }
+
+    /**
+     * Throw away the oldest bytes of the ring without reading them. Consumer side only.
+     * @param count - the number of bytes to throw away.
+     * @return uint16_t - the number of bytes thrown away, fewer than count if the ring held fewer.
+     */
+    inline uint16_t skip(uint16_t count) {
+        uint16_t t = tail;
+        uint16_t used = (uint16_t) (head - t);
+        if (count > used) {
+            count = used;
+        }
+        tail = (uint16_t) (t + count);
+        return count;
+    }
+
+    /**
+     * The number of bytes waiting to be consumed.
+     * @return uint16_t - the number of bytes in the ring.
+     */
+    inline uint16_t available() const {
+        return (uint16_t) (head - tail);
+    }
+
+    /**
+     * Count bytes that were lost before they reached the ring, for example because the UART's own holding register
+     * overran.
+     * @param count - the number of bytes that were lost.
+     */
+    inline void countOverflow(uint32_t count) {
+        overflows += count;
+    }
+
+    /**
+     * The number of bytes that were dropped because the ring or the UART was full.
+     * @return uint32_t - the overflow counter.
+     */
+    uint32_t overflowCount() const {
+        return overflows;
+    }
+
+    /**
+     * The largest number of bytes that have been waiting in the ring at any one time.
+     * @return uint16_t - the high-water mark.
+     */
+    uint16_t highWaterMark() const {
+        return highWater;
+    }
+
+private:
+    //The bytes in the ring, indexed by the free-running head and tail counters masked to the capacity.
+    uint8_t buffer[capacity]{};
+
+    //The index of the next byte to be written. Only ever written by the producer.
+    volatile uint16_t head = 0;
+
+    //The index of the next byte to be read. Only ever written by the consumer.
+    volatile uint16_t tail = 0;
+
+    //The number of bytes that have been dropped.
+    volatile uint32_t overflows = 0;
+
+    //The largest number of bytes that have been waiting in the ring at any one time.
+    volatile uint16_t highWater = 0;
+};
+
+//The ring fed by the Pixhawk UART receive interrupt.
+extern SerialRxRing mavlinkRxRing;
+
+/**
+ * Route the Pixhawk UART (Serial1, SERCOM5) receive interrupt into mavlinkRxRing. Must be called after
+ * Serial1.begin(). Transmit and error handling are still delegated to the core's Uart::IrqHandler().
+ */
+void attachMavlinkRxRing();
+
+#endif //AERORADAREMBEDDED_SERIALRXRING_H
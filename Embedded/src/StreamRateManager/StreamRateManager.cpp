@@ -0,0 +1,297 @@
+/**
+* @File: StreamRateManager.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the StreamRateManager class.
+*/
+
+#include "StreamRateManager.h"
+
+StreamRateManager::StreamRateManager(uint8_t systemId, uint8_t componentId)
+        : systemId(systemId), componentId(componentId) {
+}
+
+void StreamRateManager::setSender(Sender sender, void *context) {
+    this->sender = sender;
+    senderContext = context;
+}
+
+bool StreamRateManager::request(uint32_t messageId, uint32_t intervalMillis) {
+    int index = indexOf(messageId);
+    if (index < 0) {
+        index = add(messageId);
+        if (index < 0) {
+            return false;
+        }
+    }
+    //an interval that is already requested is not sent again
+    else if (streams[index].intervalMillis == intervalMillis) {
+        return true;
+    }
+
+    Stream &stream = streams[index];
+    stream.intervalMillis = intervalMillis;
+    stream.state = UNSENT;
+    stream.attempts = 0;
+    stream.driftStrikes = 0;
+    //an answer to the previous interval must not settle the new one
+    if (awaiting == index) {
+        awaiting = -1;
+    }
+    return true;
+}
+
+void StreamRateManager::release(uint32_t messageId) {
+    request(messageId, 0);
+}
+
+void StreamRateManager::onMessage(const mavlink_message_t &msg, unsigned long now) {
+
+    if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&msg, &heartbeat);
+        //ground stations and companion computers are not autopilots
+        if (heartbeat.autopilot == MAV_AUTOPILOT_INVALID || heartbeat.type == MAV_TYPE_GCS) {
+            return;
+        }
+        bool sameTarget = targetKnown && msg.sysid == targetSystemId && msg.compid == targetComponentId;
+        if (sameTarget && now - lastHeartbeatMillis < targetTimeoutMillis) {
+            lastHeartbeatMillis = now;
+            return;
+        }
+        if (targetKnown && !sameTarget && now - lastHeartbeatMillis < targetTimeoutMillis) {
+            return;
+        }
+
+        //a new autopilot, or the old one after a silence in which it may have rebooted and forgotten every interval
+        targetKnown = true;
+        targetSystemId = msg.sysid;
+        targetComponentId = msg.compid;
+        lastHeartbeatMillis = now;
+        for (uint8_t i = 0; i < streamCount; i++) {
+            streams[i].state = UNSENT;
+            streams[i].attempts = 0;
+            streams[i].driftStrikes = 0;
+        }
+        awaiting = -1;
+        return;
+    }
+
+    if (msg.msgid == MAVLINK_MSG_ID_COMMAND_ACK) {
+        //only the autopilot's own answers count
+        if (!targetKnown || msg.sysid != targetSystemId || msg.compid != targetComponentId) {
+            return;
+        }
+        mavlink_command_ack_t ack;
+        mavlink_msg_command_ack_decode(&msg, &ack);
+        if (ack.command != MAV_CMD_SET_MESSAGE_INTERVAL || awaiting < 0) {
+            return;
+        }
+        //only one request is outstanding, so the answer is for it
+        switch (ack.result) {
+            case MAV_RESULT_ACCEPTED:
+                settle(awaiting, CONFIRMED, now);
+                break;
+            case MAV_RESULT_TEMPORARILY_REJECTED:
+            case MAV_RESULT_IN_PROGRESS:
+                //wait for the next answer or the timeout
+                break;
+            default:
+                settle(awaiting, REJECTED, now);
+                break;
+        }
+        return;
+    }
+
+    observe(msg.msgid, msg.sysid, msg.compid, now);
+}
+
+void StreamRateManager::observe(uint32_t messageId, uint8_t systemId, uint8_t componentId, unsigned long now) {
+    if (!targetKnown || systemId != targetSystemId || componentId != targetComponentId) {
+        return;
+    }
+
+    int index = indexOf(messageId);
+    if (index >= 0) {
+        if (streams[index].windowCount < UINT16_MAX) {
+            streams[index].windowCount++;
+        }
+        return;
+    }
+
+    //stop what nobody asked for, except the messages the autopilot only sends on events
+    if (messageId != MAVLINK_MSG_ID_HEARTBEAT && messageId != MAVLINK_MSG_ID_COMMAND_ACK &&
+        messageId != MAVLINK_MSG_ID_STATUSTEXT) {
+        add(messageId);
+    }
+}
+
+void StreamRateManager::poll(unsigned long now) {
+    if (!targetKnown || sender == nullptr) {
+        return;
+    }
+
+    //send the outstanding request again if its answer is overdue, and give up after a few attempts
+    if (awaiting >= 0 && now - streams[awaiting].stateMillis >= ackTimeoutMillis) {
+        if (streams[awaiting].attempts < maxAttempts) {
+            send(awaiting, now);
+        } else {
+            settle(awaiting, REJECTED, now);
+        }
+    }
+
+    for (uint8_t i = 0; i < streamCount; i++) {
+        Stream &stream = streams[i];
+        if (stream.state == CONFIRMED) {
+            checkDrift(stream, now);
+        } else if (stream.state == REJECTED && now - stream.stateMillis >= rejectedRetryMillis) {
+            //a stop of a message that has gone anyway, or whose ID came from a corrupted header, is not retried
+            if (stream.intervalMillis == 0 && stream.windowCount == 0) {
+                remove(i--);
+                continue;
+            }
+            stream.state = UNSENT;
+            stream.attempts = 0;
+        }
+    }
+
+    //one request at a time, so every answer can be matched to its request
+    if (awaiting >= 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < streamCount; i++) {
+        if (streams[i].state == UNSENT) {
+            send(i, now);
+            return;
+        }
+    }
+}
+
+bool StreamRateManager::hasTarget() const {
+    return targetKnown;
+}
+
+uint8_t StreamRateManager::targetSystem() const {
+    return targetSystemId;
+}
+
+uint8_t StreamRateManager::targetComponent() const {
+    return targetComponentId;
+}
+
+bool StreamRateManager::isConfirmed(uint32_t messageId) const {
+    int index = indexOf(messageId);
+    return index >= 0 && streams[index].state == CONFIRMED;
+}
+
+uint32_t StreamRateManager::commandCount() const {
+    return commandsSent;
+}
+
+int StreamRateManager::indexOf(uint32_t messageId) const {
+    for (uint8_t i = 0; i < streamCount; i++) {
+        if (streams[i].messageId == messageId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int StreamRateManager::add(uint32_t messageId) {
+    int index = -1;
+    if (streamCount < maxStreams) {
+        index = streamCount++;
+    } else {
+        //a message the autopilot has agreed to stop no longer needs its entry
+        for (uint8_t i = 0; i < streamCount; i++) {
+            if (streams[i].intervalMillis == 0 && streams[i].state == CONFIRMED) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            return -1;
+        }
+    }
+    streams[index] = {messageId, 0, UNSENT, 0, 0, 0, 0, 0};
+    return index;
+}
+
+void StreamRateManager::remove(uint8_t index) {
+    //the last entry takes the place of the removed one
+    streamCount--;
+    if (index != streamCount) {
+        streams[index] = streams[streamCount];
+        if (awaiting == streamCount) {
+            awaiting = index;
+        }
+    }
+}
+
+void StreamRateManager::send(uint8_t index, unsigned long now) {
+    Stream &stream = streams[index];
+
+    //param1 is the message, param2 the interval in microseconds, -1 stops the message
+    float intervalMicros = stream.intervalMillis == 0 ? -1.0f : (float) stream.intervalMillis * 1000.0f;
+    mavlink_message_t msg;
+    mavlink_msg_command_long_pack(systemId, componentId, &msg, targetSystemId, targetComponentId,
+                                  MAV_CMD_SET_MESSAGE_INTERVAL, stream.attempts, (float) stream.messageId,
+                                  intervalMicros, 0, 0, 0, 0, 0);
+    sender(msg, senderContext);
+    commandsSent++;
+
+    stream.state = AWAITING_ACK;
+    stream.attempts++;
+    stream.stateMillis = now;
+    awaiting = index;
+}
+
+void StreamRateManager::settle(uint8_t index, State state, unsigned long now) {
+    Stream &stream = streams[index];
+    stream.state = state;
+    stream.attempts = 0;
+    stream.stateMillis = now;
+    stream.windowStartMillis = now;
+    stream.windowCount = 0;
+    if (awaiting == index) {
+        awaiting = -1;
+    }
+}
+
+void StreamRateManager::checkDrift(Stream &stream, unsigned long now) {
+    unsigned long elapsed = now - stream.windowStartMillis;
+    if (elapsed < driftWindowMillis(stream)) {
+        return;
+    }
+
+    //a stopped message may trickle in for a moment, a requested one may be off by half either way
+    bool drifted;
+    if (stream.intervalMillis == 0) {
+        drifted = stream.windowCount > stoppedTolerance;
+    } else {
+        unsigned long expected = elapsed / stream.intervalMillis;
+        drifted = (unsigned long) stream.windowCount * 2 < expected ||
+                  (unsigned long) stream.windowCount > expected * 2 + 1;
+    }
+
+    stream.windowStartMillis = now;
+    stream.windowCount = 0;
+    if (!drifted) {
+        stream.driftStrikes = 0;
+        return;
+    }
+
+    //a message the autopilot cannot send at all, e.g. a position without a GPS fix, is asked for less and less often
+    if (stream.driftStrikes < maxDriftStrikes) {
+        stream.driftStrikes++;
+    }
+    stream.state = UNSENT;
+}
+
+unsigned long StreamRateManager::driftWindowMillis(const Stream &stream) {
+    unsigned long window = (unsigned long) stream.intervalMillis * driftWindowIntervals;
+    if (window < minDriftWindowMillis) {
+        window = minDriftWindowMillis;
+    }
+    return window << stream.driftStrikes;
+}
@@ -0,0 +1,266 @@
+/**
+* @File: StreamRateManager.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the StreamRateManager class, which negotiates the rate of every MAVLink
+ * message with the autopilot, so that the Pixhawk sends each message exactly as often as it is sampled:
+ * - the autopilot is discovered from its HEARTBEAT instead of assuming system 1, component 1,
+ * - every message is requested with MAV_CMD_SET_MESSAGE_INTERVAL at the interval its consumer needs, one command at
+ *   a time, and the request is only settled by a COMMAND_ACK, otherwise it is sent again,
+ * - once a request is settled, the observed rate is compared with the requested one over a window, and the message is
+ *   only requested again if the rate has drifted, e.g. after the autopilot rebooted,
+ * - messages the autopilot streams on its own that nobody asked for are stopped, so they do not fill the receive ring.
+*/
+
+#ifndef AERORADAREMBEDDED_STREAMRATEMANAGER_H
+#define AERORADAREMBEDDED_STREAMRATEMANAGER_H
+
+#include "Arduino.h"
+
+#undef F
+
+#include "standard/mavlink.h"
+
+#undef F
+
+/**
+ * A fixed capacity table of the MAVLink messages and the intervals they are requested from the autopilot at.
+ */
+class StreamRateManager {
+
+public:
+    /**
+     * Called with every command that has to be sent to the autopilot.
+     * @param msg - the packed command.
+     * @param context - the context given to setSender.
+     */
+    typedef void (*Sender)(const mavlink_message_t &msg, void *context);
+
+    /**
+     * Where the request of a message stands.
+     */
+    enum State : uint8_t {
+        //the interval has not been sent to the autopilot yet
+        UNSENT = 0,
+        //the interval has been sent and the COMMAND_ACK is outstanding
+        AWAITING_ACK,
+        //the autopilot accepted the interval, the observed rate is being checked
+        CONFIRMED,
+        //the autopilot rejected the interval or never answered, it is tried again later
+        REJECTED
+    };
+
+    /**
+     * One message and the interval it is requested at.
+     */
+    struct Stream {
+        uint32_t messageId;
+        //the interval between two messages in milliseconds, 0 to stop the message
+        uint32_t intervalMillis;
+        State state;
+        //the number of times the current request has been sent without an answer
+        uint8_t attempts;
+        //the number of drift windows in a row that ended in a new request, lengthens the next window
+        uint8_t driftStrikes;
+        //the value of millis() when the state last changed
+        unsigned long stateMillis;
+        //the value of millis() when the current drift window started
+        unsigned long windowStartMillis;
+        //the number of messages received in the current drift window
+        uint16_t windowCount;
+    };
+
+    //The maximum number of messages whose rate is managed, the requested ones and the stopped ones.
+    static const uint8_t maxStreams = 16;
+
+    //The time in milliseconds the autopilot has to acknowledge an interval before it is sent again.
+    static const unsigned long ackTimeoutMillis = 1000;
+
+    //The number of times an interval is sent without an answer before it counts as rejected.
+    static const uint8_t maxAttempts = 3;
+
+    //The time in milliseconds after which a rejected interval is tried again. A rejected stop of a message that has
+    // not been seen since is forgotten instead.
+    static const unsigned long rejectedRetryMillis = 30 * 1000ul;
+
+    //The shortest window in milliseconds over which the observed rate of a message is compared with its interval.
+    static const unsigned long minDriftWindowMillis = 5000;
+
+    //The number of intervals of a message a drift window lasts at least.
+    static const uint8_t driftWindowIntervals = 5;
+
+    //The most drift strikes that lengthen the window, each one doubles it.
+    static const uint8_t maxDriftStrikes = 4;
+
+    //The number of copies of a stopped message that may still arrive in a window before it is stopped again.
+    static const uint16_t stoppedTolerance = 2;
+
+    //The time in milliseconds without a HEARTBEAT after which the autopilot counts as lost, and every message is
+    // requested again once it is heard from, in case it rebooted.
+    static const unsigned long targetTimeoutMillis = 5000;
+
+    /**
+     * Constructor
+     * @param systemId - the MAVLink system ID the commands are sent from.
+     * @param componentId - the MAVLink component ID the commands are sent from.
+     */
+    StreamRateManager(uint8_t systemId, uint8_t componentId);
+
+    /**
+     * Set where the commands to the autopilot are sent.
+     * @param sender - the function that writes a command to the autopilot.
+     * @param context - passed to the sender.
+     */
+    void setSender(Sender sender, void *context);
+
+    /**
+     * Request a message at an interval. Requesting a message at the interval it already has sends nothing.
+     * @param messageId - the ID of the message.
+     * @param intervalMillis - the interval between two messages in milliseconds, 0 to stop the message.
+     * @return bool - true if the message is managed, false if the table is full.
+     */
+    bool request(uint32_t messageId, uint32_t intervalMillis);
+
+    /**
+     * Ask the autopilot to stop sending a message.
+     * @param messageId - the ID of the message.
+     */
+    void release(uint32_t messageId);
+
+    /**
+     * Look at a frame from the serial stream: a HEARTBEAT may reveal the autopilot, a COMMAND_ACK settles the
+     * outstanding request and every other frame of the autopilot counts towards the observed rate of its message.
+     * Messages nobody asked for are scheduled to be stopped.
+     * @param msg - the received frame.
+     * @param now - the value of millis() when the frame was received.
+     */
+    void onMessage(const mavlink_message_t &msg, unsigned long now);
+
+    /**
+     * Count a frame of the autopilot towards the observed rate of its message, from its header alone, e.g. for
+     * frames that are skipped without being parsed. Messages nobody asked for are scheduled to be stopped.
+     * @param messageId - the ID of the message.
+     * @param systemId - the system ID of the sender.
+     * @param componentId - the component ID of the sender.
+     * @param now - the value of millis() when the frame was received.
+     */
+    void observe(uint32_t messageId, uint8_t systemId, uint8_t componentId, unsigned long now);
+
+    /**
+     * Send the next request that is due, check the outstanding request for a timeout and compare the observed rates
+     * of the settled requests with their intervals. At most one request is outstanding at any one time.
+     * @param now - the current value of millis().
+     */
+    void poll(unsigned long now);
+
+    /**
+     * Whether the autopilot has been discovered.
+     * @return bool - true once a HEARTBEAT of an autopilot has been received.
+     */
+    bool hasTarget() const;
+
+    /**
+     * The system ID of the autopilot.
+     * @return uint8_t - the system ID, 0 if the autopilot has not been discovered.
+     */
+    uint8_t targetSystem() const;
+
+    /**
+     * The component ID of the autopilot.
+     * @return uint8_t - the component ID, 0 if the autopilot has not been discovered.
+     */
+    uint8_t targetComponent() const;
+
+    /**
+     * Whether the autopilot has accepted the current interval of a message.
+     * @param messageId - the ID of the message.
+     * @return bool - true if the interval was acknowledged, false otherwise.
+     */
+    bool isConfirmed(uint32_t messageId) const;
+
+    /**
+     * The number of MAV_CMD_SET_MESSAGE_INTERVAL commands sent since boot.
+     * @return uint32_t - the command counter.
+     */
+    uint32_t commandCount() const;
+
+private:
+
+    /**
+     * Find the entry of a message.
+     * @param messageId - the ID of the message.
+     * @return int - the index of the entry, -1 if the message is not managed.
+     */
+    int indexOf(uint32_t messageId) const;
+
+    /**
+     * Add an entry for a message. If the table is full, a message that has been stopped makes room.
+     * @param messageId - the ID of the message.
+     * @return int - the index of the entry, -1 if the table is full.
+     */
+    int add(uint32_t messageId);
+
+    /**
+     * Remove an entry from the table.
+     * @param index - the index of the entry.
+     */
+    void remove(uint8_t index);
+
+    /**
+     * Send the interval of an entry to the autopilot and wait for its answer.
+     * @param index - the index of the entry.
+     * @param now - the current value of millis().
+     */
+    void send(uint8_t index, unsigned long now);
+
+    /**
+     * Settle an entry and start its first drift window.
+     * @param index - the index of the entry.
+     * @param state - CONFIRMED or REJECTED.
+     * @param now - the current value of millis().
+     */
+    void settle(uint8_t index, State state, unsigned long now);
+
+    /**
+     * Compare the observed rate of a confirmed entry with its interval once its drift window has ended, and request
+     * the entry again if the rate has drifted.
+     * @param stream - the entry.
+     * @param now - the current value of millis().
+     */
+    void checkDrift(Stream &stream, unsigned long now);
+
+    /**
+     * The length of the current drift window of an entry.
+     * @param stream - the entry.
+     * @return unsigned long - the length of the window in milliseconds.
+     */
+    static unsigned long driftWindowMillis(const Stream &stream);
+
+    //The MAVLink identity the commands are sent from.
+    uint8_t systemId;
+    uint8_t componentId;
+
+    //The function the commands are sent with, and its context.
+    Sender sender = nullptr;
+    void *senderContext = nullptr;
+
+    //The identity of the autopilot, valid once targetKnown is set.
+    bool targetKnown = false;
+    uint8_t targetSystemId = 0;
+    uint8_t targetComponentId = 0;
+
+    //The value of millis() when the autopilot last sent a HEARTBEAT.
+    unsigned long lastHeartbeatMillis = 0;
+
+    //The managed messages.
+    Stream streams[maxStreams]{};
+    uint8_t streamCount = 0;
+
+    //The index of the entry whose COMMAND_ACK is outstanding, -1 if none is.
+    int awaiting = -1;
+
+    //The number of commands sent since boot.
+    uint32_t commandsSent = 0;
+};
+
+#endif //AERORADAREMBEDDED_STREAMRATEMANAGER_H
@@ -0,0 +1,1073 @@
+/**
+* @File: TelemetryCodec.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the compact, quantized binary telemetry format that replaces raw MAVLink
+ * frames in SBD payloads. Every field of a telemetry sample is described by a schema entry (bit width, signedness,
+ * quantization step and offset) and the encoder simply walks the schema, quantizing each field and bit-packing it
+ * behind a one byte format version. A full ATTITUDE + GLOBAL_POSITION_INT snapshot with its timestamp packs into 36
+ * bytes instead of ~80, which fits into a single 50 byte Iridium credit.
+ *
+ * Several samples taken between uploads can be sent as one batch: the oldest sample is bit-packed as a keyframe and
+ * every following sample is sent as the zigzag/varint encoded difference of its quantized fields from the previous
+ * sample. Consecutive samples a few seconds apart differ very little, so each delta costs ~20 bytes instead of 35.
+ *
+ * The sectioned format wraps a batch together with other typed, length-prefixed sections (device health counters,
+ * acknowledgements, device status) so that a single mobile originated message can carry everything the device has to
+ * say, including the bootup notice and the configuration acknowledgement that used to need sessions of their own.
+ *
+ * Which fields are sampled, and how precisely, is a runtime Schema derived from one of the built-in schemas and
+ * selectable over the satellite link. A packet whose samples do not use the standard schema carries a schema section
+ * describing them as the differences from their built-in schema, usually a single byte, so that every packet can be
+ * decoded on its own.
+ *
+ * The header only depends on the C++ standard library so that it can be shared between the firmware and host-side
+ * decoders. The cloud function decoder (Microservices/CloudFunctions/src/TelemetryCodec.ts) mirrors this schema and
+ * must be updated together with it.
+*/
+
+#ifndef AERORADAREMBEDDED_TELEMETRYCODEC_H
+#define AERORADAREMBEDDED_TELEMETRYCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace TelemetryCodec {
+
+    //The version of the wire format. It is written as the first byte of every packet and can never collide with the
+    // start byte of a MAVLink frame (0xFD/0xFE) or with the legacy text messages ("bootup,", "config,").
+    static const uint8_t formatVersion = 1;
+
+    //The version of the batched wire format: a count byte, a keyframe and a delta per following sample.
+    static const uint8_t batchFormatVersion = 2;
+
+    /**
+     * The fields of a telemetry sample. Every field is held in the native integer unit noted next to it.
+     */
+    enum FieldId : uint8_t {
+        UNIX_TIME_MILLIS = 0,   //milliseconds since the unix epoch
+        LATITUDE,               //degrees * 1E7
+        LONGITUDE,              //degrees * 1E7
+        ALTITUDE,               //millimetres above mean sea level
+        RELATIVE_ALTITUDE,      //millimetres above home
+        ROLL,                   //radians * 1E4
+        PITCH,                  //radians * 1E4
+        YAW,                    //radians * 1E4
+        ROLL_SPEED,             //radians per second * 1E3
+        PITCH_SPEED,            //radians per second * 1E3
+        YAW_SPEED,              //radians per second * 1E3
+        VX,                     //centimetres per second, north
+        VY,                     //centimetres per second, east
+        VZ,                     //centimetres per second, down
+        HEADING,                //centidegrees, 65535 if unknown
+        TIME_BOOT,              //milliseconds since the autopilot booted
+        BATTERY_VOLTAGE,        //millivolts
+        BATTERY_CURRENT,        //centiamperes, -1 if unknown
+        BATTERY_REMAINING,      //percent, -1 if unknown
+        GPS_FIX_TYPE,           //MAVLink GPS_FIX_TYPE
+        SATELLITES_VISIBLE,     //255 if unknown
+        FIELD_COUNT
+    };
+
+    /**
+     * One entry of the schema. A field is transmitted as round((value - offset) / step), clamped to the range that
+     * fits into the given number of bits.
+     */
+    struct FieldSpec {
+        //The field being described.
+        FieldId id;
+        //The number of bits the quantized field occupies on the wire (1 - 63).
+        uint8_t bits;
+        //A boolean to indicate if the quantized field is two's complement.
+        bool isSigned;
+        //The size of one quantization step in the field's native unit.
+        int32_t step;
+        //The value, in the field's native unit, that is subtracted before quantizing.
+        int32_t offset;
+    };
+
+    //The standard schema, and the only schema of format version 1. The order of the entries is the order of the
+    // fields on the wire.
+    static const FieldSpec standardFields[] = {
+            {UNIX_TIME_MILLIS,  42, false, 1,   0},         //1 ms, until 2109
+            {LATITUDE,          25, true,  100, 0},         //1E-5 deg (~1.1 m), +-167 deg
+            {LONGITUDE,         26, true,  100, 0},         //1E-5 deg (~1.1 m), +-335 deg
+            {ALTITUDE,          17, false, 100, -1000000},  //0.1 m, -1000 m to 12107 m
+            {RELATIVE_ALTITUDE, 17, true,  100, 0},         //0.1 m, +-6553 m
+            {ROLL,              16, true,  1,   0},         //1E-4 rad, +-3.2767 rad
+            {PITCH,             16, true,  1,   0},         //1E-4 rad, +-3.2767 rad
+            {YAW,               16, true,  1,   0},         //1E-4 rad, +-3.2767 rad
+            {ROLL_SPEED,        12, true,  5,   0},         //0.005 rad/s, +-10.2 rad/s
+            {PITCH_SPEED,       12, true,  5,   0},         //0.005 rad/s, +-10.2 rad/s
+            {YAW_SPEED,         12, true,  5,   0},         //0.005 rad/s, +-10.2 rad/s
+            {VX,                12, true,  10,  0},         //0.1 m/s, +-204.7 m/s
+            {VY,                12, true,  10,  0},         //0.1 m/s, +-204.7 m/s
+            {VZ,                10, true,  10,  0},         //0.1 m/s, +-51.1 m/s
+            {HEADING,           9,  false, 100, 0},         //1 deg, 511 if unknown
+            {TIME_BOOT,         24, false, 100, 0},         //0.1 s, ~19 days
+    };
+
+    //The number of entries in the standard schema.
+    static const size_t standardFieldCount = sizeof(standardFields) / sizeof(standardFields[0]);
+
+    //The position schema: just where the vehicle is and where it is going, at half the size of the standard schema.
+    static const FieldSpec positionFields[] = {
+            {UNIX_TIME_MILLIS,  42, false, 1,   0},         //1 ms, until 2109
+            {LATITUDE,          25, true,  100, 0},         //1E-5 deg (~1.1 m), +-167 deg
+            {LONGITUDE,         26, true,  100, 0},         //1E-5 deg (~1.1 m), +-335 deg
+            {ALTITUDE,          17, false, 100, -1000000},  //0.1 m, -1000 m to 12107 m
+            {VX,                12, true,  10,  0},         //0.1 m/s, +-204.7 m/s
+            {VY,                12, true,  10,  0},         //0.1 m/s, +-204.7 m/s
+            {HEADING,           9,  false, 100, 0},         //1 deg, 511 if unknown
+    };
+
+    //The fields the extended schema appends to the standard schema: the battery from SYS_STATUS and the GPS receiver
+    // state from GPS_RAW_INT.
+    static const FieldSpec extensionFields[] = {
+            {BATTERY_VOLTAGE,   13, false, 10,  0},         //0.01 V, up to 81.91 V
+            {BATTERY_CURRENT,   12, true,  10,  0},         //0.1 A, +-204.7 A
+            {BATTERY_REMAINING, 8,  true,  1,   0},         //1 %, -1 if unknown
+            {GPS_FIX_TYPE,      4,  false, 1,   0},         //GPS_FIX_TYPE
+            {SATELLITES_VISIBLE, 8, false, 1,   0},         //255 if unknown
+    };
+
+    /**
+     * A single telemetry sample, indexed by FieldId.
+     */
+    struct TelemetrySample {
+        int64_t fields[FIELD_COUNT]{};
+    };
+
+    /**
+     * Writes values of arbitrary bit width into a byte buffer, most significant bit first.
+     */
+    class BitWriter {
+
+    public:
+        /**
+         * Constructor
+         * @param buffer - the buffer to write to.
+         * @param capacity - the size of the buffer in bytes.
+         */
+        BitWriter(uint8_t *buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+        /**
+         * Append the lowest bits of a value to the buffer.
+         * @param value - the value to append.
+         * @param bits - the number of bits to append (0 - 64).
+         */
+        void write(uint64_t value, uint8_t bits) {
+            for (int i = bits - 1; i >= 0; i--) {
+                size_t byteIndex = bitPosition >> 3;
+                if (byteIndex >= capacity) {
+                    overflowed = true;
+                    return;
+                }
+                uint8_t mask = (uint8_t) (0x80 >> (bitPosition & 7));
+                if ((value >> i) & 1) {
+                    buffer[byteIndex] |= mask;
+                } else {
+                    buffer[byteIndex] &= (uint8_t) ~mask;
+                }
+                bitPosition++;
+            }
+        }
+
+        /**
+         * The number of whole bytes used so far, including a partially filled last byte.
+         * @return size_t - the number of bytes used.
+         */
+        size_t bytesUsed() const {
+            return (bitPosition + 7) >> 3;
+        }
+
+        /**
+         * The number of bits written so far.
+         * @return size_t - the number of bits written.
+         */
+        size_t bitsUsed() const {
+            return bitPosition;
+        }
+
+        //A boolean to indicate if a write did not fit into the buffer.
+        bool overflowed = false;
+
+    private:
+        uint8_t *buffer;
+        size_t capacity;
+        size_t bitPosition = 0;
+    };
+
+    /**
+     * Reads values of arbitrary bit width out of a byte buffer, most significant bit first.
+     */
+    class BitReader {
+
+    public:
+        /**
+         * Constructor
+         * @param buffer - the buffer to read from.
+         * @param length - the number of valid bytes in the buffer.
+         */
+        BitReader(const uint8_t *buffer, size_t length) : buffer(buffer), length(length) {}
+
+        /**
+         * Read the next value from the buffer.
+         * @param bits - the number of bits to read (0 - 64).
+         * @return uint64_t - the value, 0 if the buffer ran out.
+         */
+        uint64_t read(uint8_t bits) {
+            uint64_t value = 0;
+            for (uint8_t i = 0; i < bits; i++) {
+                size_t byteIndex = bitPosition >> 3;
+                if (byteIndex >= length) {
+                    exhausted = true;
+                    return 0;
+                }
+                value = (value << 1) | ((buffer[byteIndex] >> (7 - (bitPosition & 7))) & 1);
+                bitPosition++;
+            }
+            return value;
+        }
+
+        /**
+         * The number of bits read so far.
+         * @return size_t - the number of bits read.
+         */
+        size_t bitsUsed() const {
+            return bitPosition;
+        }
+
+        //A boolean to indicate if a read went past the end of the buffer.
+        bool exhausted = false;
+
+    private:
+        const uint8_t *buffer;
+        size_t length;
+        size_t bitPosition = 0;
+    };
+
+    /**
+     * The mask of the lowest bits of a value that a field of a bit width keeps.
+     * @param bits - the bit width of the field.
+     * @return uint64_t - the mask.
+     */
+    inline uint64_t fieldMask(uint8_t bits) {
+        //built unsigned, so that a 63 or 64 bit field does not shift into the sign bit
+        return bits == 0 ? 0 : UINT64_MAX >> (64 - (bits > 64 ? 64 : bits));
+    }
+
+    /**
+     * Quantize a value according to its schema entry, rounding to the nearest step and clamping to the bit width.
+     * @param spec - the schema entry of the field.
+     * @param value - the value in the field's native unit.
+     * @return uint64_t - the quantized value, ready to be written with spec.bits bits.
+     */
+    inline uint64_t quantize(const FieldSpec &spec, int64_t value) {
+        int64_t shifted = value - spec.offset;
+        int64_t q = shifted >= 0 ? (shifted + spec.step / 2) / spec.step : (shifted - spec.step / 2) / spec.step;
+
+        uint64_t mask = fieldMask(spec.bits);
+        int64_t max = spec.isSigned ? (int64_t) (mask >> 1) : (int64_t) mask;
+        int64_t min = spec.isSigned ? -max - 1 : 0;
+        if (q < min) {
+            q = min;
+        } else if (q > max) {
+            q = max;
+        }
+
+        //keep only the bits of the field, which turns a negative value into its two's complement form
+        return (uint64_t) q & mask;
+    }
+
+    /**
+     * Reverse quantize().
+     * @param spec - the schema entry of the field.
+     * @param raw - the quantized value as read from the wire.
+     * @return int64_t - the value in the field's native unit.
+     */
+    inline int64_t dequantize(const FieldSpec &spec, uint64_t raw) {
+        int64_t q = (int64_t) raw;
+
+        //sign-extend negative two's complement values
+        if (spec.isSigned && spec.bits > 0 && (raw >> (spec.bits - 1)) & 1) {
+            q = (int64_t) (raw | ~fieldMask(spec.bits));
+        }
+        return q * spec.step + spec.offset;
+    }
+
+    /**
+     * The number of bytes a sample encoded with the standard schema occupies, including the version byte.
+     * @return size_t - the encoded size in bytes.
+     */
+    inline size_t encodedSize() {
+        size_t bits = 0;
+        for (size_t i = 0; i < standardFieldCount; i++) {
+            bits += standardFields[i].bits;
+        }
+        return 1 + (bits + 7) / 8;
+    }
+
+    /**
+     * Encode a sample into a buffer.
+     * @param sample - the sample to encode.
+     * @param buffer - the buffer to encode into.
+     * @param capacity - the size of the buffer in bytes.
+     * @return size_t - the number of bytes written, 0 if the buffer is too small.
+     */
+    inline size_t encode(const TelemetrySample &sample, uint8_t *buffer, size_t capacity) {
+        BitWriter writer(buffer, capacity);
+        writer.write(formatVersion, 8);
+        for (size_t i = 0; i < standardFieldCount; i++) {
+            writer.write(quantize(standardFields[i], sample.fields[standardFields[i].id]), standardFields[i].bits);
+        }
+        return writer.overflowed ? 0 : writer.bytesUsed();
+    }
+
+    /**
+     * Map a signed value onto an unsigned one so that values close to zero stay small (0, -1, 1, -2 -> 0, 1, 2, 3).
+     * @param value - the signed value.
+     * @return uint64_t - the zigzag encoded value.
+     */
+    inline uint64_t zigzagEncode(int64_t value) {
+        return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+    }
+
+    /**
+     * Reverse zigzagEncode().
+     * @param value - the zigzag encoded value.
+     * @return int64_t - the signed value.
+     */
+    inline int64_t zigzagDecode(uint64_t value) {
+        return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+    }
+
+    /**
+     * The number of bytes a value occupies as a varint (7 bits per byte, high bit set on all but the last byte).
+     * @param value - the value.
+     * @return size_t - the encoded size in bytes.
+     */
+    inline size_t varintSize(uint64_t value) {
+        size_t size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    /**
+     * Write a value as a varint.
+     * @param value - the value.
+     * @param buffer - the buffer to write to, must have at least varintSize(value) bytes left.
+     * @return size_t - the number of bytes written.
+     */
+    inline size_t writeVarint(uint64_t value, uint8_t *buffer) {
+        size_t size = 0;
+        while (value >= 0x80) {
+            buffer[size++] = (uint8_t) (value | 0x80);
+            value >>= 7;
+        }
+        buffer[size++] = (uint8_t) value;
+        return size;
+    }
+
+    /**
+     * Read a varint.
+     * @param buffer - the buffer to read from.
+     * @param length - the number of bytes left in the buffer.
+     * @param value - set to the decoded value.
+     * @return size_t - the number of bytes read, 0 if the varint is truncated or longer than 10 bytes.
+     */
+    inline size_t readVarint(const uint8_t *buffer, size_t length, uint64_t &value) {
+        value = 0;
+        for (size_t i = 0; i < length && i < 10; i++) {
+            value |= (uint64_t) (buffer[i] & 0x7F) << (7 * i);
+            if (!(buffer[i] & 0x80)) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * The schemas built into the firmware and the decoders. A runtime schema is always derived from one of them.
+     */
+    enum SchemaId : uint8_t {
+        SCHEMA_STANDARD = 0,        //attitude and position, the schema of format version 1
+        SCHEMA_POSITION,            //position and velocity only
+        SCHEMA_EXTENDED,            //the standard schema, battery and GPS receiver state
+        SCHEMA_COUNT
+    };
+
+    /**
+     * A runtime schema: the fields that are sampled and sent, in wire order, and their quantization.
+     */
+    struct Schema {
+        //The built-in schema this schema was derived from.
+        uint8_t base = SCHEMA_STANDARD;
+        //The number of fields in the schema.
+        uint8_t length = 0;
+        FieldSpec fields[FIELD_COUNT]{};
+    };
+
+    /**
+     * Get a built-in schema.
+     * @param id - the SchemaId of the schema.
+     * @param schema - set to the schema.
+     * @return bool - true if the schema exists, false otherwise.
+     */
+    inline bool builtInSchema(uint8_t id, Schema &schema) {
+        schema = Schema();
+        schema.base = id;
+        switch (id) {
+            case SCHEMA_STANDARD:
+            case SCHEMA_EXTENDED:
+                for (size_t i = 0; i < standardFieldCount; i++) {
+                    schema.fields[schema.length++] = standardFields[i];
+                }
+                if (id == SCHEMA_EXTENDED) {
+                    for (const FieldSpec &spec : extensionFields) {
+                        schema.fields[schema.length++] = spec;
+                    }
+                }
+                return true;
+            case SCHEMA_POSITION:
+                for (const FieldSpec &spec : positionFields) {
+                    schema.fields[schema.length++] = spec;
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Find a field in a schema.
+     * @param schema - the schema.
+     * @param id - the field.
+     * @return int - the index of the field in the schema, -1 if the schema does not contain it.
+     */
+    inline int findField(const Schema &schema, FieldId id) {
+        for (uint8_t i = 0; i < schema.length; i++) {
+            if (schema.fields[i].id == id) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Whether two schema entries quantize their field the same way.
+     * @param a - the first entry.
+     * @param b - the second entry.
+     * @return bool - true if the entries are equal.
+     */
+    inline bool sameSpec(const FieldSpec &a, const FieldSpec &b) {
+        return a.id == b.id && a.bits == b.bits && a.isSigned == b.isSigned && a.step == b.step &&
+               a.offset == b.offset;
+    }
+
+    /**
+     * Add, change or remove a field of a schema. A field that is added goes to its place in the base schema, or after
+     * all base fields in FieldId order if the base schema does not have it, so that the wire order only depends on
+     * which fields there are and not on the order in which they were added.
+     * @param schema - the schema to change.
+     * @param spec - the new entry of the field, 0 bits to remove the field.
+     */
+    inline void setField(Schema &schema, const FieldSpec &spec) {
+        int index = findField(schema, spec.id);
+        if (spec.bits == 0) {
+            if (index >= 0) {
+                for (uint8_t i = (uint8_t) index; i + 1 < schema.length; i++) {
+                    schema.fields[i] = schema.fields[i + 1];
+                }
+                schema.length--;
+            }
+            return;
+        }
+        if (index >= 0) {
+            schema.fields[index] = spec;
+            return;
+        }
+
+        //the place of a field: its index in the base schema, or after the base schema in FieldId order
+        Schema base;
+        builtInSchema(schema.base, base);
+        auto rank = [&base](FieldId id) {
+            int baseIndex = findField(base, id);
+            return baseIndex >= 0 ? baseIndex : FIELD_COUNT + id;
+        };
+        uint8_t position = schema.length;
+        while (position > 0 && rank(schema.fields[position - 1].id) > rank(spec.id)) {
+            schema.fields[position] = schema.fields[position - 1];
+            position--;
+        }
+        schema.fields[position] = spec;
+        schema.length++;
+    }
+
+    /**
+     * Write one entry of a schema descriptor: the field ID byte, the bits byte (0x80 if signed, 0 if the field is
+     * removed) and, unless removed, the step as a varint and the offset as a zigzag varint.
+     * @param spec - the schema entry.
+     * @param removed - a boolean to indicate if the field is removed from the base schema.
+     * @param buffer - the buffer to write to, nullptr to only measure the entry.
+     * @return size_t - the size of the entry in bytes.
+     */
+    inline size_t writeSchemaEntry(const FieldSpec &spec, bool removed, uint8_t *buffer) {
+        uint8_t scratch[2 + 10 + 10];
+        uint8_t *out = buffer != nullptr ? buffer : scratch;
+        out[0] = spec.id;
+        if (removed) {
+            out[1] = 0;
+            return 2;
+        }
+        out[1] = (uint8_t) (spec.bits | (spec.isSigned ? 0x80 : 0));
+        size_t size = 2 + writeVarint((uint64_t) spec.step, out + 2);
+        return size + writeVarint(zigzagEncode(spec.offset), out + size);
+    }
+
+    /**
+     * Write the descriptor of a schema: the base SchemaId byte followed by an entry for every field that differs
+     * from the base schema. A built-in schema is described by a single byte.
+     * @param schema - the schema.
+     * @param buffer - the buffer to write to, nullptr to only measure the descriptor.
+     * @return size_t - the size of the descriptor in bytes.
+     */
+    inline size_t writeSchemaDescriptor(const Schema &schema, uint8_t *buffer) {
+        Schema base;
+        builtInSchema(schema.base, base);
+        if (buffer != nullptr) {
+            buffer[0] = schema.base;
+        }
+        size_t size = 1;
+
+        //fields of the base schema that were removed or quantized differently
+        for (uint8_t i = 0; i < base.length; i++) {
+            int index = findField(schema, base.fields[i].id);
+            if (index < 0) {
+                size += writeSchemaEntry(base.fields[i], true, buffer != nullptr ? buffer + size : nullptr);
+            } else if (!sameSpec(schema.fields[index], base.fields[i])) {
+                size += writeSchemaEntry(schema.fields[index], false, buffer != nullptr ? buffer + size : nullptr);
+            }
+        }
+
+        //fields that were added
+        for (uint8_t i = 0; i < schema.length; i++) {
+            if (findField(base, schema.fields[i].id) < 0) {
+                size += writeSchemaEntry(schema.fields[i], false, buffer != nullptr ? buffer + size : nullptr);
+            }
+        }
+        return size;
+    }
+
+    /**
+     * The number of bytes the descriptor of a schema occupies.
+     * @param schema - the schema.
+     * @return size_t - the descriptor size in bytes.
+     */
+    inline size_t schemaDescriptorSize(const Schema &schema) {
+        return writeSchemaDescriptor(schema, nullptr);
+    }
+
+    /**
+     * Whether a schema is the standard schema, which a sample section uses unless a schema section precedes it.
+     * @param schema - the schema.
+     * @return bool - true if the schema is the unchanged standard schema.
+     */
+    inline bool isStandardSchema(const Schema &schema) {
+        return schema.base == SCHEMA_STANDARD && schemaDescriptorSize(schema) == 1;
+    }
+
+    /**
+     * Read the descriptor of a schema.
+     * @param buffer - the buffer holding the descriptor.
+     * @param length - the length of the descriptor.
+     * @param schema - set to the schema.
+     * @return bool - true if the descriptor was valid, false otherwise.
+     */
+    inline bool readSchemaDescriptor(const uint8_t *buffer, size_t length, Schema &schema) {
+        if (length < 1 || !builtInSchema(buffer[0], schema)) {
+            return false;
+        }
+        size_t offset = 1;
+        while (offset < length) {
+            if (length - offset < 2 || buffer[offset] >= FIELD_COUNT) {
+                return false;
+            }
+            FieldSpec spec = {(FieldId) buffer[offset], (uint8_t) (buffer[offset + 1] & 0x7F),
+                              (buffer[offset + 1] & 0x80) != 0, 0, 0};
+            offset += 2;
+            if (spec.bits > 0) {
+                uint64_t step;
+                uint64_t value;
+                size_t used = readVarint(buffer + offset, length - offset, step);
+                if (used == 0) {
+                    return false;
+                }
+                offset += used;
+                used = readVarint(buffer + offset, length - offset, value);
+                if (used == 0) {
+                    return false;
+                }
+                offset += used;
+                int64_t fieldOffset = zigzagDecode(value);
+                if (spec.bits > 63 || step < 1 || step > INT32_MAX || fieldOffset < INT32_MIN ||
+                    fieldOffset > INT32_MAX) {
+                    return false;
+                }
+                spec.step = (int32_t) step;
+                spec.offset = (int32_t) fieldOffset;
+            }
+            setField(schema, spec);
+        }
+        return true;
+    }
+
+    /**
+     * The number of bytes a sample bit-packed with a schema occupies, without a version byte.
+     * @param schema - the schema.
+     * @return size_t - the keyframe size in bytes.
+     */
+    inline size_t keyframeSize(const Schema &schema) {
+        size_t bits = 0;
+        for (uint8_t i = 0; i < schema.length; i++) {
+            bits += schema.fields[i].bits;
+        }
+        return (bits + 7) / 8;
+    }
+
+    /**
+     * Bit-pack the fields of a sample with a schema.
+     * @param schema - the schema.
+     * @param sample - the sample.
+     * @param writer - the writer to append to.
+     */
+    inline void writeKeyframe(const Schema &schema, const TelemetrySample &sample, BitWriter &writer) {
+        for (uint8_t i = 0; i < schema.length; i++) {
+            writer.write(quantize(schema.fields[i], sample.fields[schema.fields[i].id]), schema.fields[i].bits);
+        }
+    }
+
+    /**
+     * Read the fields of a sample bit-packed with a schema. Fields the schema does not have are left untouched.
+     * @param schema - the schema.
+     * @param reader - the reader to read from.
+     * @param sample - the sample to fill in.
+     */
+    inline void readKeyframe(const Schema &schema, BitReader &reader, TelemetrySample &sample) {
+        for (uint8_t i = 0; i < schema.length; i++) {
+            sample.fields[schema.fields[i].id] = dequantize(schema.fields[i], reader.read(schema.fields[i].bits));
+        }
+    }
+
+    /**
+     * The difference of one quantized field between two samples, as it is sent in a batch delta.
+     * @param spec - the schema entry of the field.
+     * @param previous - the previous sample.
+     * @param current - the current sample.
+     * @return uint64_t - the zigzag encoded difference of the quantized field.
+     */
+    inline uint64_t quantizedDelta(const FieldSpec &spec, const TelemetrySample &previous,
+                                   const TelemetrySample &current) {
+        int64_t a = dequantize(spec, quantize(spec, previous.fields[spec.id]));
+        int64_t b = dequantize(spec, quantize(spec, current.fields[spec.id]));
+        return zigzagEncode((b - a) / spec.step);
+    }
+
+    /**
+     * The number of bytes the delta of a sample from the previous sample occupies in a batch.
+     * @param schema - the schema of the batch.
+     * @param previous - the previous sample.
+     * @param current - the current sample.
+     * @return size_t - the encoded size of the delta in bytes.
+     */
+    inline size_t deltaSize(const Schema &schema, const TelemetrySample &previous, const TelemetrySample &current) {
+        size_t size = 0;
+        for (uint8_t i = 0; i < schema.length; i++) {
+            size += varintSize(quantizedDelta(schema.fields[i], previous, current));
+        }
+        return size;
+    }
+
+    /**
+     * Encode as many of the newest samples as fit into the buffer as the body of a batch: a count byte, the oldest
+     * encoded sample as a bit-packed keyframe and a delta from the previous sample for every following one.
+     * @param schema - the schema of the batch.
+     * @param samples - the samples to encode, oldest first.
+     * @param count - the number of samples (at most 255).
+     * @param buffer - the buffer to encode into.
+     * @param capacity - the size of the buffer in bytes.
+     * @param encodedCount - set to the number of samples that were encoded. These are always the newest ones.
+     * @return size_t - the number of bytes written, 0 if not even one sample fits.
+     */
+    inline size_t encodeBatchBody(const Schema &schema, const TelemetrySample *samples, size_t count,
+                                  uint8_t *buffer, size_t capacity, size_t &encodedCount) {
+        encodedCount = 0;
+        if (count == 0 || count > 255) {
+            return 0;
+        }
+
+        //find the oldest sample that can serve as the keyframe without the batch overflowing the buffer
+        size_t keyframeLength = keyframeSize(schema);
+        size_t total = 1 + keyframeLength;
+        size_t first = count - 1;
+        while (first > 0) {
+            size_t extra = deltaSize(schema, samples[first - 1], samples[first]);
+            if (total + extra > capacity) {
+                break;
+            }
+            total += extra;
+            first--;
+        }
+        if (total > capacity) {
+            return 0;
+        }
+
+        //count and the bit-packed keyframe, padded to a whole byte
+        buffer[0] = (uint8_t) (count - first);
+        BitWriter writer(buffer + 1, keyframeLength);
+        writeKeyframe(schema, samples[first], writer);
+        writer.write(0, (uint8_t) (keyframeLength * 8 - writer.bitsUsed()));
+        size_t offset = 1 + keyframeLength;
+
+        //a zigzag/varint delta of every quantized field for each following sample
+        for (size_t s = first + 1; s < count; s++) {
+            for (uint8_t i = 0; i < schema.length; i++) {
+                offset += writeVarint(quantizedDelta(schema.fields[i], samples[s - 1], samples[s]), buffer + offset);
+            }
+        }
+
+        encodedCount = count - first;
+        return offset;
+    }
+
+    /**
+     * Encode as many of the newest samples as fit into the buffer as a single batch packet (format version 2).
+     * @param samples - the samples to encode, oldest first.
+     * @param count - the number of samples (at most 255).
+     * @param buffer - the buffer to encode into.
+     * @param capacity - the size of the buffer in bytes.
+     * @param encodedCount - set to the number of samples that were encoded. These are always the newest ones.
+     * @return size_t - the number of bytes written, 0 if not even one sample fits.
+     */
+    inline size_t encodeBatch(const TelemetrySample *samples, size_t count, uint8_t *buffer, size_t capacity,
+                              size_t &encodedCount) {
+        encodedCount = 0;
+        if (capacity < 1) {
+            return 0;
+        }
+        buffer[0] = batchFormatVersion;
+        Schema schema;
+        builtInSchema(SCHEMA_STANDARD, schema);
+        size_t bodyLength = encodeBatchBody(schema, samples, count, buffer + 1, capacity - 1, encodedCount);
+        return bodyLength == 0 ? 0 : 1 + bodyLength;
+    }
+
+    /**
+     * Decode the body of a batch. Fields the schema does not have are 0.
+     * @param schema - the schema of the batch.
+     * @param buffer - the buffer holding the body, starting with the count byte.
+     * @param length - the number of bytes in the body.
+     * @param samples - set to the decoded samples, oldest first.
+     * @param maxSamples - the number of samples that fit into the samples array.
+     * @return size_t - the number of decoded samples, 0 if the body is truncated or has too many samples.
+     */
+    inline size_t decodeBatchBody(const Schema &schema, const uint8_t *buffer, size_t length,
+                                  TelemetrySample *samples, size_t maxSamples) {
+        size_t keyframeLength = keyframeSize(schema);
+        if (length < 1 + keyframeLength) {
+            return 0;
+        }
+        size_t count = buffer[0];
+        if (count == 0 || count > maxSamples) {
+            return 0;
+        }
+
+        //the keyframe
+        BitReader reader(buffer + 1, keyframeLength);
+        samples[0] = TelemetrySample();
+        readKeyframe(schema, reader, samples[0]);
+        size_t offset = 1 + keyframeLength;
+
+        //the deltas, each applied to the previous sample in quantized steps
+        for (size_t s = 1; s < count; s++) {
+            samples[s] = samples[s - 1];
+            for (uint8_t i = 0; i < schema.length; i++) {
+                uint64_t value;
+                size_t used = readVarint(buffer + offset, length - offset, value);
+                if (used == 0) {
+                    return 0;
+                }
+                offset += used;
+                samples[s].fields[schema.fields[i].id] += zigzagDecode(value) * schema.fields[i].step;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Decode a batch packet (format version 2).
+     * @param buffer - the buffer holding the packet.
+     * @param length - the number of bytes in the buffer.
+     * @param samples - set to the decoded samples, oldest first.
+     * @param maxSamples - the number of samples that fit into the samples array.
+     * @return size_t - the number of decoded samples, 0 if the packet is unknown, truncated or too large.
+     */
+    inline size_t decodeBatch(const uint8_t *buffer, size_t length, TelemetrySample *samples, size_t maxSamples) {
+        if (length < 1 || buffer[0] != batchFormatVersion) {
+            return 0;
+        }
+        Schema schema;
+        builtInSchema(SCHEMA_STANDARD, schema);
+        return decodeBatchBody(schema, buffer + 1, length - 1, samples, maxSamples);
+    }
+
+    /**
+     * The types of section in a sectioned packet (format version 3). Each section is written as its type byte, its
+     * length as a varint and its payload. Unknown section types can be skipped by their length.
+     */
+    enum SectionType : uint8_t {
+        SECTION_SAMPLES = 1,        //a batch body: count, keyframe and deltas
+        SECTION_HEALTH = 2,         //a varint per HealthCounter, in order
+        SECTION_ACKNOWLEDGEMENTS = 3, //a kind byte and a varint value per Acknowledgement
+        SECTION_STATUS = 4,         //a varint per StatusField, in order
+        SECTION_SCHEMA = 5          //the schema descriptor of the samples section that follows, if not standard
+    };
+
+    /**
+     * The device health counters carried in a health section, in wire order. New counters are only ever appended,
+     * so an older decoder simply ignores the trailing ones.
+     */
+    enum HealthCounter : uint8_t {
+        UPTIME_SECONDS = 0,         //seconds since the device booted
+        SBD_SESSIONS,               //SBD sessions attempted since boot
+        SBD_FAILED_SESSIONS,        //SBD sessions that failed since boot
+        SBD_BYTES_SENT,             //mobile originated bytes delivered since boot
+        SBD_CREDITS_USED,           //50 byte credits used since boot
+        MAVLINK_RX_OVERFLOWS,       //MAVLink bytes dropped by the receive ring since boot
+        MAVLINK_RX_HIGH_WATER,      //largest number of bytes waiting in the receive ring
+        BACKLOG_PENDING,            //records waiting in the flash backlog
+        BACKLOG_OVERWRITTEN,        //backlog records overwritten before they were sent since boot
+        ACTIVE_PERMILLE,            //share of the last duty cycle window spent outside idle, in parts per thousand
+        BOOT_READY_SECONDS,         //seconds from boot until uploads were allowed, 0 while booting
+        MAVLINK_RATE_REQUESTS,      //message interval commands sent to the Pixhawk since boot
+        HEAP_ALLOCATIONS,           //heap allocations since boot, constant once the firmware is running
+        HEAP_FREE_CHUNKS,           //free chunks the heap is split into, a measure of its fragmentation
+        LOOP_P99_MICROS,            //99th percentile of an active loop() in the last latency report period
+        LATENCY_MAX_MICROS,         //longest run of a task, parse or modem call in the last latency report period
+        LATENCY_MAX_PROBE,          //the LatencyProfiler::Probe of that run, tasks from TASK_FIRST by scheduler id
+        HEALTH_COUNTER_COUNT
+    };
+
+    /**
+     * The device health counters, indexed by HealthCounter.
+     */
+    struct HealthCounters {
+        uint32_t counters[HEALTH_COUNTER_COUNT]{};
+    };
+
+    /**
+     * The device status fields carried in a status section, in wire order. The section is only sent when the status
+     * has changed since it was last delivered. New fields are only ever appended.
+     */
+    enum StatusField : uint8_t {
+        STATUS_GPS_FIX = 0,         //1 if the Pixhawk has reported a position since boot
+        STATUS_BOOTUP,              //1 until the first status after a cold boot has been delivered
+        STATUS_WARM_START,          //1 if the configuration was restored after an unplanned reset
+        STATUS_RESET_CAUSE,         //the SAMD21 reset cause register of the last reset
+        STATUS_CONFIG_SEQUENCE,     //the number of configurations accepted from the server
+        STATUS_FIELD_COUNT
+    };
+
+    /**
+     * The device status, indexed by StatusField.
+     */
+    struct DeviceStatus {
+        uint32_t fields[STATUS_FIELD_COUNT]{};
+    };
+
+    /**
+     * The kinds of acknowledgement the device sends back to the server.
+     */
+    enum AcknowledgementKind : uint8_t {
+        ACK_CONFIG = 1,             //value: upload interval in seconds << 1 | upload enabled
+        ACK_COMMAND = 2             //value: command sequence << 3 | ConfigProtocol::Result
+    };
+
+    /**
+     * An acknowledgement queued for the server.
+     */
+    struct Acknowledgement {
+        AcknowledgementKind kind;
+        uint32_t value;
+    };
+
+    //The version of the sectioned wire format: a sequence of typed, length-prefixed sections.
+    static const uint8_t sectionedFormatVersion = 3;
+
+    /**
+     * The number of bytes a section header (type and varint length) occupies.
+     * @param payloadLength - the length of the section payload.
+     * @return size_t - the size of the section header in bytes.
+     */
+    inline size_t sectionHeaderSize(size_t payloadLength) {
+        return 1 + varintSize(payloadLength);
+    }
+
+    /**
+     * Write a section header.
+     * @param type - the type of the section.
+     * @param payloadLength - the length of the section payload.
+     * @param buffer - the buffer to write to, must have at least sectionHeaderSize(payloadLength) bytes left.
+     * @return size_t - the number of bytes written.
+     */
+    inline size_t writeSectionHeader(SectionType type, size_t payloadLength, uint8_t *buffer) {
+        buffer[0] = type;
+        return 1 + writeVarint(payloadLength, buffer + 1);
+    }
+
+    /**
+     * The number of bytes the payload of a health section occupies.
+     * @param health - the health counters.
+     * @return size_t - the payload size in bytes.
+     */
+    inline size_t healthPayloadSize(const HealthCounters &health) {
+        size_t size = 0;
+        for (size_t i = 0; i < HEALTH_COUNTER_COUNT; i++) {
+            size += varintSize(health.counters[i]);
+        }
+        return size;
+    }
+
+    /**
+     * Write the payload of a health section.
+     * @param health - the health counters.
+     * @param buffer - the buffer to write to, must have at least healthPayloadSize(health) bytes left.
+     * @return size_t - the number of bytes written.
+     */
+    inline size_t writeHealthPayload(const HealthCounters &health, uint8_t *buffer) {
+        size_t offset = 0;
+        for (size_t i = 0; i < HEALTH_COUNTER_COUNT; i++) {
+            offset += writeVarint(health.counters[i], buffer + offset);
+        }
+        return offset;
+    }
+
+    /**
+     * The number of bytes the payload of a status section occupies.
+     * @param status - the device status.
+     * @return size_t - the payload size in bytes.
+     */
+    inline size_t statusPayloadSize(const DeviceStatus &status) {
+        size_t size = 0;
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; i++) {
+            size += varintSize(status.fields[i]);
+        }
+        return size;
+    }
+
+    /**
+     * Write the payload of a status section.
+     * @param status - the device status.
+     * @param buffer - the buffer to write to, must have at least statusPayloadSize(status) bytes left.
+     * @return size_t - the number of bytes written.
+     */
+    inline size_t writeStatusPayload(const DeviceStatus &status, uint8_t *buffer) {
+        size_t offset = 0;
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; i++) {
+            offset += writeVarint(status.fields[i], buffer + offset);
+        }
+        return offset;
+    }
+
+    /**
+     * The number of bytes the payload of an acknowledgement section occupies.
+     * @param acks - the acknowledgements.
+     * @param count - the number of acknowledgements.
+     * @return size_t - the payload size in bytes.
+     */
+    inline size_t acknowledgementPayloadSize(const Acknowledgement *acks, size_t count) {
+        size_t size = 0;
+        for (size_t i = 0; i < count; i++) {
+            size += 1 + varintSize(acks[i].value);
+        }
+        return size;
+    }
+
+    /**
+     * Write the payload of an acknowledgement section.
+     * @param acks - the acknowledgements.
+     * @param count - the number of acknowledgements.
+     * @param buffer - the buffer to write to, must have at least acknowledgementPayloadSize(acks, count) bytes left.
+     * @return size_t - the number of bytes written.
+     */
+    inline size_t writeAcknowledgementPayload(const Acknowledgement *acks, size_t count, uint8_t *buffer) {
+        size_t offset = 0;
+        for (size_t i = 0; i < count; i++) {
+            buffer[offset++] = acks[i].kind;
+            offset += writeVarint(acks[i].value, buffer + offset);
+        }
+        return offset;
+    }
+
+    /**
+     * Decode a sample from a buffer.
+     * @param buffer - the buffer holding the packet.
+     * @param length - the number of bytes in the buffer.
+     * @param sample - set to the decoded sample.
+     * @return bool - true if the packet has a known version and was long enough, false otherwise.
+     */
+    inline bool decode(const uint8_t *buffer, size_t length, TelemetrySample &sample) {
+        BitReader reader(buffer, length);
+        if (reader.read(8) != formatVersion) {
+            return false;
+        }
+        for (size_t i = 0; i < standardFieldCount; i++) {
+            sample.fields[standardFields[i].id] = dequantize(standardFields[i], reader.read(standardFields[i].bits));
+        }
+        return !reader.exhausted;
+    }
+
+    //The version of the flash backlog record format: a sample bit-packed with the extended schema, so that a
+    // spooled sample keeps every field whatever schema it is eventually sent with.
+    static const uint8_t recordFormatVersion = 4;
+
+    /**
+     * Encode a sample as a flash backlog record.
+     * @param sample - the sample to encode.
+     * @param buffer - the buffer to encode into.
+     * @param capacity - the size of the buffer in bytes.
+     * @return size_t - the number of bytes written, 0 if the buffer is too small.
+     */
+    inline size_t encodeRecord(const TelemetrySample &sample, uint8_t *buffer, size_t capacity) {
+        Schema schema;
+        builtInSchema(SCHEMA_EXTENDED, schema);
+        BitWriter writer(buffer, capacity);
+        writer.write(recordFormatVersion, 8);
+        writeKeyframe(schema, sample, writer);
+        return writer.overflowed ? 0 : writer.bytesUsed();
+    }
+
+    /**
+     * Decode a flash backlog record, including the format version 1 records of older firmware.
+     * @param buffer - the buffer holding the record.
+     * @param length - the number of bytes in the buffer.
+     * @param sample - set to the decoded sample.
+     * @return bool - true if the record has a known version and was long enough, false otherwise.
+     */
+    inline bool decodeRecord(const uint8_t *buffer, size_t length, TelemetrySample &sample) {
+        if (length < 1 || buffer[0] != recordFormatVersion) {
+            return decode(buffer, length, sample);
+        }
+        Schema schema;
+        builtInSchema(SCHEMA_EXTENDED, schema);
+        BitReader reader(buffer + 1, length - 1);
+        sample = TelemetrySample();
+        readKeyframe(schema, reader, sample);
+        return !reader.exhausted;
+    }
+}
+
+#endif //AERORADAREMBEDDED_TELEMETRYCODEC_H
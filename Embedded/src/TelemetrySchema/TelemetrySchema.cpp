@@ -0,0 +1,184 @@
+/**
+* @File: TelemetrySchema.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the TelemetrySchema class.
+*/
+
+#include "TelemetrySchema.h"
+#include <string.h>
+
+using namespace TelemetryCodec;
+
+TelemetrySchema::TelemetrySchema() {
+    select(SCHEMA_STANDARD);
+}
+
+bool TelemetrySchema::select(uint8_t id) {
+    Schema schema;
+    if (!builtInSchema(id, schema)) {
+        return false;
+    }
+    active = schema;
+    updateMessages();
+    return true;
+}
+
+bool TelemetrySchema::load(const Schema &schema) {
+    TelemetrySchema candidate = *this;
+    candidate.active = schema;
+    candidate.updateMessages();
+    if (!candidate.usable()) {
+        return false;
+    }
+    *this = candidate;
+    return true;
+}
+
+void TelemetrySchema::setField(const FieldSpec &spec) {
+    TelemetryCodec::setField(active, spec);
+    updateMessages();
+}
+
+bool TelemetrySchema::setInterval(uint32_t messageId, uint32_t intervalMillis) {
+    int index = indexOf(messageId);
+    if (index < 0 || intervalMillis == 0) {
+        return false;
+    }
+    messages[index].intervalMillis = intervalMillis;
+    return true;
+}
+
+bool TelemetrySchema::usable() const {
+    return findField(active, UNIX_TIME_MILLIS) >= 0 && count > 0;
+}
+
+const Schema &TelemetrySchema::schema() const {
+    return active;
+}
+
+uint8_t TelemetrySchema::messageCount() const {
+    return count;
+}
+
+const ConfigProtocol::MessageRate &TelemetrySchema::message(uint8_t index) const {
+    return messages[index];
+}
+
+int TelemetrySchema::indexOf(uint32_t messageId) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (messages[i].messageId == messageId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint32_t TelemetrySchema::triggerMessage() const {
+    if (count == 0 || indexOf(MAVLINK_MSG_ID_GLOBAL_POSITION_INT) >= 0) {
+        return MAVLINK_MSG_ID_GLOBAL_POSITION_INT;
+    }
+    return messages[0].messageId;
+}
+
+void TelemetrySchema::updateMessages() {
+    ConfigProtocol::MessageRate previous[maxMessages];
+    uint8_t previousCount = count;
+    memcpy(previous, messages, sizeof(messages));
+
+    count = 0;
+    for (uint8_t i = 0; i < active.length; i++) {
+        uint32_t messageId;
+        if (!sourceOf(active.fields[i].id, messageId) || indexOf(messageId) >= 0 || count == maxMessages) {
+            continue;
+        }
+
+        //a message that was already sampled keeps its interval
+        uint32_t intervalMillis = defaultIntervalMillis;
+        for (uint8_t j = 0; j < previousCount; j++) {
+            if (previous[j].messageId == messageId) {
+                intervalMillis = previous[j].intervalMillis;
+            }
+        }
+        messages[count++] = {messageId, intervalMillis};
+    }
+}
+
+bool TelemetrySchema::sourceOf(FieldId field, uint32_t &messageId) {
+    switch (field) {
+        case LATITUDE:
+        case LONGITUDE:
+        case ALTITUDE:
+        case RELATIVE_ALTITUDE:
+        case VX:
+        case VY:
+        case VZ:
+        case HEADING:
+        case TIME_BOOT:
+            messageId = MAVLINK_MSG_ID_GLOBAL_POSITION_INT;
+            return true;
+        case ROLL:
+        case PITCH:
+        case YAW:
+        case ROLL_SPEED:
+        case PITCH_SPEED:
+        case YAW_SPEED:
+            messageId = MAVLINK_MSG_ID_ATTITUDE;
+            return true;
+        case BATTERY_VOLTAGE:
+        case BATTERY_CURRENT:
+        case BATTERY_REMAINING:
+            messageId = MAVLINK_MSG_ID_SYS_STATUS;
+            return true;
+        case GPS_FIX_TYPE:
+        case SATELLITES_VISIBLE:
+            messageId = MAVLINK_MSG_ID_GPS_RAW_INT;
+            return true;
+        default:
+            //the timestamp comes from the global time base
+            return false;
+    }
+}
+
+bool TelemetrySchema::copyFields(const TelemetryStore &store, uint32_t messageId, TelemetrySample &sample) {
+    switch (messageId) {
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
+            const mavlink_global_position_int_t &globalPositionInt = store.globalPosition().value;
+            sample.fields[LATITUDE] = globalPositionInt.lat;
+            sample.fields[LONGITUDE] = globalPositionInt.lon;
+            sample.fields[ALTITUDE] = globalPositionInt.alt;
+            sample.fields[RELATIVE_ALTITUDE] = globalPositionInt.relative_alt;
+            sample.fields[VX] = globalPositionInt.vx;
+            sample.fields[VY] = globalPositionInt.vy;
+            sample.fields[VZ] = globalPositionInt.vz;
+            sample.fields[HEADING] = globalPositionInt.hdg;
+            sample.fields[TIME_BOOT] = globalPositionInt.time_boot_ms;
+            return true;
+        }
+        case MAVLINK_MSG_ID_ATTITUDE: {
+            const mavlink_attitude_t &attitude = store.attitude().value;
+            sample.fields[ROLL] = lroundf(attitude.roll * 1E4f);
+            sample.fields[PITCH] = lroundf(attitude.pitch * 1E4f);
+            sample.fields[YAW] = lroundf(attitude.yaw * 1E4f);
+            sample.fields[ROLL_SPEED] = lroundf(attitude.rollspeed * 1E3f);
+            sample.fields[PITCH_SPEED] = lroundf(attitude.pitchspeed * 1E3f);
+            sample.fields[YAW_SPEED] = lroundf(attitude.yawspeed * 1E3f);
+            return true;
+        }
+        case MAVLINK_MSG_ID_SYS_STATUS: {
+            const mavlink_sys_status_t &sysStatus = store.sysStatus().value;
+            sample.fields[BATTERY_VOLTAGE] = sysStatus.voltage_battery;
+            sample.fields[BATTERY_CURRENT] = sysStatus.current_battery;
+            sample.fields[BATTERY_REMAINING] = sysStatus.battery_remaining;
+            return true;
+        }
+        case MAVLINK_MSG_ID_GPS_RAW_INT: {
+            const mavlink_gps_raw_int_t &gpsRawInt = store.gpsRawInt().value;
+            sample.fields[GPS_FIX_TYPE] = gpsRawInt.fix_type;
+            sample.fields[SATELLITES_VISIBLE] = gpsRawInt.satellites_visible;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+* @File: TelemetrySchema.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the TelemetrySchema class, the runtime table of what reaches the satellite:
+ * the telemetry fields that are sampled and sent with their precision, the MAVLink messages those fields come from and
+ * the interval each message is requested from the Pixhawk at. The table is selected and tuned over the satellite link
+ * by configuration commands, so that fields can be traded for bytes per mission, e.g. adding the battery from
+ * SYS_STATUS, without reflashing the firmware.
+*/
+
+#ifndef AERORADAREMBEDDED_TELEMETRYSCHEMA_H
+#define AERORADAREMBEDDED_TELEMETRYSCHEMA_H
+
+#include "MavlinkInterpreter/MavlinkInterpreter.h"
+#include "TelemetryStore/TelemetryStore.h"
+#include "TelemetryCodec/TelemetryCodec.h"
+#include "ConfigProtocol/ConfigProtocol.h"
+
+/**
+ * The fields that are sampled and sent, and the MAVLink messages they are sampled from.
+ */
+class TelemetrySchema {
+
+public:
+    //The most MAVLink messages the fields of a schema can come from.
+    static const uint8_t maxMessages = 4;
+
+    //The interval a message is requested at until a configuration command sets another.
+    static const uint32_t defaultIntervalMillis = 1000;
+
+    /**
+     * Constructor, the standard schema.
+     */
+    TelemetrySchema();
+
+    /**
+     * Switch to a built-in schema, dropping any changed fields. Messages that are still needed keep their interval.
+     * @param id - the TelemetryCodec::SchemaId of the schema.
+     * @return bool - true if the schema exists, false otherwise.
+     */
+    bool select(uint8_t id);
+
+    /**
+     * Switch to a schema, e.g. one restored from its descriptor.
+     * @param schema - the schema.
+     * @return bool - true if the schema is usable and was taken, false otherwise.
+     */
+    bool load(const TelemetryCodec::Schema &schema);
+
+    /**
+     * Add, change or remove a field.
+     * @param spec - the new schema entry of the field, 0 bits to remove the field.
+     */
+    void setField(const TelemetryCodec::FieldSpec &spec);
+
+    /**
+     * Set the interval a message of the schema is requested at.
+     * @param messageId - the MAVLink message ID.
+     * @param intervalMillis - the interval in milliseconds.
+     * @return bool - true if the schema samples the message and the interval is not 0, false otherwise.
+     */
+    bool setInterval(uint32_t messageId, uint32_t intervalMillis);
+
+    /**
+     * Whether samples can be taken and sent with the schema: it has a timestamp and at least one field from the
+     * Pixhawk.
+     * @return bool - true if the schema is usable.
+     */
+    bool usable() const;
+
+    /**
+     * The schema the samples are encoded with.
+     * @return const TelemetryCodec::Schema& - the schema.
+     */
+    const TelemetryCodec::Schema &schema() const;
+
+    /**
+     * The number of MAVLink messages the fields of the schema come from.
+     * @return uint8_t - the number of messages.
+     */
+    uint8_t messageCount() const;
+
+    /**
+     * A MAVLink message the fields of the schema come from, and its interval.
+     * @param index - the index of the message, less than messageCount().
+     * @return const ConfigProtocol::MessageRate& - the message and its interval.
+     */
+    const ConfigProtocol::MessageRate &message(uint8_t index) const;
+
+    /**
+     * Find a MAVLink message in the schema.
+     * @param messageId - the MAVLink message ID.
+     * @return int - the index of the message, -1 if the schema does not sample it.
+     */
+    int indexOf(uint32_t messageId) const;
+
+    /**
+     * The message whose arrival completes a sample: the position if the schema samples it, otherwise the first
+     * message of the schema.
+     * @return uint32_t - the MAVLink message ID, MAVLINK_MSG_ID_GLOBAL_POSITION_INT if there are no messages.
+     */
+    uint32_t triggerMessage() const;
+
+    /**
+     * The MAVLink message a field is sampled from.
+     * @param field - the field.
+     * @param messageId - set to the MAVLink message ID.
+     * @return bool - true if the field comes from a MAVLink message, false if the device fills it in itself.
+     */
+    static bool sourceOf(TelemetryCodec::FieldId field, uint32_t &messageId);
+
+    /**
+     * Copy every field that comes from a MAVLink message into a sample, in the native unit expected by the codec.
+     * @param store - the telemetry store holding the latest copy of the message.
+     * @param messageId - the MAVLink message ID.
+     * @param sample - the sample to fill in. Fields of other messages are left untouched.
+     * @return bool - true if the message is a source of fields, false otherwise.
+     */
+    static bool copyFields(const TelemetryStore &store, uint32_t messageId, TelemetryCodec::TelemetrySample &sample);
+
+private:
+    /**
+     * Rebuild the message list from the fields of the schema, keeping the intervals of messages still needed.
+     */
+    void updateMessages();
+
+    TelemetryCodec::Schema active;
+
+    //the messages the fields come from, in the order of their first field
+    ConfigProtocol::MessageRate messages[maxMessages]{};
+    uint8_t count = 0;
+};
+
+#endif //AERORADAREMBEDDED_TELEMETRYSCHEMA_H
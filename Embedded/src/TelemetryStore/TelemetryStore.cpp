@@ -0,0 +1,83 @@
+/**
+* @File: TelemetryStore.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the TelemetryStore class.
+*/
+
+#include "TelemetryStore.h"
+
+bool TelemetryStore::write(const mavlink_message_t &msg, unsigned long now) {
+    switch (msg.msgid) {
+        case MAVLINK_MSG_ID_ATTITUDE:
+            mavlink_msg_attitude_decode(&msg, &attitudeEntry.value);
+            stamp(attitudeEntry.receivedMillis, attitudeEntry.sequence, now);
+            return true;
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+            mavlink_msg_global_position_int_decode(&msg, &globalPositionEntry.value);
+            stamp(globalPositionEntry.receivedMillis, globalPositionEntry.sequence, now);
+            return true;
+        case MAVLINK_MSG_ID_SYS_STATUS:
+            mavlink_msg_sys_status_decode(&msg, &sysStatusEntry.value);
+            stamp(sysStatusEntry.receivedMillis, sysStatusEntry.sequence, now);
+            return true;
+        case MAVLINK_MSG_ID_GPS_RAW_INT:
+            mavlink_msg_gps_raw_int_decode(&msg, &gpsRawIntEntry.value);
+            stamp(gpsRawIntEntry.receivedMillis, gpsRawIntEntry.sequence, now);
+            return true;
+        case MAVLINK_MSG_ID_SYSTEM_TIME:
+            mavlink_msg_system_time_decode(&msg, &systemTimeEntry.value);
+            stamp(systemTimeEntry.receivedMillis, systemTimeEntry.sequence, now);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TelemetryStore::supports(uint32_t messageId) {
+    return messageId == MAVLINK_MSG_ID_ATTITUDE || messageId == MAVLINK_MSG_ID_GLOBAL_POSITION_INT ||
+           messageId == MAVLINK_MSG_ID_SYS_STATUS || messageId == MAVLINK_MSG_ID_GPS_RAW_INT ||
+           messageId == MAVLINK_MSG_ID_SYSTEM_TIME;
+}
+
+uint32_t TelemetryStore::sequence(uint32_t messageId) const {
+    switch (messageId) {
+        case MAVLINK_MSG_ID_ATTITUDE:
+            return attitudeEntry.sequence;
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+            return globalPositionEntry.sequence;
+        case MAVLINK_MSG_ID_SYS_STATUS:
+            return sysStatusEntry.sequence;
+        case MAVLINK_MSG_ID_GPS_RAW_INT:
+            return gpsRawIntEntry.sequence;
+        case MAVLINK_MSG_ID_SYSTEM_TIME:
+            return systemTimeEntry.sequence;
+        default:
+            return 0;
+    }
+}
+
+unsigned long TelemetryStore::receivedMillis(uint32_t messageId) const {
+    switch (messageId) {
+        case MAVLINK_MSG_ID_ATTITUDE:
+            return attitudeEntry.receivedMillis;
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+            return globalPositionEntry.receivedMillis;
+        case MAVLINK_MSG_ID_SYS_STATUS:
+            return sysStatusEntry.receivedMillis;
+        case MAVLINK_MSG_ID_GPS_RAW_INT:
+            return gpsRawIntEntry.receivedMillis;
+        case MAVLINK_MSG_ID_SYSTEM_TIME:
+            return systemTimeEntry.receivedMillis;
+        default:
+            return 0;
+    }
+}
+
+void TelemetryStore::stamp(unsigned long &receivedMillis, uint32_t &sequence, unsigned long now) {
+    receivedMillis = now;
+    //0 means never received, so it is skipped when the counter wraps
+    if (++sequence == 0) {
+        sequence = 1;
+    }
+}
@@ -0,0 +1,127 @@
+/**
+* @File: TelemetryStore.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the TelemetryStore class, the latest decoded copy of every MAVLink message
+ * the Blackbox samples. A mavlink_message_t is about 290 bytes, most of it an unused payload buffer, so instead of
+ * keeping and handing out raw messages, every frame is decoded once into its typed struct when it is parsed, together
+ * with the time it arrived and a sequence number. Consumers read the structs by reference, and tell a new copy from
+ * one they have already seen by its sequence number.
+*/
+
+#ifndef AERORADAREMBEDDED_TELEMETRYSTORE_H
+#define AERORADAREMBEDDED_TELEMETRYSTORE_H
+
+#include "Arduino.h"
+
+#undef F
+
+#include "standard/mavlink.h"
+
+#undef F
+
+/**
+ * The latest value of every sampled MAVLink message.
+ */
+class TelemetryStore {
+
+public:
+    /**
+     * The latest value of one message.
+     */
+    template<typename T>
+    struct Entry {
+        T value;
+        //the value of millis() when the message was parsed, 0 if it never was
+        unsigned long receivedMillis;
+        //incremented with every new copy, 0 if the message never arrived
+        uint32_t sequence;
+    };
+
+    /**
+     * Decode a message into its entry. Producer side only.
+     * @param msg - the parsed message.
+     * @param now - the value of millis() when the message was parsed.
+     * @return bool - true if the message is kept by the store, false otherwise.
+     */
+    bool write(const mavlink_message_t &msg, unsigned long now);
+
+    /**
+     * Whether the store keeps a message.
+     * @param messageId - the MAVLink message ID.
+     * @return bool - true if the message has an entry, false otherwise.
+     */
+    static bool supports(uint32_t messageId);
+
+    /**
+     * The sequence number of the latest copy of a message.
+     * @param messageId - the MAVLink message ID.
+     * @return uint32_t - the sequence number, 0 if the message never arrived or is not kept.
+     */
+    uint32_t sequence(uint32_t messageId) const;
+
+    /**
+     * The time the latest copy of a message was parsed.
+     * @param messageId - the MAVLink message ID.
+     * @return unsigned long - the value of millis(), 0 if the message never arrived or is not kept.
+     */
+    unsigned long receivedMillis(uint32_t messageId) const;
+
+    /**
+     * The latest ATTITUDE.
+     * @return const Entry<mavlink_attitude_t>& - the entry.
+     */
+    const Entry<mavlink_attitude_t> &attitude() const {
+        return attitudeEntry;
+    }
+
+    /**
+     * The latest GLOBAL_POSITION_INT.
+     * @return const Entry<mavlink_global_position_int_t>& - the entry.
+     */
+    const Entry<mavlink_global_position_int_t> &globalPosition() const {
+        return globalPositionEntry;
+    }
+
+    /**
+     * The latest SYS_STATUS.
+     * @return const Entry<mavlink_sys_status_t>& - the entry.
+     */
+    const Entry<mavlink_sys_status_t> &sysStatus() const {
+        return sysStatusEntry;
+    }
+
+    /**
+     * The latest GPS_RAW_INT.
+     * @return const Entry<mavlink_gps_raw_int_t>& - the entry.
+     */
+    const Entry<mavlink_gps_raw_int_t> &gpsRawInt() const {
+        return gpsRawIntEntry;
+    }
+
+    /**
+     * The latest SYSTEM_TIME.
+     * @return const Entry<mavlink_system_time_t>& - the entry.
+     */
+    const Entry<mavlink_system_time_t> &systemTime() const {
+        return systemTimeEntry;
+    }
+
+private:
+
+    /**
+     * Stamp an entry that has just been written.
+     * @param receivedMillis - the arrival time of the entry.
+     * @param sequence - the sequence number of the entry.
+     * @param now - the value of millis() when the message was parsed.
+     */
+    static void stamp(unsigned long &receivedMillis, uint32_t &sequence, unsigned long now);
+
+    Entry<mavlink_attitude_t> attitudeEntry{};
+    Entry<mavlink_global_position_int_t> globalPositionEntry{};
+    Entry<mavlink_sys_status_t> sysStatusEntry{};
+    Entry<mavlink_gps_raw_int_t> gpsRawIntEntry{};
+    Entry<mavlink_system_time_t> systemTimeEntry{};
+};
+
+#endif //AERORADAREMBEDDED_TELEMETRYSTORE_H
@@ -0,0 +1,17 @@
+/**
+* @File: GlobalTimeBase.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file declares the global instance of the TimeBase class, named timeBase, which is used to
+ * timestamp telemetry from various parts of the code.
+*/
+
+#ifndef AERORADAREMBEDDED_GLOBALTIMEBASE_H
+#define AERORADAREMBEDDED_GLOBALTIMEBASE_H
+
+#include "TimeBase.h"
+
+// Global time base
+extern TimeBase timeBase;
+
+#endif //AERORADAREMBEDDED_GLOBALTIMEBASE_H
@@ -0,0 +1,102 @@
+/**
+* @File: TimeBase.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the implementation of the TimeBase class.
+*/
+
+#include "TimeBase.h"
+
+bool TimeBase::sync(uint64_t unixMillis, unsigned long localMillis, Source source) {
+
+    //keep a fresh sync from a more accurate source
+    if (source < lastSource && localMillis - anchorLocalMillis < resyncIntervalMillis) {
+        return false;
+    }
+
+    if (source != lastSource) {
+        //the sources are offset from each other by their latency, so only measure drift within one source
+        driftReferenceUnixMillis = unixMillis;
+        driftReferenceLocalMillis = localMillis;
+    } else {
+        unsigned long localElapsed = localMillis - driftReferenceLocalMillis;
+        if (localElapsed >= minDriftIntervalMillis) {
+            int64_t unixElapsed = (int64_t) (unixMillis - driftReferenceUnixMillis);
+            int64_t measured = (unixElapsed - (int64_t) localElapsed) * 1000000000ll / (int64_t) localElapsed;
+
+            if (measured > maxDriftPpb || measured < -maxDriftPpb) {
+                //the source stepped, start measuring again
+                drift = 0;
+            } else {
+                //move a quarter of the way towards the new measurement to smooth out the jitter of single syncs
+                drift += (int32_t) ((measured - drift) / 4);
+            }
+            driftReferenceUnixMillis = unixMillis;
+            driftReferenceLocalMillis = localMillis;
+        }
+    }
+
+    //a small step back holds the clock rather than letting timestamps go backwards
+    uint64_t reached = this->unixMillis(localMillis);
+    holdUnixMillis = reached > unixMillis && reached - unixMillis <= maxHoldMillis ? reached : 0;
+
+    anchorUnixMillis = unixMillis;
+    anchorLocalMillis = localMillis;
+    lastSource = source;
+    return true;
+}
+
+bool TimeBase::syncFromIridium(uint32_t systemTimeTicks, unsigned long localMillis) {
+    return sync(iridiumEpochUnixMillis + (uint64_t) systemTimeTicks * iridiumTickMillis, localMillis, IRIDIUM);
+}
+
+bool TimeBase::syncFromMavlink(uint64_t timeUnixUsec, unsigned long localMillis) {
+
+    //the autopilot reports 0 until its GPS knows the time
+    if (timeUnixUsec == 0) {
+        return false;
+    }
+    return sync(timeUnixUsec / 1000, localMillis, MAVLINK);
+}
+
+bool TimeBase::restore(uint64_t unixMillis, int32_t driftPpb, unsigned long localMillis) {
+
+    if (lastSource != NONE || unixMillis == 0) {
+        return false;
+    }
+
+    anchorUnixMillis = unixMillis;
+    anchorLocalMillis = localMillis;
+    //the next sync comes from another source, so it starts a new drift measurement but keeps this estimate
+    drift = driftPpb > maxDriftPpb || driftPpb < -maxDriftPpb ? 0 : driftPpb;
+    lastSource = RESTORED;
+    return true;
+}
+
+uint64_t TimeBase::unixMillis(unsigned long localMillis) const {
+
+    if (lastSource == NONE) {
+        return 0;
+    }
+
+    //unsigned subtraction keeps this correct across a wrap of millis()
+    int64_t elapsed = (int64_t) (unsigned long) (localMillis - anchorLocalMillis);
+    uint64_t time = anchorUnixMillis + elapsed + elapsed * drift / 1000000000ll;
+    return time > holdUnixMillis ? time : holdUnixMillis;
+}
+
+bool TimeBase::isSynced() const {
+    return lastSource != NONE;
+}
+
+bool TimeBase::needsSync(unsigned long localMillis) const {
+    return lastSource <= RESTORED || localMillis - anchorLocalMillis >= resyncIntervalMillis;
+}
+
+TimeBase::Source TimeBase::source() const {
+    return lastSource;
+}
+
+int32_t TimeBase::driftPpb() const {
+    return drift;
+}
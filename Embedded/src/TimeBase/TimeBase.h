@@ -0,0 +1,137 @@
+/**
+* @File: TimeBase.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the TimeBase class, the local wall clock of the Blackbox. It is synchronised
+ * now and then from the Iridium system time (AT-MSSTM) or from the autopilot's GPS time (MAVLink SYSTEM_TIME) and
+ * extrapolated from millis() in between, so reading the time costs nothing and never talks to the modem. The drift of
+ * the local oscillator is estimated from successive syncs of the same source and corrected for while extrapolating.
+ * A sync that sets the clock back by a little, e.g. the other source with its different latency, holds it at the time
+ * it had reached until the new time catches up, so timestamps never go backwards. Times are 64-bit milliseconds since
+ * the unix epoch.
+*/
+
+#ifndef AERORADAREMBEDDED_TIMEBASE_H
+#define AERORADAREMBEDDED_TIMEBASE_H
+
+#include <stdint.h>
+
+/**
+ * A millisecond unix clock extrapolated from the local millisecond counter.
+ */
+class TimeBase {
+
+public:
+    /**
+     * Where the time came from, in increasing order of accuracy.
+     */
+    enum Source : uint8_t {
+        NONE = 0,
+        //the last known time from before a reset, see restore()
+        RESTORED,
+        IRIDIUM,
+        MAVLINK
+    };
+
+    //The start of the current Iridium system time era, 2014-05-11 14:23:55 UTC, in unix milliseconds.
+    static const uint64_t iridiumEpochUnixMillis = 1399818235000ull;
+    //The length of one Iridium system time tick.
+    static const uint32_t iridiumTickMillis = 90;
+    //A sync older than this is stale, a less accurate source may replace it and needsSync() asks for a new one.
+    static const unsigned long resyncIntervalMillis = 30 * 60 * 1000ul;
+    //The shortest time between two syncs that is used to estimate the drift, so that the jitter of a single sync
+    // does not dominate the estimate.
+    static const unsigned long minDriftIntervalMillis = 10 * 60 * 1000ul;
+    //The largest drift that is believed, in parts per billion. A larger apparent drift is a step of the source.
+    static const int32_t maxDriftPpb = 500000;
+    //The largest step back of a sync that holds the clock. A larger step means the clock was wrong, it is set back
+    // rather than stamping minutes of telemetry with the same time.
+    static const unsigned long maxHoldMillis = 60 * 1000ul;
+
+    /**
+     * Synchronise the clock.
+     * @param unixMillis - the time, in milliseconds since the unix epoch.
+     * @param localMillis - the value of millis() at that time.
+     * @param source - where the time came from.
+     * @return bool - true if the sync was accepted, false if a fresher sync from a more accurate source is in effect.
+     */
+    bool sync(uint64_t unixMillis, unsigned long localMillis, Source source);
+
+    /**
+     * Synchronise the clock from the Iridium system time.
+     * @param systemTimeTicks - the AT-MSSTM value, in 90 ms ticks since the Iridium epoch.
+     * @param localMillis - the value of millis() when the value was received.
+     * @return bool - true if the sync was accepted.
+     */
+    bool syncFromIridium(uint32_t systemTimeTicks, unsigned long localMillis);
+
+    /**
+     * Synchronise the clock from a MAVLink SYSTEM_TIME message.
+     * @param timeUnixUsec - the time_unix_usec field, 0 if the autopilot does not know the time yet.
+     * @param localMillis - the value of millis() when the message was received.
+     * @return bool - true if the sync was accepted.
+     */
+    bool syncFromMavlink(uint64_t timeUnixUsec, unsigned long localMillis);
+
+    /**
+     * Start the clock from the last known time saved before a reset, until a real sync replaces it. The time spent
+     * in the reset is unknown, so the clock runs behind by that much and needsSync() keeps asking for a sync.
+     * @param unixMillis - the last known time, in milliseconds since the unix epoch.
+     * @param driftPpb - the drift estimated before the reset, kept by later syncs.
+     * @param localMillis - the value of millis() to start from.
+     * @return bool - true if the clock was started, false if it is already synchronised or unixMillis is 0.
+     */
+    bool restore(uint64_t unixMillis, int32_t driftPpb, unsigned long localMillis);
+
+    /**
+     * The time at a value of millis(). The time does not go backwards for increasing values of millis() unless a sync
+     * sets the clock back by more than maxHoldMillis.
+     * @param localMillis - the value of millis(), not before the last sync.
+     * @return uint64_t - milliseconds since the unix epoch, 0 if the clock has never been synchronised.
+     */
+    uint64_t unixMillis(unsigned long localMillis) const;
+
+    /**
+     * Whether the clock has been synchronised.
+     * @return bool - true once any sync has been accepted.
+     */
+    bool isSynced() const;
+
+    /**
+     * Whether the clock should be synchronised.
+     * @param localMillis - the value of millis().
+     * @return bool - true if the clock was never synchronised, was only restored or the last sync is older than
+     * resyncIntervalMillis.
+     */
+    bool needsSync(unsigned long localMillis) const;
+
+    /**
+     * The source of the last accepted sync.
+     * @return Source - the source.
+     */
+    Source source() const;
+
+    /**
+     * The estimated drift of the local clock.
+     * @return int32_t - parts per billion that the local clock runs slow (positive) or fast (negative).
+     */
+    int32_t driftPpb() const;
+
+private:
+    Source lastSource = NONE;
+
+    //the last sync, that extrapolation starts from
+    uint64_t anchorUnixMillis = 0;
+    unsigned long anchorLocalMillis = 0;
+
+    //the sync that the drift is measured against
+    uint64_t driftReferenceUnixMillis = 0;
+    unsigned long driftReferenceLocalMillis = 0;
+
+    int32_t drift = 0;
+
+    //the time the clock had reached when a sync set it back, it stands still until the new time catches up
+    uint64_t holdUnixMillis = 0;
+};
+
+#endif //AERORADAREMBEDDED_TIMEBASE_H
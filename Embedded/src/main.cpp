@@ -11,10 +11,20 @@
 #include <main.h>
 #include "Iridium9602N/Iridium9602N.h"
 #include "MavlinkInterpreter/MavlinkInterpreter.h"
-#include "AsyncScheduler/AsyncTimeScheduler.h"
+#include "AsyncScheduler/DeadlineScheduler.h"
 #include "DistanceScheduler/AsyncDistanceScheduler.h"
 #include "DiagnosticTools/RGBLED.h"
 #include "DiagnosticTools/GlobalDiagnosticLED.h"
+#include "DiagnosticTools/LEDTimer.h"
+#include "TimeBase/TimeBase.h"
+#include "FlashStore/SamdFlash.h"
+#include "PowerIdle/PowerIdle.h"
+#include "BootSequence/BootSequence.h"
+#include "FlashStore/ConfigStore.h"
+#include "FixedString/FixedString.h"
+#include "HeapReport/HeapReport.h"
+#include "Log/Log.h"
+#include "LatencyProfiler/LatencyProfiler.h"
 
 /**
  * Setup pins on the Arduino MKR
@@ -35,31 +45,161 @@ void setupObjects();
 
 /**
  * Setup async processes. This includes:
+ * \n - Advancing the boot phases
  * \n - Parsing and queuing Mavlink messages
  * \n - Requesting Mavlink messages
- * \n - Blinking the MKR LED
- * \n - Receiving configuration messages from the Iridium 9602N
+ * \n - Applying configuration messages received from the Iridium 9602N
+ * \n - Uploading telemetry with the status and acknowledgements, retrying, draining the backlog and answering ring
+ * alerts
+ * \n - Reading the Iridium system time while the clock needs it
+ * \n - Reporting the active versus idle duty cycle
+ * \n - Reporting the use of the heap
+ * \n - Flushing the log to a host
+ * \n - Reporting the latency of the loop, the tasks and the modem calls
+ * \n - Saving the time with the configuration
  */
 void setupAsyncProcesses();
 
 /**
- * Interpret Iridium error and success messages and set the appropriate LED states.
- * @param message - the message to interpret.
+ * Advance the boot phases by one step: end the MAVLink and GPS waits once their first message arrives, start the
+ * modem after the start delay, then wait for the bootup notice to be delivered and for the configuration. The first
+ * upload is made as soon as the modem is set up. Scheduled every bootStepMillis until every phase has ended, then the
+ * boot is reported and the task disables itself.
  */
-void interpretIridiumMessage(String &message);
+void advanceBoot();
+
+/**
+ * Let uploads start once the modem is set up, with the configuration in effect so far. The first upload is made
+ * straight away and carries the bootup notice.
+ * @param now - the current value of millis().
+ */
+void allowUploads(unsigned long now);
+
+/**
+ * Whether the last reset was unplanned, i.e. a brownout or the watchdog rather than a power up or the reset button.
+ * A software reset does not count, since one follows every upload over USB through the bootloader. Only then is the
+ * stored configuration restored.
+ * @return bool - true after an unplanned reset.
+ */
+bool isWarmReset();
+
+/**
+ * Restore the stored configuration and the last known time after an unplanned reset, skip the boot phases that would
+ * fetch them from the server again and acknowledge the restored configuration with the next upload, so the server
+ * can correct it lazily.
+ */
+void restoreConfiguration();
+
+/**
+ * Save the configuration in effect and the current time to flash.
+ * @param newConfig - true if the configuration was just accepted from the server.
+ */
+void saveConfiguration(bool newConfig);
+
+/**
+ * Set the LED state of the earliest boot phase that is still running.
+ * @param now - the current value of millis().
+ */
+void showBootState(unsigned long now);
+
+/**
+ * Set the LED state of the specific operational state of the Blackbox.
+ */
+void showOperationalState();
+
+/**
+ * Upload the queued telemetry via the Iridium 9602N together with the status and acknowledgements, unless the modem is
+ * not set up yet or a session is still running, and update the LED state. While uploads are disabled, only an exchange
+ * that is due is made.
+ */
+void uploadTelemetry();
+
+/**
+ * Request every message of the telemetry schema from the Pixhawk at its interval, and SYSTEM_TIME for the time base.
+ * Only intervals that changed are sent, once the autopilot has been discovered, see StreamRateManager.
+ */
+void requestMavlinkMessageSet();
+
+/**
+ * Replace the telemetry schema. Messages the new schema no longer samples are stopped and its messages are requested.
+ * @param schema - the new telemetry schema.
+ */
+void applySchema(const TelemetrySchema &schema);
+
+/**
+ * Apply a configuration command from the server. The command is checked first and applied either entirely or not at
+ * all: a schema entry is applied before the field changes and the message rates, and the resulting schema must keep
+ * its timestamp and fit into the configuration store. An applied command is saved, so it survives an unplanned reset,
+ * and the upload setting is acknowledged with ACK_CONFIG.
+ * @param command - the parsed command.
+ * @return ConfigProtocol::Result - RESULT_OK if the command was applied, the reason otherwise.
+ */
+ConfigProtocol::Result applyCommand(const ConfigProtocol::Command &command);
+
+/**
+ * Parse a bounded slice of the MAVLink receive ring and refresh the satellite queue with the latest messages. This is
+ * scheduled every backgroundPumpIntervalMillis, so that messages are timestamped close to their arrival, and is also
+ * run from the ISBD callbacks when it is due so that telemetry keeps flowing while the modem blocks. It never
+ * re-enters itself and never talks to the modem.
+ */
+void pumpMavlinkInBackground();
 
 // Global variables
 MavlinkInterpreter mavlinkInterpreter;
-Iridium9602N iridium9602N(SerialSAT, SLEEP_PIN, RING_PIN);
-//Iridium9602NMock iridium9602N(SerialSAT, SLEEP_PIN, RING_PIN);
+
+//Spare on-chip flash for the telemetry backlog, 512 records or about 85 minutes of 10 second samples.
+SAMD_FLASH_REGION(backlogRegion, 32 * 1024);
+SamdFlash backlogFlash(backlogRegion, sizeof(backlogRegion));
+
+//Spare on-chip flash for the configuration journal, about 6 years of saves every configCheckpointMillis.
+SAMD_FLASH_REGION(configRegion, 8 * 1024);
+SamdFlash configFlash(configRegion, sizeof(configRegion));
+
+//The last accepted configuration and the last known time, restored after an unplanned reset.
+ConfigStore configStore(configFlash);
+
+Iridium9602N iridium9602N(SerialSAT, SLEEP_PIN, RING_PIN, backlogFlash);
+//Iridium9602NMock iridium9602N(SerialSAT, SLEEP_PIN, RING_PIN, backlogFlash);
 
 RGBLED rgbLED(7, 8, 9, RGBLED::START_DELAY);
 
-// Global async time schedulers
-AsyncTimeScheduler *parseAndQueueMavlinkScheduler;
-AsyncTimeScheduler *requestMavlinkScheduler;
-AsyncTimeScheduler *blinkMKRLed;
-AsyncTimeScheduler *receiveConfigurationScheduler;
+TimeBase timeBase;
+
+PowerIdle powerIdle(maxIdleMillis);
+
+//The task scheduler, sized for the tasks set up in setupAsyncProcesses() with room to spare.
+typedef DeadlineScheduler<16> TaskScheduler;
+
+// Global task scheduler and the ids of its tasks
+TaskScheduler scheduler;
+int parseAndQueueMavlinkTask = -1;
+int streamRateTask = -1;
+int receiveConfigurationTask = -1;
+int backgroundPumpTask = -1;
+int uploadTask = -1;
+int uploadFollowUpTask = -1;
+int timeSyncTask = -1;
+int dutyCycleReportTask = -1;
+int heapReportTask = -1;
+int logFlushTask = -1;
+int latencyReportTask = -1;
+int bootTask = -1;
+int configCheckpointTask = -1;
+
+//The phases of the boot, advanced by bootTask.
+BootSequence boot;
+
+//The value of millis() at which the next attempt to set up the modem is made.
+unsigned long modemRetryAtMillis = 0;
+
+//The telemetry store sequence number of the SYSTEM_TIME the clock was last synchronised with.
+uint32_t syncedSystemTimeSequence = 0;
+
+//The use of the heap, reported every heapReportMillis.
+HeapReport heapReport;
+
+//A boolean to indicate if the current ring alert has already been passed to the upload follow-up task.
+bool ringAlertSeen = false;
 
 
 // Global async distance schedulers
@@ -70,90 +210,245 @@ void setup() {
     // Initialize pins
     setupPins();
 
+    // Run the RGB LED patterns and blink the onboard LED from the timer interrupt
+    ledTimer.begin(rgbLED, LED_BUILTIN, heartbeatMillis);
+
     // Setup serial communication
     setupSerial();
 
+    //every boot phase is timed from here
+    boot.begin(millis());
 
     // **Setup objects before async processes**
     setupObjects();
 
-    prevFuncTime = millis();
+    // Attach interrupt to ring pin
+    attachInterrupt(digitalPinToInterrupt(RING_PIN), []() {
+        iridium9602N.ringInterrupt = true;
+        powerIdle.requestWake();
+        LOG_INFO(LOG_SATELLITE, "Ring interrupt triggered");
+    }, FALLING);
+
+    // Setup async processes, so that MAVLink is ingested from the first loop()
+    setupAsyncProcesses();
+
+    // Request Mavlink messages
+    requestMavlinkMessageSet();
+
+    /*
+     * The start delay and the waits for the Pixhawk run side by side. The modem, the bootup notice and the
+     * configuration follow the start delay, one after the other, see advanceBoot(). After an unplanned reset the
+     * stored configuration is used instead, and the modem is started straight away.
+     */
+    unsigned long now = millis();
+    boot.start(BootSequence::MAVLINK_LINK, now);
+    boot.start(BootSequence::GPS_FIX, now);
+    if (configStore.hasConfig() && isWarmReset()) {
+        restoreConfiguration();
+        iridium9602N.status.fields[TelemetryCodec::STATUS_WARM_START] = 1;
+        boot.skip(BootSequence::START_DELAY, now);
+        boot.skip(BootSequence::BOOTUP_MESSAGE, now);
+        boot.skip(BootSequence::CONFIGURATION, now);
+        boot.start(BootSequence::MODEM, now);
+    } else {
+        //the first upload tells the server that the device has booted
+        iridium9602N.bootUpPending = true;
+        boot.start(BootSequence::START_DELAY, now);
+    }
+    iridium9602N.status.fields[TelemetryCodec::STATUS_RESET_CAUSE] = PM->RCAUSE.reg;
+    iridium9602N.status.fields[TelemetryCodec::STATUS_CONFIG_SEQUENCE] = configStore.config().configSequence;
+
     //Set the rgbLED state to indicate that the program is currently within the start delay.
     rgbLED.setState(RGBLED::START_DELAY);
-    while (millis() < (prevFuncTime + startDelayMillis)) {
-        rgbLED.asyncRun();
-        delay(100);
+}
+
+void loop() {
+    //The active part of the loop is timed, the sleep at its end is not.
+    unsigned long loopStartMicros = micros();
+
+    //Run the tasks that are due, highest priority first: the background MAVLink pump, parsing and queuing MAVLink
+    // messages, telemetry uploads, configuration messages and MAVLink requests. The LEDs run from a timer interrupt.
+    scheduler.runDue(millis());
+    //Advance a session with the Iridium 9602N by one AT command step.
+    {
+        LatencyProfiler::Scope timed(latencyProfiler, LatencyProfiler::SESSION_STEP);
+        iridium9602N.poll();
     }
 
-    prevFuncTime = millis();
-    //Set the rgbLED state to indicate that the program is currently waiting for a GPS lock.
-    rgbLED.setState(RGBLED::WAITING_FOR_GPS_LOCK);
-    mavlink_message_t message;
-    do {
-        mavlinkInterpreter.requestMavlinkMessage(MAVLINK_MSG_ID_GLOBAL_POSITION_INT);
-        message = mavlinkInterpreter.receiveMavlinkMessage(MAVLINK_MSG_ID_GLOBAL_POSITION_INT);
-        rgbLED.asyncLEDDelay(100);
+    //A ring alert is picked up by a session straight away rather than at the next deadline of the follow-up task.
+    if (iridium9602N.ringInterrupt && !ringAlertSeen) {
+        scheduler.runSoon(uploadFollowUpTask, millis());
+    }
+    ringAlertSeen = iridium9602N.ringInterrupt;
+    latencyProfiler.record(LatencyProfiler::LOOP, micros() - loopStartMicros);
 
-        if (message.len != 0) {
-            iridium9602N.gpsFix = true;
+    //Sleep until the next task is due, a ring alert arrives or the modem answers a running session.
+    unsigned long idleMillis = scheduler.millisUntilNextDeadline(millis());
+    if (iridium9602N.session.isBusy() && idleMillis > sessionIdleMillis) {
+        idleMillis = sessionIdleMillis;
+    }
+    powerIdle.idle(idleMillis);
+}
+
+void advanceBoot() {
+
+    unsigned long now = millis();
 
+    //the first message of the telemetry schema shows that the Pixhawk link is up
+    if (boot.isRunning(BootSequence::MAVLINK_LINK)) {
+        bool linkUp = false;
+        for (uint8_t i = 0; i < iridium9602N.telemetrySchema.messageCount(); i++) {
+            linkUp |= mavlinkInterpreter.receivedMillis(iridium9602N.telemetrySchema.message(i).messageId) != 0;
         }
-        if (millis() > (prevFuncTime + gpsLockTimeoutMillis)) {
-            break;
+        if (linkUp) {
+            boot.finish(BootSequence::MAVLINK_LINK, true, now);
+        } else if (boot.hasTimedOut(BootSequence::MAVLINK_LINK, gpsLockTimeoutMillis, now)) {
+            boot.finish(BootSequence::MAVLINK_LINK, false, now);
         }
-    } while (message.len == 0);
-
-    // Attach interrupt to ring pin
-    attachInterrupt(digitalPinToInterrupt(RING_PIN), []() {
-        iridium9602N.ringInterrupt = true;
-        Serial.println("Ring interrupt triggered");
-    }, FALLING);
+    }
 
-    //Set the rgbLED state to indicate that the program is currently attempting to send a boot up message.
-    rgbLED.setState(RGBLED::SENDING_BOOTUP_MESSAGE);
-    // Try to send boot up message until it is successfully sent
-    while (!iridium9602N.sendBootUpMessage()) {
-        rgbLED.asyncRun();
-        delay(100);
+    //the Pixhawk only sends a position once it has a GPS fix
+    if (boot.isRunning(BootSequence::GPS_FIX)) {
+        if (mavlinkInterpreter.receivedMillis(MAVLINK_MSG_ID_GLOBAL_POSITION_INT) != 0) {
+            iridium9602N.gpsFix = true;
+            boot.finish(BootSequence::GPS_FIX, true, now);
+        } else if (boot.hasTimedOut(BootSequence::GPS_FIX, gpsLockTimeoutMillis, now)) {
+            boot.finish(BootSequence::GPS_FIX, false, now);
+        }
     }
 
+    //the modem is set up once the start delay is over
+    if (boot.hasTimedOut(BootSequence::START_DELAY, startDelayMillis, now)) {
+        boot.finish(BootSequence::START_DELAY, true, now);
+        boot.start(BootSequence::MODEM, now);
+    }
 
-    //Set the rgbLED state to indicate that the program is currently attempting to receive a configuration message.
-    rgbLED.setState(RGBLED::SEND_RECEIVE_CONFIG);
+    //setting up the modem blocks, the ISBD callbacks keep the MAVLink pump running meanwhile
+    if (boot.isRunning(BootSequence::MODEM) && (long) (now - modemRetryAtMillis) >= 0) {
+        if (iridium9602N.beginModem()) {
+            now = millis();
+            boot.finish(BootSequence::MODEM, true, now);
+            boot.start(BootSequence::BOOTUP_MESSAGE, now);
+            allowUploads(now);
+        } else {
+            modemRetryAtMillis = millis() + modemRetryMillis;
+        }
+    }
 
-    //void any previous pin interrupts that may have been somehow triggered
-    iridium9602N.ringInterrupt = false;
+    //the bootup notice rides in the status of the first uploads until one of them is delivered
+    if (boot.isRunning(BootSequence::BOOTUP_MESSAGE) && !iridium9602N.bootUpPending) {
+        boot.finish(BootSequence::BOOTUP_MESSAGE, true, now);
+        boot.start(BootSequence::CONFIGURATION, now);
+    }
 
+    //the server answers the bootup notice with a configuration, picked up by a later session and applied by
+    // receiveConfigurationTask; uploads run with the defaults meanwhile
+    if (boot.isRunning(BootSequence::CONFIGURATION)) {
+        if (iridium9602N.configReceived) {
+            boot.finish(BootSequence::CONFIGURATION, true, now);
+        } else if (boot.hasTimedOut(BootSequence::CONFIGURATION, configTimoutMillis, now)) {
+            boot.finish(BootSequence::CONFIGURATION, false, now);
+        }
+    }
 
-    prevFuncTime = millis();
-    //create a response packet
-    ConfigResponsePacket responsePacket;
-//    responsePacket.GPSFix = gpsLock;
-    while (!iridium9602N.receiveConfigurationMode(responsePacket, uploadData, uploadIntervalMillis)) {
-        rgbLED.asyncRun();
+    if (boot.isComplete()) {
+        boot.report();
+        showOperationalState();
+        scheduler.setEnabled(bootTask, false, now);
+        return;
+    }
 
-        //break out of the loop if the configTimoutMillis has been reached
-        if (millis() > (prevFuncTime + configTimoutMillis)) {
-            break;
-        }
-        delay(100);
+    //keep showing the session LED state while the modem is busy
+    if (!iridium9602N.session.isBusy()) {
+        showBootState(now);
     }
+}
 
+void allowUploads(unsigned long now) {
+    iridium9602N.health.counters[TelemetryCodec::BOOT_READY_SECONDS] = boot.millisToDone(BootSequence::MODEM) / 1000;
+    scheduler.runSoon(uploadTask, now);
+}
 
-    if (!iridium9602N.configReceived) {
-        //Set the rgbLED state to indicate that the configuration timout has been reached.
-        rgbLED.setState(RGBLED::CONFIG_TIMOUT);
-        //delay for 5 seconds while blinking the led
-        rgbLED.asyncLEDDelay(5 * 1000ul);
+bool isWarmReset() {
+    return (PM->RCAUSE.reg & (PM_RCAUSE_BOD12 | PM_RCAUSE_BOD33 | PM_RCAUSE_WDT)) != 0;
+}
+
+void restoreConfiguration() {
+    const ConfigStore::StoredConfig &config = configStore.config();
+    uploadData = config.uploadData;
+    uploadIntervalMillis = (long) config.uploadIntervalMillis;
+    iridium9602N.codec = config.codec;
+
+    //uploadTask was added with the default interval
+    scheduler.setPeriod(uploadTask, uploadIntervalMillis);
+
+    //the telemetry schema and the intervals of its messages
+    TelemetrySchema schema;
+    TelemetryCodec::Schema stored;
+    if (config.schemaSize > 0 && TelemetryCodec::readSchemaDescriptor(config.schema, config.schemaSize, stored)) {
+        schema.load(stored);
+    }
+    for (uint8_t i = 0; i < config.messageRateCount; i++) {
+        schema.setInterval(config.messageRates[i].messageId, config.messageRates[i].intervalMillis);
     }
+    applySchema(schema);
+    iridium9602N.configReceived = true;
+    timeBase.restore(config.unixMillis, config.driftPpb, millis());
 
-    // Setup async processes
-    setupAsyncProcesses();
+    //let the server know which configuration is in effect, it sends a new one if it disagrees
+    iridium9602N.queueAcknowledgement(TelemetryCodec::ACK_CONFIG,
+                                      (uint32_t) (uploadIntervalMillis / 1000) << 1 | uploadData);
 
-    // Request Mavlink messages
-    mavlinkInterpreter.requestMavlinkMessages({MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_GLOBAL_POSITION_INT});
+    LOG_INFO(LOG_CONFIG, "Warm start: configuration %lu restored, uploadData: %d, uploadIntervalMillis: %ld",
+             (unsigned long) config.configSequence, uploadData, uploadIntervalMillis);
+}
+
+void saveConfiguration(bool newConfig) {
+    ConfigStore::StoredConfig config = configStore.config();
+    config.uploadData = uploadData;
+    config.uploadIntervalMillis = (uint32_t) uploadIntervalMillis;
+    config.codec = iridium9602N.codec;
+    const TelemetrySchema &schema = iridium9602N.telemetrySchema;
+    config.messageRateCount = 0;
+    for (uint8_t i = 0; i < schema.messageCount() && i < ConfigStore::maxStoredMessageRates; i++) {
+        config.messageRates[config.messageRateCount++] = schema.message(i);
+    }
+    //applyCommand only accepts schemas whose descriptor fits
+    config.schemaSize = (uint8_t) TelemetryCodec::schemaDescriptorSize(schema.schema());
+    if (config.schemaSize > ConfigStore::maxStoredSchemaSize) {
+        config.schemaSize = 0;
+    } else {
+        TelemetryCodec::writeSchemaDescriptor(schema.schema(), config.schema);
+    }
+    if (newConfig) {
+        config.configSequence++;
+    }
+    config.unixMillis = timeBase.unixMillis(millis());
+    config.driftPpb = timeBase.driftPpb();
+    if (!configStore.save(config)) {
+        LOG_ERROR(LOG_CONFIG, "Saving the configuration failed");
+    }
+}
 
-    //determine the specific operational state of the Blackbox
+void showBootState(unsigned long now) {
+    if (boot.isRunning(BootSequence::START_DELAY)) {
+        rgbLED.setState(RGBLED::START_DELAY);
+    } else if (!boot.isDone(BootSequence::BOOTUP_MESSAGE)) {
+        rgbLED.setState(RGBLED::SENDING_BOOTUP_MESSAGE);
+    } else if (!boot.isDone(BootSequence::CONFIGURATION)) {
+        rgbLED.setState(RGBLED::SEND_RECEIVE_CONFIG);
+    } else if (boot.status(BootSequence::CONFIGURATION) == BootSequence::TIMED_OUT &&
+               boot.millisSinceDone(BootSequence::CONFIGURATION, now) < 5 * 1000ul) {
+        //show that the configuration timed out for 5 seconds
+        rgbLED.setState(RGBLED::CONFIG_TIMOUT);
+    } else if (!boot.isDone(BootSequence::GPS_FIX)) {
+        rgbLED.setState(RGBLED::WAITING_FOR_GPS_LOCK);
+    } else {
+        showOperationalState();
+    }
+}
+
+void showOperationalState() {
     if (iridium9602N.configReceived && uploadData) {
         rgbLED.setState(RGBLED::IN_FLIGHT);
     } else if (!uploadData) {
@@ -163,56 +458,46 @@ void setup() {
     }
 }
 
-void loop() {
-    //blink the MKR LED every 1000 ms
-    blinkMKRLed->run();
-    //request Mavlink messages every 10000 ms
-    requestMavlinkScheduler->run();
-    //Actively filter the Pixhawk serial stream to try to receive the requested Mavlink messages then parse and queue
-    // them in the Iridium9602N object.
-    parseAndQueueMavlinkScheduler->run();
+void uploadTelemetry() {
+
+    //nothing is sent before the modem is set up, and while uploads are disabled only the status, acknowledgements
+    // and messages from the server are exchanged
+    if (!iridium9602N.modemReady || iridium9602N.session.isBusy() ||
+        (!uploadData && !iridium9602N.exchangeDue(false))) {
+        return;
+    }
 
     /**
-     * This is essentially an inline AsyncTimeScheduler, however, I am not using the AsyncTimeScheduler class because the
-     * upload interval is not a constant. This is because the upload interval is determined by the configuration message
-     * received from the Iridium 9602N. Doing it this way, I can change the upload interval during runtime and it will
-     * be memory safe.
+     * Try to send a complete telemetry message via the Iridium 9602N. If the message is not successfully sent,
+     * then check to see if it is because the Pixhawk GPS does not have a fix by checking if only part of the
+     * messages of the telemetry schema have arrived, as with the attitude present the only thing that could cause
+     * iridium9602N.verifyAndPushOutSatQueue() to be false is if the Global position int message is missing due to
+     * a GPS fix error. If the Pixhawk GPS does not have a fix, then set the rgbLED state to indicate that the
+     * Pixhawk GPS does not have a fix.
      */
-    if (uploadData && millis() - prevSatUpdateTime > uploadIntervalMillis) {
-
-        /**
-         * Try to send a complete telemetry message via the Iridium 9602N. If the message is not successfully sent,
-         * then check to see if it is because the Pixhawk GPS does not have a fix by checking if the attitude
-         * information is present, as with attitude information present the only thing that could cause
-         * iridium9602N.verifyAndPushOutSatQueue() to be false is if the Global position int message is missing due to
-         * a GPS fix error. If the Pixhawk GPS does not have a fix, then set the rgbLED state to indicate that the
-         * Pixhawk GPS does not have a fix.
-         */
-
-        if (!iridium9602N.verifyAndPushOutSatQueue() && iridium9602N.attitudeInQueue) {
-            rgbLED.setState(RGBLED::NO_GPS_FIX);
-            rgbLED.asyncLEDDelay(1000ul);
-            Serial.println("No GPS fix. Not sending telemetry message.");
-        }
-
-        //reset the prevSatUpdateTime
-        prevSatUpdateTime = millis();
 
-        //determine the specific operational state of the Blackbox
-        if (iridium9602N.configReceived && uploadData) {
-            rgbLED.setState(RGBLED::IN_FLIGHT);
-        } else if (!uploadData) {
-            rgbLED.setState(RGBLED::IN_FLIGHT_NO_UPLOAD);
-        } else {
-            rgbLED.setState(RGBLED::IN_FLIGHT_DEFAULT);
-        }
+    //report the state of the MAVLink receive ring in the health counters of the upload
+    iridium9602N.health.counters[TelemetryCodec::MAVLINK_RX_OVERFLOWS] = mavlinkInterpreter.rxOverflowCount();
+    iridium9602N.health.counters[TelemetryCodec::MAVLINK_RX_HIGH_WATER] = mavlinkInterpreter.rxHighWaterMark();
+    iridium9602N.health.counters[TelemetryCodec::MAVLINK_RATE_REQUESTS] = mavlinkInterpreter.streamRates.commandCount();
+    //and how much history is still waiting in the flash backlog
+    iridium9602N.health.counters[TelemetryCodec::BACKLOG_PENDING] = iridium9602N.backlog.pendingCount();
+    iridium9602N.health.counters[TelemetryCodec::BACKLOG_OVERWRITTEN] = iridium9602N.backlog.overwrittenCount();
+
+    if (!iridium9602N.verifyAndPushOutSatQueue(uploadData) && uploadData && iridium9602N.hasPartialSample()) {
+        rgbLED.showFor(RGBLED::NO_GPS_FIX, 1000ul);
+        LOG_WARN(LOG_SATELLITE, "No GPS fix. Not sending telemetry message.");
     }
 
-    //check to see if a ring alert has been received from the Iridium 9602N. if so receive the message.
-    receiveConfigurationScheduler->run();
+    //the next regular upload is a full upload interval from now, also after a retry or a backlog drain
+    scheduler.restart(uploadTask, millis());
 
-    //blink the MKR LED every 1000 ms
-    rgbLED.asyncRun();
+    //determine the specific operational state of the Blackbox, unless an upload is now in progress
+    if (iridium9602N.session.isBusy()) {
+        rgbLED.setState(RGBLED::SENDING_TELEMETRY);
+    } else {
+        showOperationalState();
+    }
 }
 
 void setupPins() {
@@ -239,7 +524,7 @@ void setupSerial() {
     // Wait for serial port to connect
 #if !PRODUCTION_ENV
     while (!Serial);
-    Serial.println("Serial initialized");
+    LOG_INFO(LOG_SYSTEM, "Serial initialized");
 #endif
 
     // Initialize serial communication with the Iridium satellite modem
@@ -253,141 +538,306 @@ void setupSerial() {
 void setupObjects() {
     mavlinkInterpreter = MavlinkInterpreter(BAUD_RATE);
     iridium9602N.setup();
+    configStore.begin();
 }
 
 void setupAsyncProcesses() {
 
+    unsigned long now = millis();
+
+    //While idle, wake up as soon as the modem answers a running session.
+    powerIdle.setWakeCondition([]() {
+        return iridium9602N.session.isBusy() && SerialSAT.available() > 0;
+    });
+
+    //Advance the boot phases until they have all ended.
+    bootTask = scheduler.add(advanceBoot, bootStepMillis, TaskScheduler::PRIORITY_NORMAL, now);
+
+    //Keep the receive ring drained so that messages are timestamped close to their arrival.
+    backgroundPumpTask = scheduler.add(pumpMavlinkInBackground, backgroundPumpIntervalMillis,
+                                       TaskScheduler::PRIORITY_HIGH, now);
+
     // Parse and queue Mavlink messages
-    parseAndQueueMavlinkScheduler = new AsyncTimeScheduler(1000, []() {
-        // Receive Mavlink messages and insert them into the satellite queue
-        std::vector<mavlink_message_t> fulfilledMsgRequests = mavlinkInterpreter.receiveMavlinkMessages();
+    parseAndQueueMavlinkTask = scheduler.add([]() {
+        // Decode the Mavlink messages into the telemetry store
+        {
+            LatencyProfiler::Scope timed(latencyProfiler, LatencyProfiler::MAVLINK_PARSE);
+            mavlinkInterpreter.demultiplexSerialStream();
+        }
+        const TelemetryStore &store = mavlinkInterpreter.telemetryStore();
 
+        //synchronise the clock with the autopilot's GPS time, it is not part of the satellite queue
+        if (store.systemTime().sequence != syncedSystemTimeSequence) {
+            syncedSystemTimeSequence = store.systemTime().sequence;
+            timeBase.syncFromMavlink(store.systemTime().value.time_unix_usec, store.systemTime().receivedMillis);
+        }
 
-        /**
-         * Loop through each fulfilled message request and insert it into the satellite queue.
-         */
-        for (mavlink_message_t message: fulfilledMsgRequests) {
-            Serial.println(mavlinkInterpreter.toANSI(message));
-            iridium9602N.insertIntoSatQueue(message);
+        // Insert the new messages into the satellite queue
+        //the sample is only turned into text by builds that log it
+        if (iridium9602N.insertIntoSatQueue(store) && LOG_ENABLED(LOG_LEVEL_DEBUG, LOG_MAVLINK)) {
+            static FixedString<255> sampleLine;
+            mavlinkInterpreter.toANSI(iridium9602N.telemetrySchema.triggerMessage(), sampleLine);
+            LOG_DEBUG(LOG_MAVLINK, "%s", sampleLine.c_str());
         }
 
-            tm time = {0, 0, 0, 0, 0, 0};
-            iridium9602N.modem.getSystemTime(time);
-            iridium9602N.currentMeasurementUnixTime = mktime(&time);
+        //keep showing the session or boot LED state
+        if (iridium9602N.session.isBusy() || !boot.isComplete()) {
+            return;
+        }
 
         //determine the specific operational state of the Blackbox
-        if (iridium9602N.configReceived && uploadData) {
-            rgbLED.setState(RGBLED::IN_FLIGHT);
-        } else if (!uploadData) {
-            rgbLED.setState(RGBLED::IN_FLIGHT_NO_UPLOAD);
-        } else {
-            rgbLED.setState(RGBLED::IN_FLIGHT_DEFAULT);
-        }
-    });
+        showOperationalState();
+    }, 1000, TaskScheduler::PRIORITY_NORMAL, now);
 
-// Request Mavlink messages
-    requestMavlinkScheduler = new AsyncTimeScheduler(10000, []() {
-        // Request Mavlink messages from the Pixhawk
-        mavlinkInterpreter.requestMavlinkMessages({MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_GLOBAL_POSITION_INT});
-    });
+// Upload telemetry. The interval is set by the configuration message, see receiveConfigurationTask.
+    uploadTask = scheduler.add(uploadTelemetry, uploadIntervalMillis, TaskScheduler::PRIORITY_NORMAL, now);
 
-// Blink onboard LED
-    blinkMKRLed = new AsyncTimeScheduler(1000, []() {
-        // Toggle the LED state
-        ledState = !ledState;
-        // Write the LED state to the onboard LED
-        digitalWrite(LED_BUILTIN, ledState);
-    });
+// Retry a failed upload, drain the backlog or pick up a message from the server ahead of the next upload interval
+    uploadFollowUpTask = scheduler.add([]() {
+        if (iridium9602N.retryDue() || iridium9602N.backlogDrainDue() || iridium9602N.exchangeDue(uploadData)) {
+            uploadTelemetry();
+        }
+    }, 1000, TaskScheduler::PRIORITY_NORMAL, now);
+
+// Read the Iridium system time while the clock has no fresh GPS time
+    timeSyncTask = scheduler.add([]() {
+        if (iridium9602N.modemReady && timeBase.needsSync(millis())) {
+            iridium9602N.requestSystemTime();
+        }
+    }, timeSyncRetryMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Negotiate the rates of the Mavlink messages with the Pixhawk, and request them again if they drift
+    streamRateTask = scheduler.add([]() {
+        mavlinkInterpreter.streamRates.poll(millis());
+    }, streamRatePollMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Report how much of the time the CPU was awake, the rest it slept between deadlines
+    dutyCycleReportTask = scheduler.add([]() {
+        uint16_t activePermille = powerIdle.activePermille();
+        iridium9602N.health.counters[TelemetryCodec::ACTIVE_PERMILLE] = activePermille;
+        LOG_INFO(LOG_SYSTEM, "Duty cycle: %u.%u%% active, %lu ms in idle", (unsigned) activePermille / 10,
+                 (unsigned) activePermille % 10, (unsigned long) (powerIdle.idleMicros() / 1000));
+        powerIdle.resetDutyCycle();
+    }, dutyCycleReportMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Report the use of the heap, once running nothing should allocate
+    heapReportTask = scheduler.add([]() {
+        HeapReport::Snapshot heap = heapReport.report();
+        iridium9602N.health.counters[TelemetryCodec::HEAP_ALLOCATIONS] = heap.allocations;
+        iridium9602N.health.counters[TelemetryCodec::HEAP_FREE_CHUNKS] = heap.freeChunks;
+    }, heapReportMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Format the log and write it to the USB serial port, only while a host has the port open and only what fits
+    logFlushTask = scheduler.add([]() {
+        if (Serial.dtr()) {
+            logRing.flush(Serial, Serial.availableForWrite());
+        }
+    }, logFlushMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Report the latency of the loop, the tasks and the modem calls, and carry the worst in the next upload
+    latencyReportTask = scheduler.add([]() {
+        latencyProfiler.report();
+        iridium9602N.health.counters[TelemetryCodec::LOOP_P99_MICROS] = latencyProfiler.loopP99Micros();
+        iridium9602N.health.counters[TelemetryCodec::LATENCY_MAX_MICROS] = latencyProfiler.worstMicros();
+        iridium9602N.health.counters[TelemetryCodec::LATENCY_MAX_PROBE] = latencyProfiler.worstProbe();
+    }, latencyReportMillis, TaskScheduler::PRIORITY_LOW, now);
+
+// Save the time now and then, so that an unplanned reset restores a recent clock
+    configCheckpointTask = scheduler.add([]() {
+        TimeBase::Source source = timeBase.source();
+        if (iridium9602N.configReceived && source != TimeBase::NONE && source != TimeBase::RESTORED) {
+            saveConfiguration(false);
+        }
+    }, configCheckpointMillis, TaskScheduler::PRIORITY_LOW, now);
 
 // Receive configuration
-    receiveConfigurationScheduler = new AsyncTimeScheduler(1000, []() {
-
-        // Check to see if a ring alert has been received from the Iridium 9602N. If so, receive the message.
-        ConfigResponsePacket responsePacket;
-        if (iridium9602N.receiveConfigurationMode(responsePacket, uploadData, uploadIntervalMillis)) {
-            Serial.println("configurationReceived: " + String(iridium9602N.configReceived));
-            Serial.println("uploadData: " + String(uploadData));
-            Serial.println("uploadIntervalMillis: " + String(uploadIntervalMillis));
-
-            //determine the specific operational state of the Blackbox
-            if (!uploadData) {
-                rgbLED.setState(RGBLED::IN_FLIGHT_NO_UPLOAD);
-            } else {
-                rgbLED.setState(RGBLED::IN_FLIGHT);
-            }
+    receiveConfigurationTask = scheduler.add([]() {
+
+        // Apply a command the server sent with the last session, its acknowledgement goes with the next upload
+        ConfigProtocol::Command command;
+        ConfigProtocol::Result result;
+        if (!iridium9602N.takeReceivedCommand(command, result)) {
+            return;
         }
-    });
+        if (result == ConfigProtocol::RESULT_OK) {
+            result = applyCommand(command);
+        }
+        iridium9602N.queueAcknowledgement(TelemetryCodec::ACK_COMMAND,
+                                          ConfigProtocol::acknowledgementValue(command.sequence, result));
+        LOG_INFO(LOG_CONFIG, "Command %lu: result %d", (unsigned long) command.sequence, (int) result);
+        if (result != ConfigProtocol::RESULT_OK) {
+            return;
+        }
+
+        LOG_INFO(LOG_CONFIG, "configurationReceived: %d, uploadData: %d, uploadIntervalMillis: %ld",
+                 iridium9602N.configReceived, uploadData, uploadIntervalMillis);
+
+        //determine the specific operational state of the Blackbox
+        if (!uploadData) {
+            rgbLED.setState(RGBLED::IN_FLIGHT_NO_UPLOAD);
+        } else {
+            rgbLED.setState(RGBLED::IN_FLIGHT);
+        }
+    }, 1000, TaskScheduler::PRIORITY_NORMAL, now);
 
 /**
  * Push data via satellite based on distance traveled
  * CURRENTLY NOT IN USE AS I WAS NOT ABLE TO PROPERLY TEST THIS.
  */
     pushViaSatDistanceScheduler = new AsyncDistanceScheduler(0.01, []() {
-        Serial.println("pushViaSatDistanceScheduler");
+        LOG_DEBUG(LOG_SYSTEM, "pushViaSatDistanceScheduler");
     });
+
+// Time every task run by the scheduler, under the names of the latency report
+    latencyProfiler.nameTask(bootTask, "boot");
+    latencyProfiler.nameTask(backgroundPumpTask, "backgroundPump");
+    latencyProfiler.nameTask(parseAndQueueMavlinkTask, "parseAndQueue");
+    latencyProfiler.nameTask(uploadTask, "upload");
+    latencyProfiler.nameTask(uploadFollowUpTask, "uploadFollowUp");
+    latencyProfiler.nameTask(timeSyncTask, "timeSync");
+    latencyProfiler.nameTask(streamRateTask, "streamRate");
+    latencyProfiler.nameTask(dutyCycleReportTask, "dutyCycleReport");
+    latencyProfiler.nameTask(heapReportTask, "heapReport");
+    latencyProfiler.nameTask(logFlushTask, "logFlush");
+    latencyProfiler.nameTask(latencyReportTask, "latencyReport");
+    latencyProfiler.nameTask(configCheckpointTask, "configCheckpoint");
+    latencyProfiler.nameTask(receiveConfigurationTask, "receiveConfiguration");
+    scheduler.observeRuns(micros, [](uint8_t id, unsigned long elapsed) {
+        latencyProfiler.recordTask(id, elapsed);
+    });
+}
+
+void requestMavlinkMessageSet() {
+    const TelemetrySchema &schema = iridium9602N.telemetrySchema;
+    for (uint8_t i = 0; i < schema.messageCount(); i++) {
+        const ConfigProtocol::MessageRate &rate = schema.message(i);
+        mavlinkInterpreter.requestMavlinkMessage((uint8_t) rate.messageId, rate.intervalMillis);
+    }
+    mavlinkInterpreter.requestMavlinkMessage(MAVLINK_MSG_ID_SYSTEM_TIME);
+}
+
+void applySchema(const TelemetrySchema &schema) {
+
+    //stop the messages the new schema does not sample
+    const TelemetrySchema &previous = iridium9602N.telemetrySchema;
+    for (uint8_t i = 0; i < previous.messageCount(); i++) {
+        if (schema.indexOf(previous.message(i).messageId) < 0) {
+            mavlinkInterpreter.releaseMavlinkMessage((uint8_t) previous.message(i).messageId);
+        }
+    }
+
+    iridium9602N.setSchema(schema);
+    requestMavlinkMessageSet();
 }
 
-void interpretIridiumMessage(String &message) {
+ConfigProtocol::Result applyCommand(const ConfigProtocol::Command &command) {
 
-    //Store the current Blackbox operational state.
-    RGBLED::States prevState = rgbLED.getState();
+    //build the new schema and check everything before anything is changed
+    bool schemaChanged = command.hasSchema || command.quantizationCount > 0 || command.messageRateCount > 0;
+    TelemetrySchema schema = iridium9602N.telemetrySchema;
+    if (command.hasSchema) {
+        schema.select(command.schema);
+    }
+    for (uint8_t i = 0; i < command.quantizationCount; i++) {
+        schema.setField(command.quantizations[i]);
+    }
+    for (uint8_t i = 0; i < command.messageRateCount; i++) {
+        //only messages the schema samples are requested, and they are stopped by removing their fields
+        if (!schema.setInterval(command.messageRates[i].messageId, command.messageRates[i].intervalMillis)) {
+            return ConfigProtocol::RESULT_UNSUPPORTED;
+        }
+    }
+    if (!schema.usable()) {
+        return ConfigProtocol::RESULT_INVALID_VALUE;
+    }
+    if (TelemetryCodec::schemaDescriptorSize(schema.schema()) > ConfigStore::maxStoredSchemaSize) {
+        return ConfigProtocol::RESULT_UNSUPPORTED;
+    }
 
-    //Parse the message from the Iridium 9602N and determine the appropriate action/state. Then reset the previous state.
-    if (message.startsWith("Waiting for SBDIX retry...")) {
-        rgbLED.setState(RGBLED::IN_FLIGHT_SBD_FAILED);
-        rgbLED.asyncLEDDelay(5000);
-        rgbLED.setState(prevState);
-    } else if (message.startsWith("SBDIX success")) {
-        rgbLED.setState(RGBLED::IN_FLIGHT_SBD_SUCCESS);
-        rgbLED.asyncLEDDelay(5000);
-        rgbLED.setState(prevState);
+    if (command.hasUpload) {
+        uploadData = command.uploadData;
+        uploadIntervalMillis = (long) command.uploadIntervalMillis;
+
+        //uploads follow the new interval from the last one
+        scheduler.setPeriod(uploadTask, uploadIntervalMillis);
+
+        //let the server know which configuration is now in effect
+        iridium9602N.queueAcknowledgement(TelemetryCodec::ACK_CONFIG,
+                                          (uint32_t) (uploadIntervalMillis / 1000) << 1 | uploadData);
+    }
+    if (schemaChanged) {
+        applySchema(schema);
     }
-    //Reset the message buffer.
-    message = "";
+    if (command.hasCodec) {
+        iridium9602N.codec = command.codec;
+    }
+    iridium9602N.configReceived = true;
+
+    //keep the configuration across an unplanned reset
+    saveConfiguration(true);
+    iridium9602N.status.fields[TelemetryCodec::STATUS_CONFIG_SEQUENCE] = configStore.config().configSequence;
+    return ConfigProtocol::RESULT_OK;
+}
+
+//A boolean to indicate if the background pump is currently running.
+volatile bool backgroundPumpRunning = false;
+
+void pumpMavlinkInBackground() {
+
+    //never re-enter the pump
+    if (backgroundPumpRunning) {
+        return;
+    }
+    backgroundPumpRunning = true;
+
+    //decode a bounded slice of the receive ring into the telemetry store
+    {
+        LatencyProfiler::Scope timed(latencyProfiler, LatencyProfiler::MAVLINK_PARSE);
+        mavlinkInterpreter.drainRxRing(backgroundPumpMaxBytes);
+    }
+
+    /*
+     * Hand the new messages of the telemetry schema to the satellite queue, read in place from the telemetry store. A
+     * new sample only supersedes records that are not part of the upload in progress, so this never changes what the
+     * modem is sending.
+     */
+    iridium9602N.insertIntoSatQueue(mavlinkInterpreter.telemetryStore());
+
+    backgroundPumpRunning = false;
 }
 
 // ISBD callback function
 bool ISBDCallback() {
-    //blink the MKR LED every 1000 ms
-    blinkMKRLed->run();
-    //blink the RGB LED based on the current operational state of the Blackbox
-    rgbLED.asyncRun();
+    //keep ingesting MAVLink while the modem blocks
+    scheduler.runIfDue(backgroundPumpTask, millis());
     return true;
 }
 
 
-// Buffer to store the received message
-String ISBDConsoleCallbackBuffer = "";
-String ISBDDiagsCallbackBuffer = "";
+// Buffer to store the received message, a longer line is cut off in the log
+FixedString<120> ISBDConsoleCallbackBuffer;
+FixedString<120> ISBDDiagsCallbackBuffer;
 
 void ISBDConsoleCallback(IridiumSBD *device, char c) {
-    Serial.write(c);
+    //keep ingesting MAVLink while the modem blocks
+    scheduler.runIfDue(backgroundPumpTask, millis());
 
     // Accumulate characters in the buffer
     if (c != '\n') {
-        ISBDConsoleCallbackBuffer += c;
+        ISBDConsoleCallbackBuffer.append(c);
     } else {
-        interpretIridiumMessage(ISBDConsoleCallbackBuffer);
+        LOG_DEBUG(LOG_SATELLITE, "%s", ISBDConsoleCallbackBuffer.c_str());
+        ISBDConsoleCallbackBuffer.clear();
     }
-//blink the MKR LED every 1000 ms
-    blinkMKRLed->run();
-    //blink the RGB LED based on the current operational state of the Blackbox
-    rgbLED.asyncRun();
 }
 
 // ISBD diagnostics callback function (development environment)
 void ISBDDiagsCallback(IridiumSBD *device, char c) {
-    Serial.write(c);
-
     // Accumulate characters in the buffer
     if (c != '\n') {
-        ISBDDiagsCallbackBuffer += c;
+        ISBDDiagsCallbackBuffer.append(c);
     } else {
-        interpretIridiumMessage(ISBDDiagsCallbackBuffer);
+        LOG_DEBUG(LOG_SATELLITE, "%s", ISBDDiagsCallbackBuffer.c_str());
+        ISBDDiagsCallbackBuffer.clear();
     }
-//blink the MKR LED every 1000 ms
-    blinkMKRLed->run();
-    //blink the RGB LED based on the current operational state of the Blackbox
-    rgbLED.asyncRun();
-
 }
\ No newline at end of file
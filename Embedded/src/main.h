@@ -5,7 +5,7 @@
 * @Description: This header file contains the definitions and configurations for the AeroRadar Embedded project. It
  * sets up the serial interface and baud rate for MAVLink telemetry, pin assignments for the satellite module, and
  * various settings for the device, such as upload intervals and timeouts. Additionally, it defines flags for the
- * production environment, LED state, GPS lock, and whether the device is uploading data. The file also provides an
+ * production environment, GPS lock, and whether the device is uploading data. The file also provides an
  * external declaration for the RGBLED object and an interrupt handler for the satellite module's serial interface.
 */
 
@@ -21,6 +21,7 @@
 #include <sstream>
 #include <iomanip>
 #include "DiagnosticTools/RGBLED.h"
+#include "ConfigProtocol/ConfigProtocol.h"
 
 
 //The serial interface for the MAVLink telemetry.
@@ -40,9 +41,6 @@
 //Flag to indicate if the device is in production or development environment.
 #define PRODUCTION_ENV true
 
-//a boolean representing the onboard LED state.
-bool ledState = false;
-
 //the time in milliseconds between each telemetry upload.
 long uploadIntervalMillis = 2 * 60 * 1000ul;
 
@@ -58,11 +56,48 @@ long configTimoutMillis = 2 * 60 * 1000ul;
 //The time in milliseconds that the device should wait for the Pixhawk 6C to receive a GPS fix.
 long gpsLockTimeoutMillis = 5 * 60 * 1000ul;
 
-//The last time since bootup that a telemetry message was transmitted.
-long prevSatUpdateTime = 0;
+//The time in milliseconds between two steps of the boot phases.
+unsigned long bootStepMillis = 100;
+
+//The time in milliseconds between two attempts to set up the satellite modem during boot.
+unsigned long modemRetryMillis = 10 * 1000ul;
+
+//The time in milliseconds between two saves of the time with the configuration, restored after an unplanned reset.
+unsigned long configCheckpointMillis = 60 * 1000ul;
+
+//The time in milliseconds between two background MAVLink pumps.
+unsigned long backgroundPumpIntervalMillis = 20;
+
+//The maximum number of bytes a single background MAVLink pump may parse. Keeps each ISBD callback short.
+size_t backgroundPumpMaxBytes = 256;
+
+//The time in milliseconds between two polls of the MAVLink stream rate negotiation.
+unsigned long streamRatePollMillis = 100;
+
+//The time in milliseconds between two attempts to read the Iridium system time.
+long timeSyncRetryMillis = 60 * 1000ul;
+
+//The time in milliseconds between two toggles of the onboard LED.
+unsigned long heartbeatMillis = 1000;
+
+//The longest time in milliseconds the CPU sleeps between two wakes, whatever the scheduler says.
+unsigned long maxIdleMillis = 1000;
+
+//The longest time in milliseconds the CPU sleeps while an SBD session is running, so its AT exchange keeps moving.
+unsigned long sessionIdleMillis = 5;
+
+//The time in milliseconds between two reports of the active versus idle duty cycle.
+unsigned long dutyCycleReportMillis = 60 * 1000ul;
+
+//The time in milliseconds between two flushes of the log to the USB serial port, while a host is attached.
+unsigned long logFlushMillis = 50;
+
+//The time in milliseconds between two reports of the use of the heap.
+unsigned long heapReportMillis = 10 * 60 * 1000ul;
 
+//The time in milliseconds between two reports of the latency of the loop, the tasks and the modem calls.
+unsigned long latencyReportMillis = 10 * 60 * 1000ul;
 
-long prevFuncTime = 0;
 
 //A UART object for the satellite module.
 Uart SerialSAT(&sercom3, 1, 0, SERCOM_RX_PAD_1, UART_TX_PAD_0);
@@ -0,0 +1,302 @@
+/**
+* @File: ConfigProtocolTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the ConfigProtocol parser. A command arrives over the radio from
+ * outside the device, so besides the entries it understands the tests feed it wrong versions, truncated and over-long
+ * varints, entries that overrun the message and out of range values. A command encoded by the website checks that
+ * the parser and Website/src/helpers/ConfigCommandHelper.ts still agree on the format.
+*/
+
+#include "TestSupport.h"
+#include "ConfigProtocol/ConfigProtocol.h"
+#include <vector>
+
+using namespace ConfigProtocol;
+
+/**
+ * The bytes of a command, built up entry by entry.
+ */
+struct CommandBytes {
+    std::vector<uint8_t> bytes;
+
+    /**
+     * Start a command.
+     * @param sequence - the sequence number.
+     */
+    explicit CommandBytes(uint64_t sequence) {
+        bytes.push_back(formatVersion);
+        varint(sequence);
+    }
+
+    CommandBytes &varint(uint64_t value) {
+        uint8_t buffer[10];
+        size_t length = TelemetryCodec::writeVarint(value, buffer);
+        bytes.insert(bytes.end(), buffer, buffer + length);
+        return *this;
+    }
+
+    CommandBytes &entry(uint8_t type, const std::vector<uint8_t> &payload) {
+        bytes.push_back(type);
+        varint(payload.size());
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+        return *this;
+    }
+
+    Result parse(Command &command) const {
+        return ConfigProtocol::parse(bytes.data(), bytes.size(), command);
+    }
+};
+
+/**
+ * The payload of a varint.
+ * @param value - the value.
+ * @return std::vector<uint8_t> - its bytes.
+ */
+static std::vector<uint8_t> varintBytes(uint64_t value) {
+    uint8_t buffer[10];
+    size_t length = TelemetryCodec::writeVarint(value, buffer);
+    return std::vector<uint8_t>(buffer, buffer + length);
+}
+
+/**
+ * The payload of a quantization entry.
+ * @param field - the field.
+ * @param bits - the bits byte, 0x80 set if signed.
+ * @param step - the step.
+ * @param offset - the offset.
+ * @return std::vector<uint8_t> - the payload.
+ */
+static std::vector<uint8_t> quantizationBytes(uint8_t field, uint8_t bits, uint64_t step, int64_t offset) {
+    std::vector<uint8_t> payload = {field, bits};
+    std::vector<uint8_t> stepBytes = varintBytes(step);
+    std::vector<uint8_t> offsetBytes = varintBytes(TelemetryCodec::zigzagEncode(offset));
+    payload.insert(payload.end(), stepBytes.begin(), stepBytes.end());
+    payload.insert(payload.end(), offsetBytes.begin(), offsetBytes.end());
+    return payload;
+}
+
+static void rejectsOtherVersions() {
+    Command command;
+    CHECK_EQUAL(RESULT_UNKNOWN_VERSION, parse(nullptr, 0, command));
+
+    const uint8_t versionZero[] = {0, 1};
+    CHECK_EQUAL(RESULT_UNKNOWN_VERSION, parse(versionZero, sizeof(versionZero), command));
+
+    //the legacy text configuration
+    const uint8_t text[] = {'1', ',', '6', '0'};
+    CHECK_EQUAL(RESULT_UNKNOWN_VERSION, parse(text, sizeof(text), command));
+}
+
+static void rejectsBrokenSequence() {
+    Command command;
+
+    //no sequence at all, and one cut off in its continuation byte
+    const uint8_t missing[] = {formatVersion};
+    CHECK_EQUAL(RESULT_MALFORMED, parse(missing, sizeof(missing), command));
+    const uint8_t truncated[] = {formatVersion, 0x92, 0x80};
+    CHECK_EQUAL(RESULT_MALFORMED, parse(truncated, sizeof(truncated), command));
+
+    //more than ten bytes of continuation is not a varint
+    std::vector<uint8_t> overLong(1, formatVersion);
+    overLong.insert(overLong.end(), 11, 0x80);
+    overLong.push_back(0x01);
+    CHECK_EQUAL(RESULT_MALFORMED, parse(overLong.data(), overLong.size(), command));
+
+    //the sequence has to fit into an acknowledgement
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(maxSequence + 1).parse(command));
+    CHECK_EQUAL(RESULT_OK, CommandBytes(maxSequence).parse(command));
+    CHECK_EQUAL(maxSequence, command.sequence);
+}
+
+static void rejectsEntriesPastTheEnd() {
+    Command command;
+
+    //the length claims one byte more than there is
+    CommandBytes overrun(7);
+    overrun.entry(ENTRY_CODEC, {CODEC_LATEST});
+    overrun.bytes[overrun.bytes.size() - 2] = 2;
+    CHECK_EQUAL(RESULT_MALFORMED, overrun.parse(command));
+
+    //a type without a length, and a length cut off in its continuation byte
+    CommandBytes noLength(7);
+    noLength.bytes.push_back(ENTRY_CODEC);
+    CHECK_EQUAL(RESULT_MALFORMED, noLength.parse(command));
+    noLength.bytes.push_back(0x81);
+    CHECK_EQUAL(RESULT_MALFORMED, noLength.parse(command));
+
+    //a length that would wrap the offset around
+    CommandBytes huge(7);
+    huge.bytes.push_back(ENTRY_CODEC);
+    huge.varint(UINT64_MAX);
+    huge.bytes.push_back(CODEC_LATEST);
+    CHECK_EQUAL(RESULT_MALFORMED, huge.parse(command));
+
+    //an entry whose payload is shorter than its values
+    CHECK_EQUAL(RESULT_MALFORMED, CommandBytes(7).entry(ENTRY_CODEC, {}).parse(command));
+    CHECK_EQUAL(RESULT_MALFORMED, CommandBytes(7).entry(ENTRY_MESSAGE_RATE, {30}).parse(command));
+    CHECK_EQUAL(RESULT_MALFORMED, CommandBytes(7).entry(ENTRY_UPLOAD, {0x80}).parse(command));
+
+    //an entry that ends exactly at the end of the command
+    CHECK_EQUAL(RESULT_OK, CommandBytes(7).entry(ENTRY_CODEC, {CODEC_LATEST}).parse(command));
+    CHECK(command.hasCodec);
+    CHECK_EQUAL(CODEC_LATEST, command.codec);
+}
+
+static void skipsUnknownEntries() {
+    Command command;
+    CommandBytes bytes(9);
+    bytes.entry(0x7F, {1, 2, 3}).entry(ENTRY_CODEC, {CODEC_LATEST}).entry(0x40, {});
+    CHECK_EQUAL(RESULT_OK, bytes.parse(command));
+    CHECK(command.hasCodec);
+    CHECK_EQUAL(CODEC_LATEST, command.codec);
+    CHECK(!command.hasUpload);
+}
+
+static void parsesUpload() {
+    Command command;
+    CHECK_EQUAL(RESULT_OK, CommandBytes(1).entry(ENTRY_UPLOAD, varintBytes(120 << 1 | 1)).parse(command));
+    CHECK(command.hasUpload);
+    CHECK(command.uploadData);
+    CHECK_EQUAL(120000, command.uploadIntervalMillis);
+
+    //15 seconds or less falls back to the default
+    CHECK_EQUAL(RESULT_OK, CommandBytes(1).entry(ENTRY_UPLOAD, varintBytes(15 << 1)).parse(command));
+    CHECK(!command.uploadData);
+    CHECK_EQUAL(defaultUploadIntervalSeconds * 1000, command.uploadIntervalMillis);
+
+    //an interval whose milliseconds do not fit
+    uint64_t tooLong = (uint64_t) (0xFFFFFFFFull / 1000 + 1) << 1;
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(1).entry(ENTRY_UPLOAD, varintBytes(tooLong)).parse(command));
+}
+
+static void limitsMessageRates() {
+    Command command;
+    CommandBytes bytes(42);
+    for (uint8_t i = 0; i < maxMessageRates; i++) {
+        std::vector<uint8_t> payload = varintBytes(30 + i);
+        std::vector<uint8_t> interval = varintBytes(100 * (i + 1));
+        payload.insert(payload.end(), interval.begin(), interval.end());
+        bytes.entry(ENTRY_MESSAGE_RATE, payload);
+    }
+    CHECK_EQUAL(RESULT_OK, bytes.parse(command));
+    CHECK_EQUAL(maxMessageRates, command.messageRateCount);
+    CHECK_EQUAL(37, command.messageRates[7].messageId);
+    CHECK_EQUAL(800, command.messageRates[7].intervalMillis);
+
+    //the ninth is one too many, the sequence is still there to acknowledge the rejection
+    bytes.entry(ENTRY_MESSAGE_RATE, {38, 0});
+    CHECK_EQUAL(RESULT_INVALID_VALUE, bytes.parse(command));
+    CHECK_EQUAL(42, command.sequence);
+
+    //MAVLink 2 message IDs have 24 bits
+    std::vector<uint8_t> wideId = varintBytes(0x1000000);
+    wideId.push_back(0);
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(42).entry(ENTRY_MESSAGE_RATE, wideId).parse(command));
+}
+
+static void parsesQuantizations() {
+    Command command;
+
+    //bits of 0 removes the field, without a step or an offset
+    CommandBytes removal(3);
+    removal.entry(ENTRY_QUANTIZATION, {TelemetryCodec::HEADING, 0});
+    removal.entry(ENTRY_QUANTIZATION, quantizationBytes(TelemetryCodec::ALTITUDE, 0x80 | 20, 100, -5000));
+    CHECK_EQUAL(RESULT_OK, removal.parse(command));
+    CHECK_EQUAL(2, command.quantizationCount);
+    CHECK_EQUAL(TelemetryCodec::HEADING, command.quantizations[0].id);
+    CHECK_EQUAL(0, command.quantizations[0].bits);
+    CHECK_EQUAL(TelemetryCodec::ALTITUDE, command.quantizations[1].id);
+    CHECK_EQUAL(20, command.quantizations[1].bits);
+    CHECK(command.quantizations[1].isSigned);
+    CHECK_EQUAL(100, command.quantizations[1].step);
+    CHECK_EQUAL(-5000, command.quantizations[1].offset);
+
+    //the step is at least 1 and fits into an int32_t
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(3).entry(ENTRY_QUANTIZATION,
+            quantizationBytes(TelemetryCodec::ALTITUDE, 20, 0, 0)).parse(command));
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(3).entry(ENTRY_QUANTIZATION,
+            quantizationBytes(TelemetryCodec::ALTITUDE, 20, (uint64_t) INT32_MAX + 1, 0)).parse(command));
+    CHECK_EQUAL(3, command.sequence);
+    CHECK_EQUAL(RESULT_OK, CommandBytes(3).entry(ENTRY_QUANTIZATION,
+            quantizationBytes(TelemetryCodec::ALTITUDE, 20, INT32_MAX, 0)).parse(command));
+
+    //as does the offset, and the field has to exist
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(3).entry(ENTRY_QUANTIZATION,
+            quantizationBytes(TelemetryCodec::ALTITUDE, 20, 1, (int64_t) INT32_MIN - 1)).parse(command));
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(3).entry(ENTRY_QUANTIZATION,
+            quantizationBytes(TelemetryCodec::FIELD_COUNT, 20, 1, 0)).parse(command));
+
+    //a quantization without its offset
+    std::vector<uint8_t> noOffset = {TelemetryCodec::ALTITUDE, 20, 1};
+    CHECK_EQUAL(RESULT_MALFORMED, CommandBytes(3).entry(ENTRY_QUANTIZATION, noOffset).parse(command));
+}
+
+static void rejectsOutOfRangeBytes() {
+    Command command;
+    CHECK_EQUAL(RESULT_INVALID_VALUE, CommandBytes(5).entry(ENTRY_CODEC, {CODEC_COUNT}).parse(command));
+    CHECK_EQUAL(5, command.sequence);
+    CHECK_EQUAL(RESULT_INVALID_VALUE,
+                CommandBytes(5).entry(ENTRY_SCHEMA, {TelemetryCodec::SCHEMA_COUNT}).parse(command));
+    CHECK_EQUAL(RESULT_OK, CommandBytes(5).entry(ENTRY_SCHEMA, {TelemetryCodec::SCHEMA_EXTENDED}).parse(command));
+    CHECK_EQUAL(TelemetryCodec::SCHEMA_EXTENDED, command.schema);
+}
+
+static void parsesWebsiteCommand() {
+    /*
+     * encodeConfigCommand() of Website/src/helpers/ConfigCommandHelper.ts for
+     *   {sequence: 1234, upload: {enabled: true, intervalSeconds: 120},
+     *    messageRates: [{messageId: 30, intervalMillis: 200}, {messageId: 33, intervalMillis: 1000}],
+     *    codec: Codec.Latest, schema: TelemetrySchema.Extended,
+     *    quantizations: [{field: 3, bits: 20, signed: true, step: 100, offset: -5000},
+     *                    {field: 14, bits: 0, signed: false, step: 0, offset: 0}]}
+     * Regenerate it when the encoder changes.
+     */
+    static const uint8_t website[] = {
+            0x01, 0xd2, 0x09, 0x01, 0x02, 0xf1, 0x01, 0x02, 0x03, 0x1e, 0xc8, 0x01, 0x02, 0x03, 0x21, 0xe8, 0x07,
+            0x03, 0x01, 0x01, 0x05, 0x01, 0x02, 0x04, 0x05, 0x03, 0x94, 0x64, 0x8f, 0x4e, 0x04, 0x02, 0x0e, 0x00
+    };
+
+    Command command;
+    CHECK_EQUAL(RESULT_OK, parse(website, sizeof(website), command));
+    CHECK_EQUAL(1234, command.sequence);
+    CHECK(command.hasUpload);
+    CHECK(command.uploadData);
+    CHECK_EQUAL(120000, command.uploadIntervalMillis);
+    CHECK_EQUAL(2, command.messageRateCount);
+    CHECK_EQUAL(30, command.messageRates[0].messageId);
+    CHECK_EQUAL(200, command.messageRates[0].intervalMillis);
+    CHECK_EQUAL(33, command.messageRates[1].messageId);
+    CHECK_EQUAL(1000, command.messageRates[1].intervalMillis);
+    CHECK(command.hasCodec);
+    CHECK_EQUAL(CODEC_LATEST, command.codec);
+    CHECK(command.hasSchema);
+    CHECK_EQUAL(TelemetryCodec::SCHEMA_EXTENDED, command.schema);
+    CHECK_EQUAL(2, command.quantizationCount);
+    CHECK_EQUAL(TelemetryCodec::ALTITUDE, command.quantizations[0].id);
+    CHECK_EQUAL(20, command.quantizations[0].bits);
+    CHECK(command.quantizations[0].isSigned);
+    CHECK_EQUAL(100, command.quantizations[0].step);
+    CHECK_EQUAL(-5000, command.quantizations[0].offset);
+    CHECK_EQUAL(TelemetryCodec::HEADING, command.quantizations[1].id);
+    CHECK_EQUAL(0, command.quantizations[1].bits);
+}
+
+static void acknowledgesSequence() {
+    CHECK_EQUAL(1234u << 3 | RESULT_INVALID_VALUE, acknowledgementValue(1234, RESULT_INVALID_VALUE));
+    CHECK_EQUAL(maxSequence << 3, acknowledgementValue(maxSequence + 1 + maxSequence, RESULT_OK));
+}
+
+int main() {
+    RUN_TEST(rejectsOtherVersions);
+    RUN_TEST(rejectsBrokenSequence);
+    RUN_TEST(rejectsEntriesPastTheEnd);
+    RUN_TEST(skipsUnknownEntries);
+    RUN_TEST(parsesUpload);
+    RUN_TEST(limitsMessageRates);
+    RUN_TEST(parsesQuantizations);
+    RUN_TEST(rejectsOutOfRangeBytes);
+    RUN_TEST(parsesWebsiteCommand);
+    RUN_TEST(acknowledgesSequence);
+    return TEST_RESULT();
+}
@@ -0,0 +1,154 @@
+/**
+* @File: ConfigStoreTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the ConfigStore class on top of RamFlash: the stored
+ * configuration surviving reboots and many saves, a reset in the middle of a save and records written by an older
+ * firmware.
+*/
+
+#include "TestSupport.h"
+#include "FlashStore/RamFlash.h"
+#include "FlashStore/ConfigStore.h"
+#include <string.h>
+
+//2 rows of 4 pages of 64 bytes, as little as the journal works with.
+static const size_t flashSize = 2 * 4 * 64;
+
+static uint8_t memory[flashSize];
+
+/**
+ * A configuration that differs from the defaults in every field.
+ * @param sequence - the configuration sequence, to tell configurations apart.
+ * @return ConfigStore::StoredConfig - the configuration.
+ */
+static ConfigStore::StoredConfig configuration(uint32_t sequence) {
+    ConfigStore::StoredConfig config = ConfigStore::StoredConfig();
+    config.uploadData = false;
+    config.uploadIntervalMillis = 45000;
+    config.configSequence = sequence;
+    config.unixMillis = 1791000000123ull;
+    config.driftPpb = -1500;
+    config.codec = ConfigProtocol::CODEC_LATEST;
+    config.messageRateCount = 2;
+    config.messageRates[0].messageId = 33;
+    config.messageRates[0].intervalMillis = 200;
+    config.messageRates[1].messageId = 30;
+    config.messageRates[1].intervalMillis = 1000;
+    config.schemaSize = 3;
+    config.schema[0] = 1;
+    config.schema[1] = 2;
+    config.schema[2] = 3;
+    return config;
+}
+
+/**
+ * Whether two configurations are the same in every stored field.
+ * @param a - a configuration.
+ * @param b - another configuration.
+ * @return bool - true if they are the same.
+ */
+static bool sameConfig(const ConfigStore::StoredConfig &a, const ConfigStore::StoredConfig &b) {
+    bool same = a.uploadData == b.uploadData && a.uploadIntervalMillis == b.uploadIntervalMillis
+                && a.configSequence == b.configSequence && a.unixMillis == b.unixMillis && a.driftPpb == b.driftPpb
+                && a.codec == b.codec && a.messageRateCount == b.messageRateCount && a.schemaSize == b.schemaSize
+                && memcmp(a.schema, b.schema, a.schemaSize) == 0;
+    for (uint8_t r = 0; same && r < a.messageRateCount; r++) {
+        same = a.messageRates[r].messageId == b.messageRates[r].messageId
+               && a.messageRates[r].intervalMillis == b.messageRates[r].intervalMillis;
+    }
+    return same;
+}
+
+static void emptyFlashHasNoConfig() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    ConfigStore store(flash);
+
+    CHECK(!store.begin());
+    CHECK(!store.hasConfig());
+    CHECK(store.config().uploadData);
+    CHECK_EQUAL(0, store.config().configSequence);
+}
+
+static void configSurvivesReboot() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    ConfigStore store(flash);
+    store.begin();
+    CHECK(store.save(configuration(1)));
+    CHECK(store.hasConfig());
+
+    ConfigStore rebooted(flash);
+    CHECK(rebooted.begin());
+    CHECK(sameConfig(configuration(1), rebooted.config()));
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void newestOfManySavesWins() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    ConfigStore store(flash);
+    store.begin();
+
+    //enough saves to wrap the journal several times
+    for (uint32_t sequence = 1; sequence <= 50; sequence++) {
+        CHECK(store.save(configuration(sequence)));
+    }
+
+    ConfigStore rebooted(flash);
+    CHECK(rebooted.begin());
+    CHECK_EQUAL(50, rebooted.config().configSequence);
+    CHECK(flash.eraseCount(0) > 1);
+    CHECK(flash.eraseCount(1) > 1);
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void resetDuringSaveKeepsNewest() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    ConfigStore store(flash);
+    store.begin();
+    store.save(configuration(1));
+
+    //the new record was appended, the reset came before the old one was marked as sent
+    uint8_t record[ConfigStore::recordSize];
+    size_t length = ConfigStore::encode(configuration(2), record);
+    FlashBacklog journal(flash, FlashBacklog::NEWEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    journal.begin();
+    CHECK(journal.append(record, length, ConfigStore::formatVersion));
+    CHECK_EQUAL(2, journal.pendingCount());
+
+    ConfigStore rebooted(flash);
+    CHECK(rebooted.begin());
+    CHECK_EQUAL(2, rebooted.config().configSequence);
+    CHECK_EQUAL(1, journal.begin());
+}
+
+static void olderRecordKeepsDefaults() {
+    uint8_t record[ConfigStore::recordSize];
+    ConfigStore::encode(configuration(7), record);
+
+    //format version 1 ended after the configuration sequence
+    ConfigStore::StoredConfig config = ConfigStore::StoredConfig();
+    config.driftPpb = 42;
+    CHECK(ConfigStore::decode(record, ConfigStore::minRecordSize, config));
+    CHECK(!config.uploadData);
+    CHECK_EQUAL(45000, config.uploadIntervalMillis);
+    CHECK_EQUAL(7, config.configSequence);
+    CHECK_EQUAL(42, config.driftPpb);
+    CHECK_EQUAL(0, config.messageRateCount);
+
+    CHECK(!ConfigStore::decode(record, ConfigStore::minRecordSize - 1, config));
+    record[0] = ConfigStore::formatVersion + 1;
+    CHECK(!ConfigStore::decode(record, ConfigStore::recordSize, config));
+}
+
+int main() {
+    RUN_TEST(emptyFlashHasNoConfig);
+    RUN_TEST(configSurvivesReboot);
+    RUN_TEST(newestOfManySavesWins);
+    RUN_TEST(resetDuringSaveKeepsNewest);
+    RUN_TEST(olderRecordKeepsDefaults);
+    return TEST_RESULT();
+}
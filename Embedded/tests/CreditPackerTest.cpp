@@ -0,0 +1,318 @@
+/**
+* @File: CreditPackerTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of CreditPacker: the credit budget around the 50 byte boundaries,
+ * dropping optional content that would spill fewer than minSpillBytes into a credit, filling the 340 byte message and
+ * shrinking a ranked selection of samples until every selected sample is in the packet.
+*/
+
+#include "TestSupport.h"
+#include "Iridium9602N/CreditPacker.h"
+#include <stdlib.h>
+
+using namespace TelemetryCodec;
+
+//The mobile originated limit of the 9602N, as in Iridium9602N.
+static const size_t maxMessageSize = 340;
+
+//The acknowledgement in every budget test: 5 bytes of mandatory content with the version byte.
+static const Acknowledgement commandAck = {ACK_COMMAND, 0};
+
+static const int64_t sampleValues[] = {
+        1791000000123ll, 435123456, -795123456, 312345, -12345, 31415, -15000, -31415,
+        1234, -4321, 10, 2000, -1999, -300, 35900, 123456700
+};
+
+/**
+ * Health counters whose payload has the given length, every counter taking 1 to 5 varint bytes.
+ * @param payload - the length of the payload, 17 to 85 bytes.
+ * @return HealthCounters - the counters.
+ */
+static HealthCounters healthWithPayload(size_t payload) {
+    static const uint32_t widths[] = {0, 1u << 7, 1u << 14, 1u << 21, 1u << 28};
+    HealthCounters health;
+    size_t extra = payload - HEALTH_COUNTER_COUNT;
+    for (size_t i = 0; i < HEALTH_COUNTER_COUNT; i++) {
+        size_t bytes = extra < 4 ? extra : 4;
+        health.counters[i] = widths[bytes];
+        extra -= bytes;
+    }
+    return health;
+}
+
+/**
+ * Pack the command acknowledgement with health counters that make the full content the given length.
+ * @param full - the length of the full content, at least 24 bytes.
+ * @param result - set to what was packed.
+ * @return size_t - the number of bytes in the packet.
+ */
+static size_t packFull(size_t full, CreditPacker::Result &result) {
+    HealthCounters health = healthWithPayload(full - 5 - 2);
+    CHECK_EQUAL(full - 5, sectionHeaderSize(healthPayloadSize(health)) + healthPayloadSize(health));
+
+    Schema schema;
+    builtInSchema(SCHEMA_STANDARD, schema);
+    uint8_t buffer[maxMessageSize];
+    return CreditPacker::pack(nullptr, 0, schema, &commandAck, 1, nullptr, &health, buffer, sizeof(buffer), result);
+}
+
+/**
+ * Random samples a few seconds apart, on the quantization grid of the standard schema so they decode exactly.
+ * @param samples - set to the samples, oldest first.
+ * @param count - the number of samples.
+ * @param spread - the largest change of a field between samples, in quantization steps.
+ */
+static void randomSamples(TelemetrySample *samples, size_t count, int spread) {
+    for (size_t s = 0; s < count; s++) {
+        for (size_t i = 0; i < standardFieldCount; i++) {
+            const FieldSpec &spec = standardFields[i];
+            int64_t value = sampleValues[i] + (int64_t) spec.step * (rand() % (2 * spread + 1) - spread);
+            if (spec.id == UNIX_TIME_MILLIS) {
+                value = sampleValues[i] + (int64_t) s * 5000 + rand() % 100;
+            }
+            samples[s].fields[spec.id] = dequantize(spec, quantize(spec, value));
+        }
+    }
+}
+
+/**
+ * Find a section of a packet.
+ * @param packet - the packet.
+ * @param length - the length of the packet.
+ * @param type - the section type.
+ * @param payloadLength - set to the length of the payload.
+ * @return const uint8_t * - the payload, nullptr if the packet has no such section.
+ */
+static const uint8_t *findSection(const uint8_t *packet, size_t length, SectionType type, size_t &payloadLength) {
+    size_t offset = 1;
+    while (offset < length) {
+        uint8_t sectionType = packet[offset++];
+        uint64_t sectionLength;
+        size_t used = readVarint(packet + offset, length - offset, sectionLength);
+        if (used == 0 || offset + used + sectionLength > length) {
+            return nullptr;
+        }
+        offset += used;
+        if (sectionType == type) {
+            payloadLength = (size_t) sectionLength;
+            return packet + offset;
+        }
+        offset += (size_t) sectionLength;
+    }
+    return nullptr;
+}
+
+/**
+ * Whether two samples hold the same standard fields.
+ * @param a - the first sample.
+ * @param b - the second sample.
+ * @return bool - true if they do.
+ */
+static bool sameSample(const TelemetrySample &a, const TelemetrySample &b) {
+    for (size_t i = 0; i < standardFieldCount; i++) {
+        if (a.fields[standardFields[i].id] != b.fields[standardFields[i].id]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void creditsForBoundaries() {
+    CHECK_EQUAL(1, CreditPacker::creditsFor(0));
+    CHECK_EQUAL(1, CreditPacker::creditsFor(1));
+    CHECK_EQUAL(1, CreditPacker::creditsFor(50));
+    CHECK_EQUAL(2, CreditPacker::creditsFor(51));
+    CHECK_EQUAL(2, CreditPacker::creditsFor(100));
+    CHECK_EQUAL(7, CreditPacker::creditsFor(maxMessageSize));
+}
+
+static void healthFitsTheFirstCredit() {
+    static const size_t lengths[] = {24, 49, 50};
+    for (size_t length : lengths) {
+        CreditPacker::Result result;
+        CHECK_EQUAL(length, packFull(length, result));
+        CHECK_EQUAL(length, result.bytes);
+        CHECK_EQUAL(1, result.credits);
+        CHECK(result.health);
+        CHECK_EQUAL(1, result.acknowledgements);
+    }
+}
+
+static void fewSpilledBytesAreDropped() {
+    //1 to 11 bytes past the credit are not worth another credit, the health counters are left out
+    static const size_t lengths[] = {51, 55, 61};
+    for (size_t length : lengths) {
+        CreditPacker::Result result;
+        CHECK_EQUAL(5, packFull(length, result));
+        CHECK_EQUAL(1, result.credits);
+        CHECK(!result.health);
+        CHECK_EQUAL(1, result.acknowledgements);
+    }
+
+    //12 bytes are
+    CreditPacker::Result result;
+    CHECK_EQUAL(62, packFull(62, result));
+    CHECK_EQUAL(2, result.credits);
+    CHECK(result.health);
+}
+
+static void mandatoryContentOpensACredit() {
+    //8 acknowledgements of 6 bytes make 51 bytes that must all go, one byte into the second credit
+    Acknowledgement acks[8];
+    for (size_t i = 0; i < 8; i++) {
+        acks[i] = {ACK_COMMAND, 1u << 28};
+    }
+    HealthCounters health = healthWithPayload(34);
+    Schema schema;
+    builtInSchema(SCHEMA_STANDARD, schema);
+    uint8_t buffer[maxMessageSize];
+    CreditPacker::Result result;
+
+    CHECK_EQUAL(51, CreditPacker::pack(nullptr, 0, schema, acks, 8, nullptr, nullptr, buffer, sizeof(buffer),
+                                       result));
+    CHECK_EQUAL(2, result.credits);
+    CHECK_EQUAL(8, result.acknowledgements);
+
+    //the 36 bytes of health counters make 87 bytes, which fit the second credit
+    CHECK_EQUAL(87, CreditPacker::pack(nullptr, 0, schema, acks, 8, nullptr, &health, buffer, sizeof(buffer),
+                                       result));
+    CHECK_EQUAL(2, result.credits);
+    CHECK(result.health);
+
+    //without a packet to carry, nothing is packed
+    CHECK_EQUAL(0, CreditPacker::pack(nullptr, 0, schema, nullptr, 0, nullptr, &health, buffer, sizeof(buffer),
+                                      result));
+    //and mandatory content larger than the buffer does not fit at all
+    CHECK_EQUAL(0, CreditPacker::pack(nullptr, 0, schema, acks, 8, nullptr, nullptr, buffer, 50, result));
+}
+
+static void fillsTheLargestMessage() {
+    srand(3);
+    Schema schema;
+    builtInSchema(SCHEMA_STANDARD, schema);
+    HealthCounters health = healthWithPayload(17);
+
+    for (int trial = 0; trial < 200; trial++) {
+        TelemetrySample samples[16];
+        randomSamples(samples, 16, 1 + rand() % 2000);
+        uint8_t buffer[maxMessageSize];
+        CreditPacker::Result result;
+        size_t length = CreditPacker::pack(samples, 16, schema, &commandAck, 1, nullptr, &health, buffer,
+                                           sizeof(buffer), result);
+
+        CHECK(length > 0 && length <= maxMessageSize);
+        CHECK_EQUAL(length, result.bytes);
+        CHECK_EQUAL(CreditPacker::creditsFor(length), result.credits);
+        CHECK(result.credits <= 7);
+        CHECK(result.samples >= 1 && result.samples <= 16);
+
+        //the packed samples are the newest ones
+        size_t payloadLength;
+        const uint8_t *payload = findSection(buffer, length, SECTION_SAMPLES, payloadLength);
+        CHECK(payload != nullptr);
+        if (payload == nullptr) {
+            continue;
+        }
+        TelemetrySample decoded[16];
+        CHECK_EQUAL(result.samples, decodeBatchBody(schema, payload, payloadLength, decoded, 16));
+        for (size_t s = 0; s < result.samples; s++) {
+            CHECK(sameSample(samples[16 - result.samples + s], decoded[s]));
+        }
+    }
+
+    //16 far apart samples do not all fit the 340 bytes, the budget is all 7 credits
+    TelemetrySample far[16];
+    randomSamples(far, 16, 30000);
+    uint8_t buffer[maxMessageSize];
+    CreditPacker::Result result;
+    CreditPacker::pack(far, 16, schema, &commandAck, 1, nullptr, &health, buffer, sizeof(buffer), result);
+    CHECK(result.samples < 16);
+    CHECK_EQUAL(7, result.credits);
+}
+
+//The samples offered to packSelection(), the rank of every one and the number of selections.
+static TelemetrySample ranked[16];
+static int ranks[16];
+static int selections = 0;
+
+static void packsTheWholeSelection() {
+    srand(5);
+    Schema schema;
+    builtInSchema(SCHEMA_STANDARD, schema);
+
+    for (int trial = 0; trial < 100; trial++) {
+        //the oldest samples rank highest, which are the ones pack() leaves out first
+        randomSamples(ranked, 16, 1 + rand() % 30000);
+        for (int i = 0; i < 16; i++) {
+            ranks[i] = 16 - i + (rand() % 3 == 0 ? 100 : 0);
+        }
+        selections = 0;
+        auto selectSamples = [](size_t selection, TelemetrySample *out) {
+            selections++;
+            size_t count = 0;
+            for (int i = 0; i < 16; i++) {
+                size_t higher = 0;
+                for (int j = 0; j < 16; j++) {
+                    higher += ranks[j] > ranks[i] ? 1 : 0;
+                }
+                if (higher < selection) {
+                    out[count++] = ranked[i];
+                }
+            }
+            return count;
+        };
+
+        size_t selected = 16;
+        TelemetrySample samples[16];
+        uint8_t buffer[maxMessageSize];
+        CreditPacker::Result result;
+        size_t length = CreditPacker::packSelection(selected, selectSamples, samples, schema, &commandAck, 1,
+                                                    nullptr, nullptr, buffer, sizeof(buffer), result);
+        CHECK(length > 0 && length <= maxMessageSize);
+        CHECK(selected >= 1);
+        CHECK_EQUAL(selected, result.samples);
+
+        //every packed sample is one of the top ranked
+        size_t payloadLength;
+        const uint8_t *payload = findSection(buffer, length, SECTION_SAMPLES, payloadLength);
+        TelemetrySample decoded[16];
+        CHECK(payload != nullptr && decodeBatchBody(schema, payload, payloadLength, decoded, 16) == selected);
+        TelemetrySample expected[16];
+        selectSamples(selected, expected);
+        for (size_t s = 0; payload != nullptr && s < selected; s++) {
+            CHECK(sameSample(expected[s], decoded[s]));
+        }
+        if (selected < 16) {
+            CHECK(selections >= 2);
+        }
+    }
+
+    //a selection that fits is packed once
+    randomSamples(ranked, 4, 10);
+    selections = 0;
+    size_t selected = 4;
+    TelemetrySample samples[16];
+    uint8_t buffer[maxMessageSize];
+    CreditPacker::Result result;
+    CreditPacker::packSelection(selected, [](size_t selection, TelemetrySample *out) {
+        selections++;
+        for (size_t i = 0; i < selection; i++) {
+            out[i] = ranked[i];
+        }
+        return selection;
+    }, samples, schema, nullptr, 0, nullptr, nullptr, buffer, sizeof(buffer), result);
+    CHECK_EQUAL(4, selected);
+    CHECK_EQUAL(4, result.samples);
+    CHECK_EQUAL(1, selections);
+}
+
+int main() {
+    RUN_TEST(creditsForBoundaries);
+    RUN_TEST(healthFitsTheFirstCredit);
+    RUN_TEST(fewSpilledBytesAreDropped);
+    RUN_TEST(mandatoryContentOpensACredit);
+    RUN_TEST(fillsTheLargestMessage);
+    RUN_TEST(packsTheWholeSelection);
+    return TEST_RESULT();
+}
@@ -0,0 +1,210 @@
+/**
+* @File: DeadlineSchedulerTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of DeadlineScheduler: absolute deadlines that do not drift when a
+ * run is late, skipping missed deadlines, changing the period or deadline of a task, the order of tasks due at once and
+ * the time loop() may sleep until the next deadline.
+*/
+
+#include "TestSupport.h"
+#include "AsyncScheduler/DeadlineScheduler.h"
+#include <limits.h>
+
+typedef DeadlineScheduler<4> Scheduler;
+
+//The ids of the tasks in the order they ran.
+static int runs[16];
+static size_t runCount = 0;
+
+static void runFirst() {
+    runs[runCount++ % 16] = 0;
+}
+
+static void runSecond() {
+    runs[runCount++ % 16] = 1;
+}
+
+static void runThird() {
+    runs[runCount++ % 16] = 2;
+}
+
+/**
+ * A callable task that counts its runs.
+ */
+struct Counter {
+    int calls = 0;
+
+    void operator()() {
+        calls++;
+    }
+};
+
+static void deadlinesDoNotDrift() {
+    Scheduler scheduler;
+    runCount = 0;
+    int id = scheduler.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, 0);
+    CHECK_EQUAL(0, id);
+
+    //a run that is late by a varying amount, or runs for a while, does not move the deadlines after it
+    static const unsigned long lateness[] = {0, 30, 99, 1, 50, 0, 75, 10, 60, 20};
+    for (unsigned long period = 1; period <= 10; period++) {
+        unsigned long now = period * 100 + lateness[period - 1];
+        CHECK_EQUAL(0, scheduler.millisUntilNextDeadline(now));
+        CHECK_EQUAL(1, scheduler.runDue(now));
+        CHECK_EQUAL(100 - lateness[period - 1], scheduler.millisUntilNextDeadline(now));
+        CHECK_EQUAL(0, scheduler.runDue(period * 100 + 99));
+    }
+    CHECK_EQUAL(10, runCount);
+    CHECK_EQUAL(0, scheduler.skippedCount(id));
+}
+
+static void missedDeadlinesAreSkipped() {
+    Scheduler scheduler;
+    runCount = 0;
+    int id = scheduler.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, 0);
+
+    //blocked until 450: the deadlines at 100, 200 and 300 are skipped, 400 runs once and 500 is next
+    CHECK_EQUAL(1, scheduler.runDue(450));
+    CHECK_EQUAL(0, scheduler.runDue(450));
+    CHECK_EQUAL(1, runCount);
+    CHECK_EQUAL(3, scheduler.skippedCount(id));
+    CHECK_EQUAL(50, scheduler.millisUntilNextDeadline(450));
+
+    //a run exactly at the deadline skips nothing
+    CHECK_EQUAL(1, scheduler.runDue(500));
+    CHECK_EQUAL(3, scheduler.skippedCount(id));
+    CHECK_EQUAL(0, scheduler.skippedCount(-1));
+    CHECK_EQUAL(0, scheduler.skippedCount(3));
+}
+
+static void changesPeriodsAndDeadlines() {
+    Scheduler scheduler;
+    runCount = 0;
+    int id = scheduler.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, 0);
+    scheduler.runDue(100);
+
+    //a new period counts from the last deadline, a period of 0 is ignored
+    scheduler.setPeriod(id, 50);
+    CHECK_EQUAL(40, scheduler.millisUntilNextDeadline(110));
+    scheduler.setPeriod(id, 0);
+    CHECK_EQUAL(40, scheduler.millisUntilNextDeadline(110));
+    scheduler.setPeriod(id, 300);
+    CHECK_EQUAL(290, scheduler.millisUntilNextDeadline(110));
+
+    //restart() counts a period from now
+    scheduler.restart(id, 120);
+    CHECK_EQUAL(300, scheduler.millisUntilNextDeadline(120));
+
+    //runSoon() makes it due now, after which it is back on its period
+    scheduler.runSoon(id, 130);
+    CHECK_EQUAL(0, scheduler.millisUntilNextDeadline(130));
+    CHECK_EQUAL(1, scheduler.runDue(130));
+    CHECK_EQUAL(300, scheduler.millisUntilNextDeadline(130));
+
+    //a disabled task does not run, enabling it again starts a period from now
+    scheduler.setEnabled(id, false, 140);
+    CHECK_EQUAL(0, scheduler.runDue(1000));
+    scheduler.setEnabled(id, true, 1000);
+    CHECK_EQUAL(300, scheduler.millisUntilNextDeadline(1000));
+    CHECK_EQUAL(2, runCount);
+}
+
+static void runsASingleTask() {
+    Scheduler scheduler;
+    runCount = 0;
+    int first = scheduler.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, 0);
+    int second = scheduler.add(runSecond, 100, Scheduler::PRIORITY_HIGH, 0);
+
+    //only the given task runs, and only when it is due
+    CHECK(!scheduler.runIfDue(first, 99));
+    CHECK(scheduler.runIfDue(first, 100));
+    CHECK_EQUAL(1, runCount);
+    CHECK_EQUAL(0, runs[0]);
+    CHECK(!scheduler.runIfDue(first, 100));
+    CHECK(!scheduler.runIfDue(-1, 100));
+    CHECK(!scheduler.runIfDue(2, 100));
+
+    //the other one is still due
+    CHECK_EQUAL(1, scheduler.runDue(100));
+    CHECK_EQUAL(1, runs[1]);
+    CHECK(scheduler.runIfDue(second, 200));
+}
+
+static void higherPriorityRunsFirst() {
+    Scheduler scheduler;
+    runCount = 0;
+    scheduler.add(runFirst, 100, Scheduler::PRIORITY_LOW, 0);
+    scheduler.add(runSecond, 100, Scheduler::PRIORITY_HIGH, 0);
+    scheduler.add(runThird, 100, Scheduler::PRIORITY_NORMAL, 0);
+
+    //all due at once: by priority, each once
+    CHECK_EQUAL(3, scheduler.runDue(250));
+    CHECK_EQUAL(3, runCount);
+    CHECK_EQUAL(1, runs[0]);
+    CHECK_EQUAL(2, runs[1]);
+    CHECK_EQUAL(0, runs[2]);
+
+    //the same priority: the most overdue first
+    Scheduler equal;
+    runCount = 0;
+    equal.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, 50);
+    equal.add(runSecond, 100, Scheduler::PRIORITY_NORMAL, 0);
+    CHECK_EQUAL(2, equal.runDue(160));
+    CHECK_EQUAL(1, runs[0]);
+    CHECK_EQUAL(0, runs[1]);
+}
+
+static void nextWakeIsTheEarliestDeadline() {
+    Scheduler scheduler;
+    CHECK_EQUAL(Scheduler::noDeadline, scheduler.millisUntilNextDeadline(0));
+
+    int slow = scheduler.add(runFirst, 1000, Scheduler::PRIORITY_NORMAL, 0);
+    int fast = scheduler.add(runSecond, 250, Scheduler::PRIORITY_NORMAL, 0);
+    CHECK_EQUAL(250, scheduler.millisUntilNextDeadline(0));
+    CHECK_EQUAL(0, scheduler.millisUntilNextDeadline(300));
+
+    //disabled tasks do not wake loop()
+    scheduler.setEnabled(fast, false, 0);
+    CHECK_EQUAL(900, scheduler.millisUntilNextDeadline(100));
+    scheduler.setEnabled(slow, false, 0);
+    CHECK_EQUAL(Scheduler::noDeadline, scheduler.millisUntilNextDeadline(100));
+
+    //across the wraparound of millis()
+    Scheduler wrapping;
+    runCount = 0;
+    unsigned long start = ULONG_MAX - 49;
+    wrapping.add(runFirst, 100, Scheduler::PRIORITY_NORMAL, start);
+    CHECK_EQUAL(100, wrapping.millisUntilNextDeadline(start));
+    CHECK_EQUAL(51, wrapping.millisUntilNextDeadline(ULONG_MAX));
+    CHECK_EQUAL(0, wrapping.runDue(ULONG_MAX));
+    CHECK_EQUAL(1, wrapping.runDue(50));
+    CHECK_EQUAL(100, wrapping.millisUntilNextDeadline(50));
+}
+
+static void tableIsFixed() {
+    Scheduler scheduler;
+    Counter counter;
+    CHECK_EQUAL(-1, scheduler.add(runFirst, 0, Scheduler::PRIORITY_NORMAL, 0));
+    CHECK_EQUAL(0, scheduler.add(counter, 10, Scheduler::PRIORITY_NORMAL, 0));
+    for (int i = 1; i < 4; i++) {
+        CHECK_EQUAL(i, scheduler.add(runFirst, 1000, Scheduler::PRIORITY_NORMAL, 0));
+    }
+    CHECK_EQUAL(-1, scheduler.add(runFirst, 1000, Scheduler::PRIORITY_NORMAL, 0));
+
+    //a callable is called through its reference
+    scheduler.runDue(10);
+    scheduler.runDue(20);
+    CHECK_EQUAL(2, counter.calls);
+}
+
+int main() {
+    RUN_TEST(deadlinesDoNotDrift);
+    RUN_TEST(missedDeadlinesAreSkipped);
+    RUN_TEST(changesPeriodsAndDeadlines);
+    RUN_TEST(runsASingleTask);
+    RUN_TEST(higherPriorityRunsFirst);
+    RUN_TEST(nextWakeIsTheEarliestDeadline);
+    RUN_TEST(tableIsFixed);
+    return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+/**
+* @File: FixedStringTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of TextBuffer and FixedString: appending and formatting, cutting off
+ * text that does not fit and writing floats without the printf float support.
+*/
+
+#include "TestSupport.h"
+#include "FixedString/FixedString.h"
+#include <string.h>
+#include <math.h>
+
+/**
+ * Whether a string holds the expected text, printing it if not.
+ * @param text - the string.
+ * @param expected - the expected text.
+ * @return bool - true if it does.
+ */
+static bool holds(const TextBuffer &text, const char *expected) {
+    if (strcmp(text.c_str(), expected) != 0) {
+        printf("  got \"%s\", expected \"%s\"\n", text.c_str(), expected);
+        return false;
+    }
+    return true;
+}
+
+static void startsEmpty() {
+    FixedString<16> text;
+    CHECK(holds(text, ""));
+    CHECK_EQUAL(0, text.length());
+    CHECK_EQUAL(16, text.capacity());
+    CHECK(!text.truncated());
+}
+
+static void appendsAndFormats() {
+    FixedString<16> text;
+    CHECK(text.append('>'));
+    CHECK(text.appendf("%d-%s", 42, "ab"));
+    CHECK(text.append(" ok"));
+    CHECK(holds(text, ">42-ab ok"));
+    CHECK_EQUAL(9, text.length());
+
+    FixedString<8> formatted("x=%d", 7);
+    CHECK(holds(formatted, "x=7"));
+    CHECK(formatted.startsWith("x="));
+    CHECK(!formatted.startsWith("x=8"));
+    CHECK(!formatted.startsWith("x=7 and more"));
+}
+
+static void cutsOffWhatDoesNotFit() {
+    FixedString<16> text;
+    text.append("42-ab");
+    CHECK(!text.append("0123456789xyz"));
+    CHECK(text.truncated());
+    CHECK(holds(text, "42-ab0123456789x"));
+    CHECK(!text.append('z'));
+    CHECK_EQUAL(16, text.length());
+
+    //clear() forgets the truncation
+    text.clear();
+    CHECK(!text.truncated());
+    CHECK(!text.appendf("%s", "this is far too long"));
+    CHECK(holds(text, "this is far too "));
+
+    FixedString<0> none;
+    CHECK(!none.append('a'));
+    CHECK(holds(none, ""));
+    CHECK(none.truncated());
+}
+
+static void writesFloats() {
+    struct Case {
+        double value;
+        uint8_t decimals;
+        const char *expected;
+    };
+    static const Case cases[] = {
+            {3.14159,    2, "3.14"},
+            {-0.125,     2, "-0.13"},
+            {2.5,        0, "3"},
+            {0.05,       1, "0.1"},
+            {1.999999,   5, "2.00000"},
+            {12.3456789, 9, "12.345678900"},
+            {5e9,        1, "ovf"},
+            {NAN,        1, "nan"},
+            {-INFINITY,  1, "-inf"}
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        FixedString<16> text;
+        text.appendFloat(cases[i].value, cases[i].decimals);
+        CHECK(holds(text, cases[i].expected));
+    }
+}
+
+int main() {
+    RUN_TEST(startsEmpty);
+    RUN_TEST(appendsAndFormats);
+    RUN_TEST(cutsOffWhatDoesNotFit);
+    RUN_TEST(writesFloats);
+    return TEST_RESULT();
+}
@@ -0,0 +1,222 @@
+/**
+* @File: FlashBacklogTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the FlashBacklog class on top of RamFlash: recovery after a reboot,
+ * both drain orders, both overflow policies, a record torn by a reset while it was programmed and the spread of
+ * erases over the rows. RamFlash counts every program that breaks the rules of the NOR flash, none may happen.
+*/
+
+#include "TestSupport.h"
+#include "FlashStore/RamFlash.h"
+#include "FlashStore/FlashBacklog.h"
+#include <string.h>
+
+//8 rows of 4 pages of 64 bytes, a record per page.
+static const size_t flashSize = 8 * 4 * 64;
+static const size_t rowPages = 4;
+
+static uint8_t memory[flashSize];
+
+//The payload of a telemetry record.
+static const size_t payloadSize = 36;
+
+/**
+ * Append a record whose bytes all hold its number.
+ * @param backlog - the backlog.
+ * @param number - the number of the record.
+ * @return bool - whether the record was stored.
+ */
+static bool appendNumbered(FlashBacklog &backlog, uint8_t number) {
+    uint8_t payload[payloadSize];
+    memset(payload, number, sizeof(payload));
+    return backlog.append(payload, sizeof(payload), (uint8_t) (number & 1));
+}
+
+/**
+ * The number of the record a backlog hands out first.
+ * @param backlog - the backlog.
+ * @return int - the number of the record, -1 if none is pending or it does not read back intact.
+ */
+static int firstNumber(FlashBacklog &backlog) {
+    FlashBacklog::RecordRef ref;
+    if (backlog.select(&ref, 1) != 1) {
+        return -1;
+    }
+    uint8_t payload[FlashBacklog::maxRecordSize];
+    uint8_t tag;
+    size_t length = backlog.read(ref, payload, sizeof(payload), tag);
+    if (length != payloadSize || tag != (payload[0] & 1)) {
+        return -1;
+    }
+    for (size_t i = 1; i < length; i++) {
+        if (payload[i] != payload[0]) {
+            return -1;
+        }
+    }
+    return payload[0];
+}
+
+static void ramFlashFollowsTheFlash() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    CHECK_EQUAL(1, flash.eraseCount(0));
+
+    const uint8_t first[4] = {0xF0, 0xFF, 0x0F, 0x00};
+    const uint8_t second[4] = {0xF0, 0x0F, 0x0F, 0x00};
+    CHECK(flash.program(0, first, 4));
+    CHECK(flash.program(0, second, 4));
+    CHECK_EQUAL(0, flash.violations());
+
+    //programming stores the AND, only a third program of the page and setting a cleared bit break the rules
+    uint8_t stored[4];
+    flash.read(0, stored, 4);
+    CHECK_EQUAL(0xF0, stored[0]);
+    CHECK_EQUAL(0x0F, stored[1]);
+    CHECK(flash.program(0, first, 4));
+    CHECK_EQUAL(2, flash.violations());
+
+    //words only, within one page
+    CHECK(!flash.program(2, first, 4));
+    CHECK(!flash.program(62, first, 4));
+
+    CHECK(flash.eraseRow(0));
+    flash.read(0, stored, 4);
+    CHECK_EQUAL(0xFF, stored[0]);
+    CHECK_EQUAL(2, flash.eraseCount(0));
+    CHECK(!flash.eraseRow(64));
+}
+
+static void recoversAfterReboot() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    CHECK_EQUAL(0, backlog.begin());
+    CHECK_EQUAL(32, backlog.capacity());
+    CHECK_EQUAL(52, backlog.maxPayloadSize());
+
+    for (uint8_t i = 0; i < 20; i++) {
+        CHECK(appendNumbered(backlog, i));
+    }
+    CHECK_EQUAL(20, backlog.pendingCount());
+
+    //the same flash after a reboot, drained from the other end
+    FlashBacklog rebooted(flash, FlashBacklog::NEWEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    CHECK_EQUAL(20, rebooted.begin());
+    CHECK_EQUAL(19, firstNumber(rebooted));
+
+    FlashBacklog::RecordRef refs[5];
+    CHECK_EQUAL(5, rebooted.select(refs, 5));
+    for (size_t i = 0; i < 5; i++) {
+        CHECK(rebooted.markSent(refs[i]));
+    }
+    CHECK(!rebooted.markSent(refs[0]));
+    CHECK_EQUAL(15, rebooted.pendingCount());
+
+    //the sent records stay sent after another reboot
+    CHECK_EQUAL(15, backlog.begin());
+    CHECK_EQUAL(0, firstNumber(backlog));
+    backlog.setDrainOrder(FlashBacklog::NEWEST_FIRST);
+    CHECK_EQUAL(14, firstNumber(backlog));
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void overwritesOldest() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    backlog.begin();
+
+    for (uint8_t i = 0; i < 100; i++) {
+        CHECK(appendNumbered(backlog, i));
+    }
+    CHECK(backlog.pendingCount() <= backlog.capacity());
+    CHECK(backlog.pendingCount() >= backlog.capacity() - rowPages);
+    CHECK_EQUAL(100 - backlog.pendingCount(), backlog.overwrittenCount());
+    CHECK_EQUAL(100 - backlog.pendingCount(), firstNumber(backlog));
+
+    size_t pending = backlog.pendingCount();
+    int oldest = firstNumber(backlog);
+    CHECK_EQUAL(pending, backlog.begin());
+    CHECK_EQUAL(oldest, firstNumber(backlog));
+
+    //the rows wear evenly
+    uint32_t fewest = flash.eraseCount(0);
+    uint32_t most = fewest;
+    for (size_t row = 1; row < flashSize / (rowPages * 64); row++) {
+        fewest = flash.eraseCount(row) < fewest ? flash.eraseCount(row) : fewest;
+        most = flash.eraseCount(row) > most ? flash.eraseCount(row) : most;
+    }
+    CHECK(most - fewest <= 1);
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void rejectsNewest() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::REJECT_NEWEST);
+    backlog.begin();
+
+    uint8_t stored = 0;
+    while (!backlog.isFull() && stored < 100) {
+        CHECK(appendNumbered(backlog, stored++));
+    }
+    CHECK(backlog.isFull());
+    CHECK(!appendNumbered(backlog, stored));
+    CHECK_EQUAL(1, backlog.rejectedCount());
+    CHECK_EQUAL(0, backlog.overwrittenCount());
+    CHECK_EQUAL(0, firstNumber(backlog));
+
+    //sending the oldest row makes room again
+    FlashBacklog::RecordRef refs[rowPages];
+    CHECK_EQUAL(rowPages, backlog.select(refs, rowPages));
+    for (size_t i = 0; i < rowPages; i++) {
+        backlog.markSent(refs[i]);
+    }
+    CHECK(!backlog.isFull());
+    CHECK(appendNumbered(backlog, stored));
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void survivesTornRecord() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    backlog.begin();
+    for (uint8_t i = 0; i < 6; i++) {
+        appendNumbered(backlog, i);
+    }
+
+    //a reset while the next page was programmed leaves part of a header in it
+    const uint8_t torn[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    CHECK(flash.program(6 * 64, torn, sizeof(torn)));
+
+    FlashBacklog rebooted(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    CHECK_EQUAL(6, rebooted.begin());
+    CHECK_EQUAL(0, firstNumber(rebooted));
+    CHECK(appendNumbered(rebooted, 6));
+    CHECK_EQUAL(7, rebooted.pendingCount());
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void rejectsOversizedRecord() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    backlog.begin();
+
+    uint8_t payload[FlashBacklog::maxRecordSize] = {};
+    CHECK(!backlog.append(payload, backlog.maxPayloadSize() + 1, 0));
+    CHECK(backlog.append(payload, backlog.maxPayloadSize(), 0));
+    CHECK_EQUAL(1, backlog.pendingCount());
+}
+
+int main() {
+    RUN_TEST(ramFlashFollowsTheFlash);
+    RUN_TEST(recoversAfterReboot);
+    RUN_TEST(overwritesOldest);
+    RUN_TEST(rejectsNewest);
+    RUN_TEST(survivesTornRecord);
+    RUN_TEST(rejectsOversizedRecord);
+    return TEST_RESULT();
+}
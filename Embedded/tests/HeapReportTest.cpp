@@ -0,0 +1,96 @@
+/**
+* @File: HeapReportTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of HeapReport, built with malloc, calloc, realloc and free wrapped as
+ * in the firmware. They check that the counters see every allocation, and that the text paths that run during a
+ * flight, the ISBD callback lines, formatted messages and the log, allocate nothing once they run. The host C library
+ * is linked dynamically, so only the calls made from the firmware and test code are counted, which are the ones that
+ * matter here.
+*/
+
+#include "TestSupport.h"
+#include "HeapReport/HeapReport.h"
+#include "FixedString/FixedString.h"
+#include "Log/Log.h"
+#include <Arduino.h>
+#include <stdlib.h>
+
+/**
+ * A Print that counts the lines written to it.
+ */
+class LineCounter : public Print {
+
+public:
+    size_t println(const char *text) override {
+        lines++;
+        return strlen(text) + 2;
+    }
+
+    uint32_t lines = 0;
+};
+
+static void countsAllocations() {
+    HeapReport report;
+    report.report();
+
+    void *block = malloc(100);
+    void *zeroed = calloc(4, 25);
+    block = realloc(block, 200);
+    free(block);
+    free(zeroed);
+    free(nullptr);
+
+    HeapReport::Snapshot before = HeapReport::snapshot();
+    report.report();
+    CHECK_EQUAL(3, report.allocationsInLastPeriod());
+    CHECK_EQUAL(before.allocations, HeapReport::snapshot().allocations);
+
+    //a period without allocations reports none
+    report.report();
+    CHECK_EQUAL(0, report.allocationsInLastPeriod());
+}
+
+static void steadyStateAllocatesNothing() {
+    LineCounter out;
+    HeapReport report;
+
+    //the first round may set up the C library, the steady state starts after it
+    for (int round = 0; round < 2; round++) {
+        report.report();
+        logRing.flush(out, 4096);
+        report.report();
+
+        for (int i = 0; i < 10000; i++) {
+            //an ISBD callback line, one character at a time
+            static FixedString<120> line;
+            line.clear();
+            const char *message = (i & 1) ? "SBDIX: 0, 5, 1, 7, 3, 0" : "SBDRB";
+            for (const char *c = message; *c != '\0'; c++) {
+                line.append(*c);
+            }
+
+            //a sample line as written by MavlinkInterpreter::toANSI
+            FixedString<255> sample;
+            sample.append("\"heading\":");
+            sample.appendFloat(i / 100.0, 2);
+            sample.appendf(",\"latitude\":%ld", (long) i * 1000);
+
+            LOG_INFO(LOG_SATELLITE, "%s %s", line.c_str(), sample.c_str());
+            if ((i & 15) == 0) {
+                logRing.flush(out, 4096);
+            }
+        }
+        logRing.flush(out, 4096);
+        report.report();
+    }
+
+    CHECK_EQUAL(0, report.allocationsInLastPeriod());
+    CHECK(out.lines > 0);
+}
+
+int main() {
+    RUN_TEST(countsAllocations);
+    RUN_TEST(steadyStateAllocatesNothing);
+    return TEST_RESULT();
+}
@@ -0,0 +1,302 @@
+/**
+* @File: IridiumSessionTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the IridiumSession class. Every test plays a script of AT command
+ * exchanges through ScriptedModemPort and checks the result the session reports, in particular that an MO message the
+ * gateway accepted stays delivered whatever happens to the MT read that follows it.
+*/
+
+#include "TestSupport.h"
+#include "Iridium9602N/IridiumSession.h"
+#include "Iridium9602N/ScriptedModemPort.h"
+#include <string.h>
+
+typedef ScriptedModemPort::Exchange Exchange;
+
+//The largest MT message the 9602N delivers, the size of the MT buffer of Iridium9602N.
+static const size_t maxMtMessageSize = 270;
+
+static const uint8_t moMessage[] = {'p', 'i', 'n', 'g'};
+
+static uint8_t mtBuffer[maxMtMessageSize];
+
+//The AT+SBDWB exchange of moMessage, accepted by the modem.
+static const Exchange writeMessage = {"AT+SBDWB=4", nullptr, 0, "\r\nREADY\r\n", 10, "\r\n0\r\n\r\nOK\r\n"};
+
+/**
+ * Poll a session until it completes, advancing the simulated clock 10 ms at a time.
+ * @param session - the running session.
+ * @param port - the fake modem of the session.
+ * @param limitMillis - how much simulated time the session may take.
+ */
+static void runSession(IridiumSession &session, ScriptedModemPort &port, unsigned long limitMillis) {
+    for (unsigned long elapsed = 0; session.isBusy() && elapsed <= limitMillis; elapsed += 10) {
+        session.poll();
+        port.advance(10);
+    }
+}
+
+/**
+ * The AT+SBDRB response to a message: its length, the message and the low 16 bits of its byte sum.
+ * @param message - the message.
+ * @param length - the length of the message.
+ * @param response - where the response is written, length + 4 bytes.
+ * @return size_t - the length of the response.
+ */
+static size_t sbdrbResponse(const uint8_t *message, size_t length, uint8_t *response) {
+    uint16_t checksum = 0;
+    response[0] = (uint8_t) (length >> 8);
+    response[1] = (uint8_t) (length & 0xFF);
+    for (size_t i = 0; i < length; i++) {
+        response[2 + i] = message[i];
+        checksum += message[i];
+    }
+    response[2 + length] = (uint8_t) (checksum >> 8);
+    response[3 + length] = (uint8_t) (checksum & 0xFF);
+    return length + 4;
+}
+
+static void signalQuality() {
+    const Exchange script[] = {{"AT+CSQ", nullptr, 0, "\r\n+CSQ:4\r\n\r\nOK\r\n", 50, nullptr}};
+    ScriptedModemPort port(script, 1);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SIGNAL_QUALITY));
+    runSession(session, port, 1000);
+
+    CHECK(!session.isBusy());
+    CHECK_EQUAL(IridiumSession::SESSION_OK, session.result().error);
+    CHECK_EQUAL(4, session.result().signalQuality);
+    CHECK(port.finished());
+    CHECK_EQUAL(0, port.mismatches());
+}
+
+static void systemTime() {
+    const Exchange script[] = {{"AT-MSSTM", nullptr, 0, "\r\n-MSSTM: 0a3b1f2c\r\n\r\nOK\r\n", 50, nullptr}};
+    ScriptedModemPort port(script, 1);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SYSTEM_TIME));
+    runSession(session, port, 1000);
+
+    CHECK_EQUAL(IridiumSession::SESSION_OK, session.result().error);
+    CHECK_EQUAL(0x0a3b1f2cul, session.result().systemTime);
+}
+
+static void systemTimeWithoutNetwork() {
+    const Exchange script[] = {{"AT-MSSTM", nullptr, 0, "\r\n-MSSTM: no network service\r\n\r\nOK\r\n", 50, nullptr}};
+    ScriptedModemPort port(script, 1);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SYSTEM_TIME));
+    runSession(session, port, 1000);
+
+    CHECK_EQUAL(IridiumSession::SESSION_NO_NETWORK, session.result().error);
+}
+
+static void sendWithoutMessageWaiting() {
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 0, 12, 0, 0, 0, 0\r\n\r\nOK\r\n", 5000, nullptr}
+    };
+    ScriptedModemPort port(script, 2);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 10 * 1000ul);
+
+    const IridiumSession::Result &result = session.result();
+    CHECK_EQUAL(IridiumSession::SESSION_OK, result.error);
+    CHECK(result.moDelivered);
+    CHECK_EQUAL(12, result.moMsn);
+    CHECK_EQUAL(0, result.receivedLength);
+    CHECK_EQUAL(1, result.attempts);
+
+    size_t written;
+    const uint8_t *payload = port.lastPayload(written);
+    CHECK_EQUAL(sizeof(moMessage), written);
+    CHECK(memcmp(payload, moMessage, sizeof(moMessage)) == 0);
+    CHECK(port.finished());
+    CHECK_EQUAL(0, port.mismatches());
+}
+
+static void sendAndReceive() {
+    const uint8_t message[] = {'a', 'c', 'k'};
+    uint8_t response[sizeof(message) + 4];
+    size_t responseLength = sbdrbResponse(message, sizeof(message), response);
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 0, 5, 1, 7, 3, 0\r\n\r\nOK\r\n", 5000, nullptr},
+            {"AT+SBDRB", response, responseLength, "\r\nOK\r\n", 50, nullptr}
+    };
+    ScriptedModemPort port(script, 3);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 10 * 1000ul);
+
+    const IridiumSession::Result &result = session.result();
+    CHECK_EQUAL(IridiumSession::SESSION_OK, result.error);
+    CHECK(result.moDelivered);
+    CHECK_EQUAL(1, result.mtStatus);
+    CHECK_EQUAL(7, result.mtMsn);
+    CHECK_EQUAL(sizeof(message), result.receivedLength);
+    CHECK(memcmp(mtBuffer, message, sizeof(message)) == 0);
+    CHECK(port.finished());
+}
+
+static void failedReadKeepsDelivery() {
+    //the MT message "ack" with a checksum of 0 instead of 0x0137
+    const uint8_t response[] = {0x00, 0x03, 'a', 'c', 'k', 0x00, 0x00};
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 0, 5, 1, 7, 3, 0\r\n\r\nOK\r\n", 5000, nullptr},
+            {"AT+SBDRB", response, sizeof(response), "\r\nOK\r\n", 50, nullptr}
+    };
+    ScriptedModemPort port(script, 3);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 10 * 1000ul);
+
+    const IridiumSession::Result &result = session.result();
+    CHECK(!session.isBusy());
+    CHECK_EQUAL(IridiumSession::SESSION_CHECKSUM_ERROR, result.error);
+    CHECK(result.moDelivered);
+    CHECK_EQUAL(0, result.moStatus);
+    CHECK_EQUAL(5, result.moMsn);
+    CHECK_EQUAL(0, port.mismatches());
+}
+
+static void largestMessageFits() {
+    uint8_t message[maxMtMessageSize];
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t) (i * 7);
+    }
+    uint8_t response[sizeof(message) + 4];
+    size_t responseLength = sbdrbResponse(message, sizeof(message), response);
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 0, 5, 1, 8, 270, 0\r\n\r\nOK\r\n", 5000, nullptr},
+            {"AT+SBDRB", response, responseLength, "\r\nOK\r\n", 50, nullptr}
+    };
+    ScriptedModemPort port(script, 3);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 10 * 1000ul);
+
+    CHECK_EQUAL(IridiumSession::SESSION_OK, session.result().error);
+    CHECK_EQUAL(maxMtMessageSize, session.result().receivedLength);
+    CHECK(memcmp(mtBuffer, message, sizeof(message)) == 0);
+}
+
+static void oversizedMessageOverflows() {
+    uint8_t message[maxMtMessageSize + 1];
+    memset(message, 'x', sizeof(message));
+    uint8_t response[sizeof(message) + 4];
+    size_t responseLength = sbdrbResponse(message, sizeof(message), response);
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 0, 5, 1, 9, 271, 0\r\n\r\nOK\r\n", 5000, nullptr},
+            {"AT+SBDRB", response, responseLength, "\r\nOK\r\n", 50, nullptr}
+    };
+    ScriptedModemPort port(script, 3);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 10 * 1000ul);
+
+    CHECK_EQUAL(IridiumSession::SESSION_RX_OVERFLOW, session.result().error);
+    CHECK(session.result().moDelivered);
+    CHECK_EQUAL(maxMtMessageSize, session.result().receivedLength);
+}
+
+static void failedAttemptIsRetried() {
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 32, 5, 0, 0, 0, 0\r\n\r\nOK\r\n", 5000, nullptr},
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 1, 6, 0, 0, 0, 0\r\n\r\nOK\r\n", 5000, nullptr}
+    };
+    ScriptedModemPort port(script, 3);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage)));
+    runSession(session, port, 60 * 1000ul);
+
+    const IridiumSession::Result &result = session.result();
+    CHECK_EQUAL(IridiumSession::SESSION_OK, result.error);
+    CHECK(result.moDelivered);
+    CHECK_EQUAL(2, result.attempts);
+    CHECK(result.durationMillis >= IridiumSession::sbdixRetryDelayMillis);
+    CHECK(port.finished());
+}
+
+static void failedAttemptGivesUp() {
+    const Exchange script[] = {
+            writeMessage,
+            {"AT+SBDIX", nullptr, 0, "\r\n+SBDIX: 32, 5, 0, 0, 0, 0\r\n\r\nOK\r\n", 5000, nullptr}
+    };
+    ScriptedModemPort port(script, 2);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SEND_RECEIVE, moMessage, sizeof(moMessage), 1));
+    runSession(session, port, 60 * 1000ul);
+
+    CHECK_EQUAL(IridiumSession::SESSION_SEND_FAILED, session.result().error);
+    CHECK(!session.result().moDelivered);
+    CHECK_EQUAL(32, session.result().moStatus);
+}
+
+static void silentModemTimesOut() {
+    const Exchange script[] = {{"AT+CSQ", nullptr, 0, nullptr, 0, nullptr}};
+    ScriptedModemPort port(script, 1);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SIGNAL_QUALITY));
+    runSession(session, port, 2 * IridiumSession::commandTimeoutMillis);
+
+    CHECK(!session.isBusy());
+    CHECK_EQUAL(IridiumSession::SESSION_TIMEOUT, session.result().error);
+}
+
+static void oneSessionAtATime() {
+    const Exchange script[] = {{"AT+CSQ", nullptr, 0, "\r\n+CSQ:2\r\n\r\nOK\r\n", 50, nullptr}};
+    ScriptedModemPort port(script, 1);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(session.begin(IridiumSession::SIGNAL_QUALITY));
+    CHECK(!session.begin(IridiumSession::SYSTEM_TIME));
+    runSession(session, port, 1000);
+
+    CHECK_EQUAL(IridiumSession::SESSION_OK, session.result().error);
+    CHECK_EQUAL(0, port.mismatches());
+}
+
+static void messageTooLong() {
+    static uint8_t message[IridiumSession::maxMessageSize + 1];
+    ScriptedModemPort port(nullptr, 0);
+    IridiumSession session(port, mtBuffer, sizeof(mtBuffer));
+
+    CHECK(!session.begin(IridiumSession::SEND_RECEIVE, message, sizeof(message)));
+    CHECK(!session.isBusy());
+    CHECK_EQUAL(IridiumSession::SESSION_MESSAGE_TOO_LONG, session.result().error);
+}
+
+int main() {
+    RUN_TEST(signalQuality);
+    RUN_TEST(systemTime);
+    RUN_TEST(systemTimeWithoutNetwork);
+    RUN_TEST(sendWithoutMessageWaiting);
+    RUN_TEST(sendAndReceive);
+    RUN_TEST(failedReadKeepsDelivery);
+    RUN_TEST(largestMessageFits);
+    RUN_TEST(oversizedMessageOverflows);
+    RUN_TEST(failedAttemptIsRetried);
+    RUN_TEST(failedAttemptGivesUp);
+    RUN_TEST(silentModemTimesOut);
+    RUN_TEST(oneSessionAtATime);
+    RUN_TEST(messageTooLong);
+    return TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+/**
+* @File: LatencyProfilerTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of LatencyHistogram and LatencyProfiler: the percentiles against the
+ * exact ones of random runtimes, saturated counts, timing a scope with micros(), the scheduler hook that times every
+ * task and what a report keeps of its period.
+*/
+
+#include "TestSupport.h"
+#include "LatencyProfiler/LatencyProfiler.h"
+#include "AsyncScheduler/DeadlineScheduler.h"
+#include "Log/Log.h"
+#include <Arduino.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * A Print that drops the lines written to it.
+ */
+class NullPrint : public Print {
+
+public:
+    size_t println(const char *text) override {
+        return strlen(text) + 2;
+    }
+};
+
+static void percentilesBoundTheExactRank() {
+    //the percentile is the limit of the bucket of the exact rank, at most a half above it
+    srand(1);
+    for (int trial = 0; trial < 200; trial++) {
+        LatencyHistogram histogram;
+        std::vector<uint32_t> runtimes;
+        int count = 1 + rand() % 5000;
+        for (int i = 0; i < count; i++) {
+            uint32_t runtime = (uint32_t) (rand() % 3 == 0 ? rand() % 100000 : rand() % 300);
+            runtimes.push_back(runtime);
+            histogram.record(runtime);
+        }
+        std::sort(runtimes.begin(), runtimes.end());
+
+        static const uint8_t percents[] = {50, 99};
+        for (uint8_t percent : percents) {
+            uint32_t exact = runtimes[(size_t) (((uint64_t) count * percent + 99) / 100) - 1];
+            uint32_t estimate = histogram.percentile(percent);
+            CHECK(estimate >= exact && estimate <= exact + exact / 2 + 1);
+        }
+        CHECK_EQUAL(runtimes.front(), histogram.min());
+        CHECK_EQUAL(runtimes.back(), histogram.max());
+        CHECK_EQUAL(count, histogram.count());
+    }
+}
+
+static void smallRuntimesAreExact() {
+    for (uint32_t runtime = 0; runtime < 4; runtime++) {
+        LatencyHistogram histogram;
+        histogram.record(runtime);
+        CHECK_EQUAL(runtime, histogram.percentile(50));
+    }
+
+    //a single run is reported as itself, the bucket limit is clamped to the longest run
+    for (uint32_t runtime = 4; runtime < (1u << 20); runtime += 7) {
+        LatencyHistogram histogram;
+        histogram.record(runtime);
+        CHECK_EQUAL(runtime, histogram.percentile(99));
+    }
+
+    LatencyHistogram longest;
+    longest.record(0xFFFFFFFFu);
+    CHECK_EQUAL(0xFFFFFFFFu, longest.percentile(50));
+
+    LatencyHistogram empty;
+    CHECK_EQUAL(0, empty.percentile(50));
+    CHECK_EQUAL(0, empty.min());
+    CHECK_EQUAL(0, empty.count());
+}
+
+static void saturationKeepsTheShape() {
+    //more runs than a bucket counts halves every bucket, the percentiles stay where they were
+    LatencyHistogram histogram;
+    for (int i = 0; i < 200000; i++) {
+        histogram.record(i % 100 == 0 ? 5000 : 10);
+    }
+    CHECK_EQUAL(11, histogram.percentile(50));
+    CHECK_EQUAL(11, histogram.percentile(99));
+    CHECK_EQUAL(5000, histogram.max());
+    CHECK_EQUAL(200000, histogram.count());
+
+    //and still follow a change
+    for (int i = 0; i < 200000; i++) {
+        histogram.record(i % 50 == 0 ? 5000 : 10);
+    }
+    CHECK(histogram.percentile(99) >= 4096);
+}
+
+static void scopeTimesWithMicros() {
+    LatencyProfiler profiler;
+    {
+        LatencyProfiler::Scope timed(profiler, LatencyProfiler::SESSION_STEP);
+        HostArduino::advanceMicros(250);
+    }
+    const LatencyHistogram &histogram = profiler.histogram(LatencyProfiler::SESSION_STEP);
+    CHECK_EQUAL(1, histogram.count());
+    CHECK_EQUAL(250, histogram.max());
+}
+
+//The clock of the scheduler hook and what it saw.
+static unsigned long schedulerMicros = 0;
+static int observedTask = -1;
+static unsigned long observedMicros = 0;
+
+static unsigned long schedulerClock() {
+    return schedulerMicros;
+}
+
+static void schedulerTimesEveryTask() {
+    DeadlineScheduler<4> scheduler;
+    int slow = scheduler.add([]() { schedulerMicros += 1234; }, 10, DeadlineScheduler<4>::PRIORITY_LOW, 0);
+    scheduler.observeRuns(schedulerClock, [](uint8_t id, unsigned long elapsed) {
+        observedTask = id;
+        observedMicros = elapsed;
+    });
+    scheduler.runDue(10);
+    CHECK_EQUAL(slow, observedTask);
+    CHECK_EQUAL(1234, observedMicros);
+
+    //nullptr stops timing
+    observedTask = -1;
+    scheduler.observeRuns(nullptr, nullptr);
+    scheduler.runDue(20);
+    CHECK_EQUAL(-1, observedTask);
+}
+
+static void reportStartsANewPeriod() {
+    LatencyProfiler profiler;
+    profiler.nameTask(0, "upload");
+    CHECK(strcmp(profiler.name(LatencyProfiler::TASK_FIRST), "upload") == 0);
+
+    profiler.recordTask(0, 900000);
+    profiler.record(LatencyProfiler::LOOP, 950000);
+    profiler.record(LatencyProfiler::SESSION_STEP, 40);
+    profiler.report();
+    NullPrint out;
+    logRing.flush(out, 100000);
+
+    //the worst run and the loop p99 of the period are kept, the histograms start again; the loop contains every
+    // other probe, so it is not the worst
+    CHECK_EQUAL(LatencyProfiler::TASK_FIRST, profiler.worstProbe());
+    CHECK_EQUAL(900000, profiler.worstMicros());
+    CHECK_EQUAL(950000, profiler.loopP99Micros());
+    CHECK_EQUAL(0, profiler.histogram(LatencyProfiler::LOOP).count());
+    CHECK_EQUAL(0, profiler.histogram(LatencyProfiler::TASK_FIRST).count());
+
+    profiler.report();
+    CHECK_EQUAL(0, profiler.worstMicros());
+}
+
+int main() {
+    RUN_TEST(percentilesBoundTheExactRank);
+    RUN_TEST(smallRuntimesAreExact);
+    RUN_TEST(saturationKeepsTheShape);
+    RUN_TEST(scopeTimesWithMicros);
+    RUN_TEST(schedulerTimesEveryTask);
+    RUN_TEST(reportStartsANewPeriod);
+    return TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+/**
+* @File: MavlinkFramerBenchmark.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host benchmark of the MavlinkFramer class. It builds 40 seconds of an
+ * ArduPilot-like stream of 22 message types, of which the Blackbox subscribes to 5, and times two ways of getting the
+ * subscribed frames out of it: mavlink_parse_char on every byte, as before the framer, and the framer fast-forwarding
+ * past skipped frames as drainRxRing does with the receive ring. Both must deliver the same frames.
+*/
+
+#include "MavlinkFramer/MavlinkFramer.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER 1
+#endif
+
+/**
+ * A message of the stream and how often it is sent.
+ */
+struct StreamMessage {
+    uint32_t messageId;
+    //per second, a divisor of 10
+    uint8_t rate;
+};
+
+static const StreamMessage streamMix[] = {
+        {0, 1}, {1, 2}, {2, 1}, {24, 5}, {27, 10}, {29, 5}, {30, 10}, {32, 5}, {33, 5}, {35, 2}, {36, 2},
+        {42, 1}, {62, 5}, {65, 2}, {74, 5}, {87, 10}, {111, 10}, {116, 10}, {125, 1}, {136, 1}, {147, 1}, {241, 1}
+};
+
+//The messages the framer is subscribed to.
+static const uint32_t subscribed[] = {
+        MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_SYSTEM_TIME, MAVLINK_MSG_ID_ATTITUDE,
+        MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_COMMAND_ACK
+};
+
+static const int streamSeconds = 40;
+static const int repetitions = 200;
+
+/**
+ * Whether a message is one of the subscribed ones.
+ * @param messageId - the ID of the message.
+ * @return bool - true if subscribed.
+ */
+static bool isWanted(uint32_t messageId) {
+    for (size_t i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++) {
+        if (subscribed[i] == messageId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Append a frame of a message with a varying payload to the stream.
+ * @param messageId - the ID of the message.
+ * @param stream - the stream.
+ */
+static void appendFrame(uint32_t messageId, std::vector<uint8_t> &stream) {
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(messageId);
+    if (entry == nullptr) {
+        return;
+    }
+    mavlink_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msgid = messageId;
+    uint8_t *payload = (uint8_t *) _MAV_PAYLOAD_NON_CONST(&msg);
+    for (uint8_t i = 0; i < entry->max_msg_len; i++) {
+        payload[i] = (uint8_t) (1 + (i * 37 + messageId + stream.size()) % 250);
+    }
+    mavlink_finalize_message_chan(&msg, 1, 1, MAVLINK_COMM_2, entry->min_msg_len, entry->max_msg_len,
+                                  entry->crc_extra);
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    uint16_t length = mavlink_msg_to_send_buffer(frame, &msg);
+    stream.insert(stream.end(), frame, frame + length);
+}
+
+/**
+ * The cycle counter, 0 where there is none.
+ * @return uint64_t - the cycles.
+ */
+static uint64_t cycles() {
+#ifdef HAVE_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Print the cost of a path.
+ * @param name - the name of the path.
+ * @param nanos - the time it took.
+ * @param cycleCount - the cycles it took.
+ * @param bytes - the number of bytes it handled.
+ */
+static void printResult(const char *name, double nanos, uint64_t cycleCount, double bytes) {
+    printf("%-13s %.2f ns/byte, %.1f cycles/byte, %.0f MB/s\n", name, nanos / bytes, (double) cycleCount / bytes,
+           bytes / nanos * 1000.0);
+}
+
+int main() {
+    std::vector<uint8_t> stream;
+    for (int tick = 0; tick < streamSeconds * 10; tick++) {
+        for (size_t i = 0; i < sizeof(streamMix) / sizeof(streamMix[0]); i++) {
+            if (tick % (10 / streamMix[i].rate) == 0) {
+                appendFrame(streamMix[i].messageId, stream);
+            }
+        }
+    }
+    double bytes = (double) stream.size() * repetitions;
+    mavlink_message_t msg;
+
+    //every byte through the MAVLink parser
+    mavlink_status_t status;
+    long parsedFrames = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t startCycles = cycles();
+    for (int r = 0; r < repetitions; r++) {
+        for (size_t i = 0; i < stream.size(); i++) {
+            if (mavlink_parse_char(MAVLINK_COMM_0, stream[i], &msg, &status) && isWanted(msg.msgid)) {
+                parsedFrames++;
+            }
+        }
+    }
+    uint64_t parserCycles = cycles() - startCycles;
+    double parserNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    //the framer, fast-forwarding past skipped frames
+    MavlinkFramer framer(MAVLINK_COMM_1);
+    for (size_t i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++) {
+        framer.subscribe(subscribed[i]);
+    }
+    long framedFrames = 0;
+    start = std::chrono::steady_clock::now();
+    startCycles = cycles();
+    for (int r = 0; r < repetitions; r++) {
+        for (size_t i = 0; i < stream.size(); i++) {
+            MavlinkFramer::Result result = framer.feed(stream[i], msg);
+            if (result == MavlinkFramer::FRAME) {
+                framedFrames++;
+            } else if (result == MavlinkFramer::SKIPPED) {
+                uint16_t skip = framer.pendingSkip();
+                framer.skipped(skip);
+                i += skip;
+            }
+        }
+    }
+    uint64_t framerCycles = cycles() - startCycles;
+    double framerNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("stream: %lu bytes, %d repetitions, %ld subscribed frames parsed, %ld framed\n",
+           (unsigned long) stream.size(), repetitions, parsedFrames, framedFrames);
+    printResult("parse_char:", parserNanos, parserCycles, bytes);
+    printResult("framer:", framerNanos, framerCycles, bytes);
+    return parsedFrames == framedFrames ? 0 : 1;
+}
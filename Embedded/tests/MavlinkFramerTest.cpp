@@ -0,0 +1,215 @@
+/**
+* @File: MavlinkFramerTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the MavlinkFramer class against the MAVLink library: subscribed
+ * frames reach the parser intact, every other frame is reported by its header and skipped, whether its bytes are
+ * fed or fast-forwarded, and a corrupted length byte costs at most the frame that follows it.
+*/
+
+#include "TestSupport.h"
+#include "MavlinkFramer/MavlinkFramer.h"
+
+//The channel frames are packed on, MAVLink v2.
+static const uint8_t packChannel = MAVLINK_COMM_2;
+
+//The channel frames are packed on, MAVLink v1.
+static const uint8_t packChannelV1 = MAVLINK_COMM_3;
+
+//The messages the framer is subscribed to.
+static const uint32_t subscribed[] = {
+        MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_SYSTEM_TIME, MAVLINK_MSG_ID_ATTITUDE,
+        MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_COMMAND_ACK
+};
+
+//A stream as the Pixhawk sends it, subscribed and other messages interleaved.
+static const uint32_t streamIds[] = {0, 1, 30, 24, 33, 74, 42, 2, 62, 36, 30, 65, 33, 125, 147, 0, 241};
+
+static const size_t streamCount = sizeof(streamIds) / sizeof(streamIds[0]);
+
+/**
+ * Pack a message with a payload of bytes from 1 to 250, which MAVLink v2 does not trim and which are never taken for
+ * a start marker.
+ * @param messageId - the ID of the message, known to the MAVLink library.
+ * @param channel - the channel to pack on, packChannelV1 for MAVLink v1.
+ * @param msg - set to the packed message.
+ * @param frame - filled with the frame, MAVLINK_MAX_PACKET_LEN bytes.
+ * @return size_t - the length of the frame.
+ */
+static size_t packFrame(uint32_t messageId, uint8_t channel, mavlink_message_t &msg, uint8_t *frame) {
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(messageId);
+    memset(&msg, 0, sizeof(msg));
+    msg.msgid = messageId;
+    uint8_t *payload = (uint8_t *) _MAV_PAYLOAD_NON_CONST(&msg);
+    for (uint8_t i = 0; i < entry->max_msg_len; i++) {
+        payload[i] = (uint8_t) (1 + (i * 7 + messageId) % 250);
+    }
+    mavlink_finalize_message_chan(&msg, 1, 1, channel, entry->min_msg_len, entry->max_msg_len, entry->crc_extra);
+    return mavlink_msg_to_send_buffer(frame, &msg);
+}
+
+/**
+ * Whether a message is one of the subscribed ones.
+ * @param messageId - the ID of the message.
+ * @return bool - true if subscribed.
+ */
+static bool isWanted(uint32_t messageId) {
+    for (size_t i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++) {
+        if (subscribed[i] == messageId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * A framer subscribed to the subscribed messages.
+ * @param framer - the framer.
+ */
+static void subscribeAll(MavlinkFramer &framer) {
+    for (size_t i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++) {
+        framer.subscribe(subscribed[i]);
+    }
+}
+
+/**
+ * Feed the stream to a framer and check that it parses every subscribed frame and skips every other one.
+ * @param fastForward - whether the bytes of skipped frames are thrown away as drainRxRing does, rather than fed.
+ */
+static void checkStream(bool fastForward) {
+    static uint8_t stream[streamCount * MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t packed[streamCount];
+    size_t length = 0;
+    for (size_t i = 0; i < streamCount; i++) {
+        length += packFrame(streamIds[i], packChannel, packed[i], stream + length);
+    }
+
+    MavlinkFramer framer(MAVLINK_COMM_1);
+    subscribeAll(framer);
+
+    size_t next = 0;
+    size_t skippedBytes = 0;
+    mavlink_message_t msg;
+    for (size_t position = 0; position < length; position++) {
+        MavlinkFramer::Result result = framer.feed(stream[position], msg);
+        if (result == MavlinkFramer::NONE) {
+            continue;
+        }
+        if (next >= streamCount) {
+            CHECK(false);
+            break;
+        }
+
+        uint32_t expected = streamIds[next];
+        CHECK_EQUAL(expected, framer.header().messageId);
+        CHECK_EQUAL(packed[next].len, framer.header().payloadLength);
+        if (result == MavlinkFramer::FRAME) {
+            CHECK(isWanted(expected));
+            CHECK_EQUAL(expected, msg.msgid);
+            CHECK_EQUAL(packed[next].len, msg.len);
+            CHECK(memcmp(_MAV_PAYLOAD(&msg), _MAV_PAYLOAD(&packed[next]), msg.len) == 0);
+        } else {
+            CHECK(!isWanted(expected));
+            if (fastForward) {
+                uint16_t skip = framer.pendingSkip();
+                framer.skipped(skip);
+                position += skip;
+            }
+            skippedBytes += MAVLINK_CORE_HEADER_LEN + 1 + packed[next].len + MAVLINK_NUM_CHECKSUM_BYTES;
+        }
+        next++;
+    }
+
+    CHECK_EQUAL(streamCount, next);
+    CHECK_EQUAL(skippedBytes, framer.skippedBytes());
+}
+
+static void parsesSubscribedFrames() {
+    checkStream(false);
+}
+
+static void fastForwardsSkippedFrames() {
+    checkStream(true);
+}
+
+static void readsMavlinkV1Headers() {
+    mavlink_get_channel_status(packChannelV1)->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    uint8_t frame[2 * MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t skipped;
+    mavlink_message_t wanted;
+    size_t length = packFrame(MAVLINK_MSG_ID_VFR_HUD, packChannelV1, skipped, frame);
+    length += packFrame(MAVLINK_MSG_ID_ATTITUDE, packChannelV1, wanted, frame + length);
+    CHECK_EQUAL(MAVLINK_STX_MAVLINK1, frame[0]);
+
+    MavlinkFramer framer(MAVLINK_COMM_1);
+    subscribeAll(framer);
+    mavlink_message_t msg;
+    int frames = 0;
+    int skips = 0;
+    for (size_t i = 0; i < length; i++) {
+        MavlinkFramer::Result result = framer.feed(frame[i], msg);
+        if (result == MavlinkFramer::SKIPPED) {
+            skips++;
+            CHECK_EQUAL(MAVLINK_MSG_ID_VFR_HUD, framer.header().messageId);
+            CHECK_EQUAL(skipped.len + MAVLINK_NUM_CHECKSUM_BYTES, framer.pendingSkip());
+        } else if (result == MavlinkFramer::FRAME) {
+            frames++;
+            CHECK_EQUAL(MAVLINK_MSG_ID_ATTITUDE, msg.msgid);
+        }
+    }
+    CHECK_EQUAL(1, skips);
+    CHECK_EQUAL(1, frames);
+}
+
+static void recoversFromCorruptLength() {
+    uint8_t stream[3 * MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t msg;
+    size_t length = packFrame(MAVLINK_MSG_ID_VFR_HUD, packChannel, msg, stream);
+    length += packFrame(MAVLINK_MSG_ID_ATTITUDE, packChannel, msg, stream + length);
+    size_t third = length;
+    length += packFrame(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, packChannel, msg, stream + length);
+
+    //the skipped frame claims to be a few bytes longer, which swallows the start of the next one
+    stream[1] += 4;
+
+    MavlinkFramer framer(MAVLINK_COMM_1);
+    subscribeAll(framer);
+    int frames = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (framer.feed(stream[i], msg) == MavlinkFramer::FRAME) {
+            frames++;
+            CHECK_EQUAL(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, msg.msgid);
+        }
+    }
+
+    //the payloads hold no start marker, only the CRC of the swallowed frame could be taken for one
+    bool falseStart = false;
+    for (size_t i = third - 2; i < third; i++) {
+        falseStart |= stream[i] == MAVLINK_STX || stream[i] == MAVLINK_STX_MAVLINK1;
+    }
+    CHECK(frames <= 1);
+    if (!falseStart) {
+        CHECK_EQUAL(1, frames);
+    }
+}
+
+static void subscriptions() {
+    MavlinkFramer framer;
+    CHECK(!framer.isSubscribed(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(framer.subscribe(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(framer.isSubscribed(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(!framer.isSubscribed(MAVLINK_MSG_ID_ATTITUDE + 1));
+    framer.unsubscribe(MAVLINK_MSG_ID_ATTITUDE);
+    CHECK(!framer.isSubscribed(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(framer.subscribe(MavlinkFramer::maxSubscribedId));
+    CHECK(!framer.subscribe(MavlinkFramer::maxSubscribedId + 1));
+}
+
+int main() {
+    RUN_TEST(parsesSubscribedFrames);
+    RUN_TEST(fastForwardsSkippedFrames);
+    RUN_TEST(readsMavlinkV1Headers);
+    RUN_TEST(recoversFromCorruptLength);
+    RUN_TEST(subscriptions);
+    return TEST_RESULT();
+}
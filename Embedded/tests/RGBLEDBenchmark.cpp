@@ -0,0 +1,40 @@
+/**
+* @File: RGBLEDBenchmark.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host benchmark of the RGBLED pattern engine. It calls asyncRun() in a loop with
+ * the simulated clock advancing 1 ms every 16 calls and the state cycling through every pattern, and reports the cost
+ * of a call and how often the pins are written per simulated second.
+*/
+
+#include "DiagnosticTools/RGBLED.h"
+#include <stdio.h>
+#include <chrono>
+
+static const unsigned long calls = 50000000ul;
+
+//The calls per simulated millisecond.
+static const unsigned long callsPerMilli = 16;
+
+int main() {
+    RGBLED led(7, 8, 9, RGBLED::IN_FLIGHT);
+    uint32_t writesBefore = HostArduino::analogWriteCount();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < calls; i++) {
+        if (i % callsPerMilli == 0) {
+            HostArduino::advanceMillis(1);
+        }
+        if ((i & 0xFFFFF) == 0) {
+            led.setState((RGBLED::States) ((i >> 20) % RGBLED::STATE_COUNT));
+        }
+        led.asyncRun();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t writes = HostArduino::analogWriteCount() - writesBefore;
+    double simulatedSeconds = (double) calls / callsPerMilli / 1000.0;
+    printf("asyncRun: %.1f Mcalls/s, %.2f ns/call, %.1f analogWrite per simulated second\n",
+           calls / seconds / 1e6, seconds * 1e9 / calls, writes / simulatedSeconds);
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+* @File: RGBLEDTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the RGBLED pattern engine: the timing of the steps, what a change
+ * of state does, states shown for a while, catching up after a gap and that only a change of color reaches the pins.
+*/
+
+#include "TestSupport.h"
+#include "DiagnosticTools/RGBLED.h"
+#include <limits.h>
+
+static const int redPin = 7;
+static const int greenPin = 8;
+static const int bluePin = 9;
+
+/**
+ * The length of one run through the pattern of a state.
+ * @param state - the state.
+ * @return unsigned long - the length in milliseconds.
+ */
+static unsigned long cycleMillis(RGBLED::States state) {
+    const RGBLED::Pattern &pattern = RGBLED::patternOf(state);
+    unsigned long total = 0;
+    for (uint8_t i = 0; i < pattern.stepCount; i++) {
+        total += pattern.steps[i].durationMillis;
+    }
+    return total;
+}
+
+/**
+ * Whether the pins show a color.
+ * @param red - the red value.
+ * @param green - the green value.
+ * @param blue - the blue value.
+ * @return bool - true if they do.
+ */
+static bool shows(int red, int green, int blue) {
+    return HostArduino::analogValue(redPin) == red && HostArduino::analogValue(greenPin) == green
+           && HostArduino::analogValue(bluePin) == blue;
+}
+
+static void firstRunWritesEveryChannel() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::IN_FLIGHT);
+    uint32_t writes = HostArduino::analogWriteCount();
+
+    CHECK_EQUAL(850, led.asyncRun());
+    CHECK_EQUAL(3, HostArduino::analogWriteCount() - writes);
+    CHECK(shows(0, 0, 255));
+}
+
+static void stepsFollowThePattern() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::IN_FLIGHT);
+    led.asyncRun();
+    uint32_t writes = HostArduino::analogWriteCount();
+
+    HostArduino::advanceMillis(849);
+    CHECK_EQUAL(1, led.asyncRun());
+    CHECK_EQUAL(0, HostArduino::analogWriteCount() - writes);
+
+    //blue to white only changes red and green
+    HostArduino::advanceMillis(1);
+    CHECK_EQUAL(150, led.asyncRun());
+    CHECK_EQUAL(2, HostArduino::analogWriteCount() - writes);
+    CHECK(shows(255, 255, 255));
+
+    HostArduino::advanceMillis(150);
+    CHECK_EQUAL(850, led.asyncRun());
+    CHECK(shows(0, 0, 255));
+}
+
+static void stateChanges() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::IN_FLIGHT);
+    led.asyncRun();
+    HostArduino::advanceMillis(300);
+
+    //the same state leaves the pattern running
+    led.setState(RGBLED::IN_FLIGHT);
+    CHECK_EQUAL(550, led.asyncRun());
+
+    //a new state starts its pattern from the first step
+    led.setState(RGBLED::WAITING_FOR_GPS_LOCK);
+    CHECK_EQUAL(RGBLED::WAITING_FOR_GPS_LOCK, led.getState());
+    CHECK_EQUAL(500, led.asyncRun());
+    CHECK(shows(0, 0, 255));
+    HostArduino::advanceMillis(500);
+    CHECK_EQUAL(500, led.asyncRun());
+    CHECK(shows(0, 0, 0));
+}
+
+static void catchesUpAfterGap() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::START_DELAY);
+    led.asyncRun();
+
+    //within the catch-up limit the pattern stays in time, three and a half cycles later it is half way through
+    HostArduino::advanceMillis(3 * cycleMillis(RGBLED::START_DELAY) + 875);
+    CHECK_EQUAL(125, led.asyncRun());
+    CHECK(shows(255, 165, 0));
+
+    //after a longer gap it carries on from now
+    HostArduino::advanceMillis(60 * 1000ul + 10);
+    unsigned long next = led.asyncRun();
+    CHECK(next > 0 && next <= 250);
+}
+
+static void singleStepPatternDoesNotStep() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::STATE_COUNT);
+    CHECK_EQUAL(ULONG_MAX, led.asyncRun());
+    CHECK(shows(0, 0, 0));
+}
+
+static void patternTimings() {
+    CHECK_EQUAL(1500, cycleMillis(RGBLED::START_DELAY));
+    CHECK_EQUAL(1000, cycleMillis(RGBLED::IN_FLIGHT));
+    CHECK_EQUAL(1000, cycleMillis(RGBLED::WAITING_FOR_GPS_LOCK));
+    CHECK_EQUAL(100, cycleMillis(RGBLED::CONFIG_TIMOUT));
+    CHECK_EQUAL(100, cycleMillis(RGBLED::IN_FLIGHT_SBD_FAILED));
+    CHECK_EQUAL(100, cycleMillis(RGBLED::IN_FLIGHT_SBD_SUCCESS));
+    CHECK_EQUAL(100, cycleMillis(RGBLED::NO_GPS_FIX));
+    for (int state = 0; state < RGBLED::STATE_COUNT; state++) {
+        const RGBLED::Pattern &pattern = RGBLED::patternOf((RGBLED::States) state);
+        CHECK(pattern.stepCount >= 2);
+        for (uint8_t i = 0; i < pattern.stepCount; i++) {
+            CHECK(pattern.steps[i].durationMillis > 0);
+        }
+    }
+}
+
+static void showForOverlaysTheState() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::IN_FLIGHT);
+    led.asyncRun();
+    HostArduino::advanceMillis(300);
+
+    //the shown state starts straight away and the next run is due at its next step
+    led.showFor(RGBLED::IN_FLIGHT_SBD_SUCCESS, 5000);
+    CHECK_EQUAL(RGBLED::IN_FLIGHT, led.getState());
+    CHECK_EQUAL(50, led.asyncRun());
+    CHECK(shows(0, 255, 0));
+
+    //a state set meanwhile neither ends nor restarts it
+    HostArduino::advanceMillis(4975);
+    led.setState(RGBLED::IN_FLIGHT_NO_UPLOAD);
+    CHECK_EQUAL(RGBLED::IN_FLIGHT_NO_UPLOAD, led.getState());
+    CHECK_EQUAL(25, led.asyncRun());
+    CHECK(shows(0, 0, 0));
+
+    //once its time is over the current state starts from the first step
+    HostArduino::advanceMillis(25);
+    CHECK_EQUAL(850, led.asyncRun());
+    CHECK(shows(0, 0, 255));
+}
+
+static void showForEndsBeforeTheNextStep() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::WAITING_FOR_GPS_LOCK);
+    led.asyncRun();
+
+    //the run is due when the shown state ends, even in the middle of one of its steps
+    led.showFor(RGBLED::NO_GPS_FIX, 1020);
+    HostArduino::advanceMillis(1000);
+    CHECK_EQUAL(20, led.asyncRun());
+    CHECK(shows(255, 255, 0));
+    HostArduino::advanceMillis(20);
+    CHECK_EQUAL(500, led.asyncRun());
+    CHECK(shows(0, 0, 255));
+
+    //over a single step pattern it is the only run due
+    RGBLED off(redPin, greenPin, bluePin, RGBLED::STATE_COUNT);
+    off.asyncRun();
+    off.showFor(RGBLED::START_DELAY, 100);
+    CHECK_EQUAL(100, off.asyncRun());
+    HostArduino::advanceMillis(100);
+    CHECK_EQUAL(ULONG_MAX, off.asyncRun());
+    CHECK(shows(0, 0, 0));
+}
+
+static void delaySleeps() {
+    RGBLED led(redPin, greenPin, bluePin, RGBLED::IN_FLIGHT);
+    unsigned long start = millis();
+    led.asyncLEDDelay(1000);
+    CHECK_EQUAL(1000, millis() - start);
+}
+
+int main() {
+    RUN_TEST(firstRunWritesEveryChannel);
+    RUN_TEST(stepsFollowThePattern);
+    RUN_TEST(stateChanges);
+    RUN_TEST(catchesUpAfterGap);
+    RUN_TEST(singleStepPatternDoesNotStep);
+    RUN_TEST(patternTimings);
+    RUN_TEST(showForOverlaysTheState);
+    RUN_TEST(showForEndsBeforeTheNextStep);
+    RUN_TEST(delaySleeps);
+    return TEST_RESULT();
+}
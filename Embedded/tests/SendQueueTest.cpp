@@ -0,0 +1,305 @@
+/**
+* @File: SendQueueTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of SendQueue: routine records superseded within minSpacingMillis,
+ * records in flight kept from being superseded, expired or evicted, which record makes room in a full queue, the
+ * eviction handler spooling records to a FlashBacklog on RamFlash and deadlines across the wraparound of millis().
+*/
+
+#include "TestSupport.h"
+#include "Iridium9602N/SendQueue.h"
+#include "FlashStore/FlashBacklog.h"
+#include "FlashStore/RamFlash.h"
+#include <limits.h>
+
+using namespace TelemetryCodec;
+
+//The history spacing of the tests, a minute as in Iridium9602N.
+static const unsigned long spacingMillis = 60 * 1000ul;
+
+//A lifetime that does not run out during a test.
+static const unsigned long longLifetime = 3600 * 1000ul;
+
+/**
+ * A sample that carries its number in the time field.
+ * @param number - the number.
+ * @return TelemetrySample - the sample.
+ */
+static TelemetrySample numbered(int64_t number) {
+    TelemetrySample sample;
+    sample.fields[UNIX_TIME_MILLIS] = number;
+    return sample;
+}
+
+/**
+ * The number of a record.
+ * @param queue - the queue.
+ * @param index - the index of the record.
+ * @return int64_t - the number of its sample.
+ */
+static int64_t numberAt(const SendQueue &queue, size_t index) {
+    return queue.at(index).sample.fields[UNIX_TIME_MILLIS];
+}
+
+//The numbers of the records handed to countEvicted.
+static int64_t evicted[32];
+static size_t evictedCount = 0;
+
+static void countEvicted(const SendQueue::Record &record, void *context) {
+    (void) context;
+    evicted[evictedCount++ % 32] = record.sample.fields[UNIX_TIME_MILLIS];
+}
+
+/**
+ * Fill a queue with routine records a spacing apart, numbered from 1.
+ * @param queue - the queue.
+ * @return unsigned long - the time the last record was queued.
+ */
+static unsigned long fillRoutine(SendQueue &queue) {
+    unsigned long now = 0;
+    for (int i = 1; i <= SendQueue::capacity; i++) {
+        now = (unsigned long) i * spacingMillis;
+        CHECK(queue.push(numbered(i), SendQueue::ROUTINE, now, longLifetime));
+    }
+    return now;
+}
+
+static void routineFixesAreSuperseded() {
+    SendQueue queue(spacingMillis);
+    queue.setEvictionHandler(countEvicted, nullptr);
+    evictedCount = 0;
+
+    //the second fix is the head of the history, the third replaces it while it is less than a spacing after the first
+    queue.push(numbered(1), SendQueue::ROUTINE, 0, longLifetime);
+    queue.push(numbered(2), SendQueue::ROUTINE, 10000, longLifetime);
+    queue.push(numbered(3), SendQueue::ROUTINE, 20000, longLifetime);
+    CHECK_EQUAL(2, queue.size());
+    CHECK_EQUAL(3, numberAt(queue, 1));
+    queue.push(numbered(4), SendQueue::ROUTINE, 59999, longLifetime);
+    CHECK_EQUAL(2, queue.size());
+    CHECK_EQUAL(4, numberAt(queue, 1));
+
+    //a head a full spacing after the record before it stays
+    queue.push(numbered(5), SendQueue::ROUTINE, 60000, longLifetime);
+    CHECK_EQUAL(2, queue.size());
+    queue.push(numbered(6), SendQueue::ROUTINE, 61000, longLifetime);
+    CHECK_EQUAL(3, queue.size());
+    CHECK_EQUAL(5, numberAt(queue, 1));
+
+    //critical records are never superseded and do not break up the routine history
+    queue.push(numbered(7), SendQueue::CRITICAL, 62000, longLifetime);
+    queue.push(numbered(8), SendQueue::ROUTINE, 63000, longLifetime);
+    CHECK_EQUAL(4, queue.size());
+    CHECK_EQUAL(7, numberAt(queue, 2));
+    CHECK_EQUAL(8, numberAt(queue, 3));
+
+    //superseded records count as dropped but are not evicted
+    CHECK_EQUAL(4, queue.droppedCount());
+    CHECK_EQUAL(0, evictedCount);
+}
+
+static void inFlightRecordsAreKept() {
+    SendQueue queue(spacingMillis);
+    queue.setEvictionHandler(countEvicted, nullptr);
+    evictedCount = 0;
+
+    //not superseded
+    queue.push(numbered(1), SendQueue::ROUTINE, 0, 30000);
+    queue.push(numbered(2), SendQueue::ROUTINE, 10000, 30000);
+    queue.markInFlight(1);
+    queue.push(numbered(3), SendQueue::ROUTINE, 20000, 30000);
+    CHECK_EQUAL(3, queue.size());
+
+    //not expired, only the record that is not in flight is
+    queue.markInFlight(0);
+    CHECK_EQUAL(0, queue.dropExpired(45000));
+    CHECK_EQUAL(1, queue.dropExpired(50001));
+    CHECK_EQUAL(2, queue.size());
+    CHECK_EQUAL(3, evicted[0]);
+
+    //and not ranked
+    uint8_t order[SendQueue::capacity];
+    CHECK_EQUAL(0, queue.rank(order, sizeof(order)));
+
+    //a failed session returns them, now they can expire
+    CHECK_EQUAL(2, queue.completeInFlight(false));
+    CHECK_EQUAL(1, queue.at(0).attempts);
+    CHECK_EQUAL(2, queue.dropExpired(50001));
+    CHECK_EQUAL(0, queue.size());
+
+    //not evicted: a full queue in flight turns new records away
+    SendQueue full(spacingMillis);
+    full.setEvictionHandler(countEvicted, nullptr);
+    unsigned long now = fillRoutine(full);
+    for (size_t i = 0; i < full.size(); i++) {
+        full.markInFlight(i);
+    }
+    evictedCount = 0;
+    CHECK(!full.push(numbered(100), SendQueue::CRITICAL, now + spacingMillis, longLifetime));
+    CHECK_EQUAL(SendQueue::capacity, full.size());
+    CHECK_EQUAL(1, evictedCount);
+    CHECK_EQUAL(100, evicted[0]);
+
+    //a delivered session removes them without evicting them
+    CHECK_EQUAL(SendQueue::capacity, full.completeInFlight(true));
+    CHECK_EQUAL(0, full.size());
+    CHECK_EQUAL(1, evictedCount);
+}
+
+static void routineRecordsMakeRoom() {
+    SendQueue queue(spacingMillis);
+    queue.setEvictionHandler(countEvicted, nullptr);
+    evictedCount = 0;
+
+    //a critical record among routine ones: a new critical record evicts the oldest routine record, not it
+    queue.push(numbered(0), SendQueue::CRITICAL, 0, longLifetime);
+    for (int i = 1; i < SendQueue::capacity; i++) {
+        queue.push(numbered(i), SendQueue::ROUTINE, (unsigned long) i * spacingMillis, longLifetime);
+    }
+    CHECK(queue.push(numbered(100), SendQueue::CRITICAL, 20 * spacingMillis, longLifetime));
+    CHECK_EQUAL(1, evicted[0]);
+    CHECK_EQUAL(0, numberAt(queue, 0));
+
+    //so does a routine record, the in flight one is skipped
+    queue.markInFlight(1);
+    CHECK(queue.push(numbered(101), SendQueue::ROUTINE, 21 * spacingMillis, longLifetime));
+    CHECK_EQUAL(3, evicted[1]);
+    CHECK_EQUAL(SendQueue::capacity, queue.size());
+
+    //expired records go first
+    SendQueue expiring(spacingMillis);
+    expiring.setEvictionHandler(countEvicted, nullptr);
+    expiring.push(numbered(1), SendQueue::ROUTINE, 0, longLifetime);
+    expiring.push(numbered(2), SendQueue::CRITICAL, 0, 1000);
+    for (int i = 3; i <= SendQueue::capacity; i++) {
+        expiring.push(numbered(i), SendQueue::ROUTINE, (unsigned long) i * spacingMillis, longLifetime);
+    }
+    evictedCount = 0;
+    CHECK(expiring.push(numbered(100), SendQueue::ROUTINE, 20 * spacingMillis, longLifetime));
+    CHECK_EQUAL(1, evictedCount);
+    CHECK_EQUAL(2, evicted[0]);
+    CHECK_EQUAL(1, numberAt(expiring, 0));
+}
+
+static void onlyCriticalRecordsEvictCriticalOnes() {
+    SendQueue queue(spacingMillis);
+    queue.setEvictionHandler(countEvicted, nullptr);
+    for (int i = 1; i <= SendQueue::capacity; i++) {
+        queue.push(numbered(i), SendQueue::CRITICAL, (unsigned long) i * spacingMillis, longLifetime);
+    }
+    evictedCount = 0;
+
+    //a routine record does not make room among critical ones, it is evicted itself
+    CHECK(!queue.push(numbered(100), SendQueue::ROUTINE, 20 * spacingMillis, longLifetime));
+    CHECK_EQUAL(100, evicted[0]);
+    CHECK_EQUAL(1, numberAt(queue, 0));
+
+    //a newer critical record takes the place of the oldest critical one
+    CHECK(queue.push(numbered(101), SendQueue::CRITICAL, 21 * spacingMillis, longLifetime));
+    CHECK_EQUAL(1, evicted[1]);
+    CHECK_EQUAL(2, numberAt(queue, 0));
+    CHECK_EQUAL(101, numberAt(queue, SendQueue::capacity - 1));
+    CHECK_EQUAL(2, queue.droppedCount());
+}
+
+static void ranksCriticalThenNewest() {
+    SendQueue queue(spacingMillis);
+    queue.push(numbered(0), SendQueue::ROUTINE, 0, longLifetime);
+    queue.push(numbered(1), SendQueue::CRITICAL, spacingMillis, longLifetime);
+    queue.push(numbered(2), SendQueue::ROUTINE, 2 * spacingMillis, longLifetime);
+    queue.push(numbered(3), SendQueue::CRITICAL, 3 * spacingMillis, longLifetime);
+    queue.push(numbered(4), SendQueue::ROUTINE, 4 * spacingMillis, longLifetime);
+
+    static const uint8_t expected[] = {3, 1, 4, 2, 0};
+    uint8_t order[SendQueue::capacity];
+    CHECK_EQUAL(5, queue.rank(order, sizeof(order)));
+    for (size_t i = 0; i < 5; i++) {
+        CHECK_EQUAL(expected[i], order[i]);
+    }
+    CHECK_EQUAL(2, queue.rank(order, 2));
+}
+
+//The backlog the spooling handler appends to.
+static const size_t flashSize = 8 * 4 * 64;
+static uint8_t memory[flashSize];
+
+/**
+ * The eviction handler of Iridium9602N: the record encoded with every field, tagged with its priority.
+ * @param record - the evicted record.
+ * @param context - the FlashBacklog.
+ */
+static void spoolToBacklog(const SendQueue::Record &record, void *context) {
+    uint8_t encoded[FlashBacklog::maxRecordSize];
+    size_t length = encodeRecord(record.sample, encoded, sizeof(encoded));
+    CHECK(length > 0 && ((FlashBacklog *) context)->append(encoded, length, record.priority));
+}
+
+static void evictedRecordsReachTheBacklog() {
+    RamFlash flash(memory, flashSize);
+    flash.eraseAll();
+    FlashBacklog backlog(flash, FlashBacklog::OLDEST_FIRST, FlashBacklog::OVERWRITE_OLDEST);
+    backlog.begin();
+
+    SendQueue queue(spacingMillis);
+    queue.setEvictionHandler(spoolToBacklog, &backlog);
+    unsigned long now = fillRoutine(queue);
+
+    //a record that makes room, a record turned away and an expired record are spooled, in that order
+    queue.push(numbered(100), SendQueue::CRITICAL, now + spacingMillis, 1000);
+    for (size_t i = 0; i < queue.size(); i++) {
+        queue.markInFlight(i);
+    }
+    queue.push(numbered(101), SendQueue::CRITICAL, now + 2 * spacingMillis, longLifetime);
+    queue.completeInFlight(false);
+    queue.dropExpired(now + 3 * spacingMillis);
+    CHECK_EQUAL(3, backlog.pendingCount());
+
+    static const int64_t numbers[] = {1, 101, 100};
+    static const uint8_t tags[] = {SendQueue::ROUTINE, SendQueue::CRITICAL, SendQueue::CRITICAL};
+    FlashBacklog::RecordRef refs[3];
+    CHECK_EQUAL(3, backlog.select(refs, 3));
+    for (size_t i = 0; i < 3; i++) {
+        uint8_t payload[FlashBacklog::maxRecordSize];
+        uint8_t tag;
+        size_t length = backlog.read(refs[i], payload, sizeof(payload), tag);
+        TelemetrySample sample;
+        CHECK(decodeRecord(payload, length, sample));
+        CHECK_EQUAL(numbers[i], sample.fields[UNIX_TIME_MILLIS]);
+        CHECK_EQUAL(tags[i], tag);
+    }
+    CHECK_EQUAL(0, flash.violations());
+}
+
+static void deadlinesWrapAround() {
+    SendQueue queue(spacingMillis);
+
+    //queued just before millis() wraps, due just after it
+    unsigned long start = ULONG_MAX - 999;
+    queue.push(numbered(1), SendQueue::ROUTINE, start, 5000);
+    CHECK_EQUAL(4000, queue.at(0).deadlineMillis);
+    CHECK_EQUAL(0, queue.dropExpired(ULONG_MAX));
+    CHECK_EQUAL(0, queue.dropExpired(4000));
+    CHECK_EQUAL(1, queue.dropExpired(4001));
+
+    //the spacing of the history is measured across the wrap too
+    queue.push(numbered(2), SendQueue::ROUTINE, start, longLifetime);
+    queue.push(numbered(3), SendQueue::ROUTINE, start + 30000, longLifetime);
+    queue.push(numbered(4), SendQueue::ROUTINE, start + 40000, longLifetime);
+    CHECK_EQUAL(2, queue.size());
+    CHECK_EQUAL(4, numberAt(queue, 1));
+    queue.push(numbered(5), SendQueue::ROUTINE, start + spacingMillis + 40000, longLifetime);
+    queue.push(numbered(6), SendQueue::ROUTINE, start + spacingMillis + 50000, longLifetime);
+    CHECK_EQUAL(3, queue.size());
+}
+
+int main() {
+    RUN_TEST(routineFixesAreSuperseded);
+    RUN_TEST(inFlightRecordsAreKept);
+    RUN_TEST(routineRecordsMakeRoom);
+    RUN_TEST(onlyCriticalRecordsEvictCriticalOnes);
+    RUN_TEST(ranksCriticalThenNewest);
+    RUN_TEST(evictedRecordsReachTheBacklog);
+    RUN_TEST(deadlinesWrapAround);
+    return TEST_RESULT();
+}
@@ -0,0 +1,432 @@
+/**
+* @File: StreamRateManagerTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the StreamRateManager class, fed with messages packed by the
+ * MAVLink library: discovering the autopilot, matching every COMMAND_ACK to the one outstanding request, sending a
+ * request again with the next confirmation number, retrying rejected requests, requesting everything again after the
+ * autopilot went silent, lengthening the drift window of a message that never comes and stopping the messages nobody
+ * asked for until the table is full.
+*/
+
+#include "TestSupport.h"
+#include "StreamRateManager/StreamRateManager.h"
+
+//The MAVLink identity of the satellite link.
+static const uint8_t ownSystem = 42;
+static const uint8_t ownComponent = 191;
+
+//The autopilot.
+static const uint8_t autopilotSystem = 1;
+static const uint8_t autopilotComponent = MAV_COMP_ID_AUTOPILOT1;
+
+//The commands the manager sent, and the time each one was sent at.
+static mavlink_command_long_t sent[64];
+static unsigned long sentMillis[64];
+static size_t sentCount = 0;
+
+//The time the tests are at, for the sender.
+static unsigned long clockMillis = 0;
+
+/**
+ * The sender of the manager: decodes the command and keeps it.
+ * @param msg - the packed command.
+ * @param context - unused.
+ */
+static void capture(const mavlink_message_t &msg, void *context) {
+    (void) context;
+    CHECK_EQUAL(MAVLINK_MSG_ID_COMMAND_LONG, msg.msgid);
+    CHECK_EQUAL(ownSystem, msg.sysid);
+    CHECK_EQUAL(ownComponent, msg.compid);
+    mavlink_msg_command_long_decode(&msg, &sent[sentCount % 64]);
+    sentMillis[sentCount % 64] = clockMillis;
+    sentCount++;
+}
+
+/**
+ * The last command the manager sent.
+ * @return const mavlink_command_long_t& - the command.
+ */
+static const mavlink_command_long_t &lastSent() {
+    return sent[(sentCount - 1) % 64];
+}
+
+/**
+ * Whether the last command requested a message at an interval.
+ * @param messageId - the ID of the message.
+ * @param intervalMillis - the interval, 0 for a stop.
+ * @param confirmation - the confirmation number.
+ * @return bool - true if it did.
+ */
+static bool lastRequested(uint32_t messageId, uint32_t intervalMillis, uint8_t confirmation) {
+    const mavlink_command_long_t &command = lastSent();
+    float intervalMicros = intervalMillis == 0 ? -1.0f : (float) intervalMillis * 1000.0f;
+    bool match = command.command == MAV_CMD_SET_MESSAGE_INTERVAL && command.param1 == (float) messageId
+                 && command.param2 == intervalMicros && command.confirmation == confirmation;
+    if (!match) {
+        printf("  sent message %g at %g us, confirmation %u\n", command.param1, command.param2, command.confirmation);
+    }
+    return match;
+}
+
+/**
+ * A manager that sends to capture, with nothing sent yet.
+ * @param manager - the manager.
+ */
+static void start(StreamRateManager &manager) {
+    manager.setSender(capture, nullptr);
+    sentCount = 0;
+    clockMillis = 0;
+}
+
+/**
+ * Poll a manager at a time.
+ * @param manager - the manager.
+ * @param now - the time.
+ */
+static void pollAt(StreamRateManager &manager, unsigned long now) {
+    clockMillis = now;
+    manager.poll(now);
+}
+
+/**
+ * Hand a HEARTBEAT to a manager.
+ * @param manager - the manager.
+ * @param now - the time it arrives.
+ * @param systemId - the system that sends it.
+ * @param type - the MAV_TYPE of the sender.
+ * @param autopilot - the MAV_AUTOPILOT of the sender.
+ */
+static void heartbeat(StreamRateManager &manager, unsigned long now, uint8_t systemId = autopilotSystem,
+                      uint8_t type = MAV_TYPE_QUADROTOR, uint8_t autopilot = MAV_AUTOPILOT_PX4) {
+    mavlink_message_t msg;
+    mavlink_msg_heartbeat_pack(systemId, autopilotComponent, &msg, type, autopilot, 0, 0, MAV_STATE_ACTIVE);
+    manager.onMessage(msg, now);
+}
+
+/**
+ * Hand a COMMAND_ACK to a manager.
+ * @param manager - the manager.
+ * @param now - the time it arrives.
+ * @param result - the MAV_RESULT.
+ * @param systemId - the system that sends it.
+ * @param command - the command it answers.
+ */
+static void ack(StreamRateManager &manager, unsigned long now, uint8_t result, uint8_t systemId = autopilotSystem,
+                uint16_t command = MAV_CMD_SET_MESSAGE_INTERVAL) {
+    mavlink_message_t msg;
+    mavlink_msg_command_ack_pack(systemId, autopilotComponent, &msg, command, result, 0, 0, ownSystem, ownComponent);
+    manager.onMessage(msg, now);
+}
+
+/**
+ * Hand an ATTITUDE of the autopilot to a manager.
+ * @param manager - the manager.
+ * @param now - the time it arrives.
+ */
+static void attitude(StreamRateManager &manager, unsigned long now) {
+    mavlink_message_t msg;
+    mavlink_msg_attitude_pack(autopilotSystem, autopilotComponent, &msg, (uint32_t) now, 0.1f, 0.2f, 0.3f, 0, 0, 0);
+    manager.onMessage(msg, now);
+}
+
+/**
+ * Run a manager from one time to another, polling it every 100 ms.
+ * @param manager - the manager.
+ * @param from - the first time.
+ * @param to - the time to stop before.
+ * @param attitudeMillis - the interval the autopilot sends ATTITUDE at, 0 for never.
+ */
+static void run(StreamRateManager &manager, unsigned long from, unsigned long to, unsigned long attitudeMillis) {
+    for (unsigned long now = from; now < to; now += 10) {
+        if (attitudeMillis > 0 && (now - from) % attitudeMillis == 0) {
+            attitude(manager, now);
+        }
+        if (now % 100 == 0) {
+            pollAt(manager, now);
+        }
+    }
+}
+
+static void waitsForTheAutopilot() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    CHECK(manager.request(MAVLINK_MSG_ID_ATTITUDE, 100));
+    pollAt(manager, 0);
+    CHECK_EQUAL(0, sentCount);
+
+    //ground stations and invalid autopilots are not the autopilot
+    heartbeat(manager, 10, 255, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID);
+    heartbeat(manager, 20, 2, MAV_TYPE_GENERIC, MAV_AUTOPILOT_INVALID);
+    pollAt(manager, 30);
+    CHECK(!manager.hasTarget());
+    CHECK_EQUAL(0, sentCount);
+
+    heartbeat(manager, 40);
+    CHECK(manager.hasTarget());
+    CHECK_EQUAL(autopilotSystem, manager.targetSystem());
+    CHECK_EQUAL(autopilotComponent, manager.targetComponent());
+    pollAt(manager, 50);
+    CHECK_EQUAL(1, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+    CHECK_EQUAL(autopilotSystem, lastSent().target_system);
+    CHECK_EQUAL(autopilotComponent, lastSent().target_component);
+    CHECK_EQUAL(1, manager.commandCount());
+}
+
+static void acksSettleTheOutstandingRequest() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+    manager.request(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 1000);
+
+    //one request at a time
+    pollAt(manager, 0);
+    pollAt(manager, 100);
+    CHECK_EQUAL(1, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+
+    //answers of another system or to another command are not for it
+    ack(manager, 110, MAV_RESULT_ACCEPTED, 7);
+    ack(manager, 120, MAV_RESULT_ACCEPTED, autopilotSystem, 400);
+    CHECK(!manager.isConfirmed(MAVLINK_MSG_ID_ATTITUDE));
+    pollAt(manager, 200);
+    CHECK_EQUAL(1, sentCount);
+
+    //the autopilot's answer is, and the next request goes out
+    ack(manager, 210, MAV_RESULT_ACCEPTED);
+    CHECK(manager.isConfirmed(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(!manager.isConfirmed(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    pollAt(manager, 300);
+    CHECK_EQUAL(2, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 1000, 0));
+
+    //a new interval while the old one is outstanding is not settled by the answer to the old one
+    manager.request(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 500);
+    ack(manager, 310, MAV_RESULT_ACCEPTED);
+    CHECK(!manager.isConfirmed(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    pollAt(manager, 400);
+    CHECK_EQUAL(3, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 500, 0));
+    ack(manager, 410, MAV_RESULT_ACCEPTED);
+    CHECK(manager.isConfirmed(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+
+    //the same interval again sends nothing, a release sends a stop
+    manager.request(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 500);
+    pollAt(manager, 500);
+    CHECK_EQUAL(3, sentCount);
+    manager.release(MAVLINK_MSG_ID_ATTITUDE);
+    pollAt(manager, 600);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 0, 0));
+}
+
+static void retriesCountConfirmations() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+
+    //without an answer the request goes again every ackTimeoutMillis, with the next confirmation number
+    pollAt(manager, 0);
+    pollAt(manager, 999);
+    CHECK_EQUAL(1, sentCount);
+    pollAt(manager, 1000);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 1));
+    pollAt(manager, 2000);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 2));
+    CHECK_EQUAL(3, sentCount);
+
+    //after maxAttempts it counts as rejected, and is tried again after rejectedRetryMillis
+    pollAt(manager, 3000);
+    CHECK_EQUAL(3, sentCount);
+    pollAt(manager, 3000 + StreamRateManager::rejectedRetryMillis - 1);
+    CHECK_EQUAL(3, sentCount);
+    pollAt(manager, 3000 + StreamRateManager::rejectedRetryMillis);
+    CHECK_EQUAL(4, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+
+    //an answer that asks to wait keeps the request outstanding until its timeout
+    unsigned long retried = 3000 + StreamRateManager::rejectedRetryMillis;
+    ack(manager, retried + 500, MAV_RESULT_TEMPORARILY_REJECTED);
+    ack(manager, retried + 600, MAV_RESULT_IN_PROGRESS);
+    pollAt(manager, retried + 999);
+    CHECK_EQUAL(4, sentCount);
+    pollAt(manager, retried + 1000);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 1));
+    ack(manager, retried + 1100, MAV_RESULT_ACCEPTED);
+    CHECK(manager.isConfirmed(MAVLINK_MSG_ID_ATTITUDE));
+}
+
+static void rejectedRequestsAreRetriedOrForgotten() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    attitude(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+
+    //two messages nobody asked for are stopped, then a requested one: the table holds them in that order
+    manager.observe(200, autopilotSystem, autopilotComponent, 0);
+    manager.observe(201, autopilotSystem, autopilotComponent, 0);
+    manager.request(MAVLINK_MSG_ID_VFR_HUD, 1000);
+
+    static const uint32_t order[] = {MAVLINK_MSG_ID_ATTITUDE, 200, 201, MAVLINK_MSG_ID_VFR_HUD};
+    for (size_t i = 0; i < 4; i++) {
+        pollAt(manager, 10 * i);
+        CHECK_EQUAL(i + 1, sentCount);
+        CHECK_EQUAL(order[i], (uint32_t) lastSent().param1);
+        ack(manager, 10 * i + 5, i == 0 ? MAV_RESULT_ACCEPTED : MAV_RESULT_DENIED);
+    }
+
+    //after rejectedRetryMillis the stops of messages that have not been seen since are forgotten, the request is
+    // sent again in the same poll, although the second stop took the place of the first
+    run(manager, 100, StreamRateManager::rejectedRetryMillis + 200, 100);
+    CHECK_EQUAL(5, sentCount);
+    CHECK(lastRequested(MAVLINK_MSG_ID_VFR_HUD, 1000, 0));
+    CHECK_EQUAL(StreamRateManager::rejectedRetryMillis + 100, sentMillis[4]);
+
+    //a forgotten message that comes back is stopped again
+    ack(manager, StreamRateManager::rejectedRetryMillis + 105, MAV_RESULT_ACCEPTED);
+    manager.observe(201, autopilotSystem, autopilotComponent, StreamRateManager::rejectedRetryMillis + 150);
+    pollAt(manager, StreamRateManager::rejectedRetryMillis + 200);
+    CHECK_EQUAL(6, sentCount);
+    CHECK(lastRequested(201, 0, 0));
+    CHECK(manager.isConfirmed(MAVLINK_MSG_ID_ATTITUDE));
+}
+
+static void requestsAgainAfterAReboot() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+    manager.request(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 1000);
+    pollAt(manager, 0);
+    ack(manager, 5, MAV_RESULT_ACCEPTED);
+    pollAt(manager, 10);
+    ack(manager, 15, MAV_RESULT_ACCEPTED);
+    CHECK_EQUAL(2, sentCount);
+
+    //regular heartbeats, and those of another autopilot meanwhile, change nothing
+    for (unsigned long now = 1000; now <= 4000; now += 1000) {
+        heartbeat(manager, now);
+        heartbeat(manager, now + 500, 2);
+        pollAt(manager, now + 600);
+    }
+    CHECK_EQUAL(2, sentCount);
+    CHECK_EQUAL(autopilotSystem, manager.targetSystem());
+
+    //after targetTimeoutMillis of silence the autopilot may have rebooted, so every interval is sent again
+    unsigned long back = 4000 + StreamRateManager::targetTimeoutMillis;
+    heartbeat(manager, back);
+    CHECK(!manager.isConfirmed(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(!manager.isConfirmed(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    pollAt(manager, back);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+    ack(manager, back + 5, MAV_RESULT_ACCEPTED);
+    pollAt(manager, back + 10);
+    CHECK(lastRequested(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 1000, 0));
+    CHECK_EQUAL(4, sentCount);
+
+    //after a silence another autopilot may take over
+    unsigned long other = back + StreamRateManager::targetTimeoutMillis;
+    heartbeat(manager, other, 2);
+    CHECK_EQUAL(2, manager.targetSystem());
+    pollAt(manager, other);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+    CHECK_EQUAL(2, lastSent().target_system);
+}
+
+static void driftWindowBacksOff() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+    pollAt(manager, 0);
+    ack(manager, 5, MAV_RESULT_ACCEPTED);
+
+    //at the requested rate nothing is sent again
+    run(manager, 10, 30000, 100);
+    CHECK_EQUAL(1, sentCount);
+
+    //a message that stops coming is requested again after a window, and every window after that is twice as long up
+    // to maxDriftStrikes doublings
+    unsigned long now = 30000;
+    for (int strike = 0; strike <= StreamRateManager::maxDriftStrikes + 1; strike++) {
+        size_t before = sentCount;
+        unsigned long settled = now;
+        int doublings = strike < StreamRateManager::maxDriftStrikes ? strike : StreamRateManager::maxDriftStrikes;
+        unsigned long window = StreamRateManager::minDriftWindowMillis << doublings;
+        while (sentCount == before) {
+            pollAt(manager, now);
+            now += 100;
+        }
+        //the first window may have started before the messages stopped
+        unsigned long waited = sentMillis[(sentCount - 1) % 64] - settled;
+        if (strike == 0) {
+            CHECK(waited <= 2 * window);
+        } else {
+            CHECK(waited >= window && waited < window + 200);
+        }
+        CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+        ack(manager, now, MAV_RESULT_ACCEPTED);
+    }
+
+    //once it comes at its rate again the window is back to the shortest
+    run(manager, now, now + 90000, 100);
+    size_t before = sentCount;
+    run(manager, now + 90000, now + 90000 + 2 * StreamRateManager::minDriftWindowMillis + 100, 0);
+    CHECK(sentCount > before);
+}
+
+static void stopsUnrequestedMessagesUntilFull() {
+    StreamRateManager manager(ownSystem, ownComponent);
+    start(manager);
+    heartbeat(manager, 0);
+    manager.request(MAVLINK_MSG_ID_ATTITUDE, 100);
+
+    //messages of other systems and the messages only sent on events are left alone
+    manager.observe(300, 2, autopilotComponent, 0);
+    manager.observe(MAVLINK_MSG_ID_STATUSTEXT, autopilotSystem, autopilotComponent, 0);
+    attitude(manager, 0);
+
+    //every other message nobody asked for takes an entry, until the table is full
+    for (uint32_t id = 100; id < 100 + StreamRateManager::maxStreams - 1; id++) {
+        manager.observe(id, autopilotSystem, autopilotComponent, 0);
+    }
+    manager.observe(150, autopilotSystem, autopilotComponent, 0);
+    CHECK(!manager.request(MAVLINK_MSG_ID_VFR_HUD, 1000));
+
+    //each is stopped in turn, the table order shows that neither 300 nor STATUSTEXT took an entry
+    pollAt(manager, 0);
+    CHECK(lastRequested(MAVLINK_MSG_ID_ATTITUDE, 100, 0));
+    ack(manager, 5, MAV_RESULT_ACCEPTED);
+    pollAt(manager, 10);
+    CHECK(lastRequested(100, 0, 0));
+    ack(manager, 15, MAV_RESULT_ACCEPTED);
+    CHECK(manager.isConfirmed(100));
+
+    //a stopped message makes room for the next one
+    manager.observe(150, autopilotSystem, autopilotComponent, 20);
+    CHECK(!manager.isConfirmed(100));
+    pollAt(manager, 30);
+    CHECK(lastRequested(150, 0, 0));
+    ack(manager, 35, MAV_RESULT_ACCEPTED);
+    for (uint32_t id = 101; id < 100 + StreamRateManager::maxStreams - 1; id++) {
+        pollAt(manager, 40 + id);
+        CHECK(lastRequested(id, 0, 0));
+        ack(manager, 40 + id, MAV_RESULT_ACCEPTED);
+    }
+    CHECK_EQUAL(StreamRateManager::maxStreams + 1, sentCount);
+    CHECK(manager.request(MAVLINK_MSG_ID_VFR_HUD, 1000));
+}
+
+int main() {
+    RUN_TEST(waitsForTheAutopilot);
+    RUN_TEST(acksSettleTheOutstandingRequest);
+    RUN_TEST(retriesCountConfirmations);
+    RUN_TEST(rejectedRequestsAreRetriedOrForgotten);
+    RUN_TEST(requestsAgainAfterAReboot);
+    RUN_TEST(driftWindowBacksOff);
+    RUN_TEST(stopsUnrequestedMessagesUntilFull);
+    return TEST_RESULT();
+}
@@ -0,0 +1,122 @@
+/**
+* @File: TelemetryCodecTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the TelemetryCodec namespace: the quantization of every field
+ * width the schema allows, the size of a standard sample and the round trip of single samples and batches.
+*/
+
+#include "TestSupport.h"
+#include "TelemetryCodec/TelemetryCodec.h"
+
+using namespace TelemetryCodec;
+
+//A sample with every standard field set, some of them negative.
+static const int64_t sampleValues[] = {
+        1791000000123ll, 435123456, -795123456, 312345, -12345, 31415, -15000, -31415,
+        1234, -4321, 10, 2000, -1999, -300, 35900, 123456700
+};
+
+/**
+ * The standard sample built from sampleValues.
+ * @return TelemetrySample - the sample.
+ */
+static TelemetrySample standardSample() {
+    TelemetrySample sample;
+    for (size_t i = 0; i < standardFieldCount; i++) {
+        sample.fields[standardFields[i].id] = sampleValues[i];
+    }
+    return sample;
+}
+
+static void everyFieldWidthRoundTrips() {
+    const int64_t values[] = {0, 1, -1, 1000, -1000, INT64_MAX / 2, INT64_MIN / 2, INT64_MAX, INT64_MIN + 1};
+
+    for (uint8_t bits = 1; bits <= 63; bits++) {
+        for (int isSigned = 0; isSigned < 2; isSigned++) {
+            FieldSpec spec = {LATITUDE, bits, isSigned != 0, 1, 0};
+            uint64_t mask = fieldMask(bits);
+            int64_t max = isSigned ? (int64_t) (mask >> 1) : (int64_t) mask;
+            int64_t min = isSigned ? -max - 1 : 0;
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+                int64_t expected = values[i] < min ? min : values[i] > max ? max : values[i];
+                uint64_t raw = quantize(spec, values[i]);
+                CHECK((raw & ~mask) == 0);
+                CHECK_EQUAL(expected, dequantize(spec, raw));
+            }
+        }
+    }
+}
+
+static void quantizeRoundsToNearestStep() {
+    FieldSpec spec = {ALTITUDE, 17, false, 100, -1000000};
+
+    CHECK_EQUAL(0, quantize(spec, -1000000));
+    CHECK_EQUAL(1, quantize(spec, -999950));
+    CHECK_EQUAL(0, quantize(spec, -999951));
+    CHECK_EQUAL(0, quantize(spec, -2000000));
+    CHECK_EQUAL(fieldMask(17), quantize(spec, 1000000000));
+    CHECK_EQUAL(-999900, dequantize(spec, 1));
+}
+
+static void standardSampleSize() {
+    //278 bits of fields after the version byte
+    CHECK_EQUAL(36, encodedSize());
+
+    uint8_t buffer[64];
+    CHECK_EQUAL(36, encode(standardSample(), buffer, sizeof(buffer)));
+    CHECK_EQUAL(0, encode(standardSample(), buffer, 35));
+}
+
+static void standardSampleRoundTrips() {
+    TelemetrySample sample = standardSample();
+    uint8_t buffer[64];
+    size_t length = encode(sample, buffer, sizeof(buffer));
+
+    TelemetrySample decoded;
+    CHECK(decode(buffer, length, decoded));
+    for (size_t i = 0; i < standardFieldCount; i++) {
+        const FieldSpec &spec = standardFields[i];
+        CHECK_EQUAL(dequantize(spec, quantize(spec, sample.fields[spec.id])), decoded.fields[spec.id]);
+    }
+
+    CHECK(!decode(buffer, length - 1, decoded));
+    buffer[0] = formatVersion + 1;
+    CHECK(!decode(buffer, length, decoded));
+}
+
+static void batchRoundTrips() {
+    TelemetrySample samples[3];
+    samples[0] = standardSample();
+    for (size_t s = 1; s < 3; s++) {
+        samples[s] = samples[s - 1];
+        samples[s].fields[UNIX_TIME_MILLIS] += 1000;
+        samples[s].fields[LATITUDE] -= 2500;
+        samples[s].fields[YAW] += 120;
+    }
+
+    uint8_t buffer[128];
+    size_t encodedCount;
+    size_t length = encodeBatch(samples, 3, buffer, sizeof(buffer), encodedCount);
+    CHECK(length > 0);
+    CHECK_EQUAL(3, encodedCount);
+
+    TelemetrySample decoded[3];
+    CHECK_EQUAL(3, decodeBatch(buffer, length, decoded, 3));
+    for (size_t s = 0; s < 3; s++) {
+        for (size_t i = 0; i < standardFieldCount; i++) {
+            const FieldSpec &spec = standardFields[i];
+            CHECK_EQUAL(dequantize(spec, quantize(spec, samples[s].fields[spec.id])), decoded[s].fields[spec.id]);
+        }
+    }
+}
+
+int main() {
+    RUN_TEST(everyFieldWidthRoundTrips);
+    RUN_TEST(quantizeRoundsToNearestStep);
+    RUN_TEST(standardSampleSize);
+    RUN_TEST(standardSampleRoundTrips);
+    RUN_TEST(batchRoundTrips);
+    return TEST_RESULT();
+}
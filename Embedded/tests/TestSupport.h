@@ -0,0 +1,46 @@
+/**
+* @File: TestSupport.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file defines the checks used by the host tests in this directory. Every test file builds
+ * into its own executable whose main() runs its test functions with RUN_TEST and returns TEST_RESULT(), so ctest
+ * reports a test file as failed if any of its checks failed. A failed check prints where it is and carries on.
+*/
+
+#ifndef AERORADAREMBEDDED_TESTSUPPORT_H
+#define AERORADAREMBEDDED_TESTSUPPORT_H
+
+#include <stdio.h>
+
+//The number of checks that failed, every test file is a single executable so this is not shared.
+static int testFailures = 0;
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                \
+            testFailures++;                                                                     \
+        }                                                                                       \
+    } while (false)
+
+#define CHECK_EQUAL(expected, actual)                                                           \
+    do {                                                                                        \
+        long long expectedValue = (long long) (expected);                                       \
+        long long actualValue = (long long) (actual);                                           \
+        if (expectedValue != actualValue) {                                                     \
+            printf("%s:%d: CHECK_EQUAL(%s, %s) failed, expected %lld got %lld\n", __FILE__,     \
+                   __LINE__, #expected, #actual, expectedValue, actualValue);                   \
+            testFailures++;                                                                     \
+        }                                                                                       \
+    } while (false)
+
+#define RUN_TEST(test)                                                                          \
+    do {                                                                                        \
+        int failuresBefore = testFailures;                                                      \
+        test();                                                                                 \
+        printf("%s %s\n", testFailures == failuresBefore ? "PASS" : "FAIL", #test);             \
+    } while (false)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+#endif //AERORADAREMBEDDED_TESTSUPPORT_H
@@ -0,0 +1,160 @@
+/**
+* @File: TimeBaseTest.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host tests of the TimeBase class: extrapolating the time from millis() between
+ * syncs, estimating the drift from syncs of the same source at least minDriftIntervalMillis apart, which source wins,
+ * restoring the time after a reset and holding the clock when a sync sets it back.
+*/
+
+#include "TestSupport.h"
+#include "TimeBase/TimeBase.h"
+#include <limits.h>
+
+//A time in 2026, in unix milliseconds.
+static const uint64_t someTime = 1791000000000ull;
+
+//Ten minutes, the shortest sync interval the drift is measured over.
+static const unsigned long tenMinutes = TimeBase::minDriftIntervalMillis;
+
+static void extrapolatesFromMillis() {
+    TimeBase clock;
+    CHECK(!clock.isSynced());
+    CHECK(clock.needsSync(0));
+    CHECK_EQUAL(0, clock.unixMillis(1000));
+
+    CHECK(clock.sync(someTime, 1000, TimeBase::MAVLINK));
+    CHECK(clock.isSynced());
+    CHECK(!clock.needsSync(1000));
+    CHECK_EQUAL(someTime, clock.unixMillis(1000));
+    CHECK_EQUAL(someTime + 60000, clock.unixMillis(61000));
+    CHECK(clock.needsSync(1000 + TimeBase::resyncIntervalMillis));
+
+    //across the wraparound of millis()
+    TimeBase wrapping;
+    wrapping.sync(someTime, ULONG_MAX - 499, TimeBase::MAVLINK);
+    CHECK_EQUAL(someTime + 1000, wrapping.unixMillis(500));
+
+    //the Iridium system time counts 90 ms ticks since its epoch, the MAVLink time microseconds
+    TimeBase iridium;
+    CHECK(iridium.syncFromIridium(1000, 0));
+    CHECK_EQUAL(TimeBase::iridiumEpochUnixMillis + 90000, iridium.unixMillis(0));
+    CHECK_EQUAL(TimeBase::IRIDIUM, iridium.source());
+    TimeBase mavlink;
+    CHECK(!mavlink.syncFromMavlink(0, 0));
+    CHECK(mavlink.syncFromMavlink(someTime * 1000 + 999, 0));
+    CHECK_EQUAL(someTime, mavlink.unixMillis(0));
+}
+
+static void estimatesDrift() {
+    //a local clock that runs 100 ppm slow: 60 ms behind every 10 minutes
+    TimeBase clock;
+    clock.sync(someTime, 0, TimeBase::MAVLINK);
+
+    //syncs less than minDriftIntervalMillis after the reference do not measure it
+    clock.sync(someTime + tenMinutes / 2 + 30, tenMinutes / 2, TimeBase::MAVLINK);
+    CHECK_EQUAL(0, clock.driftPpb());
+
+    //the estimate moves a quarter of the way towards every measurement
+    clock.sync(someTime + tenMinutes + 60, tenMinutes, TimeBase::MAVLINK);
+    CHECK_EQUAL(25000, clock.driftPpb());
+    clock.sync(someTime + 2 * tenMinutes + 120, 2 * tenMinutes, TimeBase::MAVLINK);
+    CHECK_EQUAL(43750, clock.driftPpb());
+
+    //and corrects the extrapolation, by 43 ms over 1000 s
+    CHECK_EQUAL(someTime + 2 * tenMinutes + 120 + 1000000 + 43, clock.unixMillis(2 * tenMinutes + 1000000));
+
+    //an apparent drift above maxDriftPpb is a step of the source, the estimate starts over
+    clock.sync(someTime + 3 * tenMinutes + 2000, 3 * tenMinutes, TimeBase::MAVLINK);
+    CHECK_EQUAL(0, clock.driftPpb());
+}
+
+static void measuresDriftWithinASource() {
+    TimeBase clock;
+    clock.sync(someTime, 0, TimeBase::MAVLINK);
+    clock.sync(someTime + tenMinutes + 60, tenMinutes, TimeBase::MAVLINK);
+    CHECK_EQUAL(25000, clock.driftPpb());
+
+    //a fresh sync of a more accurate source is kept
+    CHECK(!clock.syncFromIridium(0, tenMinutes + 1000));
+    CHECK_EQUAL(TimeBase::MAVLINK, clock.source());
+
+    //a stale one is replaced, the other source starts a new measurement and keeps the estimate
+    unsigned long stale = tenMinutes + TimeBase::resyncIntervalMillis;
+    CHECK(clock.sync(someTime + stale + 5000, stale, TimeBase::IRIDIUM));
+    CHECK_EQUAL(TimeBase::IRIDIUM, clock.source());
+    CHECK_EQUAL(25000, clock.driftPpb());
+    clock.sync(someTime + stale + 5000 + tenMinutes + 60, stale + tenMinutes, TimeBase::IRIDIUM);
+    CHECK_EQUAL(43750, clock.driftPpb());
+}
+
+static void restoresAfterAReset() {
+    TimeBase clock;
+    CHECK(!clock.restore(0, 0, 0));
+    CHECK(clock.restore(someTime, 20000, 100));
+    CHECK_EQUAL(TimeBase::RESTORED, clock.source());
+    CHECK(clock.needsSync(100));
+    CHECK_EQUAL(someTime + 1000000 + 20, clock.unixMillis(1000100));
+
+    //the first real sync replaces it and keeps the drift
+    CHECK(clock.sync(someTime + 3600000, 200, TimeBase::IRIDIUM));
+    CHECK_EQUAL(someTime + 3600000, clock.unixMillis(200));
+    CHECK_EQUAL(20000, clock.driftPpb());
+    CHECK(!clock.restore(someTime, 0, 300));
+
+    //an implausible drift is not restored
+    TimeBase implausible;
+    implausible.restore(someTime, TimeBase::maxDriftPpb + 1, 0);
+    CHECK_EQUAL(0, implausible.driftPpb());
+}
+
+static void neverGoesBackwards() {
+    TimeBase clock;
+    clock.sync(someTime, 0, TimeBase::IRIDIUM);
+
+    //a sync 2 s behind holds the clock until the new time has caught up
+    CHECK(clock.sync(someTime + 8000, 10000, TimeBase::MAVLINK));
+    CHECK_EQUAL(someTime + 10000, clock.unixMillis(10000));
+    CHECK_EQUAL(someTime + 10000, clock.unixMillis(11000));
+    CHECK_EQUAL(someTime + 10000, clock.unixMillis(12000));
+    CHECK_EQUAL(someTime + 10001, clock.unixMillis(12001));
+
+    //and across every sync of a clock with jittery syncs
+    uint64_t last = clock.unixMillis(12001);
+    unsigned long local = 12001;
+    for (int i = 0; i < 1000; i++) {
+        local += 1000;
+        uint64_t source = someTime + local - 2000 + (uint64_t) ((i * 7919) % 3000);
+        clock.sync(source, local, i % 3 == 0 ? TimeBase::IRIDIUM : TimeBase::MAVLINK);
+        for (unsigned long step = 0; step < 1000; step += 250) {
+            uint64_t now = clock.unixMillis(local + step);
+            CHECK(now >= last);
+            last = now;
+        }
+    }
+
+    //a sync more than maxHoldMillis behind sets the clock back, the old time was wrong
+    TimeBase wrong;
+    wrong.sync(someTime + TimeBase::maxHoldMillis + 1, 0, TimeBase::MAVLINK);
+    wrong.sync(someTime, 0, TimeBase::MAVLINK);
+    CHECK_EQUAL(someTime, wrong.unixMillis(0));
+    CHECK_EQUAL(someTime + 10, wrong.unixMillis(10));
+
+    //a later sync ahead of the held time ends the hold
+    TimeBase ahead;
+    ahead.sync(someTime + 5000, 0, TimeBase::MAVLINK);
+    ahead.sync(someTime, 0, TimeBase::MAVLINK);
+    ahead.sync(someTime + 2000, 1000, TimeBase::MAVLINK);
+    CHECK_EQUAL(someTime + 5000, ahead.unixMillis(1000));
+    ahead.sync(someTime + 9000, 2000, TimeBase::MAVLINK);
+    CHECK_EQUAL(someTime + 9000, ahead.unixMillis(2000));
+}
+
+int main() {
+    RUN_TEST(extrapolatesFromMillis);
+    RUN_TEST(estimatesDrift);
+    RUN_TEST(measuresDriftWithinASource);
+    RUN_TEST(restoresAfterAReset);
+    RUN_TEST(neverGoesBackwards);
+    return TEST_RESULT();
+}
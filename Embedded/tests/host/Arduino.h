@@ -0,0 +1,105 @@
+/**
+* @File: Arduino.h
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This header file stands in for the Arduino core in the host build. It declares only what the
+ * firmware modules built by the host tests use. HostArduino.cpp implements it on a simulated clock that only moves
+ * when a test or benchmark moves it, and counts the writes to the pins.
+*/
+
+#ifndef AERORADAREMBEDDED_HOST_ARDUINO_H
+#define AERORADAREMBEDDED_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#define F(string) string
+
+#define LOW 0
+#define HIGH 1
+#define OUTPUT 1
+
+/**
+ * The milliseconds since the host clock started.
+ * @return unsigned long - the milliseconds.
+ */
+unsigned long millis();
+
+/**
+ * The microseconds since the host clock started.
+ * @return unsigned long - the microseconds.
+ */
+unsigned long micros();
+
+void pinMode(int pin, int mode);
+
+void digitalWrite(int pin, int value);
+
+void analogWrite(int pin, int value);
+
+void noInterrupts();
+
+void interrupts();
+
+//The host runs no interrupts, so masking them does nothing.
+inline uint32_t __get_PRIMASK() {
+    return 0;
+}
+
+inline void __disable_irq() {
+}
+
+inline void __set_PRIMASK(uint32_t primask) {
+}
+
+/**
+ * Where text is written, such as Serial. Only the part the firmware modules use, a test implements println() to see
+ * the lines.
+ */
+class Print {
+
+public:
+    virtual ~Print() = default;
+
+    /**
+     * Write a line.
+     * @param text - the line, without the line ending.
+     * @return size_t - the bytes written.
+     */
+    virtual size_t println(const char *text) = 0;
+};
+
+/**
+ * The controls of the host build.
+ */
+namespace HostArduino {
+
+    /**
+     * Move the clock forward.
+     * @param micros - the microseconds to advance by.
+     */
+    void advanceMicros(unsigned long micros);
+
+    /**
+     * Move the clock forward.
+     * @param millis - the milliseconds to advance by.
+     */
+    void advanceMillis(unsigned long millis);
+
+    /**
+     * The number of analogWrite() calls since the start.
+     * @return uint32_t - the number of calls.
+     */
+    uint32_t analogWriteCount();
+
+    /**
+     * The value last written to a pin with analogWrite().
+     * @param pin - the pin, below 32.
+     * @return int - the value, 0 if never written.
+     */
+    int analogValue(int pin);
+}
+
+#endif //AERORADAREMBEDDED_HOST_ARDUINO_H
@@ -0,0 +1,57 @@
+/**
+* @File: HostArduino.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host implementation of the Arduino core declared in Arduino.h.
+*/
+
+#include "Arduino.h"
+
+//The simulated time in microseconds.
+static uint64_t clockMicros = 0;
+
+static uint32_t analogWrites = 0;
+static int analogValues[32];
+
+unsigned long millis() {
+    return (unsigned long) (clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long) clockMicros;
+}
+
+void pinMode(int pin, int mode) {
+}
+
+void digitalWrite(int pin, int value) {
+}
+
+void analogWrite(int pin, int value) {
+    analogWrites++;
+    if (pin >= 0 && pin < 32) {
+        analogValues[pin] = value;
+    }
+}
+
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+void HostArduino::advanceMicros(unsigned long micros) {
+    clockMicros += micros;
+}
+
+void HostArduino::advanceMillis(unsigned long millis) {
+    clockMicros += (uint64_t) millis * 1000;
+}
+
+uint32_t HostArduino::analogWriteCount() {
+    return analogWrites;
+}
+
+int HostArduino::analogValue(int pin) {
+    return pin >= 0 && pin < 32 ? analogValues[pin] : 0;
+}
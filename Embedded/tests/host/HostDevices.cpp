@@ -0,0 +1,49 @@
+/**
+* @File: HostDevices.cpp
+* @Author: Yarema Dzulynsky
+* @Date: 2026-10-16
+* @Description: This file contains the host versions of the firmware's device globals, ledTimer and powerIdle, whose
+ * real implementations program TC3 and put the SAMD21 to sleep. On the host, wake() runs the LED interrupt straight
+ * away, a test calls tick() itself when the next step is due, the heartbeat LED is left out, and idle() moves the
+ * simulated clock forward instead of sleeping.
+*/
+
+#include "Arduino.h"
+#include "DiagnosticTools/LEDTimer.h"
+#include "PowerIdle/GlobalPowerIdle.h"
+
+LEDTimer ledTimer;
+
+PowerIdle powerIdle(50);
+
+void LEDTimer::begin(RGBLED &rgbLED, int heartbeatPin, unsigned long heartbeatMillis) {
+    this->rgbLED = &rgbLED;
+    this->heartbeatPin = heartbeatPin;
+    this->heartbeatMillis = heartbeatMillis;
+    wake();
+}
+
+void LEDTimer::tick() {
+    if (rgbLED == nullptr) {
+        return;
+    }
+    ticks++;
+    rgbLED->asyncRun();
+}
+
+void LEDTimer::wake() {
+    tick();
+}
+
+uint32_t LEDTimer::tickCount() const {
+    return ticks;
+}
+
+PowerIdle::PowerIdle(unsigned long maxIdleMillis) : maxIdleMillis(maxIdleMillis) {
+}
+
+unsigned long PowerIdle::idle(unsigned long millisUntilDeadline) {
+    unsigned long sleep = millisUntilDeadline < maxIdleMillis ? millisUntilDeadline : maxIdleMillis;
+    HostArduino::advanceMillis(sleep);
+    return sleep;
+}
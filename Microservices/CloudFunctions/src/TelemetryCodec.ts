@@ -0,0 +1,577 @@
+/**
+ * Decoder for the compact, quantized binary telemetry format sent by the blackbox.
+ *
+ * This is a port of Embedded/src/TelemetryCodec/TelemetryCodec.h. The schema below must match the firmware schema
+ * entry for entry: a field is transmitted as round((value - offset) / step) in the given number of bits, most
+ * significant bit first, behind a one byte format version. Batches carry a keyframe followed by zigzag/varint encoded
+ * deltas of the quantized fields of every following sample. A sectioned packet whose samples are not encoded with the
+ * standard schema carries a schema section first, describing the schema as the differences from a built-in schema.
+ *
+ * @module TelemetryCodec
+ */
+
+/**
+ * The version of the wire format written as the first byte of every packet.
+ */
+export const TELEMETRY_FORMAT_VERSION = 1;
+
+/**
+ * The version of the batched wire format: a count byte, a keyframe and a delta per following sample.
+ */
+export const TELEMETRY_BATCH_FORMAT_VERSION = 2;
+
+/**
+ * The version of the sectioned wire format: a sequence of typed, length-prefixed sections.
+ */
+export const TELEMETRY_SECTIONED_FORMAT_VERSION = 3;
+
+// Section types of the sectioned format
+const SECTION_SAMPLES = 1;
+const SECTION_HEALTH = 2;
+const SECTION_ACKNOWLEDGEMENTS = 3;
+const SECTION_STATUS = 4;
+const SECTION_SCHEMA = 5;
+
+/**
+ * The device health counters in wire order. New counters are only ever appended.
+ */
+export const HEALTH_COUNTERS = [
+    'uptimeSeconds',
+    'sbdSessions',
+    'sbdFailedSessions',
+    'sbdBytesSent',
+    'sbdCreditsUsed',
+    'mavlinkRxOverflows',
+    'mavlinkRxHighWater',
+    'backlogPending',
+    'backlogOverwritten',
+    'activePermille',
+    'bootReadySeconds',
+    'mavlinkRateRequests',
+    'heapAllocations',
+    'heapFreeChunks',
+    'loopP99Micros',
+    'latencyMaxMicros',
+    'latencyMaxProbe',
+];
+
+/**
+ * The device status fields in wire order. New fields are only ever appended.
+ */
+export const STATUS_FIELDS = [
+    'gpsFix',
+    'bootup',
+    'warmStart',
+    'resetCause',
+    'configSequence',
+];
+
+/**
+ * The kind of acknowledgement that confirms the configuration in effect.
+ * Its value is the upload interval in seconds shifted left by one, ORed with the upload enabled flag.
+ */
+export const ACK_CONFIG = 1;
+
+/**
+ * The kind of acknowledgement that answers a binary configuration command.
+ * Its value is the sequence number of the command shifted left by three, ORed with the index of the result in
+ * COMMAND_RESULTS.
+ */
+export const ACK_COMMAND = 2;
+
+/**
+ * The outcomes of a configuration command, in wire order.
+ */
+export const COMMAND_RESULTS = [
+    'ok',
+    'unknownVersion',
+    'malformed',
+    'invalidValue',
+    'unsupported',
+];
+
+/**
+ * An acknowledgement sent by the device.
+ *
+ * @typedef {Object} Acknowledgement
+ * @property {number} kind - The kind of acknowledgement
+ * @property {number} value - The value being acknowledged
+ */
+export type Acknowledgement = {
+    kind: number;
+    value: number;
+}
+
+/**
+ * The content of a sectioned packet. Sections that were not present are left empty.
+ *
+ * @typedef {Object} SectionedTelemetry
+ * @property {TelemetrySample[]} samples - The samples, oldest first
+ * @property {Object | null} health - The device health counters by name
+ * @property {Acknowledgement[]} acknowledgements - The acknowledgements
+ * @property {Object | null} status - The device status fields by name
+ * @property {TelemetrySchema | null} schema - The schema of the samples, null if they use the standard schema
+ */
+export type SectionedTelemetry = {
+    samples: TelemetrySample[];
+    health: { [counter: string]: number } | null;
+    acknowledgements: Acknowledgement[];
+    status: { [field: string]: number } | null;
+    schema: TelemetrySchema | null;
+}
+
+/**
+ * A decoded telemetry sample. Every field is in the native integer unit used by the firmware. Fields the schema of the
+ * sample does not have are left out.
+ *
+ * @typedef {Object} TelemetrySample
+ * @property {number} unixTimeMillis - Milliseconds since the unix epoch
+ * @property {number} latitude - Degrees * 1E7
+ * @property {number} longitude - Degrees * 1E7
+ * @property {number} altitude - Millimetres above mean sea level
+ * @property {number} relativeAltitude - Millimetres above home
+ * @property {number} roll - Radians * 1E4
+ * @property {number} pitch - Radians * 1E4
+ * @property {number} yaw - Radians * 1E4
+ * @property {number} rollSpeed - Radians per second * 1E3
+ * @property {number} pitchSpeed - Radians per second * 1E3
+ * @property {number} yawSpeed - Radians per second * 1E3
+ * @property {number} vx - Centimetres per second, north
+ * @property {number} vy - Centimetres per second, east
+ * @property {number} vz - Centimetres per second, down
+ * @property {number} heading - Centidegrees
+ * @property {number} timeBoot - Milliseconds since the autopilot booted
+ * @property {number} batteryVoltage - Millivolts
+ * @property {number} batteryCurrent - Centiamperes, -1 if unknown
+ * @property {number} batteryRemaining - Percent, -1 if unknown
+ * @property {number} gpsFixType - MAVLink GPS_FIX_TYPE
+ * @property {number} satellitesVisible - 255 if unknown
+ */
+export type TelemetrySample = {
+    unixTimeMillis: number;
+    latitude?: number;
+    longitude?: number;
+    altitude?: number;
+    relativeAltitude?: number;
+    roll?: number;
+    pitch?: number;
+    yaw?: number;
+    rollSpeed?: number;
+    pitchSpeed?: number;
+    yawSpeed?: number;
+    vx?: number;
+    vy?: number;
+    vz?: number;
+    heading?: number;
+    timeBoot?: number;
+    batteryVoltage?: number;
+    batteryCurrent?: number;
+    batteryRemaining?: number;
+    gpsFixType?: number;
+    satellitesVisible?: number;
+}
+
+export type FieldSpec = {
+    field: keyof TelemetrySample;
+    bits: number;
+    isSigned: boolean;
+    step: number;
+    offset: number;
+}
+
+/**
+ * The schema the samples of a packet are encoded with.
+ *
+ * @typedef {Object} TelemetrySchema
+ * @property {number} base - The built-in schema it was derived from, an index into BUILT_IN_SCHEMAS
+ * @property {FieldSpec[]} fields - The fields in wire order
+ */
+export type TelemetrySchema = {
+    base: number;
+    fields: FieldSpec[];
+}
+
+/**
+ * The fields in the order of their ID, as used by schema descriptors. New fields are only ever appended.
+ */
+const FIELD_IDS: (keyof TelemetrySample)[] = [
+    'unixTimeMillis',
+    'latitude',
+    'longitude',
+    'altitude',
+    'relativeAltitude',
+    'roll',
+    'pitch',
+    'yaw',
+    'rollSpeed',
+    'pitchSpeed',
+    'yawSpeed',
+    'vx',
+    'vy',
+    'vz',
+    'heading',
+    'timeBoot',
+    'batteryVoltage',
+    'batteryCurrent',
+    'batteryRemaining',
+    'gpsFixType',
+    'satellitesVisible',
+];
+
+// The standard schema and the schema of format version 1, in wire order.
+const SCHEMA: FieldSpec[] = [
+    { field: 'unixTimeMillis', bits: 42, isSigned: false, step: 1, offset: 0 },
+    { field: 'latitude', bits: 25, isSigned: true, step: 100, offset: 0 },
+    { field: 'longitude', bits: 26, isSigned: true, step: 100, offset: 0 },
+    { field: 'altitude', bits: 17, isSigned: false, step: 100, offset: -1000000 },
+    { field: 'relativeAltitude', bits: 17, isSigned: true, step: 100, offset: 0 },
+    { field: 'roll', bits: 16, isSigned: true, step: 1, offset: 0 },
+    { field: 'pitch', bits: 16, isSigned: true, step: 1, offset: 0 },
+    { field: 'yaw', bits: 16, isSigned: true, step: 1, offset: 0 },
+    { field: 'rollSpeed', bits: 12, isSigned: true, step: 5, offset: 0 },
+    { field: 'pitchSpeed', bits: 12, isSigned: true, step: 5, offset: 0 },
+    { field: 'yawSpeed', bits: 12, isSigned: true, step: 5, offset: 0 },
+    { field: 'vx', bits: 12, isSigned: true, step: 10, offset: 0 },
+    { field: 'vy', bits: 12, isSigned: true, step: 10, offset: 0 },
+    { field: 'vz', bits: 10, isSigned: true, step: 10, offset: 0 },
+    { field: 'heading', bits: 9, isSigned: false, step: 100, offset: 0 },
+    { field: 'timeBoot', bits: 24, isSigned: false, step: 100, offset: 0 },
+];
+
+// The position schema, in wire order.
+const POSITION_SCHEMA: FieldSpec[] = [
+    { field: 'unixTimeMillis', bits: 42, isSigned: false, step: 1, offset: 0 },
+    { field: 'latitude', bits: 25, isSigned: true, step: 100, offset: 0 },
+    { field: 'longitude', bits: 26, isSigned: true, step: 100, offset: 0 },
+    { field: 'altitude', bits: 17, isSigned: false, step: 100, offset: -1000000 },
+    { field: 'vx', bits: 12, isSigned: true, step: 10, offset: 0 },
+    { field: 'vy', bits: 12, isSigned: true, step: 10, offset: 0 },
+    { field: 'heading', bits: 9, isSigned: false, step: 100, offset: 0 },
+];
+
+// The fields the extended schema appends to the standard schema.
+const EXTENSION_FIELDS: FieldSpec[] = [
+    { field: 'batteryVoltage', bits: 13, isSigned: false, step: 10, offset: 0 },
+    { field: 'batteryCurrent', bits: 12, isSigned: true, step: 10, offset: 0 },
+    { field: 'batteryRemaining', bits: 8, isSigned: true, step: 1, offset: 0 },
+    { field: 'gpsFixType', bits: 4, isSigned: false, step: 1, offset: 0 },
+    { field: 'satellitesVisible', bits: 8, isSigned: false, step: 1, offset: 0 },
+];
+
+/**
+ * The built-in schemas in the order of their ID: standard, position and extended.
+ */
+export const BUILT_IN_SCHEMAS: FieldSpec[][] = [
+    SCHEMA,
+    POSITION_SCHEMA,
+    [...SCHEMA, ...EXTENSION_FIELDS],
+];
+
+/**
+ * Reads values of arbitrary bit width out of a buffer, most significant bit first.
+ */
+class BitReader {
+    private bitPosition = 0;
+    public exhausted = false;
+
+    constructor(private readonly buffer: Buffer) {}
+
+    read(bits: number): number {
+        let value = 0;
+        for (let i = 0; i < bits; i++) {
+            const byteIndex = this.bitPosition >> 3;
+            if (byteIndex >= this.buffer.length) {
+                this.exhausted = true;
+                return 0;
+            }
+            // Multiply instead of shifting so that 32 bit fields do not overflow into the sign bit
+            value = value * 2 + ((this.buffer[byteIndex] >> (7 - (this.bitPosition & 7))) & 1);
+            this.bitPosition++;
+        }
+        return value;
+    }
+}
+
+/**
+ * Check whether a buffer holds a compact telemetry packet rather than raw MAVLink frames or a text message.
+ *
+ * @param {Buffer} buffer - The message data
+ * @returns {boolean} True if the buffer starts with a known format version
+ */
+export function isCompactTelemetry(buffer: Buffer): boolean {
+    return buffer.length > 0 &&
+        (buffer[0] === TELEMETRY_FORMAT_VERSION || buffer[0] === TELEMETRY_BATCH_FORMAT_VERSION ||
+            buffer[0] === TELEMETRY_SECTIONED_FORMAT_VERSION);
+}
+
+/**
+ * Read a varint (7 bits per byte, high bit set on all but the last byte).
+ *
+ * @returns {[number, number] | null} The value and the offset after it, or null if the varint is truncated
+ */
+function readVarint(buffer: Buffer, offset: number): [number, number] | null {
+    let value = 0;
+    let scale = 1;
+    let byte;
+    do {
+        if (offset >= buffer.length) {
+            return null;
+        }
+        byte = buffer[offset++];
+        value += (byte & 0x7F) * scale;
+        scale *= 128;
+    } while (byte & 0x80);
+    return [value, offset];
+}
+
+/**
+ * The number of bytes of a sample bit-packed with a schema, rounded up to a whole byte.
+ */
+function keyframeSize(fields: FieldSpec[]): number {
+    return Math.ceil(fields.reduce((bits, spec) => bits + spec.bits, 0) / 8);
+}
+
+/**
+ * Add, change or remove a field of a schema, keeping the wire order of the firmware: a field that is added goes to
+ * its place in the base schema, or after all base fields in field ID order.
+ *
+ * @param {TelemetrySchema} schema - The schema to change
+ * @param {FieldSpec} spec - The new entry of the field, 0 bits to remove the field
+ */
+function setField(schema: TelemetrySchema, spec: FieldSpec): void {
+    const index = schema.fields.findIndex((existing) => existing.field === spec.field);
+    if (spec.bits === 0) {
+        if (index >= 0) {
+            schema.fields.splice(index, 1);
+        }
+        return;
+    }
+    if (index >= 0) {
+        schema.fields[index] = spec;
+        return;
+    }
+
+    const base = BUILT_IN_SCHEMAS[schema.base];
+    const rank = (field: keyof TelemetrySample) => {
+        const baseIndex = base.findIndex((existing) => existing.field === field);
+        return baseIndex >= 0 ? baseIndex : FIELD_IDS.length + FIELD_IDS.indexOf(field);
+    };
+    let position = schema.fields.length;
+    while (position > 0 && rank(schema.fields[position - 1].field) > rank(spec.field)) {
+        position--;
+    }
+    schema.fields.splice(position, 0, spec);
+}
+
+/**
+ * Read a schema descriptor: the built-in schema ID followed by an entry per field that differs from it (the field ID,
+ * the bits with 0x80 if signed or 0 if the field is removed, and unless removed the varint step and the zigzag varint
+ * offset).
+ *
+ * @param {Buffer} payload - The descriptor
+ * @returns {TelemetrySchema | null} The schema, or null if the descriptor is malformed or uses an unknown schema
+ */
+function readSchemaDescriptor(payload: Buffer): TelemetrySchema | null {
+    if (payload.length < 1 || payload[0] >= BUILT_IN_SCHEMAS.length) {
+        return null;
+    }
+    const schema: TelemetrySchema = { base: payload[0], fields: [...BUILT_IN_SCHEMAS[payload[0]]] };
+    let offset = 1;
+    while (offset < payload.length) {
+        if (payload.length - offset < 2 || payload[offset] >= FIELD_IDS.length) {
+            return null;
+        }
+        const spec: FieldSpec = {
+            field: FIELD_IDS[payload[offset]],
+            bits: payload[offset + 1] & 0x7F,
+            isSigned: (payload[offset + 1] & 0x80) !== 0,
+            step: 0,
+            offset: 0,
+        };
+        offset += 2;
+        if (spec.bits > 0) {
+            const step = readVarint(payload, offset);
+            if (!step) {
+                return null;
+            }
+            const fieldOffset = readVarint(payload, step[1]);
+            if (!fieldOffset) {
+                return null;
+            }
+            spec.step = step[0];
+            // Undo the zigzag mapping (0, 1, 2, 3 -> 0, -1, 1, -2)
+            spec.offset = fieldOffset[0] % 2 === 0 ? fieldOffset[0] / 2 : -(fieldOffset[0] + 1) / 2;
+            offset = fieldOffset[1];
+        }
+        setField(schema, spec);
+    }
+    return schema;
+}
+
+/**
+ * Read one schema field from a bit reader and convert it back to its native unit.
+ */
+function readField(reader: BitReader, spec: FieldSpec): number {
+    let raw = reader.read(spec.bits);
+    // Sign-extend negative two's complement values
+    if (spec.isSigned && raw >= Math.pow(2, spec.bits - 1)) {
+        raw -= Math.pow(2, spec.bits);
+    }
+    return raw * spec.step + spec.offset;
+}
+
+/**
+ * Decode a compact telemetry packet.
+ *
+ * @param {Buffer} buffer - The message data
+ * @returns {TelemetrySample | null} The decoded sample, or null if the packet is unknown or truncated
+ */
+export function decodeTelemetry(buffer: Buffer): TelemetrySample | null {
+    const reader = new BitReader(buffer);
+    if (reader.read(8) !== TELEMETRY_FORMAT_VERSION) {
+        return null;
+    }
+
+    const sample = {} as TelemetrySample;
+    for (const spec of SCHEMA) {
+        sample[spec.field] = readField(reader, spec);
+    }
+
+    return reader.exhausted ? null : sample;
+}
+
+/**
+ * Decode the body of a batch: a count byte, a bit-packed keyframe and a zigzag/varint delta from the previous sample,
+ * in quantization steps, for every following sample.
+ *
+ * @param {Buffer} body - The batch body, starting with the count byte
+ * @param {FieldSpec[]} fields - The fields of the schema of the batch, in wire order
+ * @returns {TelemetrySample[] | null} The decoded samples oldest first, or null if the body is truncated
+ */
+function decodeBatchBody(body: Buffer, fields: FieldSpec[] = SCHEMA): TelemetrySample[] | null {
+    const size = keyframeSize(fields);
+    if (body.length < 1 + size) {
+        return null;
+    }
+    const count = body[0];
+    if (count === 0) {
+        return null;
+    }
+
+    // The keyframe
+    const reader = new BitReader(body.subarray(1, 1 + size));
+    const keyframe = {} as TelemetrySample;
+    for (const spec of fields) {
+        keyframe[spec.field] = readField(reader, spec);
+    }
+    const samples: TelemetrySample[] = [keyframe];
+
+    // The deltas
+    let offset = 1 + size;
+    for (let s = 1; s < count; s++) {
+        const sample = { ...samples[s - 1] };
+        for (const spec of fields) {
+            const varint = readVarint(body, offset);
+            if (!varint) {
+                return null;
+            }
+            const [value, next] = varint;
+            offset = next;
+
+            // Undo the zigzag mapping (0, 1, 2, 3 -> 0, -1, 1, -2)
+            const delta = value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+            sample[spec.field] = (sample[spec.field] as number) + delta * spec.step;
+        }
+        samples.push(sample);
+    }
+
+    return samples;
+}
+
+/**
+ * Decode a batch packet (format version 2).
+ *
+ * @param {Buffer} buffer - The message data
+ * @returns {TelemetrySample[] | null} The decoded samples oldest first, or null if the packet is unknown or truncated
+ */
+export function decodeTelemetryBatch(buffer: Buffer): TelemetrySample[] | null {
+    if (buffer.length < 1 || buffer[0] !== TELEMETRY_BATCH_FORMAT_VERSION) {
+        return null;
+    }
+    return decodeBatchBody(buffer.subarray(1));
+}
+
+/**
+ * Decode a sectioned packet (format version 3). Unknown section types are skipped. The samples are decoded with the
+ * schema of the schema section before them, or the standard schema if there is none.
+ *
+ * @param {Buffer} buffer - The message data
+ * @returns {SectionedTelemetry | null} The content of the packet, or null if the packet is unknown or malformed
+ */
+export function decodeSectionedTelemetry(buffer: Buffer): SectionedTelemetry | null {
+    if (buffer.length < 1 || buffer[0] !== TELEMETRY_SECTIONED_FORMAT_VERSION) {
+        return null;
+    }
+
+    const result: SectionedTelemetry = {
+        samples: [], health: null, acknowledgements: [], status: null, schema: null,
+    };
+    let offset = 1;
+    while (offset < buffer.length) {
+        const type = buffer[offset++];
+        const length = readVarint(buffer, offset);
+        if (!length || length[1] + length[0] > buffer.length) {
+            return null;
+        }
+        const payload = buffer.subarray(length[1], length[1] + length[0]);
+        offset = length[1] + length[0];
+
+        if (type === SECTION_SCHEMA) {
+            result.schema = readSchemaDescriptor(payload);
+            if (!result.schema) {
+                return null;
+            }
+        } else if (type === SECTION_SAMPLES) {
+            const samples = decodeBatchBody(payload, result.schema ? result.schema.fields : SCHEMA);
+            if (!samples) {
+                return null;
+            }
+            result.samples = samples;
+        } else if (type === SECTION_HEALTH) {
+            result.health = {};
+            let position = 0;
+            for (let i = 0; i < HEALTH_COUNTERS.length && position < payload.length; i++) {
+                const varint = readVarint(payload, position);
+                if (!varint) {
+                    return null;
+                }
+                result.health[HEALTH_COUNTERS[i]] = varint[0];
+                position = varint[1];
+            }
+        } else if (type === SECTION_ACKNOWLEDGEMENTS) {
+            let position = 0;
+            while (position < payload.length) {
+                const kind = payload[position++];
+                const varint = readVarint(payload, position);
+                if (!varint) {
+                    return null;
+                }
+                result.acknowledgements.push({ kind: kind, value: varint[0] });
+                position = varint[1];
+            }
+        } else if (type === SECTION_STATUS) {
+            result.status = {};
+            let position = 0;
+            for (let i = 0; i < STATUS_FIELDS.length && position < payload.length; i++) {
+                const varint = readVarint(payload, position);
+                if (!varint) {
+                    return null;
+                }
+                result.status[STATUS_FIELDS[i]] = varint[0];
+                position = varint[1];
+            }
+        }
+    }
+
+    return result;
+}
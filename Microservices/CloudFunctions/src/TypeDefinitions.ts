@@ -21,6 +21,11 @@
  * @property {number} vz - Velocity of the drone in the z-axis in meters per second
  * @property {number} yaw - Yaw angle of the drone in degrees
  * @property {boolean} inFlight - Whether the drone is in flight
+ * @property {number} [batteryVoltage] - Battery voltage in volts
+ * @property {number} [batteryCurrent] - Battery current in amperes, -0.01 if unknown
+ * @property {number} [batteryRemaining] - Remaining battery in percent, -1 if unknown
+ * @property {number} [gpsFixType] - MAVLink GPS fix type
+ * @property {number} [satellitesVisible] - Number of visible GPS satellites, 255 if unknown
  */
 export type SatToFirebase = {
     rollSpeed: number;
@@ -42,6 +47,11 @@ export type SatToFirebase = {
     vz: number;
     yaw: number;
     inFlight: boolean;
+    batteryVoltage?: number;
+    batteryCurrent?: number;
+    batteryRemaining?: number;
+    gpsFixType?: number;
+    satellitesVisible?: number;
 
 }
 
@@ -9,6 +9,19 @@ import * as functions from 'firebase-functions';
 import * as admin from 'firebase-admin';
 import { PassThrough } from "stream";
 import { SatToFirebase, RockBlockMessage } from "./TypeDefinitions";
+import {
+    ACK_COMMAND,
+    ACK_CONFIG,
+    Acknowledgement,
+    COMMAND_RESULTS,
+    decodeSectionedTelemetry,
+    decodeTelemetry,
+    decodeTelemetryBatch,
+    isCompactTelemetry,
+    TELEMETRY_BATCH_FORMAT_VERSION,
+    TELEMETRY_SECTIONED_FORMAT_VERSION,
+    TelemetrySample
+} from "./TelemetryCodec";
 import {
     common,
     MavLinkPacketParser,
@@ -31,6 +44,52 @@ const allowedIPAddresses: string[] = ['<IP ADDRESSES>'];
 const imeiToDroneID: Map<string, string> = new Map<string, string>();
 imeiToDroneID.set('<MODEM SERIAL NUMBER>', '<DRONE ID>');
 
+/**
+ * Copy a decoded compact telemetry sample into the object that is pushed to Firebase, converting every field from the
+ * firmware's native integer units into the units used by the website. Fields the telemetry schema left out keep their
+ * last value.
+ *
+ * @param {TelemetrySample} sample - The decoded sample
+ * @param {SatToFirebase} data - The object to fill in
+ */
+function applyTelemetrySample(sample: TelemetrySample, data: SatToFirebase) {
+    const radToDeg = 180 / Math.PI;
+
+    if (sample.roll !== undefined) data.roll = parseFloat((sample.roll / 1E4 * radToDeg).toFixed(2));
+    if (sample.pitch !== undefined) data.pitch = parseFloat((sample.pitch / 1E4 * radToDeg).toFixed(2));
+    if (sample.yaw !== undefined) data.yaw = parseFloat((sample.yaw / 1E4 * radToDeg).toFixed(2));
+    if (sample.rollSpeed !== undefined) data.rollSpeed = parseFloat((sample.rollSpeed / 1E3 * radToDeg).toFixed(2));
+    if (sample.pitchSpeed !== undefined) data.pitchSpeed = parseFloat((sample.pitchSpeed / 1E3 * radToDeg).toFixed(2));
+    if (sample.yawSpeed !== undefined) data.yawSpeed = parseFloat((sample.yawSpeed / 1E3 * radToDeg).toFixed(2));
+
+    // Calculate the ground speed of the aircraft
+    if (sample.vx !== undefined && sample.vy !== undefined) {
+        const groundSpeed = Math.round(Math.sqrt(Math.pow(sample.vx, 2) + Math.pow(sample.vy, 2)));
+        data.groundSpeed = groundSpeed / 100;
+    }
+
+    if (sample.latitude !== undefined) data.latitude = sample.latitude / 10000000;
+    if (sample.longitude !== undefined) data.longitude = sample.longitude / 10000000;
+    if (sample.altitude !== undefined) data.altitude = sample.altitude / 1000;
+    if (sample.relativeAltitude !== undefined) data.relativeAltitude = sample.relativeAltitude / 1000;
+    if (sample.vx !== undefined) {
+        data.vx = sample.vx / 100;
+        data.inFlight = (sample.vx / 100) > 65;
+    }
+    if (sample.vy !== undefined) data.vy = sample.vy / 100;
+    if (sample.vz !== undefined) data.vz = sample.vz / 100;
+    if (sample.heading !== undefined) data.heading = sample.heading / 100;
+    if (sample.timeBoot !== undefined) data.flightTime = sample.timeBoot / 1000;
+    data.uploadTime = sample.unixTimeMillis / 1000;
+
+    // The battery and the GPS receiver, sent by the extended schema
+    if (sample.batteryVoltage !== undefined) data.batteryVoltage = sample.batteryVoltage / 1000;
+    if (sample.batteryCurrent !== undefined) data.batteryCurrent = sample.batteryCurrent / 100;
+    if (sample.batteryRemaining !== undefined) data.batteryRemaining = sample.batteryRemaining;
+    if (sample.gpsFixType !== undefined) data.gpsFixType = sample.gpsFixType;
+    if (sample.satellitesVisible !== undefined) data.satellitesVisible = sample.satellitesVisible;
+}
+
 /**
  * Cloud Function to receive RockBlock messages from IoT device.
  *
@@ -116,6 +175,75 @@ exports.receiveRockBlockMessage = functions.https.onRequest(async (req, res) =>
             // Convert message data from hex to a buffer
             const buffer = Buffer.from(message.data, 'hex');
 
+            // Check if it's a compact telemetry packet
+            if (isCompactTelemetry(buffer)) {
+                const droneID = imeiToDroneID.get(message.imei) as string;
+                let samples: TelemetrySample[] | null = null;
+                let acknowledgements: Acknowledgement[] = [];
+
+                if (buffer[0] === TELEMETRY_SECTIONED_FORMAT_VERSION) {
+                    const sectioned = decodeSectionedTelemetry(buffer);
+                    if (sectioned) {
+                        samples = sectioned.samples;
+                        acknowledgements = sectioned.acknowledgements;
+                        if (sectioned.schema) {
+                            // Which fields the device sends, so the website knows which values are live
+                            await admin.database().ref('Config/' + droneID + "/schema").set({
+                                base: sectioned.schema.base,
+                                fields: sectioned.schema.fields.map((spec) => spec.field),
+                            });
+                        }
+                        if (sectioned.health) {
+                            await admin.database().ref('Health/' + droneID).set(sectioned.health);
+                        }
+                        if (sectioned.status) {
+                            await admin.database().ref('Status/' + droneID).set(sectioned.status);
+                            await admin.database().ref('Config/' + droneID + "/GPSFix").set(sectioned.status.gpsFix === 1);
+
+                            // The bootup notice replaces the legacy bootup message, a configuration has to be sent again
+                            if (sectioned.status.bootup === 1) {
+                                await admin.database().ref('Config/' + droneID + "/ready").set(false);
+                                await admin.database().ref('Config/' + droneID + "/receivedConfig").set(false);
+                            }
+                        }
+                    }
+                } else if (buffer[0] === TELEMETRY_BATCH_FORMAT_VERSION) {
+                    samples = decodeTelemetryBatch(buffer);
+                } else {
+                    const sample = decodeTelemetry(buffer);
+                    samples = sample ? [sample] : null;
+                }
+                if (!samples) {
+                    console.error('Malformed compact telemetry packet:', message);
+                    res.status(400).send(`Malformed compact telemetry packet`);
+                    return;
+                }
+
+                // A configuration acknowledgement completes the same handshake as the legacy config message
+                for (const ack of acknowledgements) {
+                    if (ack.kind === ACK_CONFIG) {
+                        await admin.database().ref('Config/' + droneID + "/receivedConfig").set(true);
+                        await admin.database().ref('Config/' + droneID + "/lastHandshake").set(Date.now());
+                    } else if (ack.kind === ACK_COMMAND) {
+                        // Record which command the device answered and how, so the website can tell if it was applied
+                        await admin.database().ref('Config/' + droneID + "/lastCommand").set({
+                            sequence: ack.value >>> 3,
+                            result: COMMAND_RESULTS[ack.value & 7] || 'unknown',
+                        });
+                    }
+                }
+
+                dataToPushToFirebase.droneID = droneID;
+
+                // Write every sample to Firebase Realtime Database oldest first, so the mission log sees the full track
+                for (const sample of samples) {
+                    applyTelemetrySample(sample, dataToPushToFirebase);
+                    await admin.database().ref('Live/' + dataToPushToFirebase.droneID).set(dataToPushToFirebase);
+                }
+                res.status(200).send(dataToPushToFirebase);
+                return;
+            }
+
             // Check if it's a config message
             const configMessage = buffer.toString('utf8');
             console.log('Config message: ' + configMessage);
@@ -4,6 +4,7 @@ import {DroneConfigProps} from "../interfaces/PropArguments";
 import {Button, Input, Segment} from "semantic-ui-react";
 import Database from "../database/Database";
 import {sendMessageURL} from "../credentials/APICredentials";
+import {configCommandToHexString, MAX_COMMAND_SEQUENCE} from "../helpers/ConfigCommandHelper";
 
 export default function DroneConfigBanner(props: DroneConfigProps): JSX.Element {
     const [config, setConfig] = useState({
@@ -43,8 +44,11 @@ export default function DroneConfigBanner(props: DroneConfigProps): JSX.Element
         if (!config.ready) {
             Database.setData(`Config/${props.droneID}/receivedConfig`, false);
 
-            const sendString = `${config.online ? "1" : "0"},${config.frequency},`;
-            const hexString = stringToHexString(sendString);
+            // The device acknowledges the command with its sequence number, seconds are unique enough for a human
+            const hexString = configCommandToHexString({
+                sequence: Math.floor(Date.now() / 1000) & MAX_COMMAND_SEQUENCE,
+                upload: {enabled: config.online, intervalSeconds: config.frequency},
+            });
 
             const options = {method: 'POST', headers: {accept: 'text/plain'}};
 
@@ -72,13 +76,6 @@ export default function DroneConfigBanner(props: DroneConfigProps): JSX.Element
         Database.setData(`Config/${props.droneID}/frequency`, newFrequency);
     }
 
-    function stringToHexString(input: string): string {
-        return input
-            .split("")
-            .map((char) => char.charCodeAt(0).toString(16))
-            .join("");
-    }
-
     const bannerStyle = {
         backgroundColor: "#f9f9f9",
         borderRadius: "5px",
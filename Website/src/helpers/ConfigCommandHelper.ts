@@ -0,0 +1,191 @@
+/**
+
+ Encodes the binary configuration commands sent to the Blackbox as mobile terminated SBD messages. This mirrors
+ Embedded/src/ConfigProtocol/ConfigProtocol.h and must be updated together with it:
+
+     version | varint sequence | (type | varint length | payload)*
+
+ Embedded/tests/ConfigProtocolTest.cpp parses a command encoded by this file, regenerate it when the encoding changes.
+
+ */
+
+// The version of the command format
+const COMMAND_FORMAT_VERSION = 1;
+
+// Entry types of a command
+const ENTRY_UPLOAD = 1;
+const ENTRY_MESSAGE_RATE = 2;
+const ENTRY_CODEC = 3;
+const ENTRY_QUANTIZATION = 4;
+const ENTRY_SCHEMA = 5;
+
+/**
+
+ The largest sequence number of a command. The device echoes it in its acknowledgement.
+ */
+export const MAX_COMMAND_SEQUENCE = 0xFFFFFF;
+
+/**
+
+ How the samples of an upload are encoded: a delta encoded batch of the history, or only the latest sample.
+ */
+export enum Codec {
+    Batch = 0,
+    Latest = 1,
+}
+
+/**
+
+ The telemetry schemas built into the Blackbox: which fields are sampled and sent.
+ */
+export enum TelemetrySchema {
+    // Attitude and position
+    Standard = 0,
+    // Position and velocity only, about half the size of the standard schema
+    Position = 1,
+    // The standard schema, the battery and the GPS receiver state
+    Extended = 2,
+}
+
+/**
+
+ @interface MessageRate
+ @description The interval a MAVLink message of the telemetry schema is requested from the Pixhawk at.
+ @property {number} messageId - The MAVLink message ID.
+ @property {number} intervalMillis - The interval between two messages in milliseconds.
+ */
+export interface MessageRate {
+    messageId: number;
+    intervalMillis: number;
+}
+
+/**
+
+ @interface FieldQuantization
+ @description The quantization of a telemetry field on the wire.
+ @property {number} field - The ID of the field, in the order of the firmware's TelemetryCodec::FieldId.
+ @property {number} bits - The number of bits of the quantized field (1 - 63), 0 to remove the field from the schema.
+ @property {boolean} signed - Whether the quantized field is two's complement.
+ @property {number} step - The size of one quantization step in the field's native unit.
+ @property {number} offset - The value subtracted before quantizing, in the field's native unit.
+ */
+export interface FieldQuantization {
+    field: number;
+    bits: number;
+    signed: boolean;
+    step: number;
+    offset: number;
+}
+
+/**
+
+ @interface ConfigCommand
+ @description A configuration command. Only the parts that are set are sent.
+ @property {number} sequence - The sequence number of the command.
+ @property {Object} [upload] - The upload flag and the upload interval in seconds.
+ @property {MessageRate[]} [messageRates] - The request intervals of messages of the telemetry schema.
+ @property {Codec} [codec] - The sample codec.
+ @property {TelemetrySchema} [schema] - The built-in telemetry schema, applied before the quantizations.
+ @property {FieldQuantization[]} [quantizations] - The fields to add to, requantize in or remove from the schema.
+ */
+export interface ConfigCommand {
+    sequence: number;
+    upload?: {
+        enabled: boolean;
+        intervalSeconds: number;
+    };
+    messageRates?: MessageRate[];
+    codec?: Codec;
+    schema?: TelemetrySchema;
+    quantizations?: FieldQuantization[];
+}
+
+/**
+
+ Appends a value as a varint (7 bits per byte, high bit set on all but the last byte).
+
+ @param {number[]} bytes - The bytes to append to.
+
+ @param {number} value - The non-negative integer to append.
+ */
+function pushVarint(bytes: number[], value: number): void {
+    while (value >= 0x80) {
+        bytes.push((value % 0x80) | 0x80);
+        value = Math.floor(value / 0x80);
+    }
+    bytes.push(value);
+}
+
+/**
+
+ Appends an entry with its type and length.
+
+ @param {number[]} bytes - The bytes to append to.
+
+ @param {number} type - The entry type.
+
+ @param {number[]} payload - The payload of the entry.
+ */
+function pushEntry(bytes: number[], type: number, payload: number[]): void {
+    bytes.push(type);
+    pushVarint(bytes, payload.length);
+    bytes.push(...payload);
+}
+
+/**
+
+ Encodes a configuration command.
+
+ @param {ConfigCommand} command - The command.
+
+ @returns {number[]} - The bytes of the command.
+ */
+export function encodeConfigCommand(command: ConfigCommand): number[] {
+    const bytes: number[] = [COMMAND_FORMAT_VERSION];
+    pushVarint(bytes, command.sequence & MAX_COMMAND_SEQUENCE);
+
+    if (command.upload) {
+        const payload: number[] = [];
+        pushVarint(payload, Math.max(0, Math.round(command.upload.intervalSeconds)) * 2 + (command.upload.enabled ? 1 : 0));
+        pushEntry(bytes, ENTRY_UPLOAD, payload);
+    }
+    for (const rate of command.messageRates ?? []) {
+        const payload: number[] = [];
+        pushVarint(payload, rate.messageId);
+        pushVarint(payload, rate.intervalMillis);
+        pushEntry(bytes, ENTRY_MESSAGE_RATE, payload);
+    }
+    if (command.codec !== undefined) {
+        pushEntry(bytes, ENTRY_CODEC, [command.codec]);
+    }
+    if (command.schema !== undefined) {
+        pushEntry(bytes, ENTRY_SCHEMA, [command.schema]);
+    }
+    for (const quantization of command.quantizations ?? []) {
+        // a removed field has no step and offset
+        if (quantization.bits === 0) {
+            pushEntry(bytes, ENTRY_QUANTIZATION, [quantization.field, 0]);
+            continue;
+        }
+        const payload: number[] = [quantization.field, quantization.bits | (quantization.signed ? 0x80 : 0)];
+        pushVarint(payload, quantization.step);
+        // zigzag, so that small negative offsets stay short
+        pushVarint(payload, quantization.offset < 0 ? -quantization.offset * 2 - 1 : quantization.offset * 2);
+        pushEntry(bytes, ENTRY_QUANTIZATION, payload);
+    }
+    return bytes;
+}
+
+/**
+
+ Encodes a configuration command as the hex string expected by the RockBlock API.
+
+ @param {ConfigCommand} command - The command.
+
+ @returns {string} - The hex string of the command.
+ */
+export function configCommandToHexString(command: ConfigCommand): string {
+    return encodeConfigCommand(command)
+        .map((byte) => byte.toString(16).padStart(2, "0"))
+        .join("");
+}